@@ -1,5 +0,0 @@
-#include <time.h>
-#include <sys/time.h>
-#include "esp_log.h"
-
-void set_time_to_2026_01_13_17_00_local(void);
@@ -0,0 +1,66 @@
+#pragma once
+#include <stdint.h>
+#include <time.h>
+
+#include "esp_err.h"
+#include "esp_timer.h"
+
+// Единая шкала времени прошивки.
+//
+//   timebase_mono_us() — монотонная, мкс от загрузки (esp_timer). Ею
+//       метятся события конвейера: всплески RMT, пакеты, снимки питания.
+//   timebase_now_us()  — настенная, мкс от эпохи (TZ не задан: местное =
+//       UTC). Это монотонная + смещение + поправка хода кварца; чтение без
+//       блокировок (seqlock, пишущий — в критической секции), из ISR можно.
+//
+// Настенное время переживает перезагрузку и deep sleep — в RTC-памяти
+// вместе с отметкой RTC-таймера (он идёт и во сне), выключение питания —
+// в NVS (последнее сохранённое, раз в час: после включения отстаёт на
+// время без питания). Без того и другого — время по умолчанию.
+//
+// Уход хода учится по поправкам пользователя: ошибка предсказанного
+// времени делится на время с прошлой поправки (не меньше
+// TIMEBASE_LEARN_MIN_S), оценка копится с весом 1/2 и хранится в NVS.
+// Поправка больше TIMEBASE_STEP_MAX_S — это установка, а не уход.
+
+#define TIMEBASE_LEARN_MIN_S 3600
+#define TIMEBASE_STEP_MAX_S 3600
+#define TIMEBASE_DRIFT_MAX_PPB 200000 // ±200 ppm
+#define TIMEBASE_SAVE_PERIOD_S 3600
+
+typedef enum {
+    TIMEBASE_SRC_DEFAULT = 0, // не выставлялось: 2026-01-13 17:00
+    TIMEBASE_SRC_NVS,         // последнее сохранённое до выключения
+    TIMEBASE_SRC_RTC,         // пережило сброс / deep sleep
+    TIMEBASE_SRC_USER,        // выставлено вручную
+} timebase_src_t;
+
+// Как можно раньше в app_main (поднимает NVS, если ещё не поднят)
+esp_err_t timebase_init(void);
+
+static inline int64_t timebase_mono_us(void)
+{
+    return esp_timer_get_time(); // в IRAM, из ISR можно
+}
+
+// Из любого контекста, включая ISR
+int64_t timebase_mono_to_wall_us(int64_t mono_us);
+
+static inline int64_t timebase_now_us(void)
+{
+    return timebase_mono_to_wall_us(timebase_mono_us());
+}
+
+static inline time_t timebase_now_s(void)
+{
+    return (time_t)(timebase_now_us() / 1000000);
+}
+
+// Поправка пользователя (из задачи): сдвиг + обучение ухода
+esp_err_t timebase_set_wall_us(int64_t wall_us);
+
+timebase_src_t timebase_source(void);
+int32_t timebase_drift_ppb(void);
+
+// В лог: источник, время, уход, число поправок
+void timebase_report(void);
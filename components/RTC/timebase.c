@@ -0,0 +1,297 @@
+#include "timebase.h"
+
+#include <stddef.h>
+#include <sys/time.h>
+
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_rtc_time.h"
+#include "freertos/FreeRTOS.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+
+static const char *TAG = "timebase";
+
+#define TB_DEFAULT_WALL_S 1768323600LL // 2026-01-13 17:00:00
+#define TB_RTC_MAGIC 0x54494D45u       // "TIME"
+#define TB_NVS_NS "timebase"
+#define TB_TICK_S 60                   // перепривязка к RTC-таймеру
+
+// wall = base_wall + d + (d * rate_q24 >> 24), d = mono - base_mono.
+// rate_q24 — поправка хода в долях 2^-24 (~0.06 ppm): в ISR только
+// умножение и сдвиг, d * rate не переполняется и за годы.
+typedef struct {
+    int64_t base_mono_us;
+    int64_t base_wall_us;
+    int32_t rate_q24;
+} tb_state_t;
+
+static tb_state_t s_st = {.base_wall_us = TB_DEFAULT_WALL_S * 1000000};
+static volatile uint32_t s_seq = 0; // нечётный — идёт запись
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Переживает программный сброс и deep sleep. Привязка «RTC-таймер ->
+// настенное время» обновляется раз в TB_TICK_S и при каждой поправке.
+typedef struct {
+    uint32_t magic;
+    uint32_t check; // сумма полей ниже
+    int64_t anchor_rtc_us;
+    int64_t anchor_wall_us;
+    int64_t sync_wall_us; // последняя поправка, 0 — не было (или разрыв)
+    int32_t drift_ppb;
+    uint32_t corrections;
+} tb_rtc_t;
+
+RTC_NOINIT_ATTR static tb_rtc_t s_rtc;
+
+static timebase_src_t s_src = TIMEBASE_SRC_DEFAULT;
+static int32_t s_drift_ppb = 0;
+static int64_t s_sync_wall_us = 0;
+static uint32_t s_corrections = 0;
+static bool s_nvs_ok = false;
+static esp_timer_handle_t s_tick = NULL;
+static uint32_t s_ticks = 0;
+
+static const char *const s_src_names[] = {"default", "nvs", "rtc", "user"};
+
+// ------------------------- шкала -------------------------
+
+static int32_t ppb_to_q24(int32_t ppb)
+{
+    return (int32_t)(((int64_t)ppb << 24) / 1000000000);
+}
+
+static int64_t apply_rate(int64_t d, int32_t rate_q24)
+{
+    return d + ((d * rate_q24) >> 24);
+}
+
+IRAM_ATTR int64_t timebase_mono_to_wall_us(int64_t mono_us)
+{
+    uint32_t seq;
+    tb_state_t st;
+    do
+    {
+        seq = __atomic_load_n(&s_seq, __ATOMIC_ACQUIRE);
+        st = s_st;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((seq & 1) || seq != __atomic_load_n(&s_seq, __ATOMIC_RELAXED));
+    return st.base_wall_us + apply_rate(mono_us - st.base_mono_us, st.rate_q24);
+}
+
+// Из задачи. Прерывания на этом ядре выключены — ISR не застанет запись
+// на середине и не зациклится; читатель на другом ядре подождёт.
+static void state_commit(int64_t mono_us, int64_t wall_us, int32_t drift_ppb)
+{
+    taskENTER_CRITICAL(&s_lock);
+    __atomic_store_n(&s_seq, s_seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    s_st.base_mono_us = mono_us;
+    s_st.base_wall_us = wall_us;
+    s_st.rate_q24 = ppb_to_q24(drift_ppb);
+    __atomic_store_n(&s_seq, s_seq + 1, __ATOMIC_RELEASE);
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+// ------------------------- хранение -------------------------
+
+static uint32_t rtc_sum(const tb_rtc_t *r)
+{
+    const uint8_t *p = (const uint8_t *)r + offsetof(tb_rtc_t, anchor_rtc_us);
+    size_t n = sizeof(*r) - offsetof(tb_rtc_t, anchor_rtc_us);
+    uint32_t h = 2166136261u; // FNV-1a
+    for (size_t i = 0; i < n; i++)
+        h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+// Привязка к RTC-таймеру по текущему настенному времени
+static void rtc_save(void)
+{
+    int64_t rtc_us = (int64_t)esp_rtc_get_time_us();
+    s_rtc.anchor_wall_us = timebase_now_us();
+    s_rtc.anchor_rtc_us = rtc_us;
+    s_rtc.sync_wall_us = s_sync_wall_us;
+    s_rtc.drift_ppb = s_drift_ppb;
+    s_rtc.corrections = s_corrections;
+    s_rtc.check = rtc_sum(&s_rtc);
+    s_rtc.magic = TB_RTC_MAGIC;
+}
+
+static bool rtc_load(int64_t *wall_us)
+{
+    if (s_rtc.magic != TB_RTC_MAGIC || s_rtc.check != rtc_sum(&s_rtc))
+        return false;
+    int64_t d = (int64_t)esp_rtc_get_time_us() - s_rtc.anchor_rtc_us;
+    if (d < 0)
+        return false; // RTC-таймер сброшен (включение питания)
+    s_drift_ppb = s_rtc.drift_ppb;
+    s_sync_wall_us = s_rtc.sync_wall_us;
+    s_corrections = s_rtc.corrections;
+    *wall_us = s_rtc.anchor_wall_us + apply_rate(d, ppb_to_q24(s_drift_ppb));
+    return true;
+}
+
+static void nvs_save(void)
+{
+    if (!s_nvs_ok)
+        return;
+    nvs_handle_t h;
+    if (nvs_open(TB_NVS_NS, NVS_READWRITE, &h) != ESP_OK)
+        return;
+    esp_err_t err = nvs_set_i64(h, "wall", timebase_now_us());
+    if (err == ESP_OK)
+        err = nvs_set_i32(h, "drift", s_drift_ppb);
+    if (err == ESP_OK)
+        err = nvs_set_i64(h, "sync", s_sync_wall_us);
+    if (err == ESP_OK)
+        err = nvs_set_u32(h, "corr", s_corrections);
+    if (err == ESP_OK)
+        err = nvs_commit(h);
+    nvs_close(h);
+    if (err != ESP_OK)
+        ESP_LOGW(TAG, "NVS save: %s", esp_err_to_name(err));
+}
+
+// Уход — свойство кварца, берём всегда; время — только если RTC не помог
+static bool nvs_load(int64_t *wall_us)
+{
+    nvs_handle_t h;
+    if (!s_nvs_ok || nvs_open(TB_NVS_NS, NVS_READONLY, &h) != ESP_OK)
+        return false;
+    int32_t drift = 0;
+    if (nvs_get_i32(h, "drift", &drift) == ESP_OK)
+        s_drift_ppb = drift;
+    uint32_t corr = 0;
+    if (nvs_get_u32(h, "corr", &corr) == ESP_OK)
+        s_corrections = corr;
+    bool ok = nvs_get_i64(h, "wall", wall_us) == ESP_OK;
+    nvs_close(h);
+    return ok;
+}
+
+static void tick_cb(void *arg)
+{
+    (void)arg;
+    rtc_save();
+    // libc (time/localtime у сторонних) — по той же шкале
+    int64_t now = timebase_now_us();
+    struct timeval tv = {.tv_sec = (time_t)(now / 1000000),
+                         .tv_usec = (suseconds_t)(now % 1000000)};
+    settimeofday(&tv, NULL);
+    if (++s_ticks % (TIMEBASE_SAVE_PERIOD_S / TB_TICK_S) == 0)
+        nvs_save();
+}
+
+// ------------------------- API -------------------------
+
+esp_err_t timebase_init(void)
+{
+    if (s_tick)
+        return ESP_ERR_INVALID_STATE;
+
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    {
+        ESP_LOGW(TAG, "NVS partition reformatted");
+        err = nvs_flash_erase();
+        if (err == ESP_OK)
+            err = nvs_flash_init();
+    }
+    s_nvs_ok = err == ESP_OK;
+    if (!s_nvs_ok)
+        ESP_LOGW(TAG, "NVS unavailable (%s), time survives resets only",
+                 esp_err_to_name(err));
+
+    int64_t wall_us = TB_DEFAULT_WALL_S * 1000000;
+    int64_t nvs_wall_us = 0;
+    bool from_nvs = nvs_load(&nvs_wall_us); // уход — в любом случае
+    if (rtc_load(&wall_us))
+    {
+        s_src = TIMEBASE_SRC_RTC;
+    }
+    else if (from_nvs)
+    {
+        // без питания простояли неизвестно сколько: точка поправки
+        // больше не годится для обучения
+        wall_us = nvs_wall_us;
+        s_sync_wall_us = 0;
+        s_src = TIMEBASE_SRC_NVS;
+    }
+    state_commit(timebase_mono_us(), wall_us, s_drift_ppb);
+    rtc_save();
+
+    const esp_timer_create_args_t args = {
+        .callback = tick_cb,
+        .name = "timebase",
+    };
+    err = esp_timer_create(&args, &s_tick);
+    if (err == ESP_OK)
+        err = esp_timer_start_periodic(s_tick, TB_TICK_S * 1000000ULL);
+    if (err != ESP_OK)
+        return err;
+    tick_cb(NULL); // libc сразу по шкале
+    s_ticks = 0;
+    timebase_report();
+    return ESP_OK;
+}
+
+esp_err_t timebase_set_wall_us(int64_t wall_us)
+{
+    if (wall_us <= 0)
+        return ESP_ERR_INVALID_ARG;
+    int64_t mono = timebase_mono_us();
+    int64_t predicted = timebase_mono_to_wall_us(mono);
+    int64_t err_us = wall_us - predicted;
+    int64_t elapsed_us = predicted - s_sync_wall_us;
+
+    bool step = err_us > TIMEBASE_STEP_MAX_S * 1000000LL ||
+                err_us < -TIMEBASE_STEP_MAX_S * 1000000LL;
+    if (s_sync_wall_us && !step && elapsed_us >= TIMEBASE_LEARN_MIN_S * 1000000LL)
+    {
+        // недоучтённый уход за время с прошлой поправки, в оценку — половину
+        int64_t ppb = err_us * 1000000000 / elapsed_us;
+        int64_t drift = s_drift_ppb + ppb / 2;
+        if (drift > TIMEBASE_DRIFT_MAX_PPB)
+            drift = TIMEBASE_DRIFT_MAX_PPB;
+        if (drift < -TIMEBASE_DRIFT_MAX_PPB)
+            drift = -TIMEBASE_DRIFT_MAX_PPB;
+        ESP_LOGI(TAG, "correction %+lld ms after %lld s: drift %+ld -> %+ld ppb",
+                 (long long)(err_us / 1000), (long long)(elapsed_us / 1000000),
+                 (long)s_drift_ppb,
+                 (long)drift);
+        s_drift_ppb = (int32_t)drift;
+        s_corrections++;
+    }
+    else
+    {
+        ESP_LOGI(TAG, "%s %+lld ms (source was %s)", step ? "set" : "correction",
+                 (long long)(err_us / 1000), s_src_names[s_src]);
+    }
+
+    state_commit(mono, wall_us, s_drift_ppb);
+    s_sync_wall_us = wall_us;
+    s_src = TIMEBASE_SRC_USER;
+    if (s_tick)
+        tick_cb(NULL);
+    nvs_save();
+    return ESP_OK;
+}
+
+timebase_src_t timebase_source(void) { return s_src; }
+
+int32_t timebase_drift_ppb(void) { return s_drift_ppb; }
+
+void timebase_report(void)
+{
+    time_t t = timebase_now_s();
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    int32_t d = s_drift_ppb < 0 ? -s_drift_ppb : s_drift_ppb;
+    ESP_LOGI(TAG, "%04d-%02d-%02d %02d:%02d:%02d (%s), drift %c%ld.%03ld ppm "
+                  "from %lu corrections, NVS %s",
+             tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min,
+             tm.tm_sec, s_src_names[s_src], s_drift_ppb < 0 ? '-' : '+',
+             (long)(d / 1000), (long)(d % 1000), (unsigned long)s_corrections,
+             s_nvs_ok ? "ok" : "off");
+}
@@ -3,27 +3,34 @@
 
 #define TAG "bq25896"
 
-esp_err_t bq25896_init(bq25896_t *ctx, i2c_master_bus_handle_t bus)
+esp_err_t bq25896_init(bq25896_t *ctx)
 {
     ESP_RETURN_ON_FALSE(ctx != NULL, ESP_ERR_INVALID_ARG, TAG, "ctx null");
-    ESP_RETURN_ON_FALSE(bus != NULL, ESP_ERR_INVALID_ARG, TAG, "bus null");
 
-    i2c_device_config_t dev_cfg = {
-        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
-        .device_address  = BQ25896_SLAVE_ADDRESS,
-        .scl_speed_hz     = 400000,
+    const i2c_bus_dev_config_t dev_cfg = {
+        .name       = "bq25896",
+        .addr       = BQ25896_SLAVE_ADDRESS,
+        .scl_hz     = 400000,
+        .timeout_ms = 100,
+        .prio       = I2C_BUS_PRIO_HIGH,
     };
 
     ctx->addr_7bit = BQ25896_SLAVE_ADDRESS;
     ctx->dev = NULL;
 
-    return i2c_master_bus_add_device(bus, &dev_cfg, &ctx->dev);
+    return i2c_bus_add_device(&dev_cfg, &ctx->dev);
 }
 
 esp_err_t bq25896_read_reg(bq25896_t *ctx, uint8_t reg, uint8_t *val)
 {
     ESP_RETURN_ON_FALSE(ctx && ctx->dev && val, ESP_ERR_INVALID_ARG, TAG, "bad args");
-    return i2c_master_transmit_receive(ctx->dev, &reg, 1, val, 1, 100);
+    return i2c_bus_write_read(ctx->dev, &reg, 1, val, 1);
+}
+
+esp_err_t bq25896_read_regs(bq25896_t *ctx, uint8_t reg, uint8_t *buf, size_t len)
+{
+    ESP_RETURN_ON_FALSE(ctx && ctx->dev && buf && len, ESP_ERR_INVALID_ARG, TAG, "bad args");
+    return i2c_bus_write_read(ctx->dev, &reg, 1, buf, len);
 }
 
 esp_err_t bq25896_write_reg(bq25896_t *ctx, uint8_t reg, uint8_t val)
@@ -31,7 +38,44 @@ esp_err_t bq25896_write_reg(bq25896_t *ctx, uint8_t reg, uint8_t val)
     ESP_RETURN_ON_FALSE(ctx && ctx->dev, ESP_ERR_INVALID_ARG, TAG, "bad args");
 
     uint8_t buf[2] = { reg, val };
-    return i2c_master_transmit(ctx->dev, buf, sizeof(buf), 100);
+    return i2c_bus_write(ctx->dev, buf, sizeof(buf));
+}
+
+void bq25896_decode_status(uint8_t v, bq25896_status_t *out)
+{
+    // REG0B:
+    // CHRG_STAT bits [4:3]
+    // PG_STAT bit [2]
+    out->raw_sys_status = v;
+    out->chg_state = (bq25896_charge_state_t)((v >> 3) & 0x03);
+    out->power_good = ((v >> 2) & 0x01) != 0;
+}
+
+void bq25896_decode_fault(uint8_t v, bq25896_fault_t *out)
+{
+    out->raw = v;
+    out->watchdog = (v >> 7) & 0x01;
+    out->boost = (v >> 6) & 0x01;
+    out->chrg = (bq25896_chrg_fault_t)((v >> 4) & 0x03);
+    out->bat_ovp = (v >> 3) & 0x01;
+    out->ntc = v & 0x07;
+}
+
+void bq25896_decode_adc(const uint8_t r[BQ25896_ADC_LEN], bq25896_adc_t *out)
+{
+#define ADC_REG(reg) r[(reg) - BQ25896_ADC_FIRST]
+    uint8_t batv = ADC_REG(BQ25896_REG_BATV);
+    uint8_t vbus = ADC_REG(BQ25896_REG_REG11);
+
+    out->therm_reg = (batv & 0x80) != 0;
+    out->vbat_mv = 2304 + 20 * (batv & 0x7F);
+    out->vsys_mv = 2304 + 20 * (ADC_REG(BQ25896_REG_SYSV) & 0x7F);
+    // 21% + 0.465% * n, в десятых долях процента без float
+    out->ts_pct_x10 = (uint16_t)(210 + (ADC_REG(BQ25896_REG_TSPCT) & 0x7F) * 93 / 20);
+    out->vbus_good = (vbus & 0x80) != 0;
+    out->vbus_mv = out->vbus_good ? 2600 + 100 * (vbus & 0x7F) : 0;
+    out->ichg_ma = 50 * (ADC_REG(BQ25896_REG_ICHGR) & 0x7F);
+#undef ADC_REG
 }
 
 esp_err_t bq25896_get_status(bq25896_t *ctx, bq25896_status_t *out)
@@ -42,12 +86,65 @@ esp_err_t bq25896_get_status(bq25896_t *ctx, bq25896_status_t *out)
     esp_err_t err = bq25896_read_reg(ctx, BQ25896_REG_SYS_STATUS, &v);
     if (err != ESP_OK) return err;
 
-    // REG0B:
-    // CHRG_STAT bits [4:3]
-    // PG_STAT bit [2]
-    out->raw_sys_status = v;
-    out->chg_state = (bq25896_charge_state_t)((v >> 3) & 0x03);
-    out->power_good = ((v >> 2) & 0x01) != 0;
+    bq25896_decode_status(v, out);
+    return ESP_OK;
+}
+
+esp_err_t bq25896_get_fault(bq25896_t *ctx, bq25896_fault_t *out)
+{
+    ESP_RETURN_ON_FALSE(out != NULL, ESP_ERR_INVALID_ARG, TAG, "out null");
+
+    uint8_t v = 0;
+    esp_err_t err = bq25896_read_reg(ctx, BQ25896_REG_FAULT, &v);
+    if (err != ESP_OK) return err;
+
+    bq25896_decode_fault(v, out);
+    return ESP_OK;
+}
+
+esp_err_t bq25896_set_adc_mode(bq25896_t *ctx, bq25896_adc_mode_t mode)
+{
+    uint8_t v = 0;
+    esp_err_t err = bq25896_read_reg(ctx, BQ25896_REG_ADC_CTRL, &v);
+    if (err != ESP_OK) return err;
+
+    uint8_t nv = v & ~BQ25896_CONV_RATE;
+    if (mode == BQ25896_ADC_CONTINUOUS)
+        nv |= BQ25896_CONV_RATE;
+    nv &= ~BQ25896_CONV_START; // не запускать одиночное заодно
+    if (nv == (v & ~BQ25896_CONV_START)) return ESP_OK;
+    return bq25896_write_reg(ctx, BQ25896_REG_ADC_CTRL, nv);
+}
+
+esp_err_t bq25896_adc_start(bq25896_t *ctx)
+{
+    uint8_t v = 0;
+    esp_err_t err = bq25896_read_reg(ctx, BQ25896_REG_ADC_CTRL, &v);
+    if (err != ESP_OK) return err;
+    if (v & BQ25896_CONV_START) return ESP_OK; // уже идёт
+    return bq25896_write_reg(ctx, BQ25896_REG_ADC_CTRL, v | BQ25896_CONV_START);
+}
+
+esp_err_t bq25896_adc_busy(bq25896_t *ctx, bool *busy)
+{
+    ESP_RETURN_ON_FALSE(busy != NULL, ESP_ERR_INVALID_ARG, TAG, "busy null");
+
+    uint8_t v = 0;
+    esp_err_t err = bq25896_read_reg(ctx, BQ25896_REG_ADC_CTRL, &v);
+    if (err != ESP_OK) return err;
+    // в одиночном режиме CONV_START держится, пока идёт преобразование
+    *busy = (v & BQ25896_CONV_START) != 0;
+    return ESP_OK;
+}
+
+esp_err_t bq25896_get_adc(bq25896_t *ctx, bq25896_adc_t *out)
+{
+    ESP_RETURN_ON_FALSE(out != NULL, ESP_ERR_INVALID_ARG, TAG, "out null");
+
+    uint8_t r[BQ25896_ADC_LEN];
+    esp_err_t err = bq25896_read_regs(ctx, BQ25896_ADC_FIRST, r, sizeof(r));
+    if (err != ESP_OK) return err;
 
+    bq25896_decode_adc(r, out);
     return ESP_OK;
 }
@@ -3,7 +3,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include "esp_err.h"
-#include "driver/i2c_master.h"
+#include "i2c_bus.h"
 
 
 
@@ -12,8 +12,21 @@
 #
 
 // Registers (subset)
+#define BQ25896_REG_ADC_CTRL     0x02   // CONV_START[7], CONV_RATE[6]
 #define BQ25896_REG_SYS_STATUS   0x0B
-#define BQ25896_REG_REG11        0x11
+#define BQ25896_REG_FAULT        0x0C
+#define BQ25896_REG_BATV         0x0E   // THERM_STAT[7], BATV[6:0]
+#define BQ25896_REG_SYSV         0x0F
+#define BQ25896_REG_TSPCT        0x10
+#define BQ25896_REG_REG11        0x11   // VBUS_GD[7], VBUSV[6:0]
+#define BQ25896_REG_ICHGR        0x12
+
+// Блок АЦП REG0E..REG12 читается одной транзакцией
+#define BQ25896_ADC_FIRST        BQ25896_REG_BATV
+#define BQ25896_ADC_LEN          (BQ25896_REG_ICHGR - BQ25896_REG_BATV + 1)
+
+#define BQ25896_CONV_START       0x80
+#define BQ25896_CONV_RATE        0x40
 
 typedef enum {
     BQ25896_CHG_NOT_CHARGING = 0,  // 00b
@@ -23,26 +36,77 @@ typedef enum {
 } bq25896_charge_state_t;
 
 typedef struct {
-    i2c_master_dev_handle_t dev;
+    i2c_bus_dev_t dev;
     uint8_t addr_7bit;
 } bq25896_t;
 
+typedef enum {
+    BQ25896_ADC_ONESHOT = 0,   // преобразование по bq25896_adc_start
+    BQ25896_ADC_CONTINUOUS,    // раз в секунду само (чип потребляет больше)
+} bq25896_adc_mode_t;
+
+typedef enum {
+    BQ25896_CHRG_FAULT_NONE    = 0,
+    BQ25896_CHRG_FAULT_INPUT   = 1,  // VBUS OVP или VBAT < VBUS < 3.8 V
+    BQ25896_CHRG_FAULT_THERMAL = 2,
+    BQ25896_CHRG_FAULT_TIMER   = 3,  // истёк safety timer
+} bq25896_chrg_fault_t;
+
+typedef struct {
+    bool watchdog;                    // WATCHDOG_FAULT (REG0C bit7)
+    bool boost;                       // BOOST_FAULT (bit6)
+    bq25896_chrg_fault_t chrg;        // CHRG_FAULT (bits5..4)
+    bool bat_ovp;                     // BAT_FAULT (bit3)
+    uint8_t ntc;                      // NTC_FAULT (bits2..0), 0 — норма
+    uint8_t raw;
+} bq25896_fault_t;
+
+typedef struct {
+    uint16_t vbat_mv;                 // BATV: 2304 + 20 mV * n
+    uint16_t vsys_mv;                 // SYSV: 2304 + 20 mV * n
+    uint16_t ts_pct_x10;              // TSPCT: % от REGN * 10, 21% + 0.465% * n
+    uint16_t vbus_mv;                 // VBUSV: 2600 + 100 mV * n, 0 без VBUS
+    uint16_t ichg_ma;                 // ICHGR: 50 mA * n
+    bool vbus_good;                   // VBUS_GD
+    bool therm_reg;                   // THERM_STAT: ток снижен по температуре
+} bq25896_adc_t;
+
 typedef struct {
     bool power_good;                  // PG_STAT (REG0B bit2)
     bq25896_charge_state_t chg_state; // CHRG_STAT (REG0B bits4..3)
     uint8_t raw_sys_status;           // raw REG0B value (for debug)
 } bq25896_status_t;
 
-// Attach device to an existing I2C master bus
-esp_err_t bq25896_init(bq25896_t *ctx, i2c_master_bus_handle_t bus);
+// Register on the shared bus (i2c_bus_init already called); status and
+// fault events get high priority in the bus queue
+esp_err_t bq25896_init(bq25896_t *ctx);
 
 // Basic register access
 esp_err_t bq25896_read_reg(bq25896_t *ctx, uint8_t reg, uint8_t *val);
 esp_err_t bq25896_write_reg(bq25896_t *ctx, uint8_t reg, uint8_t val);
+// len регистров подряд начиная с reg одной транзакцией (автоинкремент адреса)
+esp_err_t bq25896_read_regs(bq25896_t *ctx, uint8_t reg, uint8_t *buf, size_t len);
 
 // High-level: read REG0B and decode PG_STAT + CHRG_STAT
 esp_err_t bq25896_get_status(bq25896_t *ctx, bq25896_status_t *out);
 
+// REG0C защёлкивает ошибку до чтения: первое чтение после INT — что
+// случилось, следующее — текущее состояние
+esp_err_t bq25896_get_fault(bq25896_t *ctx, bq25896_fault_t *out);
+
+// АЦП: режим, запуск одиночного преобразования, готовность
+esp_err_t bq25896_set_adc_mode(bq25896_t *ctx, bq25896_adc_mode_t mode);
+esp_err_t bq25896_adc_start(bq25896_t *ctx);
+esp_err_t bq25896_adc_busy(bq25896_t *ctx, bool *busy);
+
+// REG0E..REG12 одной транзакцией
+esp_err_t bq25896_get_adc(bq25896_t *ctx, bq25896_adc_t *out);
+
+// Разбор уже прочитанных регистров (когда блок читается вместе с другими)
+void bq25896_decode_status(uint8_t reg0b, bq25896_status_t *out);
+void bq25896_decode_fault(uint8_t reg0c, bq25896_fault_t *out);
+void bq25896_decode_adc(const uint8_t regs[BQ25896_ADC_LEN], bq25896_adc_t *out);
+
 // Convenience helpers
 static inline bool bq25896_is_charging_active(const bq25896_status_t *st)
 {
@@ -1,48 +1,45 @@
 #include "bq27220.h"
 #include "bq27220_regs.h"
 
+#include <string.h>
+
 #include "esp_err.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
+static const char *TAG = "bq27220";
 
+#define BQ_MAC_DELAY_MS         2      // выбор адреса MAC -> данные готовы
+#define BQ_STATUS_POLL_MS       20
+#define BQ_STATUS_TIMEOUT_MS    2000   // вход/выход CONFIG UPDATE ~1 с
 
- esp_err_t i2c_bq27220_init(bq27220_t *cfg)
-{
-    // I2C bus config (new driver)
-    i2c_master_bus_config_t bus_cfg = {
-        .i2c_port = -1, // auto-select
-        .sda_io_num = (gpio_num_t)GROVE_SDA,
-        .scl_io_num = (gpio_num_t)GROVE_SCL,
-        .clk_source = I2C_CLK_SRC_DEFAULT,
-        .glitch_ignore_cnt = 7,
-        .flags.enable_internal_pullup = false, // обычно внешние подтяжки на Grove уже есть
-    };
+// 0x3E..0x61: адрес, MACData, сумма, длина
+#define MAC_BLK_LEN (COMMAND_MAC_DATA_LEN + 1 - COMMAND_SELECT_SUBCLASS)
 
-    ESP_ERROR_CHECK(i2c_new_master_bus(&bus_cfg, &cfg->s_i2c_bus));
 
-    i2c_device_config_t dev_cfg = {
-        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
-        .device_address  = BQ27220_I2C_ADDRESS, // 0x55 (7-bit)
-        .scl_speed_hz    = 400000,              // 100k если будут ошибки
+ esp_err_t i2c_bq27220_init(bq27220_t *cfg)
+{
+    // шину создаёт и восстанавливает i2c_bus, здесь только устройство
+    const i2c_bus_dev_config_t dev_cfg = {
+        .name       = "bq27220",
+        .addr       = BQ27220_I2C_ADDRESS, // 0x55 (7-bit)
+        .scl_hz     = 400000,              // 100k если будут ошибки
+        .timeout_ms = 50,
+        .prio       = I2C_BUS_PRIO_NORMAL,
     };
 
-    ESP_ERROR_CHECK(i2c_master_bus_add_device(cfg->s_i2c_bus, &dev_cfg, &cfg->s_bq_dev));
-
-
-
-    return ESP_OK;
-
-
+    return i2c_bus_add_device(&dev_cfg, &cfg->s_bq_dev);
 }
 
 // read 16-bit little-endian value from Standard Command register
  esp_err_t bq_read_u16(uint8_t reg, uint16_t *out, bq27220_t *cfg)
 {
     uint8_t rx[2] = {0};
-    esp_err_t err = i2c_master_transmit_receive(
+    esp_err_t err = i2c_bus_write_read(
         cfg->s_bq_dev,
         &reg, 1,
-        rx, 2,
-        50 /* timeout ms */
+        rx, 2
     );
     if (err != ESP_OK) return err;
 
@@ -50,6 +47,12 @@
     return ESP_OK;
 }
 
+esp_err_t bq_read_block(uint8_t reg, uint8_t *buf, size_t len, bq27220_t *cfg)
+{
+    if (!buf || !len) return ESP_ERR_INVALID_ARG;
+    return i2c_bus_write_read(cfg->s_bq_dev, &reg, 1, buf, len);
+}
+
 esp_err_t bq_write_subcmd(uint16_t subcmd, bq27220_t *cfg)
 {
     // Формируем пакет: [регистр 0x3E] [LSB команды] [MSB команды]
@@ -58,5 +61,238 @@ esp_err_t bq_write_subcmd(uint16_t subcmd, bq27220_t *cfg)
     tx[1] = (uint8_t)(subcmd & 0x00FF);
     tx[2] = (uint8_t)((subcmd >> 8) & 0x00FF);
 
-    return i2c_master_transmit(cfg->s_bq_dev, tx, 3, 50);
-}
\ No newline at end of file
+    return i2c_bus_write(cfg->s_bq_dev, tx, 3);
+}
+esp_err_t bq_control(uint16_t subcmd, bq27220_t *cfg)
+{
+    uint8_t tx[3] = {COMMAND_CONTROL, (uint8_t)(subcmd & 0xFF), (uint8_t)(subcmd >> 8)};
+    return i2c_bus_write(cfg->s_bq_dev, tx, sizeof(tx));
+}
+
+// ------------------------- память данных -------------------------
+
+static uint8_t mac_checksum(const uint8_t *p, size_t len)
+{
+    uint8_t sum = 0;
+    for (size_t i = 0; i < len; i++)
+        sum += p[i];
+    return (uint8_t)(0xFF - sum);
+}
+
+// Ждём, пока биты mask в OperationStatus станут set / сброшены
+static esp_err_t wait_status(uint16_t mask, bool set, bq27220_t *cfg)
+{
+    for (int t = 0; t <= BQ_STATUS_TIMEOUT_MS; t += BQ_STATUS_POLL_MS)
+    {
+        uint16_t st = 0;
+        if (bq_read_u16(COMMAND_OPERATION_STATUS, &st, cfg) == ESP_OK &&
+            ((st & mask) != 0) == set)
+            return ESP_OK;
+        vTaskDelay(pdMS_TO_TICKS(BQ_STATUS_POLL_MS));
+    }
+    return ESP_ERR_TIMEOUT;
+}
+
+esp_err_t bq_get_security(bq27220_operation_status_sec_t *out, bq27220_t *cfg)
+{
+    uint16_t st = 0;
+    esp_err_t err = bq_read_u16(COMMAND_OPERATION_STATUS, &st, cfg);
+    if (err != ESP_OK) return err;
+    *out = (bq27220_operation_status_sec_t)((st & OPERATION_STATUS_SEC_MASK) >>
+                                            OPERATION_STATUS_SEC_SHIFT);
+    return ESP_OK;
+}
+
+esp_err_t bq_unseal(bq27220_t *cfg)
+{
+    bq27220_operation_status_sec_t sec;
+    esp_err_t err = bq_get_security(&sec, cfg);
+    if (err != ESP_OK) return err;
+    if (sec != OPERATION_STATUS_SEC_SEALED) return ESP_OK;
+
+    // ключи — две отдельные записи подряд (не дольше 4 с между ними)
+    err = bq_control(UNSEALKEY1, cfg);
+    if (err == ESP_OK) err = bq_control(UNSEALKEY2, cfg);
+    if (err != ESP_OK) return err;
+    vTaskDelay(pdMS_TO_TICKS(BQ_MAC_DELAY_MS));
+
+    err = bq_get_security(&sec, cfg);
+    if (err != ESP_OK) return err;
+    if (sec == OPERATION_STATUS_SEC_SEALED)
+    {
+        ESP_LOGE(TAG, "unseal rejected (keys changed?)");
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    return ESP_OK;
+}
+
+esp_err_t bq_seal(bq27220_t *cfg)
+{
+    return bq_control(CONTROL_SEALED, cfg);
+}
+
+esp_err_t bq_cfg_update_enter(bq27220_t *cfg)
+{
+    esp_err_t err = bq_control(CONTROL_ENTER_CFG_UPDATE, cfg);
+    if (err != ESP_OK) return err;
+    return wait_status(OPERATION_STATUS_CFGUPDATE, true, cfg);
+}
+
+esp_err_t bq_cfg_update_exit(bool reinit, bq27220_t *cfg)
+{
+    esp_err_t err = bq_control(reinit ? CONTROL_EXIT_CFG_UPDATE_REINIT
+                                      : CONTROL_EXIT_CFG_UPDATE, cfg);
+    if (err != ESP_OK) return err;
+    return wait_status(OPERATION_STATUS_CFGUPDATE, false, cfg);
+}
+
+esp_err_t bq_dm_read(uint16_t addr, uint8_t *buf, size_t len, bq27220_t *cfg)
+{
+    if (!buf || !len || len > MAC_BLOCK_SIZE) return ESP_ERR_INVALID_ARG;
+
+    uint8_t sel[3] = {COMMAND_SELECT_SUBCLASS, (uint8_t)(addr & 0xFF), (uint8_t)(addr >> 8)};
+    esp_err_t err = i2c_bus_write(cfg->s_bq_dev, sel, sizeof(sel));
+    if (err != ESP_OK) return err;
+    vTaskDelay(pdMS_TO_TICKS(BQ_MAC_DELAY_MS));
+
+    // эхо адреса, 32 байта данных, сумма и длина — одной транзакцией
+    uint8_t blk[MAC_BLK_LEN];
+    err = bq_read_block(COMMAND_SELECT_SUBCLASS, blk, sizeof(blk), cfg);
+    if (err != ESP_OK) return err;
+
+    uint16_t echo = (uint16_t)blk[0] | ((uint16_t)blk[1] << 8);
+    uint8_t blen = blk[COMMAND_MAC_DATA_LEN - COMMAND_SELECT_SUBCLASS];
+    if (echo != addr || blen < len + 4 || blen > MAC_BLOCK_SIZE + 4)
+        return ESP_ERR_INVALID_RESPONSE;
+    if (mac_checksum(blk, blen - 2) != blk[COMMAND_MAC_DATA_SUM - COMMAND_SELECT_SUBCLASS])
+        return ESP_ERR_INVALID_CRC;
+
+    memcpy(buf, &blk[2], len);
+    return ESP_OK;
+}
+
+esp_err_t bq_dm_write(uint16_t addr, const uint8_t *data, size_t len, bq27220_t *cfg)
+{
+    if (!data || !len || len > MAC_BLOCK_SIZE) return ESP_ERR_INVALID_ARG;
+
+    uint8_t tx[3 + MAC_BLOCK_SIZE];
+    tx[0] = COMMAND_SELECT_SUBCLASS;
+    tx[1] = (uint8_t)(addr & 0xFF);
+    tx[2] = (uint8_t)(addr >> 8);
+    memcpy(&tx[3], data, len);
+    esp_err_t err = i2c_bus_write(cfg->s_bq_dev, tx, 3 + len);
+    if (err != ESP_OK) return err;
+
+    // запись в память данных происходит по сумме и длине
+    uint8_t tail[3] = {COMMAND_MAC_DATA_SUM, mac_checksum(&tx[1], 2 + len), (uint8_t)(len + 4)};
+    err = i2c_bus_write(cfg->s_bq_dev, tail, sizeof(tail));
+    if (err != ESP_OK) return err;
+    vTaskDelay(pdMS_TO_TICKS(BQ_MAC_DELAY_MS));
+    return ESP_OK;
+}
+
+// ------------------------- конфигурация -------------------------
+
+static bq27220_dm_cached_t *cache_slot(uint16_t addr, bq27220_t *cfg)
+{
+    bq27220_dm_cached_t *free_slot = NULL;
+    for (int i = 0; i < BQ27220_DM_CACHE_MAX; i++)
+    {
+        bq27220_dm_cached_t *c = &cfg->dm_cache[i];
+        if (c->valid && c->addr == addr) return c;
+        if (!c->valid && !free_slot) free_slot = c;
+    }
+    return free_slot;
+}
+
+static esp_err_t dm_read_u16(uint16_t addr, uint16_t *out, bq27220_t *cfg)
+{
+    uint8_t b[2];
+    esp_err_t err = bq_dm_read(addr, b, sizeof(b), cfg);
+    if (err != ESP_OK) return err;
+    *out = (uint16_t)((b[0] << 8) | b[1]); // память данных — big-endian
+    return ESP_OK;
+}
+
+// Доступ, нужный для DM, берётся один раз на весь bq_config_apply
+static esp_err_t ensure_unsealed(bool *was_sealed, bq27220_t *cfg)
+{
+    if (*was_sealed) return ESP_OK;
+    bq27220_operation_status_sec_t sec;
+    esp_err_t err = bq_get_security(&sec, cfg);
+    if (err != ESP_OK) return err;
+    if (sec != OPERATION_STATUS_SEC_SEALED) return ESP_OK;
+    err = bq_unseal(cfg);
+    if (err == ESP_OK) *was_sealed = true;
+    return err;
+}
+
+esp_err_t bq_config_apply(const bq27220_dm_param_t *params, size_t n,
+                          size_t *written, bq27220_t *cfg)
+{
+    if (written) *written = 0;
+    if (!params || !n || n > BQ27220_DM_CACHE_MAX) return ESP_ERR_INVALID_ARG;
+
+    bool was_sealed = false;
+    size_t diff = 0;
+    esp_err_t err = ESP_OK;
+
+    // 1) текущие значения: из кэша или из чипа
+    for (size_t i = 0; i < n && err == ESP_OK; i++)
+    {
+        bq27220_dm_cached_t *c = cache_slot(params[i].addr, cfg);
+        if (!c) return ESP_ERR_NO_MEM;
+        if (!c->valid)
+        {
+            err = ensure_unsealed(&was_sealed, cfg);
+            if (err == ESP_OK) err = dm_read_u16(params[i].addr, &c->value, cfg);
+            if (err != ESP_OK) break;
+            c->addr = params[i].addr;
+            c->valid = true;
+        }
+        if (c->value != params[i].value) diff++;
+    }
+
+    // 2) только отличающиеся, в CONFIG UPDATE
+    if (err == ESP_OK && diff)
+    {
+        err = ensure_unsealed(&was_sealed, cfg);
+        if (err == ESP_OK) err = bq_cfg_update_enter(cfg);
+        if (err == ESP_OK)
+        {
+            size_t done = 0;
+            for (size_t i = 0; i < n && err == ESP_OK; i++)
+            {
+                bq27220_dm_cached_t *c = cache_slot(params[i].addr, cfg);
+                if (c->value == params[i].value) continue;
+                uint16_t old = c->value;
+                uint8_t b[2] = {(uint8_t)(params[i].value >> 8), (uint8_t)(params[i].value & 0xFF)};
+                c->valid = false; // пока не прочитали обратно — неизвестно
+                err = bq_dm_write(params[i].addr, b, sizeof(b), cfg);
+                if (err == ESP_OK) err = dm_read_u16(params[i].addr, &c->value, cfg);
+                if (err != ESP_OK) break;
+                c->valid = true;
+                if (c->value != params[i].value)
+                {
+                    ESP_LOGE(TAG, "%s: wrote %u, reads %u", params[i].name,
+                             params[i].value, c->value);
+                    err = ESP_ERR_INVALID_RESPONSE;
+                    break;
+                }
+                ESP_LOGI(TAG, "%s: %u -> %u", params[i].name, old, c->value);
+                done++;
+            }
+            // reinit — только если всё записалось, иначе выходим как было
+            esp_err_t xerr = bq_cfg_update_exit(err == ESP_OK, cfg);
+            if (err == ESP_OK) err = xerr;
+            if (written) *written = done;
+        }
+    }
+
+    if (was_sealed)
+    {
+        esp_err_t serr = bq_seal(cfg);
+        if (err == ESP_OK) err = serr;
+    }
+    return err;
+}
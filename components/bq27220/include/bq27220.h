@@ -1,21 +1,73 @@
-#include "driver/i2c_master.h"   // ESP-IDF 5.x new driver
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "i2c_bus.h"
+#include "bq27220_regs.h"
 
-#define GROVE_SDA 8
-#define GROVE_SCL 18
 #define BQ27220_I2C_ADDRESS 0x55
 
+#define BQ27220_DM_CACHE_MAX 8 // параметров памяти данных в кэше
+
+typedef struct {
+    uint16_t addr;
+    uint16_t value;
+    bool valid;
+} bq27220_dm_cached_t;
+
 typedef struct {
-    i2c_master_bus_handle_t s_i2c_bus;
-    i2c_master_dev_handle_t s_bq_dev;
+    i2c_bus_dev_t s_bq_dev;
+    // последнее прочитанное/записанное значение параметров памяти данных
+    bq27220_dm_cached_t dm_cache[BQ27220_DM_CACHE_MAX];
 } bq27220_t;
 
+// Параметр памяти данных (I2/U2): адрес DM_* и нужное значение
+typedef struct {
+    uint16_t addr;
+    uint16_t value;
+    const char *name;
+} bq27220_dm_param_t;
+
 
 #define BQ27220_REG_VOLTAGE        0x08
 #define BQ27220_REG_SOC            0x2C
 
+// Регистрирует гейдж на общей шине (i2c_bus_init уже вызван)
 esp_err_t i2c_bq27220_init(bq27220_t *cfg);
 esp_err_t bq_read_u16(uint8_t reg, uint16_t *out, bq27220_t *cfg);
+// len байт подряд начиная с reg одной транзакцией (стандартные команды
+// идут подряд, гейдж сам увеличивает адрес)
+esp_err_t bq_read_block(uint8_t reg, uint8_t *buf, size_t len, bq27220_t *cfg);
+// Подкоманда через AltManufacturerAccess() (0x3E)
 esp_err_t bq_write_subcmd(uint16_t subcmd, bq27220_t *cfg);
+// Подкоманда через Control() (0x00) — ключи, CONTROL_*
+esp_err_t bq_control(uint16_t subcmd, bq27220_t *cfg);
+
+// ---- доступ к памяти данных ----
+
+esp_err_t bq_get_security(bq27220_operation_status_sec_t *out, bq27220_t *cfg);
+// UNSEALKEY1/2; если уже не SEALED — ничего не делает
+esp_err_t bq_unseal(bq27220_t *cfg);
+esp_err_t bq_seal(bq27220_t *cfg);
 
+// CONFIG UPDATE: вход/выход с ожиданием флага CFGUPDATE. reinit — гейдж
+// заново инициализируется с новыми параметрами (SOC пересчитывается, но
+// выученная ёмкость остаётся, в отличие от RESET).
+esp_err_t bq_cfg_update_enter(bq27220_t *cfg);
+esp_err_t bq_cfg_update_exit(bool reinit, bq27220_t *cfg);
 
+// Блок MAC: адрес в 0x3E, данные в 0x40.., контрольная сумма (0xFF минус
+// сумма байт адреса и данных) и длина (данные + 4) в 0x60/0x61.
+// Чтение проверяет эхо адреса и сумму. len <= MAC_BLOCK_SIZE. Нужен
+// UNSEALED, запись — ещё и CONFIG UPDATE.
+esp_err_t bq_dm_read(uint16_t addr, uint8_t *buf, size_t len, bq27220_t *cfg);
+esp_err_t bq_dm_write(uint16_t addr, const uint8_t *data, size_t len, bq27220_t *cfg);
 
+// Привести параметры к params. Значения сверяются с кэшем, чего нет в
+// кэше — читается из чипа; если всё совпадает, CONFIG UPDATE не нужен.
+// Иначе пишутся только отличающиеся, каждый проверяется чтением, выход
+// с reinit. Исходный уровень доступа восстанавливается. written — сколько
+// параметров записано (может быть NULL).
+esp_err_t bq_config_apply(const bq27220_dm_param_t *params, size_t n,
+                          size_t *written, bq27220_t *cfg);
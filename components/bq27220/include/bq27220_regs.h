@@ -1,3 +1,5 @@
+#pragma once
+
 #define COMMAND_CONTROL                 0x00
 #define COMMAND_AT_RATE                 0x02
 #define COMMAND_AT_RATE_TIME_TO_EMPTY   0x04
@@ -64,6 +66,19 @@
 #define CONTROL_EXIT_CFG_UPDATE         0x0092
 #define CONTROL_RETURN_TO_ROM           0x0F00
 
+// OperationStatus()
+#define OPERATION_STATUS_CALMD          (1u << 0)
+#define OPERATION_STATUS_SEC_SHIFT      1
+#define OPERATION_STATUS_SEC_MASK       (0x3u << OPERATION_STATUS_SEC_SHIFT)
+#define OPERATION_STATUS_INITCOMP       (1u << 5)
+#define OPERATION_STATUS_CFGUPDATE      (1u << 10)
+
+// Data Memory (адреса для COMMAND_SELECT_SUBCLASS), значения big-endian
+#define DM_GAS_GAUGING_DESIGN_CAPACITY  0x929F // I2, mAh
+#define DM_GAS_GAUGING_DESIGN_ENERGY    0x92A1 // I2, mWh
+
+#define MAC_BLOCK_SIZE                  32     // COMMAND_MAC_DATA .. 0x5F
+
 #define UNSEALKEY1 (0x0414u)
 #define UNSEALKEY2 (0x3672u)
 
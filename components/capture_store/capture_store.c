@@ -0,0 +1,1122 @@
+#include "capture_store.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "decoder.h"
+#include "decoder_capture.h"
+#include "esp_log.h"
+#include "esp_vfs_fat.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "nvs.h"
+#include "timebase.h"
+
+static const char *TAG = "store";
+
+#define CS_REC_MAGIC 0xCA97
+#define CS_QUEUE_DEPTH 16
+#define CS_PENDING_MAX 64     // записей индекса ждут, пока их данные уйдут на флеш
+#define CS_POLL_MS DECODER_CAPTURE_GAP_MS
+#define CS_TAKE_WAIT_MS 10
+#define CS_IDX_CHUNK 16       // записей индекса за одно чтение
+#define CS_FIND_SCAN_MAX 512  // столько просматривает один вызов find
+#define CS_META_SECTORS 1     // оценка: каталог/FAT на каждый fsync
+#define CS_NVS_NS "cstore"
+#define CS_NVS_SAVE_SECTORS 256 // счётчик износа в NVS не чаще, чем раз в 1 МБ
+#define CS_PATH_MAX 48
+
+#define FNV_INIT 2166136261u
+
+// Заголовок записи в сегменте; за ним len байт данных. Записи идут
+// подряд и могут пересекать страницы; если до конца страницы меньше
+// заголовка или там нули (добивка под заголовок, недописанный сырой
+// захват) — следующая запись с новой страницы.
+typedef struct __attribute__((packed)) {
+    uint16_t magic;
+    uint8_t kind;
+    uint8_t proto;
+    uint16_t len;
+    uint8_t radio_id;
+    uint8_t flags;
+    int64_t time_us;
+    uint32_t freq_khz;
+    uint32_t hash;  // FNV-1a данных
+    uint32_t check; // FNV-1a полей выше
+} cs_rec_hdr_t;
+
+#define CS_HDR ((uint32_t)sizeof(cs_rec_hdr_t))
+
+typedef struct {
+    uint32_t id;
+    uint32_t dat_bytes;
+    uint32_t entries;
+} cs_seg_t;
+
+static capture_store_cfg_t s_cfg;
+static SemaphoreHandle_t s_lock = NULL;
+static QueueHandle_t s_inbox = NULL;
+static bool s_ready = false;
+static wl_handle_t s_wl = WL_INVALID_HANDLE;
+
+// по возрастанию id; последний — текущий, если s_seg_open
+static cs_seg_t s_segs[CAPTURE_STORE_MAX_SEGS];
+static int s_nsegs = 0;
+static uint32_t s_first_abs = 0; // номер первой записи s_segs[0]
+static uint32_t s_next_id = 0;
+
+// Копия [first, end) для capture_store_range — без s_lock
+static portMUX_TYPE s_range_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_range_first = 0, s_range_end = 0;
+
+// запись: s_batch[0] лежит в сегменте по смещению s_batch_base (кратно
+// странице), всё до него — на флеше; первые s_tail_len байт пачки — тоже
+// (неполная страница в конце файла, её перепишут вместе с остальным)
+static FILE *s_dat = NULL;
+static FILE *s_idx = NULL;
+static bool s_seg_open = false;
+static uint8_t s_batch[CAPTURE_STORE_BATCH_PAGES * CAPTURE_STORE_PAGE];
+static uint32_t s_batch_len = 0;
+static uint32_t s_batch_base = 0;
+static uint32_t s_tail_len = 0;
+static capture_index_t s_pending[CS_PENDING_MAX];
+static int s_npending = 0;
+static int64_t s_dirty_us = 0; // первая запись в пачке; 0 — пачка пуста
+
+// чтение: по открытому файлу данных и индекса
+typedef struct {
+    FILE *f;
+    uint32_t seg;
+} cs_reader_t;
+
+static cs_reader_t s_rd_dat = {0};
+static cs_reader_t s_rd_idx = {0};
+
+// номер последнего записанного сырого захвата
+static uint32_t s_cap_stored = 0;
+
+static capture_store_stats_t s_st;
+static volatile uint32_t s_inbox_dropped = 0; // пишет задача потока
+static uint64_t s_life_saved = 0;
+
+// ------------------------- мелочи -------------------------
+
+static uint32_t fnv1a(uint32_t h, const void *data, size_t n)
+{
+    const uint8_t *p = data;
+    for (size_t i = 0; i < n; i++)
+        h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+static uint16_t index_check(const capture_index_t *e)
+{
+    uint32_t h = fnv1a(FNV_INIT, e, offsetof(capture_index_t, check));
+    return (uint16_t)(h ^ (h >> 16));
+}
+
+static uint32_t hdr_check(const cs_rec_hdr_t *h)
+{
+    return fnv1a(FNV_INIT, h, offsetof(cs_rec_hdr_t, check));
+}
+
+static uint32_t page_up(uint32_t n)
+{
+    return (n + CAPTURE_STORE_PAGE - 1) / CAPTURE_STORE_PAGE * CAPTURE_STORE_PAGE;
+}
+
+static void seg_path(char *buf, uint32_t id, bool idx)
+{
+    snprintf(buf, CS_PATH_MAX, "%s/seg_%08lx.%s", CAPTURE_STORE_BASE_PATH,
+             (unsigned long)id, idx ? "idx" : "dat");
+}
+
+static uint64_t used_bytes(void)
+{
+    uint64_t n = 0;
+    for (int i = 0; i < s_nsegs; i++)
+        n += s_segs[i].dat_bytes + (uint64_t)s_segs[i].entries * sizeof(capture_index_t);
+    return n;
+}
+
+static void wear_save(void)
+{
+    nvs_handle_t h;
+    if (nvs_open(CS_NVS_NS, NVS_READWRITE, &h) != ESP_OK)
+        return;
+    if (nvs_set_i64(h, "sectors", (int64_t)s_st.life_sectors) == ESP_OK)
+        nvs_commit(h);
+    nvs_close(h);
+    s_life_saved = s_st.life_sectors;
+}
+
+static void wear_load(void)
+{
+    nvs_handle_t h;
+    if (nvs_open(CS_NVS_NS, NVS_READONLY, &h) != ESP_OK)
+        return;
+    int64_t v = 0;
+    if (nvs_get_i64(h, "sectors", &v) == ESP_OK && v > 0)
+        s_st.life_sectors = (uint64_t)v;
+    nvs_close(h);
+    s_life_saved = s_st.life_sectors;
+}
+
+// Переписано секторов. WL пишет сектор целиком, даже если изменился байт:
+// отсюда и целые страницы, и индекс пачками.
+static void account(uint32_t sectors)
+{
+    s_st.flash_bytes += (uint64_t)sectors * CAPTURE_STORE_PAGE;
+    s_st.life_sectors += sectors;
+    if (s_st.life_sectors - s_life_saved >= CS_NVS_SAVE_SECTORS)
+        wear_save();
+}
+
+static uint32_t sectors_touched(uint32_t off, uint32_t len)
+{
+    if (!len)
+        return 0;
+    return (off + len - 1) / CAPTURE_STORE_PAGE - off / CAPTURE_STORE_PAGE + 1;
+}
+
+static bool file_sync(FILE *f)
+{
+    return fflush(f) == 0 && fsync(fileno(f)) == 0;
+}
+
+static void reader_drop(uint32_t seg)
+{
+    if (s_rd_dat.f && s_rd_dat.seg == seg)
+    {
+        fclose(s_rd_dat.f);
+        s_rd_dat.f = NULL;
+    }
+    if (s_rd_idx.f && s_rd_idx.seg == seg)
+    {
+        fclose(s_rd_idx.f);
+        s_rd_idx.f = NULL;
+    }
+}
+
+static FILE *reader(bool idx, uint32_t seg)
+{
+    cs_reader_t *r = idx ? &s_rd_idx : &s_rd_dat;
+    if (r->f && r->seg == seg)
+        return r->f;
+    if (r->f)
+        fclose(r->f);
+    char path[CS_PATH_MAX];
+    seg_path(path, seg, idx);
+    r->f = fopen(path, "rb");
+    r->seg = seg;
+    return r->f;
+}
+
+static uint32_t end_abs(void)
+{
+    uint32_t n = s_first_abs;
+    for (int i = 0; i < s_nsegs; i++)
+        n += s_segs[i].entries;
+    return n;
+}
+
+// Под s_lock, после каждой смены s_first_abs или числа записей
+static void range_publish(void)
+{
+    uint32_t first = s_first_abs, end = end_abs();
+    taskENTER_CRITICAL(&s_range_mux);
+    s_range_first = first;
+    s_range_end = end;
+    taskEXIT_CRITICAL(&s_range_mux);
+}
+
+// Под s_lock задача хранилища пишет на флеш (fwrite + fsync, стирание WL),
+// а FatFS на это время держит весь том. Чтение не ждёт — повторит позже.
+static bool read_lock(void)
+{
+    return xSemaphoreTake(s_lock, 0) == pdTRUE;
+}
+
+// ------------------------- сегменты -------------------------
+
+static void seg_unlink(uint32_t id)
+{
+    char path[CS_PATH_MAX];
+    reader_drop(id);
+    seg_path(path, id, false);
+    unlink(path);
+    seg_path(path, id, true);
+    unlink(path);
+}
+
+static void seg_delete_oldest(void)
+{
+    cs_seg_t *s = &s_segs[0];
+    seg_unlink(s->id);
+    ESP_LOGI(TAG, "segment %08lx dropped (%lu captures)", (unsigned long)s->id,
+             (unsigned long)s->entries);
+    s_first_abs += s->entries;
+    s_nsegs--;
+    memmove(&s_segs[0], &s_segs[1], (size_t)s_nsegs * sizeof(cs_seg_t));
+    range_publish();
+}
+
+// Записать из пачки целые страницы; tail — и неполную последнюю, как
+// есть, без добивки: место в сегменте не теряется, а следующая запись
+// перепишет эту страницу с начала (сектор WL пишется целиком в любом
+// случае). Затем — индекс записей, чьи данные уже целиком на флеше.
+static esp_err_t batch_write(bool tail)
+{
+    if (!s_seg_open)
+        return ESP_ERR_INVALID_STATE;
+    cs_seg_t *seg = &s_segs[s_nsegs - 1];
+
+    uint32_t n = s_batch_len / CAPTURE_STORE_PAGE * CAPTURE_STORE_PAGE;
+    uint32_t w = tail ? s_batch_len : n;
+    if (w > s_tail_len)
+    {
+        // после неполной страницы файл стоит на её конце — назад к началу
+        if ((s_tail_len && fseek(s_dat, (long)s_batch_base, SEEK_SET) != 0) ||
+            fwrite(s_batch, 1, w, s_dat) != w || !file_sync(s_dat))
+        {
+            ESP_LOGE(TAG, "segment %08lx: write failed", (unsigned long)seg->id);
+            return ESP_FAIL;
+        }
+        account(sectors_touched(s_batch_base, w) + CS_META_SECTORS);
+        s_tail_len = w - n;
+        s_batch_len -= n;
+        memmove(s_batch, &s_batch[n], s_batch_len);
+        s_batch_base += n;
+        s_st.stored_bytes += s_batch_base + s_tail_len - seg->dat_bytes;
+        seg->dat_bytes = s_batch_base + s_tail_len;
+        s_st.flushes++;
+        // FatFS читает не дальше размера файла на момент fopen
+        reader_drop(seg->id);
+    }
+    if (s_batch_len == s_tail_len)
+        s_dirty_us = 0;
+
+    int k = 0;
+    while (k < s_npending &&
+           s_pending[k].off + CS_HDR + s_pending[k].len <= seg->dat_bytes)
+        k++;
+    if (!k)
+        return ESP_OK;
+    uint32_t at = seg->entries * sizeof(capture_index_t);
+    size_t bytes = (size_t)k * sizeof(capture_index_t);
+    if (fwrite(s_pending, 1, bytes, s_idx) != bytes || !file_sync(s_idx))
+    {
+        ESP_LOGE(TAG, "segment %08lx: index write failed", (unsigned long)seg->id);
+        return ESP_FAIL;
+    }
+    account(sectors_touched(at, bytes) + CS_META_SECTORS);
+    s_st.stored_bytes += bytes;
+    seg->entries += k;
+    reader_drop(seg->id);
+    range_publish();
+    s_npending -= k;
+    memmove(s_pending, &s_pending[k], (size_t)s_npending * sizeof(capture_index_t));
+    return ESP_OK;
+}
+
+static void seg_close(void)
+{
+    if (!s_seg_open)
+        return;
+    if (s_batch_len > s_tail_len || s_npending)
+        batch_write(true);
+    fclose(s_dat);
+    fclose(s_idx);
+    s_dat = s_idx = NULL;
+    s_seg_open = false;
+    // чего не записали (ошибка) — потеряно
+    s_st.dropped += s_npending;
+    s_npending = 0;
+    s_batch_len = 0;
+    s_tail_len = 0;
+    s_dirty_us = 0;
+    wear_save();
+}
+
+static esp_err_t seg_open_new(void)
+{
+    while (s_nsegs && (s_nsegs >= CAPTURE_STORE_MAX_SEGS ||
+                       used_bytes() + CAPTURE_STORE_SEG_SIZE > s_cfg.max_bytes))
+        seg_delete_oldest();
+
+    uint32_t id = s_next_id++;
+    char path[CS_PATH_MAX];
+    seg_path(path, id, false);
+    s_dat = fopen(path, "wb");
+    seg_path(path, id, true);
+    s_idx = fopen(path, "wb");
+    if (!s_dat || !s_idx)
+    {
+        ESP_LOGE(TAG, "segment %08lx: create failed", (unsigned long)id);
+        if (s_dat)
+            fclose(s_dat);
+        if (s_idx)
+            fclose(s_idx);
+        s_dat = s_idx = NULL;
+        return ESP_FAIL;
+    }
+    s_segs[s_nsegs++] = (cs_seg_t){.id = id};
+    s_seg_open = true;
+    s_batch_base = 0;
+    s_batch_len = 0;
+    s_tail_len = 0;
+    return ESP_OK;
+}
+
+// ------------------------- запись -------------------------
+
+static esp_err_t batch_put(const void *data, uint32_t n)
+{
+    const uint8_t *p = data;
+    while (n)
+    {
+        uint32_t room = sizeof(s_batch) - s_batch_len;
+        if (!room)
+        {
+            esp_err_t err = batch_write(false);
+            if (err != ESP_OK)
+                return err;
+            continue;
+        }
+        uint32_t k = n < room ? n : room;
+        memcpy(&s_batch[s_batch_len], p, k);
+        s_batch_len += k;
+        p += k;
+        n -= k;
+    }
+    return ESP_OK;
+}
+
+// Заголовок новой записи: место в сегменте и в очереди индекса
+static esp_err_t rec_begin(cs_rec_hdr_t *h, capture_index_t *e)
+{
+    uint32_t total = CS_HDR + h->len + CS_HDR; // с запасом на выравнивание заголовка
+    if (s_npending == CS_PENDING_MAX && batch_write(true) != ESP_OK)
+        seg_close();
+    if (s_seg_open && s_batch_base + s_batch_len + total > CAPTURE_STORE_SEG_SIZE)
+        seg_close();
+    if (!s_seg_open && seg_open_new() != ESP_OK)
+        return ESP_FAIL;
+
+    // заголовок целиком на одной странице: так его находит восстановление
+    uint32_t in_page = (s_batch_base + s_batch_len) % CAPTURE_STORE_PAGE;
+    if (in_page && CAPTURE_STORE_PAGE - in_page < CS_HDR)
+    {
+        uint8_t zero[sizeof(cs_rec_hdr_t)] = {0};
+        batch_put(zero, CAPTURE_STORE_PAGE - in_page);
+    }
+
+    h->magic = CS_REC_MAGIC;
+    h->check = hdr_check(h);
+    *e = (capture_index_t){
+        .time_us = h->time_us,
+        .freq_khz = h->freq_khz,
+        .hash = h->hash,
+        .seg = s_segs[s_nsegs - 1].id,
+        .off = s_batch_base + s_batch_len,
+        .len = h->len,
+        .kind = h->kind,
+        .proto = h->proto,
+        .radio_id = h->radio_id,
+        .flags = h->flags,
+    };
+    e->check = index_check(e);
+    if (!s_dirty_us)
+        s_dirty_us = timebase_mono_us();
+    return batch_put(h, CS_HDR);
+}
+
+static void rec_commit(const capture_index_t *e)
+{
+    s_pending[s_npending++] = *e;
+    s_st.records++;
+    s_st.payload_bytes += e->len;
+}
+
+static void store_packet(const packet_t *pkt)
+{
+    uint16_t len = pkt->len < (int)sizeof(pkt->data) ? (uint16_t)pkt->len
+                                                     : (uint16_t)sizeof(pkt->data);
+    cs_rec_hdr_t h = {
+        .kind = CAPTURE_KIND_PACKET,
+        .proto = pkt->proto,
+        .len = len,
+        .radio_id = pkt->radio_id,
+        .time_us = timebase_mono_to_wall_us(pkt->timestamp_us),
+        .freq_khz = pkt->freq_hz / 1000,
+        .hash = fnv1a(FNV_INIT, pkt->data, len),
+    };
+    capture_index_t e;
+    if (rec_begin(&h, &e) == ESP_OK && batch_put(pkt->data, len) == ESP_OK)
+        rec_commit(&e);
+    else
+        s_st.dropped++;
+}
+
+// Захват закончен, если после его последнего всплеска прошло больше
+// паузы: следующий всплеск начнёт новый захват. Копируется кусками прямо
+// из буфера decoder_capture, между кусками буфер отпускается (пока
+// пишется страница, декодер не ждёт). Если за это время захват всё-таки
+// сменился — запись добивается нулями и в индекс не попадает.
+static void capture_poll(int64_t now)
+{
+    uint32_t seq = decoder_capture_seq();
+    if (!seq || seq == s_cap_stored)
+        return;
+    decoder_capture_t cap;
+    if (!decoder_capture_take(&cap, pdMS_TO_TICKS(CS_TAKE_WAIT_MS)))
+        return; // в следующий раз
+    if (cap.seq == s_cap_stored || !cap.count ||
+        now - cap.end_us < DECODER_CAPTURE_GAP_MS * 1000LL)
+    {
+        decoder_capture_give();
+        return;
+    }
+    seq = s_cap_stored = cap.seq;
+    uint32_t count = cap.count;
+    bool truncated = cap.truncated;
+    if (count > CAPTURE_STORE_MAX_DATA / sizeof(uint16_t))
+    {
+        count = CAPTURE_STORE_MAX_DATA / sizeof(uint16_t);
+        truncated = true;
+    }
+    cs_rec_hdr_t h = {
+        .kind = CAPTURE_KIND_RAW,
+        .proto = DECODER_PROTO_NONE,
+        .len = (uint16_t)(count * sizeof(uint16_t)),
+        .radio_id = cap.radio_id,
+        .flags = (cap.first_level ? CAPTURE_FLAG_LEVEL_HIGH : 0) |
+                 (truncated ? CAPTURE_FLAG_TRUNCATED : 0),
+        .time_us = timebase_mono_to_wall_us(cap.end_us),
+        .freq_khz = s_cfg.radio_freq_hz ? s_cfg.radio_freq_hz(cap.radio_id) / 1000 : 0,
+        .hash = fnv1a(FNV_INIT, cap.dur, count * sizeof(uint16_t)),
+    };
+    decoder_capture_give();
+
+    capture_index_t e;
+    if (rec_begin(&h, &e) != ESP_OK)
+    {
+        s_st.dropped++;
+        return;
+    }
+    uint32_t pos = 0;
+    bool ok = true;
+    while (pos < h.len)
+    {
+        uint32_t room = sizeof(s_batch) - s_batch_len;
+        if (!room)
+        {
+            if (batch_write(false) != ESP_OK)
+            {
+                seg_close();
+                s_st.dropped++;
+                return;
+            }
+            continue;
+        }
+        uint32_t k = h.len - pos < room ? h.len - pos : room;
+        if (ok && decoder_capture_take(&cap, pdMS_TO_TICKS(CS_TAKE_WAIT_MS)))
+        {
+            ok = cap.seq == seq;
+            if (ok)
+                memcpy(&s_batch[s_batch_len], (const uint8_t *)cap.dur + pos, k);
+            decoder_capture_give();
+        }
+        else
+        {
+            ok = false;
+        }
+        if (!ok)
+            memset(&s_batch[s_batch_len], 0, k);
+        s_batch_len += k;
+        pos += k;
+    }
+    if (ok)
+        rec_commit(&e);
+    else
+        s_st.dropped++;
+}
+
+static void drain_inbox(void)
+{
+    packet_t pkt;
+    while (xQueueReceive(s_inbox, &pkt, 0) == pdTRUE)
+        store_packet(&pkt);
+}
+
+static void store_task(void *arg)
+{
+    (void)arg;
+    packet_t pkt;
+    while (1)
+    {
+        bool got = xQueueReceive(s_inbox, &pkt, pdMS_TO_TICKS(CS_POLL_MS)) == pdTRUE;
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        if (got)
+        {
+            store_packet(&pkt);
+            drain_inbox();
+        }
+        int64_t now = timebase_mono_us();
+        capture_poll(now);
+        if (s_dirty_us && now - s_dirty_us >= CAPTURE_STORE_FLUSH_MS * 1000LL &&
+            batch_write(true) != ESP_OK)
+            seg_close();
+        xSemaphoreGive(s_lock);
+    }
+}
+
+// Задача общего потока: только копия в очередь
+static void on_stream_packet(const packet_t *pkt, void *ctx)
+{
+    (void)ctx;
+    if (xQueueSend(s_inbox, pkt, 0) != pdTRUE)
+        s_inbox_dropped++;
+}
+
+// ------------------------- монтирование -------------------------
+
+static int seg_cmp(const void *a, const void *b)
+{
+    uint32_t x = ((const cs_seg_t *)a)->id, y = ((const cs_seg_t *)b)->id;
+    return x < y ? -1 : x > y;
+}
+
+static long file_size(const char *path)
+{
+    struct stat st;
+    return stat(path, &st) == 0 ? (long)st.st_size : -1;
+}
+
+static void scan_segments(void)
+{
+    DIR *dir = opendir(CAPTURE_STORE_BASE_PATH);
+    if (!dir)
+        return;
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL)
+    {
+        unsigned long id;
+        char ext[4];
+        if (sscanf(de->d_name, "seg_%8lx.%3s", &id, ext) != 2 || strcmp(ext, "dat"))
+            continue;
+        if (s_nsegs == CAPTURE_STORE_MAX_SEGS)
+        {
+            // не влезли в таблицу (другие пороги в прошлой прошивке) —
+            // удаляем старейшие
+            qsort(s_segs, (size_t)s_nsegs, sizeof(cs_seg_t), seg_cmp);
+            if (id < s_segs[0].id)
+            {
+                seg_unlink((uint32_t)id);
+                continue;
+            }
+            seg_unlink(s_segs[0].id);
+            s_nsegs--;
+            memmove(&s_segs[0], &s_segs[1], (size_t)s_nsegs * sizeof(cs_seg_t));
+        }
+        s_segs[s_nsegs++] = (cs_seg_t){.id = (uint32_t)id};
+    }
+    closedir(dir);
+    qsort(s_segs, (size_t)s_nsegs, sizeof(cs_seg_t), seg_cmp);
+
+    char path[CS_PATH_MAX];
+    for (int i = 0; i < s_nsegs; i++)
+    {
+        seg_path(path, s_segs[i].id, false);
+        long dat = file_size(path);
+        seg_path(path, s_segs[i].id, true);
+        long idx = file_size(path);
+        s_segs[i].dat_bytes = dat > 0 ? (uint32_t)dat : 0;
+        s_segs[i].entries = idx > 0 ? (uint32_t)idx / sizeof(capture_index_t) : 0;
+    }
+    if (s_nsegs)
+        s_next_id = s_segs[s_nsegs - 1].id + 1;
+}
+
+static bool index_valid(const capture_index_t *e, uint32_t seg, uint32_t dat_bytes)
+{
+    return e->check == index_check(e) && e->seg == seg &&
+           e->off + CS_HDR + e->len <= dat_bytes;
+}
+
+// FNV-1a len байт с текущей позиции (через буфер пачки, он ещё не нужен)
+static bool data_hash(FILE *dat, uint32_t len, uint32_t *hash)
+{
+    uint32_t h = FNV_INIT;
+    while (len)
+    {
+        size_t k = len < sizeof(s_batch) ? len : sizeof(s_batch);
+        if (fread(s_batch, 1, k, dat) != k)
+            return false;
+        h = fnv1a(h, s_batch, k);
+        len -= k;
+    }
+    *hash = h;
+    return true;
+}
+
+// Данные записи на месте. Неполную последнюю страницу следующая запись
+// переписывает целиком: если питание пропало посреди, проиндексированные
+// записи на ней могли пропасть вместе со страницей.
+static bool record_ok(FILE *dat, const capture_index_t *e)
+{
+    cs_rec_hdr_t h;
+    uint32_t hash;
+    return fseek(dat, (long)e->off, SEEK_SET) == 0 && fread(&h, sizeof(h), 1, dat) == 1 &&
+           h.magic == CS_REC_MAGIC && h.check == hdr_check(&h) && h.len == e->len &&
+           data_hash(dat, h.len, &hash) && hash == e->hash;
+}
+
+// Последний сегмент после пропадания питания: индекс — до последней целой
+// записи, данные за ней — переиндексировать, хвост — обрезать по странице.
+// Читается не больше одного сегмента.
+static void recover_last(void)
+{
+    if (!s_nsegs)
+        return;
+    cs_seg_t *seg = &s_segs[s_nsegs - 1];
+    char dat_path[CS_PATH_MAX], idx_path[CS_PATH_MAX];
+    seg_path(dat_path, seg->id, false);
+    seg_path(idx_path, seg->id, true);
+
+    FILE *idx = fopen(idx_path, "r+b");
+    if (!idx)
+        idx = fopen(idx_path, "w+b");
+    FILE *dat = fopen(dat_path, "rb");
+    if (!idx || !dat)
+    {
+        ESP_LOGE(TAG, "segment %08lx: cannot open for recovery", (unsigned long)seg->id);
+        if (idx)
+            fclose(idx);
+        if (dat)
+            fclose(dat);
+        return;
+    }
+
+    // индекс пишется после данных: целые записи с конца — в порядке, если
+    // их данные пережили перезапись последней страницы
+    uint32_t end = 0;
+    capture_index_t e;
+    while (seg->entries)
+    {
+        fseek(idx, (long)(seg->entries - 1) * (long)sizeof(e), SEEK_SET);
+        if (fread(&e, sizeof(e), 1, idx) == 1 && index_valid(&e, seg->id, seg->dat_bytes) &&
+            record_ok(dat, &e))
+        {
+            end = e.off + CS_HDR + e.len;
+            break;
+        }
+        seg->entries--;
+    }
+    uint32_t idx_bytes = seg->entries * sizeof(capture_index_t);
+
+    uint32_t pos = end;
+    uint32_t good_end = end;
+    uint32_t added = 0;
+    cs_rec_hdr_t h;
+    while (pos + CS_HDR <= seg->dat_bytes)
+    {
+        uint32_t in_page = pos % CAPTURE_STORE_PAGE;
+        if (in_page && CAPTURE_STORE_PAGE - in_page < CS_HDR)
+        {
+            pos = page_up(pos);
+            continue;
+        }
+        fseek(dat, (long)pos, SEEK_SET);
+        bool hdr_ok = fread(&h, sizeof(h), 1, dat) == 1 && h.magic == CS_REC_MAGIC &&
+                      h.check == hdr_check(&h);
+        if (!hdr_ok)
+        {
+            if (!in_page)
+                break; // страница не дописана — дальше ничего нет
+            pos = page_up(pos); // нули до конца страницы
+            continue;
+        }
+        if (pos + CS_HDR + h.len > seg->dat_bytes)
+            break;
+        uint32_t hash;
+        if (data_hash(dat, h.len, &hash) && hash == h.hash)
+        {
+            e = (capture_index_t){
+                .time_us = h.time_us,
+                .freq_khz = h.freq_khz,
+                .hash = h.hash,
+                .seg = seg->id,
+                .off = pos,
+                .len = h.len,
+                .kind = h.kind,
+                .proto = h.proto,
+                .radio_id = h.radio_id,
+                .flags = h.flags,
+            };
+            e.check = index_check(&e);
+            fseek(idx, (long)idx_bytes, SEEK_SET);
+            if (fwrite(&e, sizeof(e), 1, idx) == 1)
+            {
+                idx_bytes += sizeof(e);
+                seg->entries++;
+                added++;
+            }
+        }
+        // битые данные при целом заголовке — пропускаем запись
+        pos += CS_HDR + h.len;
+        good_end = pos;
+    }
+    fclose(dat);
+    file_sync(idx);
+    fclose(idx);
+
+    if (file_size(idx_path) > (long)idx_bytes && truncate(idx_path, idx_bytes) != 0)
+        ESP_LOGW(TAG, "segment %08lx: index not truncated", (unsigned long)seg->id);
+    uint32_t keep = page_up(good_end);
+    bool cut = keep < seg->dat_bytes;
+    if (cut)
+    {
+        if (truncate(dat_path, keep) != 0)
+            ESP_LOGW(TAG, "segment %08lx: data not truncated", (unsigned long)seg->id);
+        seg->dat_bytes = keep;
+    }
+    s_st.recovered = added;
+    if (added || cut)
+        ESP_LOGW(TAG, "segment %08lx: %lu captures reindexed, data kept %lu bytes",
+                 (unsigned long)seg->id, (unsigned long)added, (unsigned long)keep);
+}
+
+// ------------------------- API -------------------------
+
+esp_err_t capture_store_init(const capture_store_cfg_t *cfg)
+{
+    if (!cfg)
+        return ESP_ERR_INVALID_ARG;
+    if (s_lock)
+        return ESP_ERR_INVALID_STATE;
+    s_cfg = *cfg;
+
+    s_lock = xSemaphoreCreateMutex();
+    s_inbox = xQueueCreate(CS_QUEUE_DEPTH, sizeof(packet_t));
+    if (!s_lock || !s_inbox)
+        return ESP_ERR_NO_MEM;
+
+    const esp_vfs_fat_mount_config_t mount = {
+        .format_if_mount_failed = true,
+        .max_files = 5, // запись: данные + индекс, чтение: данные + индекс, Drive
+        .allocation_unit_size = CAPTURE_STORE_PAGE,
+    };
+    esp_err_t err = esp_vfs_fat_spiflash_mount_rw_wl(CAPTURE_STORE_BASE_PATH,
+                                                      CAPTURE_STORE_PARTITION,
+                                                      &mount, &s_wl);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "mount %s: %s", CAPTURE_STORE_PARTITION, esp_err_to_name(err));
+        return err;
+    }
+    uint64_t free_bytes = 0;
+    esp_vfs_fat_info(CAPTURE_STORE_BASE_PATH, &s_st.total_bytes, &free_bytes);
+    if (!s_cfg.max_bytes || s_cfg.max_bytes > s_st.total_bytes)
+        s_cfg.max_bytes = s_st.total_bytes / 10 * 9;
+
+    wear_load();
+    int64_t t0 = timebase_mono_us();
+    scan_segments();
+    recover_last();
+    while (s_nsegs > 1 && used_bytes() > s_cfg.max_bytes)
+        seg_delete_oldest();
+    range_publish();
+    ESP_LOGI(TAG, "mounted in %lld ms",
+             (long long)((timebase_mono_us() - t0) / 1000));
+
+    err = decoder_stream_subscribe(on_stream_packet, NULL);
+    if (err != ESP_OK)
+        return err;
+    if (xTaskCreatePinnedToCore(store_task, "capture_store", 4096, NULL, s_cfg.prio,
+                                NULL, s_cfg.core) != pdPASS)
+        return ESP_ERR_NO_MEM;
+    s_ready = true;
+    capture_store_report();
+    return ESP_OK;
+}
+
+bool capture_store_ready(void)
+{
+    return s_ready;
+}
+
+esp_err_t capture_store_flush(void)
+{
+    if (!s_ready)
+        return ESP_ERR_INVALID_STATE;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    drain_inbox();
+    capture_poll(timebase_mono_us());
+    esp_err_t err = ESP_OK;
+    if (s_batch_len > s_tail_len || s_npending)
+    {
+        err = batch_write(true);
+        if (err != ESP_OK)
+            seg_close();
+    }
+    xSemaphoreGive(s_lock);
+    return err;
+}
+
+void capture_store_range(uint32_t *first, uint32_t *end)
+{
+    if (!s_ready)
+    {
+        *first = *end = 0;
+        return;
+    }
+    taskENTER_CRITICAL(&s_range_mux);
+    *first = s_range_first;
+    *end = s_range_end;
+    taskEXIT_CRITICAL(&s_range_mux);
+}
+
+// Под блокировкой
+static esp_err_t read_index_locked(uint32_t from, capture_index_t *out, size_t n,
+                                   size_t *got)
+{
+    *got = 0;
+    if (from < s_first_abs)
+        return ESP_ERR_NOT_FOUND;
+    uint32_t base = s_first_abs;
+    for (int i = 0; i < s_nsegs && *got < n; i++)
+    {
+        const cs_seg_t *seg = &s_segs[i];
+        if (from >= base + seg->entries)
+        {
+            base += seg->entries;
+            continue;
+        }
+        FILE *f = reader(true, seg->id);
+        if (!f)
+            return ESP_FAIL;
+        uint32_t at = from - base;
+        size_t k = seg->entries - at;
+        if (k > n - *got)
+            k = n - *got;
+        if (fseek(f, (long)at * (long)sizeof(capture_index_t), SEEK_SET) != 0 ||
+            fread(&out[*got], sizeof(capture_index_t), k, f) != k)
+            return ESP_FAIL;
+        *got += k;
+        from += k;
+        base += seg->entries;
+    }
+    return ESP_OK;
+}
+
+esp_err_t capture_store_read_index(uint32_t from, capture_index_t *out, size_t n,
+                                   size_t *got)
+{
+    if (!out || !got)
+        return ESP_ERR_INVALID_ARG;
+    *got = 0;
+    if (!s_ready)
+        return ESP_ERR_INVALID_STATE;
+    if (!read_lock())
+        return ESP_ERR_TIMEOUT;
+    esp_err_t err = read_index_locked(from, out, n, got);
+    xSemaphoreGive(s_lock);
+    return err;
+}
+
+static bool filter_match(const capture_filter_t *f, const capture_index_t *e)
+{
+    if (f->from_us && e->time_us < f->from_us)
+        return false;
+    if (f->to_us && e->time_us > f->to_us)
+        return false;
+    if (f->freq_min_khz && e->freq_khz < f->freq_min_khz)
+        return false;
+    if (f->freq_max_khz && e->freq_khz > f->freq_max_khz)
+        return false;
+    if (f->proto_mask && !(f->proto_mask & (1u << e->proto)))
+        return false;
+    if (f->kind_mask && !(f->kind_mask & (1u << e->kind)))
+        return false;
+    if (f->hash && e->hash != f->hash)
+        return false;
+    return true;
+}
+
+// Просматривает не больше CS_FIND_SCAN_MAX записей за вызов, чтобы не
+// держать вызывающего (LVGL) долго: *next < end — ещё не всё.
+esp_err_t capture_store_find(const capture_filter_t *flt, uint32_t from,
+                             uint32_t *out, size_t n, size_t *got, uint32_t *next)
+{
+    if (!flt || !out || !got || !next)
+        return ESP_ERR_INVALID_ARG;
+    *got = 0;
+    *next = from;
+    if (!s_ready)
+        return ESP_ERR_INVALID_STATE;
+
+    capture_index_t chunk[CS_IDX_CHUNK];
+    esp_err_t err = ESP_OK;
+    if (!read_lock())
+        return ESP_ERR_TIMEOUT;
+    if (from < s_first_abs)
+        from = s_first_abs;
+    uint32_t end = end_abs();
+    uint32_t stop = end - from > CS_FIND_SCAN_MAX ? from + CS_FIND_SCAN_MAX : end;
+    while (from < stop && *got < n)
+    {
+        size_t k = stop - from < CS_IDX_CHUNK ? stop - from : CS_IDX_CHUNK;
+        size_t rd = 0;
+        err = read_index_locked(from, chunk, k, &rd);
+        if (err != ESP_OK || !rd)
+            break;
+        size_t i = 0;
+        for (; i < rd && *got < n; i++)
+            if (filter_match(flt, &chunk[i]))
+                out[(*got)++] = from + (uint32_t)i;
+        from += (uint32_t)i;
+    }
+    *next = from;
+    xSemaphoreGive(s_lock);
+    return err;
+}
+
+esp_err_t capture_store_read(const capture_index_t *e, uint32_t pos, void *buf,
+                             size_t len, size_t *got)
+{
+    if (!e || !buf || !got)
+        return ESP_ERR_INVALID_ARG;
+    *got = 0;
+    if (!s_ready)
+        return ESP_ERR_INVALID_STATE;
+    if (pos >= e->len)
+        return ESP_OK;
+    if (len > e->len - pos)
+        len = e->len - pos;
+
+    esp_err_t err = ESP_OK;
+    if (!read_lock())
+        return ESP_ERR_TIMEOUT;
+    FILE *f = reader(false, e->seg);
+    if (!f)
+        err = ESP_ERR_NOT_FOUND; // сегмент уже удалён
+    else if (fseek(f, (long)(e->off + CS_HDR + pos), SEEK_SET) != 0)
+        err = ESP_FAIL;
+    else
+        *got = fread(buf, 1, len, f);
+    xSemaphoreGive(s_lock);
+    return err;
+}
+
+esp_err_t capture_store_file_info(const char *name, capture_seg_info_t *out)
+{
+    if (!name || !out)
+        return ESP_ERR_INVALID_ARG;
+    unsigned long id;
+    char ext[4];
+    if (sscanf(name, "seg_%8lx.%3s", &id, ext) != 2 ||
+        (strcmp(ext, "dat") && strcmp(ext, "idx")))
+        return ESP_ERR_NOT_FOUND;
+    if (!s_ready)
+        return ESP_ERR_INVALID_STATE;
+
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    if (!read_lock())
+        return ESP_ERR_TIMEOUT;
+    uint32_t first = s_first_abs;
+    for (int i = 0; i < s_nsegs; i++)
+    {
+        const cs_seg_t *seg = &s_segs[i];
+        if (seg->id != id)
+        {
+            first += seg->entries;
+            continue;
+        }
+        *out = (capture_seg_info_t){
+            .seg = seg->id,
+            .index = ext[0] == 'i',
+            .first = first,
+            .entries = seg->entries,
+            .dat_bytes = seg->dat_bytes,
+        };
+        capture_index_t e;
+        size_t got = 0;
+        if (seg->entries && read_index_locked(first, &e, 1, &got) == ESP_OK && got)
+            out->from_us = e.time_us;
+        if (seg->entries &&
+            read_index_locked(first + seg->entries - 1, &e, 1, &got) == ESP_OK && got)
+            out->to_us = e.time_us;
+        err = ESP_OK;
+        break;
+    }
+    xSemaphoreGive(s_lock);
+    return err;
+}
+
+bool capture_store_io_try_lock(void)
+{
+    return !s_ready || read_lock(); // не смонтировано — писать некому
+}
+
+void capture_store_io_unlock(void)
+{
+    if (s_ready)
+        xSemaphoreGive(s_lock);
+}
+
+void capture_store_get_stats(capture_store_stats_t *out)
+{
+    if (!out)
+        return;
+    if (!s_ready)
+    {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *out = s_st;
+    out->entries = end_abs() - s_first_abs;
+    out->segments = (uint32_t)s_nsegs;
+    out->used_bytes = used_bytes();
+    out->free_bytes = 0;
+    esp_vfs_fat_info(CAPTURE_STORE_BASE_PATH, &out->total_bytes, &out->free_bytes);
+    out->dropped += s_inbox_dropped;
+    out->wa_x100 = out->payload_bytes
+                       ? (uint32_t)(out->flash_bytes * 100 / out->payload_bytes)
+                       : 0;
+    out->sa_x100 = out->payload_bytes
+                       ? (uint32_t)(out->stored_bytes * 100 / out->payload_bytes)
+                       : 0;
+    uint64_t sectors = out->total_bytes / CAPTURE_STORE_PAGE;
+    out->erase_avg_x100 = sectors ? (uint32_t)(out->life_sectors * 100 / sectors) : 0;
+    xSemaphoreGive(s_lock);
+}
+
+void capture_store_report(void)
+{
+    capture_store_stats_t st;
+    capture_store_get_stats(&st);
+    ESP_LOGI(TAG, "%lu captures in %lu segments, %llu/%llu KB (limit %llu KB)",
+             (unsigned long)st.entries, (unsigned long)st.segments,
+             (unsigned long long)(st.used_bytes / 1024),
+             (unsigned long long)(st.total_bytes / 1024),
+             (unsigned long long)(s_cfg.max_bytes / 1024));
+    ESP_LOGI(TAG, "since boot: %lu records, %llu B data, %llu B stored "
+                  "(SA %lu.%02lu), %llu B to flash (WA %lu.%02lu), %lu flushes, "
+                  "%lu dropped; wear %llu sectors (%lu.%02lu erase cycles avg)",
+             (unsigned long)st.records, (unsigned long long)st.payload_bytes,
+             (unsigned long long)st.stored_bytes,
+             (unsigned long)(st.sa_x100 / 100), (unsigned long)(st.sa_x100 % 100),
+             (unsigned long long)st.flash_bytes,
+             (unsigned long)(st.wa_x100 / 100), (unsigned long)(st.wa_x100 % 100),
+             (unsigned long)st.flushes, (unsigned long)st.dropped,
+             (unsigned long long)st.life_sectors,
+             (unsigned long)(st.erase_avg_x100 / 100),
+             (unsigned long)(st.erase_avg_x100 % 100));
+}
@@ -0,0 +1,158 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+// Хранилище захватов на флеше: пакеты из общего потока декодеров и сырые
+// таймлайны decoder_capture.
+//
+// Раздел "storage" (FATFS поверх wear levelling, сектор 4 КБ) в
+// CAPTURE_STORE_BASE_PATH. Данные — только дописываются, сегментами
+// seg_XXXXXXXX.dat не больше CAPTURE_STORE_SEG_SIZE; рядом индекс
+// seg_XXXXXXXX.idx — по записи capture_index_t (32 байта) на захват:
+// время, частота, протокол, хеш, где лежат данные. Список и фильтр читают
+// только индексы.
+//
+// Запись — в фоне, задачей хранилища: захваты копятся в RAM и уходят на
+// флеш целыми страницами (пачка — CAPTURE_STORE_BATCH_PAGES). Если за
+// CAPTURE_STORE_FLUSH_MS пачка не набралась, неполная последняя страница
+// пишется как есть, без добивки, и следующий сброс переписывает её с
+// начала: место в сегменте не теряется, платой — лишняя перезапись
+// сектора на каждый такой сброс (видна в WA). Индекс пишется после
+// данных, так что он не ссылается на то, чего нет.
+//
+// После пропадания питания проверяется только последний сегмент: его
+// индекс обрезается до последней записи, чьи данные целы (перезапись
+// последней страницы могла их потерять), данные после неё
+// переиндексируются. Дальше — новый сегмент. Старые сегменты удаляются
+// целиком, когда занято больше max_bytes.
+
+#ifndef CAPTURE_STORE_BASE_PATH
+#define CAPTURE_STORE_BASE_PATH "/store"
+#endif
+#define CAPTURE_STORE_PARTITION "storage"
+
+#define CAPTURE_STORE_PAGE 4096        // = сектор WL
+#define CAPTURE_STORE_BATCH_PAGES 2
+#define CAPTURE_STORE_SEG_SIZE (256 * 1024) // столько же — худший случай восстановления
+#define CAPTURE_STORE_MAX_SEGS 64
+#define CAPTURE_STORE_FLUSH_MS 5000
+#define CAPTURE_STORE_MAX_DATA 65535   // байт данных в одной записи
+
+typedef enum {
+    CAPTURE_KIND_PACKET = 0, // декодированные байты (packet_t.data)
+    CAPTURE_KIND_RAW,        // длительности уровней, uint16 LE, тики decoder_capture
+} capture_kind_t;
+
+// flags
+#define CAPTURE_FLAG_LEVEL_HIGH 0x01 // RAW: первый уровень — высокий
+#define CAPTURE_FLAG_TRUNCATED 0x02  // RAW: хвост не влез в буфер захвата
+
+typedef struct __attribute__((packed)) {
+    int64_t time_us;   // настенное время конца захвата (timebase)
+    uint32_t freq_khz;
+    uint32_t hash;     // FNV-1a данных: поиск повторов
+    uint32_t seg;
+    uint32_t off;      // заголовок записи в сегменте
+    uint16_t len;      // байт данных
+    uint8_t kind;      // capture_kind_t
+    uint8_t proto;     // decoder_proto_t
+    uint8_t radio_id;
+    uint8_t flags;
+    uint16_t check;    // FNV-1a полей выше, свёрнутый до 16 бит
+} capture_index_t;
+
+// Фильтр списка: нулевые поля — «любое»
+typedef struct {
+    int64_t from_us, to_us;
+    uint32_t freq_min_khz, freq_max_khz;
+    uint32_t proto_mask; // 1 << decoder_proto_t
+    uint8_t kind_mask;   // 1 << capture_kind_t
+    uint32_t hash;
+} capture_filter_t;
+
+typedef struct {
+    uint32_t entries;       // захватов в индексе
+    uint32_t segments;
+    uint64_t used_bytes;    // сегменты + индексы
+    uint64_t total_bytes;   // раздел
+    uint64_t free_bytes;
+    // с загрузки
+    uint32_t records;
+    uint32_t dropped;       // очередь полна / не дождались захвата
+    uint32_t flushes;
+    uint32_t recovered;     // переиндексировано при монтировании
+    uint64_t payload_bytes; // данные захватов
+    uint64_t stored_bytes;  // на сколько выросли сегменты и индексы
+    uint32_t sa_x100;       // stored_bytes / payload_bytes (место)
+    uint64_t flash_bytes;   // секторов переписано * 4 КБ (данные, индекс, FAT)
+    uint32_t wa_x100;       // flash_bytes / payload_bytes (износ)
+    // за всё время (NVS)
+    uint64_t life_sectors;  // перезаписей секторов
+    uint32_t erase_avg_x100; // life_sectors / секторов раздела
+} capture_store_stats_t;
+
+typedef struct {
+    uint64_t max_bytes;  // 0 — 90% раздела
+    UBaseType_t prio;
+    BaseType_t core;
+    // частота радио для сырых захватов (в decoder_capture её нет); NULL — 0
+    uint32_t (*radio_freq_hz)(uint8_t radio_id);
+} capture_store_cfg_t;
+
+// Монтирует раздел (при ошибке — форматирует), восстанавливает последний
+// сегмент, подписывается на общий поток декодеров и запускает задачу.
+// Поток и захват могут подняться позже (rf_start_rx).
+esp_err_t capture_store_init(const capture_store_cfg_t *cfg);
+bool capture_store_ready(void);
+
+// Сбросить накопленное на флеш сейчас, вместе с законченным сырым
+// захватом (из любой задачи, кроме ISR)
+esp_err_t capture_store_flush(void);
+
+// Номера записей сквозные: удаление старого сегмента сдвигает first, но
+// номера оставшихся не меняются. [*first, *end) — без блокировки
+void capture_store_range(uint32_t *first, uint32_t *end);
+
+// Чтение (read_index, find, read, file_info) не ждёт записи: пока задача
+// хранилища пишет на флеш, сразу возвращает ESP_ERR_TIMEOUT — повторить
+// позже. Так его можно звать из контекста LVGL.
+
+// n записей индекса начиная с номера from; *got — сколько прочитано
+esp_err_t capture_store_read_index(uint32_t from, capture_index_t *out,
+                                   size_t n, size_t *got);
+
+// До n подходящих под фильтр, начиная с from; *next — откуда продолжать
+esp_err_t capture_store_find(const capture_filter_t *flt, uint32_t from,
+                             uint32_t *out, size_t n, size_t *got,
+                             uint32_t *next);
+
+// Кусок данных записи: байты [pos, pos + len) — без чтения целиком
+esp_err_t capture_store_read(const capture_index_t *e, uint32_t pos,
+                             void *buf, size_t len, size_t *got);
+
+// Сегмент хранилища по имени файла (без пути) — из таблицы сегментов и
+// индекса, без чтения данных. ESP_ERR_NOT_FOUND — не файл хранилища.
+typedef struct {
+    uint32_t seg;
+    bool index;        // .idx, иначе .dat
+    uint32_t first;    // номер первой записи
+    uint32_t entries;
+    uint32_t dat_bytes;
+    int64_t from_us, to_us; // время первой и последней записи
+} capture_seg_info_t;
+
+esp_err_t capture_store_file_info(const char *name, capture_seg_info_t *out);
+
+// Своё чтение с того же раздела (readdir, stat, fread): FatFS держит том,
+// пока хранилище пишет, и оно ждало бы стирания. false — хранилище пишет,
+// повторить позже; true — до capture_store_io_unlock запись подождёт
+// (хранилище не смонтировано — всегда true).
+bool capture_store_io_try_lock(void);
+void capture_store_io_unlock(void);
+
+void capture_store_get_stats(capture_store_stats_t *out);
+void capture_store_report(void);
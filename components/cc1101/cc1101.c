@@ -7,6 +7,19 @@
 static const char *TAG = "cc1101";
 
 
+void cc1101_lock(cc1101_t *cc)
+{
+    if (cc->lock) xSemaphoreTakeRecursive(cc->lock, portMAX_DELAY);
+    // блокировка PM со счётчиком — вложенные lock/unlock парны
+    if (cc->pm_lock) esp_pm_lock_acquire(cc->pm_lock);
+}
+
+void cc1101_unlock(cc1101_t *cc)
+{
+    if (cc->pm_lock) esp_pm_lock_release(cc->pm_lock);
+    if (cc->lock) xSemaphoreGiveRecursive(cc->lock);
+}
+
 static esp_err_t xfer(cc1101_t *cc, const uint8_t *tx, uint8_t *rx, int len)
 {
     spi_transaction_t t;
@@ -14,7 +27,10 @@ static esp_err_t xfer(cc1101_t *cc, const uint8_t *tx, uint8_t *rx, int len)
     t.length = len * 8;
     t.tx_buffer = tx;
     t.rx_buffer = rx;
-    return spi_device_polling_transmit(cc->dev, &t);
+    cc1101_lock(cc);
+    esp_err_t err = spi_device_polling_transmit(cc->dev, &t);
+    cc1101_unlock(cc);
+    return err;
 }
 
 esp_err_t cc1101_init_dev(cc1101_t *cc, const cc1101_cfg_t *cfg)
@@ -23,6 +39,14 @@ esp_err_t cc1101_init_dev(cc1101_t *cc, const cc1101_cfg_t *cfg)
     memset(cc, 0, sizeof(*cc));
     cc->host = cfg->host;
     cc->pin_cs = cfg->pin_cs;
+    cc->pin_power_en = cfg->pin_power_en;
+    cc->pin_gdo0 = cfg->pin_gdo0;
+    cc->pin_gdo2 = cfg->pin_gdo2;
+    cc->lock = xSemaphoreCreateRecursiveMutex();
+    if (!cc->lock) return ESP_ERR_NO_MEM;
+    // без CONFIG_PM_ENABLE — ESP_ERR_NOT_SUPPORTED, работаем без блокировки
+    if (esp_pm_lock_create(ESP_PM_APB_FREQ_MAX, 0, "cc1101", &cc->pm_lock) != ESP_OK)
+        cc->pm_lock = NULL;
 
     spi_device_interface_config_t devcfg = {
         .clock_speed_hz = (cfg->clock_hz > 0) ? cfg->clock_hz : (2 * 1000 * 1000),
@@ -35,6 +59,7 @@ esp_err_t cc1101_init_dev(cc1101_t *cc, const cc1101_cfg_t *cfg)
     esp_err_t err = spi_bus_add_device(cfg->host, &devcfg, &cc->dev);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "spi_bus_add_device failed: %s", esp_err_to_name(err));
+        cc1101_deinit_dev(cc);
         return err;
     }
 
@@ -42,6 +67,24 @@ esp_err_t cc1101_init_dev(cc1101_t *cc, const cc1101_cfg_t *cfg)
     return ESP_OK;
 }
 
+void cc1101_deinit_dev(cc1101_t *cc)
+{
+    if (!cc) return;
+    if (cc->dev) {
+        cc1101_power_on(cc, false);
+        spi_bus_remove_device(cc->dev);
+        cc->dev = NULL;
+    }
+    if (cc->pm_lock) {
+        esp_pm_lock_delete(cc->pm_lock);
+        cc->pm_lock = NULL;
+    }
+    if (cc->lock) {
+        vSemaphoreDelete(cc->lock);
+        cc->lock = NULL;
+    }
+}
+
 esp_err_t cc1101_strobe(cc1101_t *cc, uint8_t strobe)
 {
     uint8_t tx[1] = { strobe };
@@ -134,7 +177,9 @@ esp_err_t cc1101_write_burst_reg(cc1101_t *cc, uint8_t addr, const uint8_t *data
     t.length = tx_len * 8;
     t.tx_buffer = tx;
 
+    cc1101_lock(cc);
     esp_err_t err = spi_device_polling_transmit(cc->dev, &t);
+    cc1101_unlock(cc);
 
     if (tx != stack_buf) free(tx);
     return err;
@@ -168,7 +213,9 @@ esp_err_t cc1101_read_burst_reg(cc1101_t *cc, uint8_t addr, uint8_t *out, size_t
     t.tx_buffer = tx;
     t.rx_buffer = rx;
 
+    cc1101_lock(cc);
     esp_err_t err = spi_device_polling_transmit(cc->dev, &t);
+    cc1101_unlock(cc);
     if (err == ESP_OK) memcpy(out, &rx[1], len);
 
     if (tx != stack_tx) { free(tx); free(rx); }
@@ -195,16 +242,18 @@ esp_err_t cc1101_apply_preset_pairs_then_patable(cc1101_t *cc, const uint8_t *pr
     return cc1101_write_burst_reg(cc, CC1101_PATABLE, &preset[i], 8);
 }
 
-void cc1101_power_on(bool on)
+void cc1101_power_on(cc1101_t *cc, bool on)
 {
+    if (!cc || cc->pin_power_en < 0) return;
+
     gpio_config_t pwr_cfg = {
-        .pin_bit_mask = 1ULL << PIN_POWER_EN,
+        .pin_bit_mask = 1ULL << cc->pin_power_en,
         .mode = GPIO_MODE_OUTPUT,
         .pull_up_en = GPIO_PULLUP_DISABLE,
         .pull_down_en = GPIO_PULLDOWN_DISABLE,
         .intr_type = GPIO_INTR_DISABLE,
     };
     gpio_config(&pwr_cfg);
-    gpio_set_level(PIN_POWER_EN, on);
+    gpio_set_level(cc->pin_power_en, on);
     vTaskDelay(pdMS_TO_TICKS(50));
 }
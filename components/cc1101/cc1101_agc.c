@@ -0,0 +1,174 @@
+#include "cc1101_agc.h"
+#include "cc1101_regs.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "cc1101_agc";
+
+// индексы в shadow[]
+enum { AGC2 = 0, AGC1 = 1, AGC0 = 2 };
+static const uint8_t s_agc_addr[3] = { CC1101_AGCCTRL2, CC1101_AGCCTRL1, CC1101_AGCCTRL0 };
+
+// Нужно минимум столько всплесков в окне, чтобы менять запас по статистике
+#define AGC_MIN_WINDOW_BURSTS 8
+// Пересчитывать регистры только если шум ушёл больше чем на столько dB
+#define AGC_NF_HYST_DB 2
+
+static int clampi(int v, int lo, int hi)
+{
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+esp_err_t cc1101_agc_init(cc1101_agc_t *agc, cc1101_t *cc, const cc1101_agc_cfg_t *cfg)
+{
+    if (!agc || !cc) return ESP_ERR_INVALID_ARG;
+    memset(agc, 0, sizeof(*agc));
+    agc->cc = cc;
+    if (cfg) {
+        agc->cfg = *cfg;
+    } else {
+        agc->cfg = (cc1101_agc_cfg_t)CC1101_AGC_CFG_DEFAULT();
+    }
+    agc->margin_db = agc->cfg.margin_min_db;
+
+    // Стартуем с того, что записал пресет — shadow должен совпадать с чипом
+    for (int i = 0; i < 3; i++) {
+        esp_err_t err = cc1101_read_reg(cc, s_agc_addr[i], &agc->shadow[i]);
+        if (err != ESP_OK) return err;
+    }
+    ESP_LOGI(TAG, "init AGCCTRL2=0x%02X AGCCTRL1=0x%02X AGCCTRL0=0x%02X",
+             agc->shadow[AGC2], agc->shadow[AGC1], agc->shadow[AGC0]);
+    return ESP_OK;
+}
+
+esp_err_t cc1101_agc_sample(cc1101_agc_t *agc)
+{
+    // Меряем только "между пакетами": сразу после всплеска RSSI ещё показывает сигнал
+    int64_t now = esp_timer_get_time();
+    if (now - agc->last_burst_us < (int64_t)agc->cfg.quiet_gap_ms * 1000)
+        return ESP_OK;
+
+    int16_t dbm = 0;
+    esp_err_t err = cc1101_read_rssi_dbm(agc->cc, &dbm);
+    if (err != ESP_OK) return err;
+
+    int32_t x = (int32_t)dbm * 16;
+    if (!agc->nf_valid) {
+        agc->nf_q4 = x;
+        agc->nf_valid = true;
+    } else if (x < agc->nf_q4) {
+        // вниз быстро (1/4), вверх медленно (1/64): пакеты, попавшие в замер,
+        // почти не поднимают оценку, а реальный рост шума всё равно догоняем
+        agc->nf_q4 += (x - agc->nf_q4) / 4;
+    } else {
+        agc->nf_q4 += (x - agc->nf_q4) / 64;
+    }
+    agc->samples++;
+    return ESP_OK;
+}
+
+void cc1101_agc_note_burst(cc1101_agc_t *agc, bool decoded)
+{
+    agc->last_burst_us = esp_timer_get_time();
+    agc->bursts++;
+    if (decoded) agc->decoded++;
+}
+
+static void agc_compute(const cc1101_agc_t *agc, int nf, uint8_t out[3])
+{
+    // Сколько dB шум выше "тихого" эфира (первые 10 dB не трогаем)
+    int over = nf - (agc->cfg.quiet_dbm + 10);
+    if (over < 0) over = 0;
+
+    // MAX_LNA_GAIN: шаг ~2.6-3 dB, 0 = максимум, 7 = -17 dB.
+    // Рядом с сильной помехой режем усиление, чтобы фронтенд не уходил в компрессию.
+    int lna = clampi((over + 2) / 3, 0, 7);
+
+    // MAGN_TARGET: 7 = 42 dB в тишине, при помехах ниже (не ниже 3 = 33 dB)
+    int magn = clampi(7 - over / 4, 3, 7);
+
+    // CARRIER_SENSE_ABS_THR: шум + запас, относительно cs_ref_dbm, -7..+7 dB
+    int thr = clampi(nf + agc->margin_db - agc->cfg.cs_ref_dbm, -7, 7);
+
+    // CARRIER_SENSE_REL_THR: +6 dB включаем, когда ложных срабатываний много
+    int rel = (agc->margin_db >= 12) ? 1 : 0;
+
+    out[AGC2] = (uint8_t)((agc->shadow[AGC2] & 0xC0) | (lna << 3) | magn);
+    out[AGC1] = (uint8_t)((agc->shadow[AGC1] & 0x40) | (rel << 4) | (thr & 0x0F));
+
+    // AGCCTRL0: при сильной помехе — большой гистерезис (HYST_LEVEL=11),
+    // иначе средний (10), остальные поля как в пресете
+    uint8_t hyst = (over > 10) ? 0xC0 : 0x80;
+    out[AGC0] = (uint8_t)((agc->shadow[AGC0] & 0x3F) | hyst);
+}
+
+esp_err_t cc1101_agc_tune(cc1101_agc_t *agc)
+{
+    if (!agc->nf_valid) return ESP_OK;
+
+    // --- Статистика окна: успешные декодирования / ложные срабатывания ---
+    uint32_t bursts = agc->bursts;
+    uint32_t decoded = agc->decoded;
+    uint32_t wb = bursts - agc->win_bursts;
+    uint32_t wd = decoded - agc->win_decoded;
+    bool margin_changed = false;
+
+    if (wb >= AGC_MIN_WINDOW_BURSTS) {
+        agc->success_permille = (uint16_t)(wd * 1000 / wb);
+        agc->false_permille = (uint16_t)((wb - wd) * 1000 / wb);
+        agc->win_bursts = bursts;
+        agc->win_decoded = decoded;
+
+        if (agc->false_permille > 600 && agc->margin_db + 2 <= agc->cfg.margin_max_db) {
+            agc->margin_db += 2;
+            margin_changed = true;
+        } else if (agc->false_permille < 150 && wd > 0 && agc->margin_db > agc->cfg.margin_min_db) {
+            agc->margin_db--;
+            margin_changed = true;
+        }
+    } else if (wb == 0 && agc->margin_db > agc->cfg.margin_min_db) {
+        // тишина целое окно — понемногу возвращаем чувствительность
+        agc->margin_db--;
+        margin_changed = true;
+    }
+
+    int nf = (int)(agc->nf_q4 / 16);
+    int d = nf - agc->nf_applied_dbm;
+    if (!margin_changed && agc->reg_writes && d <= AGC_NF_HYST_DB && d >= -AGC_NF_HYST_DB)
+        return ESP_OK;
+
+    uint8_t want[3];
+    agc_compute(agc, nf, want);
+
+    // Пишем только отличающиеся регистры (обычно 0 или 1 SPI-транзакция)
+    for (int i = 0; i < 3; i++) {
+        if (want[i] == agc->shadow[i]) continue;
+        esp_err_t err = cc1101_write_reg(agc->cc, s_agc_addr[i], want[i]);
+        if (err != ESP_OK) return err;
+        agc->shadow[i] = want[i];
+        agc->reg_writes++;
+        ESP_LOGI(TAG, "nf=%d dBm margin=%u -> reg 0x%02X = 0x%02X",
+                 nf, agc->margin_db, s_agc_addr[i], want[i]);
+    }
+    agc->nf_applied_dbm = (int16_t)nf;
+    return ESP_OK;
+}
+
+void cc1101_agc_get_stats(const cc1101_agc_t *agc, cc1101_agc_stats_t *out)
+{
+    if (!agc || !out) return;
+    memset(out, 0, sizeof(*out));
+    out->noise_floor_dbm = (int16_t)(agc->nf_q4 / 16);
+    out->margin_db = agc->margin_db;
+    out->agcctrl2 = agc->shadow[AGC2];
+    out->agcctrl1 = agc->shadow[AGC1];
+    out->agcctrl0 = agc->shadow[AGC0];
+    out->samples = agc->samples;
+    out->bursts = agc->bursts;
+    out->decoded = agc->decoded;
+    out->false_triggers = out->bursts - out->decoded;
+    out->success_permille = agc->success_permille;
+    out->false_trigger_permille = agc->false_permille;
+    out->reg_writes = agc->reg_writes;
+}
@@ -0,0 +1,157 @@
+#include "cc1101_foc.h"
+#include "cc1101_regs.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "cc1101_foc";
+
+#define FOCCFG_BS_CS_GATE 0x20
+// Источник считаем активным, если слышали его за последние N мкс
+#define FOC_ACTIVE_WINDOW_US (60LL * 1000 * 1000)
+// Дальше этого (±~63 кГц) не двигаем — скорее всего ошибка оценки
+#define FOC_MAX_STEPS 40
+
+esp_err_t cc1101_foc_init(cc1101_foc_t *foc, cc1101_t *cc)
+{
+    if (!foc || !cc) return ESP_ERR_INVALID_ARG;
+    memset(foc, 0, sizeof(*foc));
+    foc->cc = cc;
+    foc->active = -1;
+
+    uint8_t v = 0;
+    esp_err_t err = cc1101_read_reg(cc, CC1101_FSCTRL0, &v);
+    if (err != ESP_OK) return err;
+    foc->fsctrl0 = (int8_t)v;
+
+    // FOC_BS_CS_GATE: демодулятор замораживает оценку, пока нет carrier sense,
+    // иначе к моменту чтения FREQEST уже "уплывает" по шуму после всплеска
+    err = cc1101_read_reg(cc, CC1101_FOCCFG, &v);
+    if (err != ESP_OK) return err;
+    if (!(v & FOCCFG_BS_CS_GATE)) {
+        err = cc1101_write_reg(cc, CC1101_FOCCFG, v | FOCCFG_BS_CS_GATE);
+        if (err != ESP_OK) return err;
+    }
+    return ESP_OK;
+}
+
+// Ключ источника: первые байты пакета (ID у пультов с фиксированным кодом)
+static uint32_t foc_source_key(const uint8_t *data, size_t len)
+{
+    uint32_t h = 2166136261u;
+    if (len > 3) len = 3;
+    for (size_t i = 0; i < len; i++) {
+        h ^= data[i];
+        h *= 16777619u;
+    }
+    return h ? h : 1;
+}
+
+static int foc_find_slot(cc1101_foc_t *foc, uint32_t key)
+{
+    int oldest = 0;
+    for (int i = 0; i < CC1101_FOC_MAX_SOURCES; i++) {
+        if (foc->src[i].key == key) return i;
+        if (foc->src[i].last_us < foc->src[oldest].last_us) oldest = i;
+    }
+    // новый источник вытесняет самый давний (пустые слоты имеют last_us = 0)
+    if (oldest == foc->active) foc->active = -1;
+    memset(&foc->src[oldest], 0, sizeof(foc->src[oldest]));
+    foc->src[oldest].key = key;
+    return oldest;
+}
+
+static int foc_pick_dominant(const cc1101_foc_t *foc, int64_t now)
+{
+    int best = -1;
+    for (int i = 0; i < CC1101_FOC_MAX_SOURCES; i++) {
+        const cc1101_foc_source_t *s = &foc->src[i];
+        if (!s->key || now - s->last_us > FOC_ACTIVE_WINDOW_US) continue;
+        if (best < 0 || s->hits > foc->src[best].hits ||
+            (s->hits == foc->src[best].hits && s->last_us > foc->src[best].last_us))
+            best = i;
+    }
+    return best;
+}
+
+static esp_err_t foc_apply(cc1101_foc_t *foc, int8_t steps)
+{
+    // FSCTRL0 действует на синтезатор после IDLE -> RX (MCSM0 делает автокалибровку)
+    cc1101_lock(foc->cc);
+    esp_err_t err = cc1101_strobe(foc->cc, CC1101_SIDLE);
+    if (err == ESP_OK) err = cc1101_write_reg(foc->cc, CC1101_FSCTRL0, (uint8_t)steps);
+    if (err == ESP_OK) err = cc1101_strobe(foc->cc, CC1101_SRX);
+    cc1101_unlock(foc->cc);
+    if (err == ESP_OK) {
+        foc->fsctrl0 = steps;
+        foc->corrections++;
+    }
+    return err;
+}
+
+esp_err_t cc1101_foc_on_burst(cc1101_foc_t *foc, const uint8_t *data, size_t len)
+{
+    foc->bursts++;
+    if (!data || len < 2) {
+        foc->unknown++;
+        return ESP_OK;
+    }
+
+    uint8_t raw = 0;
+    esp_err_t err = cc1101_read_status(foc->cc, CC1101_FREQEST, &raw);
+    if (err != ESP_OK) return err;
+
+    int residual = (int8_t)raw;
+    int total_q4 = ((int)foc->fsctrl0 + residual) * 16;
+    int64_t now = esp_timer_get_time();
+
+    int i = foc_find_slot(foc, foc_source_key(data, len));
+    cc1101_foc_source_t *s = &foc->src[i];
+    if (s->hits == 0) {
+        s->offset_q4 = (int16_t)total_q4;
+    } else {
+        s->offset_q4 += (int16_t)((total_q4 - s->offset_q4) / 4);
+    }
+    s->hits++;
+    if (residual >= -1 && residual <= 1) s->centered++;
+    s->last_us = now;
+
+    int best = foc_pick_dominant(foc, now);
+    if (best < 0) return ESP_OK;
+
+    int steps = foc->src[best].offset_q4;
+    steps = (steps >= 0 ? steps + 8 : steps - 8) / 16; // округление
+    if (steps > FOC_MAX_STEPS) steps = FOC_MAX_STEPS;
+    if (steps < -FOC_MAX_STEPS) steps = -FOC_MAX_STEPS;
+
+    if (steps == foc->fsctrl0) {
+        foc->active = (int8_t)best;
+        return ESP_OK;
+    }
+
+    err = foc_apply(foc, (int8_t)steps);
+    if (err != ESP_OK) return err;
+    foc->active = (int8_t)best;
+
+    ESP_LOGI(TAG, "src %08lX: offset %+ld Hz (FSCTRL0=%d), hits %lu, centered %lu",
+             (unsigned long)foc->src[best].key, (long)steps * CC1101_FOC_STEP_HZ, steps,
+             (unsigned long)foc->src[best].hits, (unsigned long)foc->src[best].centered);
+    return ESP_OK;
+}
+
+void cc1101_foc_log(const cc1101_foc_t *foc)
+{
+    ESP_LOGI(TAG, "FSCTRL0=%d (%+ld Hz) bursts=%lu unknown=%lu corrections=%lu",
+             foc->fsctrl0, (long)foc->fsctrl0 * CC1101_FOC_STEP_HZ,
+             (unsigned long)foc->bursts, (unsigned long)foc->unknown,
+             (unsigned long)foc->corrections);
+
+    for (int i = 0; i < CC1101_FOC_MAX_SOURCES; i++) {
+        const cc1101_foc_source_t *s = &foc->src[i];
+        if (!s->key) continue;
+        ESP_LOGI(TAG, "%c src %08lX: %+ld Hz, hits %lu, centered %lu",
+                 i == foc->active ? '*' : ' ', (unsigned long)s->key,
+                 (long)s->offset_q4 * CC1101_FOC_STEP_HZ / 16,
+                 (unsigned long)s->hits, (unsigned long)s->centered);
+    }
+}
@@ -0,0 +1,212 @@
+#include "cc1101_presets.h"
+#include "cc1101_regs.h"
+#include <math.h>
+#include <string.h>
+#include "esp_log.h"
+
+static const char *TAG = "cc1101_preset";
+
+// Формулы — datasheet CC1101, раздел 12 (data rate), 13 (RX BW), 16.1 (deviation)
+
+// PATABLE для 433 МГц: мощность -> код, по убыванию
+static const struct {
+    int8_t dbm;
+    uint8_t pa;
+} s_pa_table[] = {
+    { 10, 0xC0 }, { 7, 0xC8 }, { 5, 0x84 }, { 0, 0x60 },
+    { -10, 0x34 }, { -15, 0x1D }, { -20, 0x0E }, { -30, 0x12 },
+};
+#define PA_TABLE_LEN (sizeof(s_pa_table) / sizeof(s_pa_table[0]))
+
+static esp_err_t out_of_range(cc1101_preset_report_t *rep, const char *field,
+                              int32_t value, int32_t min, int32_t max)
+{
+    if (rep) {
+        rep->field = field;
+        rep->value = value;
+        rep->min = min;
+        rep->max = max;
+    }
+    return ESP_ERR_INVALID_ARG;
+}
+
+// DRATE: R = (256 + M) * 2^E * f_xosc / 2^28
+static void calc_drate(uint32_t baud, uint8_t *e_out, uint8_t *m_out, uint32_t *actual)
+{
+    int e = (int)floor(log2((double)baud * (1 << 20) / (double)F_XOSC_HZ));
+    if (e < 0) e = 0;
+    if (e > 15) e = 15;
+    long m = lround((double)baud * 268435456.0 / ((double)F_XOSC_HZ * (double)(1 << e)) - 256.0);
+    if (m > 255 && e < 15) {
+        e++;
+        m = 0;
+    }
+    if (m < 0) m = 0;
+    if (m > 255) m = 255;
+    *e_out = (uint8_t)e;
+    *m_out = (uint8_t)m;
+    *actual = (uint32_t)lround((256.0 + m) * (double)(1 << e) * (double)F_XOSC_HZ / 268435456.0);
+}
+
+// RX BW = f_xosc / (8 * (4 + M) * 2^E), берём самую узкую полосу, не уже заданной
+static bool calc_bw(uint32_t bw_hz, uint8_t *e_out, uint8_t *m_out, uint32_t *actual)
+{
+    bool found = false;
+    double best = 0;
+    for (int e = 0; e < 4; e++) {
+        for (int m = 0; m < 4; m++) {
+            double bw = (double)F_XOSC_HZ / (8.0 * (4 + m) * (1 << e));
+            if (bw + 0.5 < (double)bw_hz) continue;
+            if (!found || bw < best) {
+                best = bw;
+                *e_out = (uint8_t)e;
+                *m_out = (uint8_t)m;
+                found = true;
+            }
+        }
+    }
+    if (found) *actual = (uint32_t)lround(best);
+    return found;
+}
+
+// f_dev = f_xosc / 2^17 * (8 + M) * 2^E, ближайшее значение
+static void calc_dev(uint32_t dev_hz, uint8_t *e_out, uint8_t *m_out, uint32_t *actual)
+{
+    double best_err = 0;
+    for (int e = 0; e < 8; e++) {
+        for (int m = 0; m < 8; m++) {
+            double dev = (double)F_XOSC_HZ / 131072.0 * (8 + m) * (1 << e);
+            double err = fabs(dev - (double)dev_hz);
+            if ((e == 0 && m == 0) || err < best_err) {
+                best_err = err;
+                *e_out = (uint8_t)e;
+                *m_out = (uint8_t)m;
+                *actual = (uint32_t)lround(dev);
+            }
+        }
+    }
+}
+
+esp_err_t cc1101_preset_compile(const cc1101_preset_t *p, uint8_t *out, size_t out_size,
+                                size_t *out_len, cc1101_preset_report_t *rep)
+{
+    if (!p || !out) return ESP_ERR_INVALID_ARG;
+    if (rep) memset(rep, 0, sizeof(*rep));
+    if (out_size < CC1101_PRESET_IMAGE_MAX) return ESP_ERR_INVALID_SIZE;
+
+    bool fsk = cc1101_preset_is_fsk(p);
+
+    // --- проверка диапазонов ---
+    if ((int)p->modulation < CC1101_MOD_2FSK || p->modulation > CC1101_MOD_OOK)
+        return out_of_range(rep, "modulation", p->modulation, CC1101_MOD_2FSK, CC1101_MOD_OOK);
+
+    // 2-FSK до 500 kBaud, GFSK и ASK/OOK до 250 kBaud
+    int32_t rate_max = (p->modulation == CC1101_MOD_2FSK) ? 500000 : 250000;
+    if (p->data_rate_baud < 600 || p->data_rate_baud > (uint32_t)rate_max)
+        return out_of_range(rep, "data_rate_baud", (int32_t)p->data_rate_baud, 600, rate_max);
+
+    if (p->rx_bw_hz < 58000 || p->rx_bw_hz > 812500)
+        return out_of_range(rep, "rx_bw_hz", (int32_t)p->rx_bw_hz, 58000, 812500);
+
+    if (fsk && (p->deviation_hz < 1587 || p->deviation_hz > 380859))
+        return out_of_range(rep, "deviation_hz", (int32_t)p->deviation_hz, 1587, 380859);
+
+    // FREQ_IF 1..31, шаг f_xosc / 2^10
+    long freq_if = lround((double)p->if_hz * 1024.0 / (double)F_XOSC_HZ);
+    if (freq_if < 1 || freq_if > 31)
+        return out_of_range(rep, "if_hz", (int32_t)p->if_hz, 25391, 787109);
+
+    if (p->tx_power_dbm < -30 || p->tx_power_dbm > 10)
+        return out_of_range(rep, "tx_power_dbm", p->tx_power_dbm, -30, 10);
+
+    if (p->sync_mode > 7)
+        return out_of_range(rep, "sync_mode", p->sync_mode, 0, 7);
+
+    // --- расчёт ---
+    uint8_t dr_e, dr_m, bw_e = 0, bw_m = 0, dev_e = 0, dev_m = 0;
+    uint32_t dr_act, bw_act = 0, dev_act = 0;
+    calc_drate(p->data_rate_baud, &dr_e, &dr_m, &dr_act);
+    calc_bw(p->rx_bw_hz, &bw_e, &bw_m, &bw_act); // диапазон уже проверен
+    if (fsk) calc_dev(p->deviation_hz, &dev_e, &dev_m, &dev_act);
+
+    // 2-FSK=0, GFSK=1, ASK/OOK=3
+    uint8_t mod_format = (p->modulation == CC1101_MOD_2FSK) ? 0 : (p->modulation == CC1101_MOD_GFSK) ? 1 : 3;
+
+    size_t pa_idx = PA_TABLE_LEN - 1;
+    for (size_t i = 0; i < PA_TABLE_LEN; i++) {
+        if (s_pa_table[i].dbm <= p->tx_power_dbm) {
+            pa_idx = i;
+            break;
+        }
+    }
+
+    size_t n = 0;
+#define EMIT(reg, val) do { out[n++] = (reg); out[n++] = (uint8_t)(val); } while (0)
+
+    EMIT(CC1101_IOCFG0, 0x0D);                  // GD0 async serial data
+    EMIT(CC1101_FSCTRL1, freq_if);
+    EMIT(CC1101_PKTCTRL0, 0x32);                // async, continuous, no whitening
+    EMIT(CC1101_PKTCTRL1, 0x04);
+    EMIT(CC1101_MDMCFG0, 0x00);
+    EMIT(CC1101_MDMCFG1, 0x02);
+    EMIT(CC1101_MDMCFG2, (mod_format << 4) | p->sync_mode);
+    EMIT(CC1101_MDMCFG3, dr_m);
+    EMIT(CC1101_MDMCFG4, (bw_e << 6) | (bw_m << 4) | dr_e);
+    if (fsk) EMIT(CC1101_DEVIATN, (dev_e << 4) | dev_m);
+    EMIT(CC1101_MCSM0, 0x18);                   // autocal idle->rx/tx
+    EMIT(CC1101_FOCCFG, fsk ? 0x16 : 0x18);
+    EMIT(CC1101_AGCCTRL0, p->agcctrl0);
+    EMIT(CC1101_AGCCTRL1, p->agcctrl1);
+    EMIT(CC1101_AGCCTRL2, p->agcctrl2);
+    EMIT(CC1101_WORCTRL, 0xFB);
+    EMIT(CC1101_FREND0, fsk ? 0x10 : 0x11);     // OOK: PA_POWER=1 -> PATABLE[1] для "1"
+    EMIT(CC1101_FREND1, fsk ? 0x56 : 0xB6);
+    EMIT(0, 0);                                  // end load reg
+#undef EMIT
+
+    // PATABLE[8]
+    memset(&out[n], 0, 8);
+    if (fsk) {
+        out[n] = s_pa_table[pa_idx].pa;
+    } else {
+        // OOK: "0" = выключено, ASK: "0" = минимальная мощность
+        out[n] = (p->modulation == CC1101_MOD_ASK) ? s_pa_table[PA_TABLE_LEN - 1].pa : 0x00;
+        out[n + 1] = s_pa_table[pa_idx].pa;
+    }
+    n += 8;
+
+    if (out_len) *out_len = n;
+    if (rep) {
+        rep->data_rate_baud = dr_act;
+        rep->rx_bw_hz = bw_act;
+        rep->deviation_hz = dev_act;
+        rep->if_hz = (uint32_t)lround((double)freq_if * (double)F_XOSC_HZ / 1024.0);
+        rep->tx_power_dbm = s_pa_table[pa_idx].dbm;
+    }
+    return ESP_OK;
+}
+
+esp_err_t cc1101_apply_preset(cc1101_t *cc, const cc1101_preset_t *p)
+{
+    if (!cc || !p) return ESP_ERR_INVALID_ARG;
+
+    uint8_t image[CC1101_PRESET_IMAGE_MAX];
+    cc1101_preset_report_t rep;
+    esp_err_t err = cc1101_preset_compile(p, image, sizeof(image), NULL, &rep);
+    if (err != ESP_OK) {
+        if (rep.field) {
+            ESP_LOGE(TAG, "preset '%s': %s=%ld out of range [%ld..%ld]", p->name ? p->name : "?",
+                     rep.field, (long)rep.value, (long)rep.min, (long)rep.max);
+        } else {
+            ESP_LOGE(TAG, "preset '%s': %s", p->name ? p->name : "?", esp_err_to_name(err));
+        }
+        return err;
+    }
+
+    ESP_LOGI(TAG, "preset '%s': %lu Bd, BW %lu Hz, dev %lu Hz, IF %lu Hz, %d dBm",
+             p->name ? p->name : "?", (unsigned long)rep.data_rate_baud,
+             (unsigned long)rep.rx_bw_hz, (unsigned long)rep.deviation_hz,
+             (unsigned long)rep.if_hz, rep.tx_power_dbm);
+
+    return cc1101_apply_preset_pairs_then_patable(cc, image);
+}
@@ -2,21 +2,29 @@
 #include "esp_err.h"
 #include "driver/spi_master.h"
 #include "driver/gpio.h"
-
-
-#define PIN_POWER_EN 15
+#include "esp_pm.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 
 
 typedef struct {
     spi_host_device_t host;
     int pin_cs;
     int clock_hz; // например 2*1000*1000
+    int pin_power_en; // -1 если модуль питается с общей линии
+    int pin_gdo0;     // async serial data -> RMT
+    int pin_gdo2;     // -1 если не разведён
 } cc1101_cfg_t;
 
 typedef struct {
     spi_host_device_t host;
     int pin_cs;
+    int pin_power_en;
+    int pin_gdo0;
+    int pin_gdo2;
     spi_device_handle_t dev;
+    SemaphoreHandle_t lock; // один spi_device из нескольких задач (декодер, AGC, FOC)
+    esp_pm_lock_handle_t pm_lock; // APB max, пока держим lock; NULL без CONFIG_PM_ENABLE
 } cc1101_t;
 
 // STROBES
@@ -32,6 +40,9 @@ typedef struct {
 
 
 esp_err_t cc1101_init_dev(cc1101_t *cc, const cc1101_cfg_t *cfg);
+// Обратное init_dev: питание модуля выключено, spi_device снят с шины.
+// Можно звать и после неудачного init_dev.
+void cc1101_deinit_dev(cc1101_t *cc);
 esp_err_t cc1101_strobe(cc1101_t *cc, uint8_t strobe);
 esp_err_t cc1101_read_status(cc1101_t *cc, uint8_t addr, uint8_t *outv);
 esp_err_t cc1101_write_reg(cc1101_t *cc, uint8_t addr, uint8_t val);
@@ -42,7 +53,14 @@ esp_err_t cc1101_read_rssi_dbm(cc1101_t *cc, int16_t *out_dbm);
 esp_err_t cc1101_write_burst_reg(cc1101_t *cc, uint8_t addr, const uint8_t *data, size_t len);
 esp_err_t cc1101_read_burst_reg(cc1101_t *cc, uint8_t addr, uint8_t *out, size_t len);
 esp_err_t cc1101_apply_preset_pairs_then_patable(cc1101_t *cc, const uint8_t *preset);
-void cc1101_power_on(bool on);
+void cc1101_power_on(cc1101_t *cc, bool on);
+
+// Для составных операций (SIDLE -> запись -> SRX), которые нельзя разрывать.
+// Мьютекс рекурсивный, внутри можно вызывать обычные cc1101_* функции.
+// Пока он взят, частота APB не снижается: при DFS цепочка транзакций не
+// перемежается переключениями частоты.
+void cc1101_lock(cc1101_t *cc);
+void cc1101_unlock(cc1101_t *cc);
 
 
 
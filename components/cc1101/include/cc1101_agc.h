@@ -0,0 +1,69 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "cc1101.h"
+
+// Фоновая оценка уровня шума + автоподстройка AGCCTRL0/1/2.
+//
+// Использование:
+//   cc1101_agc_init()      — после применения пресета (читает текущие AGCCTRL*)
+//   cc1101_agc_sample()    — часто (~100 мс), одно чтение RSSI между пакетами
+//   cc1101_agc_note_burst()— из колбэка декодера на каждый всплеск
+//   cc1101_agc_tune()      — редко (~2 с), пишет только изменившиеся регистры
+
+typedef struct {
+    // Уровень RSSI, при котором CARRIER_SENSE_ABS_THR=0 срабатывает на макс. усилении.
+    // Зависит от платы/фильтра, подбирается измерением.
+    int16_t cs_ref_dbm;
+    int16_t quiet_dbm;      // ниже этого шум считаем "тихим" эфиром
+    uint8_t margin_min_db;  // минимальный запас порога CS над шумом
+    uint8_t margin_max_db;
+    uint16_t quiet_gap_ms;  // не мерить шум столько мс после всплеска
+} cc1101_agc_cfg_t;
+
+#define CC1101_AGC_CFG_DEFAULT() { \
+    .cs_ref_dbm = -90,             \
+    .quiet_dbm = -100,             \
+    .margin_min_db = 4,            \
+    .margin_max_db = 20,           \
+    .quiet_gap_ms = 50,            \
+}
+
+typedef struct {
+    int16_t noise_floor_dbm;
+    uint8_t margin_db;
+    uint8_t agcctrl2, agcctrl1, agcctrl0; // что сейчас записано в чип
+    uint32_t samples;
+    uint32_t bursts;         // всего всплесков
+    uint32_t decoded;        // из них декодировано
+    uint32_t false_triggers; // всплески без единого байта
+    uint16_t success_permille;       // за последнее окно tune()
+    uint16_t false_trigger_permille; // за последнее окно tune()
+    uint32_t reg_writes;
+} cc1101_agc_stats_t;
+
+typedef struct {
+    cc1101_t *cc;
+    cc1101_agc_cfg_t cfg;
+
+    int32_t nf_q4;           // шум, dBm * 16
+    bool nf_valid;
+    int16_t nf_applied_dbm;  // шум, под который считались текущие регистры
+    uint8_t margin_db;
+
+    uint8_t shadow[3];       // AGCCTRL2, AGCCTRL1, AGCCTRL0
+    uint32_t reg_writes;
+
+    volatile int64_t last_burst_us;
+    volatile uint32_t bursts, decoded;
+    uint32_t win_bursts, win_decoded; // счётчики на начало окна
+    uint16_t success_permille, false_permille;
+    uint32_t samples;
+} cc1101_agc_t;
+
+esp_err_t cc1101_agc_init(cc1101_agc_t *agc, cc1101_t *cc, const cc1101_agc_cfg_t *cfg);
+esp_err_t cc1101_agc_sample(cc1101_agc_t *agc);
+void cc1101_agc_note_burst(cc1101_agc_t *agc, bool decoded);
+esp_err_t cc1101_agc_tune(cc1101_agc_t *agc);
+void cc1101_agc_get_stats(const cc1101_agc_t *agc, cc1101_agc_stats_t *out);
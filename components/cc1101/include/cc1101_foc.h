@@ -0,0 +1,41 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "cc1101.h"
+
+// Компенсация смещения частоты дешёвых пультов по FREQEST.
+//
+// После каждого принятого всплеска читаем FREQEST (остаток смещения
+// относительно текущего FSCTRL0), копим оценку на каждый источник и
+// выставляем FSCTRL0 под самый активный источник — следующие всплески
+// попадают в центр RX-фильтра, и полосу (MDMCFG4) можно сузить.
+//
+// FREQEST и FSCTRL0: знаковые 8 бит, шаг F_XOSC / 2^14 ≈ 1587 Гц.
+
+#define CC1101_FOC_MAX_SOURCES 8
+#define CC1101_FOC_STEP_HZ ((int32_t)(F_XOSC_HZ >> 14))
+
+typedef struct {
+    uint32_t key;       // 0 = свободный слот
+    int16_t offset_q4;  // полное смещение источника, шаги FSCTRL0 * 16
+    uint32_t hits;      // всплесков от источника
+    uint32_t centered;  // из них попали в центр (|FREQEST| <= 1 шаг)
+    int64_t last_us;
+} cc1101_foc_source_t;
+
+typedef struct {
+    cc1101_t *cc;
+    cc1101_foc_source_t src[CC1101_FOC_MAX_SOURCES];
+    int8_t fsctrl0;      // что сейчас записано в чип
+    int8_t active;       // индекс источника, под который настроен FSCTRL0, -1 = нет
+    uint32_t bursts;
+    uint32_t unknown;    // всплески без ключа источника (меньше 2 байт)
+    uint32_t corrections;
+} cc1101_foc_t;
+
+esp_err_t cc1101_foc_init(cc1101_foc_t *foc, cc1101_t *cc);
+// Вызывать из колбэка декодера сразу после всплеска, пока FREQEST не ушёл
+esp_err_t cc1101_foc_on_burst(cc1101_foc_t *foc, const uint8_t *data, size_t len);
+void cc1101_foc_log(const cc1101_foc_t *foc);
@@ -1,5 +1,62 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include "esp_err.h"
+#include "cc1101.h"
 
-extern const uint8_t subghz_device_cc1101_preset_2fsk_dev2_38khz_async_regs[];
-extern const uint8_t subghz_device_cc1101_preset_2fsk_dev12khz_async_regs[];
-extern const uint8_t subghz_device_cc1101_preset_2fsk_dev47_6khz_async_regs[];
+// Пресеты задаются физическими параметрами, регистры считаются один раз
+// на старте (cc1101_preset_compile) в формате пар (addr,val) ... 0,0 + PATABLE[8],
+// который понимает cc1101_apply_preset_pairs_then_patable().
+
+typedef enum {
+    CC1101_MOD_2FSK = 0,
+    CC1101_MOD_GFSK = 1,
+    CC1101_MOD_ASK  = 2, // "0" передаётся с минимальной мощностью PATABLE
+    CC1101_MOD_OOK  = 3,
+} cc1101_modulation_t;
+
+typedef struct {
+    const char *name;
+    cc1101_modulation_t modulation;
+    uint32_t data_rate_baud;
+    uint32_t rx_bw_hz;      // берётся ближайшая полоса фильтра >= заданной
+    uint32_t deviation_hz;  // только для 2-FSK/GFSK
+    uint32_t if_hz;
+    int8_t tx_power_dbm;    // таблица PATABLE для 433 МГц, -30..+10 dBm
+    uint8_t sync_mode;      // MDMCFG2 SYNC_MODE, 0..7 (4 = без sync, по carrier sense)
+    uint8_t agcctrl2, agcctrl1, agcctrl0;
+} cc1101_preset_t;
+
+// Отчёт компилятора: при ошибке — какое поле и допустимый диапазон,
+// при успехе — реальные значения после квантования в регистры
+typedef struct {
+    const char *field;
+    int32_t value, min, max;
+
+    uint32_t data_rate_baud;
+    uint32_t rx_bw_hz;
+    uint32_t deviation_hz;
+    uint32_t if_hz;
+    int8_t tx_power_dbm;
+} cc1101_preset_report_t;
+
+// Размер образа регистров с запасом: ~17 пар + 0,0 + PATABLE[8]
+#define CC1101_PRESET_IMAGE_MAX 48
+
+esp_err_t cc1101_preset_compile(const cc1101_preset_t *p, uint8_t *out, size_t out_size,
+                                size_t *out_len, cc1101_preset_report_t *rep);
+
+// compile + cc1101_apply_preset_pairs_then_patable, ошибки пишет в лог
+esp_err_t cc1101_apply_preset(cc1101_t *cc, const cc1101_preset_t *p);
+
+static inline bool cc1101_preset_is_fsk(const cc1101_preset_t *p)
+{
+    return p->modulation == CC1101_MOD_2FSK || p->modulation == CC1101_MOD_GFSK;
+}
+
+extern const cc1101_preset_t cc1101_preset_2fsk_dev2_38khz;
+extern const cc1101_preset_t cc1101_preset_2fsk_dev12khz;
+extern const cc1101_preset_t cc1101_preset_2fsk_dev47_6khz;
+extern const cc1101_preset_t cc1101_preset_am270;
+extern const cc1101_preset_t cc1101_preset_am650;
@@ -4,6 +4,7 @@
 // CC1101 register addresses (Config registers)
 #define CC1101_IOCFG0 0x02
 #define CC1101_FSCTRL1 0x0B
+#define CC1101_FSCTRL0 0x0C
 
 #define CC1101_PKTCTRL1 0x07
 #define CC1101_PKTCTRL0 0x08
@@ -55,6 +56,8 @@
 #define CC1101_VERSION 0x31
 #define CC1101_MARCSTATE 0x35
 #define CC1101_RSSI 0x34
+#define CC1101_FREQEST 0x32
+#define CC1101_LQI 0x33
 
 
 
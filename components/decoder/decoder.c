@@ -2,155 +2,674 @@
 #include "freertos/FreeRTOS.h"
 
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "driver/rmt_rx.h"
 #include "esp_log.h"
+#include "timebase.h"
 #include <stdlib.h>
+#include <string.h>
 #include "decoder.h"
-
-#define PIN_CC_GDO0 3
+#include "decoder_capture.h"
 
 
 static const char *TAG = "DECODER";
 packet_t last_pkt = { .data = {0}, .len = 0, .updated = false };
 
-bool decoder_rmt_running = true; // Локальная переменная для управления приемом
-
+bool decoder_rmt_running = false; // приём включает rf_start_rx
 
-static QueueHandle_t rmt_rx_evt_queue = NULL;
+typedef struct {
+    size_t num_symbols;
+    int64_t timestamp_us;
+} rx_evt_t;
 
 // Этот callback вызывается драйвером, когда пакет принят (по таймауту паузы)
 static bool IRAM_ATTR rmt_rx_done_callback(rmt_channel_handle_t channel, const rmt_rx_done_event_data_t *edata, void *user_data)
 {
-    
+    decoder_t *dec = (decoder_t *)user_data;
     BaseType_t high_task_wakeup = pdFALSE;
-    // Отправляем количество принятых символов в очередь
-    xQueueSendFromISR(rmt_rx_evt_queue, &edata->num_symbols, &high_task_wakeup);
-    // printf("go\n");
+    // Отправляем количество принятых символов и время конца всплеска
+    rx_evt_t evt = {
+        .num_symbols = edata->num_symbols,
+        .timestamp_us = timebase_mono_us(),
+    };
+    xQueueSendFromISR(dec->evt_queue, &evt, &high_task_wakeup);
 
     return high_task_wakeup == pdTRUE;
 }
 
-void rmt_rx_loop_task(void *arg)
+// PWM: ~350 мкс импульс = 0, ~700 мкс = 1. Возвращает число принятых байт.
+static int decode_pwm(const rmt_symbol_word_t *raw_symbols, size_t num_symbols, uint8_t *out, size_t out_size)
+{
+    uint32_t last_dur = 0;
+    int last_lvl = -1;
+    uint8_t current_byte = 0;
+    int bit_count = 0;
+    int bytes_printed = 0;
+
+    for (size_t i = 0; i < num_symbols; i++)
+    {
+        uint32_t durs[2] = {raw_symbols[i].duration0, raw_symbols[i].duration1};
+        int lvls[2] = {raw_symbols[i].level0, raw_symbols[i].level1};
+
+        for (int j = 0; j < 2; j++)
+        {
+            if (durs[j] == 0)
+                continue;
+
+            if (last_lvl == -1)
+            {
+                last_lvl = lvls[j];
+                last_dur = durs[j];
+            }
+            else if (lvls[j] == last_lvl)
+            {
+                last_dur += durs[j];
+            }
+            else
+            {
+                // Реальный переход уровня
+                if (durs[j] > 5)
+                { // Игнорируем совсем мелкий шум
+
+                    // Нас интересует только длительность ПОЛОЖИТЕЛЬНОГО импульса
+                    if (last_lvl == 1)
+                    {
+                        int bit = -1;
+                        if (last_dur >= 25 && last_dur <= 45)
+                            bit = 0; // ~350 мкс
+                        else if (last_dur >= 60 && last_dur <= 85)
+                            bit = 1; // ~700 мкс
+
+                        if (bit != -1)
+                        {
+                            current_byte = (current_byte << 1) | bit;
+                            bit_count++;
+
+                            if (bit_count == 8)
+                            {
+                                if (bytes_printed < (int)out_size)
+                                {
+                                    out[bytes_printed++] = current_byte;
+                                }
+
+                                bit_count = 0;
+                                current_byte = 0;
+                            }
+                        }
+                    }
+
+                    last_lvl = lvls[j];
+                    last_dur = durs[j];
+                }
+            }
+        }
+    }
+    return bytes_printed;
+}
+
+// ------------------------- Общий поток -------------------------
+
+#define STREAM_IN_DEPTH 32
+#define STREAM_REORDER_MAX 16
+#define STREAM_MAX_SUBS 4
+
+static decoder_pipeline_cfg_t s_pipe;
+static TaskHandle_t s_worker = NULL;
+
+static QueueHandle_t s_stream_in = NULL;
+static int64_t s_stream_hold_us = 0;
+static packet_t s_pending[STREAM_REORDER_MAX]; // отсортированы по timestamp_us
+static int s_pending_n = 0;
+static struct {
+    decoder_stream_cb_t cb;
+    void *ctx;
+} s_subs[STREAM_MAX_SUBS];
+static int s_sub_count = 0;
+
+static void stream_emit_oldest(void)
+{
+    const packet_t *p = &s_pending[0];
+    last_pkt = *p;
+    last_pkt.updated = true;
+    for (int i = 0; i < s_sub_count; i++)
+        s_subs[i].cb(p, s_subs[i].ctx);
+
+    s_pending_n--;
+    memmove(&s_pending[0], &s_pending[1], (size_t)s_pending_n * sizeof(packet_t));
+}
+
+static void stream_insert(const packet_t *p)
+{
+    if (s_pending_n == STREAM_REORDER_MAX)
+        stream_emit_oldest();
+
+    int i = s_pending_n;
+    while (i > 0 && s_pending[i - 1].timestamp_us > p->timestamp_us)
+    {
+        s_pending[i] = s_pending[i - 1];
+        i--;
+    }
+    s_pending[i] = *p;
+    s_pending_n++;
+}
+
+static void stream_task(void *arg)
+{
+    (void)arg;
+    packet_t in;
+
+    while (1)
+    {
+        TickType_t wait = portMAX_DELAY;
+        if (s_pending_n)
+        {
+            int64_t left_us = s_pending[0].timestamp_us + s_stream_hold_us - timebase_mono_us();
+            wait = (left_us > 0) ? pdMS_TO_TICKS(left_us / 1000) + 1 : 0;
+        }
+
+        if (xQueueReceive(s_stream_in, &in, wait) == pdTRUE)
+            stream_insert(&in);
+
+        int64_t now = timebase_mono_us();
+        while (s_pending_n && now - s_pending[0].timestamp_us >= s_stream_hold_us)
+            stream_emit_oldest();
+    }
+}
+
+esp_err_t decoder_stream_init(uint32_t hold_ms)
+{
+    if (s_stream_in)
+        return ESP_OK;
+    if (!s_worker)
+        return ESP_ERR_INVALID_STATE;
+    s_stream_hold_us = (int64_t)hold_ms * 1000;
+    s_stream_in = xQueueCreate(STREAM_IN_DEPTH, sizeof(packet_t));
+    if (!s_stream_in)
+        return ESP_ERR_NO_MEM;
+    if (xTaskCreatePinnedToCore(stream_task, "rf_stream", 3072, NULL, s_pipe.stream_prio,
+                                NULL, s_pipe.stream_core) != pdPASS)
+        return ESP_ERR_NO_MEM;
+    return ESP_OK;
+}
+
+esp_err_t decoder_stream_subscribe(decoder_stream_cb_t cb, void *ctx)
+{
+    if (!cb)
+        return ESP_ERR_INVALID_ARG;
+    if (s_sub_count >= STREAM_MAX_SUBS)
+        return ESP_ERR_NO_MEM;
+    s_subs[s_sub_count].cb = cb;
+    s_subs[s_sub_count].ctx = ctx;
+    s_sub_count++;
+    return ESP_OK;
+}
+
+// ------------------------- Кольца захват -> разбор -------------------------
+
+// Один производитель, один потребитель: свой счётчик каждый пишет сам,
+// чужой читает с acquire. Буфер (символы и метаданные) заполнен до
+// публикации индекса — release на head.
+static bool spsc_push(decoder_spsc_t *q, uint8_t v)
+{
+    uint32_t head = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+    if (head - __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE) >= DECODER_RX_BUFS)
+        return false;
+    q->slot[head % DECODER_RX_BUFS] = v;
+    __atomic_store_n(&q->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static bool spsc_pop(decoder_spsc_t *q, uint8_t *v)
+{
+    uint32_t tail = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+    if (__atomic_load_n(&q->head, __ATOMIC_ACQUIRE) == tail)
+        return false;
+    *v = q->slot[tail % DECODER_RX_BUFS];
+    __atomic_store_n(&q->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static bool spsc_empty(decoder_spsc_t *q)
+{
+    return __atomic_load_n(&q->head, __ATOMIC_ACQUIRE) ==
+           __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+}
+
+// радио + источник бенчмарка; добавляются, не удаляются
+static decoder_t *s_decs[DECODER_MAX_RADIOS + 1];
+static int s_dec_count = 0;
+
+// Из одной задачи (rf_start_rx, бенчмарк — контекст LVGL)
+static esp_err_t dec_register(decoder_t *dec)
+{
+    if (s_dec_count >= (int)(sizeof(s_decs) / sizeof(s_decs[0])))
+        return ESP_ERR_NO_MEM;
+    s_decs[s_dec_count] = dec;
+    __atomic_store_n(&s_dec_count, s_dec_count + 1, __ATOMIC_RELEASE);
+    return ESP_OK;
+}
+
+// ------------------------- Бенчмарк -------------------------
+
+#define BENCH_BYTES 16 // как длинная посылка брелока
+#define BENCH_SYMBOLS (BENCH_BYTES * 8)
+
+static decoder_t s_bench_dec;
+static rmt_symbol_word_t s_bench_sym[BENCH_SYMBOLS];
+static volatile bool s_bench_run = false;
+static volatile bool s_bench_alive = false; // источник ещё в цикле
+// dec->task источника: будят и удаляют его только под этой блокировкой
+static portMUX_TYPE s_bench_mux = portMUX_INITIALIZER_UNLOCKED;
+static int64_t s_bench_t0 = 0;
+static uint32_t s_bench_done = 0;      // только задача разбора
+static uint64_t s_bench_decode_us = 0; // только задача разбора
+
+// Источник: на месте задачи захвата, вместо RMT — готовый всплеск
+static void bench_task(void *arg)
+{
+    decoder_t *dec = (decoder_t *)arg;
+    while (s_bench_run)
+    {
+        uint8_t idx;
+        if (!spsc_pop(&dec->free, &idx))
+        {
+            // разбор отдаст буфер и разбудит
+            dec->overruns++;
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(10));
+            continue;
+        }
+        dec->buf[idx].num_symbols = BENCH_SYMBOLS;
+        dec->buf[idx].timestamp_us = timebase_mono_us();
+        spsc_push(&dec->filled, idx);
+        dec->bursts++;
+        xTaskNotifyGive(s_worker);
+    }
+    // сам не удаляется: на хэндл ещё могут слать уведомления, удалит
+    // decoder_bench_stop
+    s_bench_alive = false;
+    while (1)
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+static void bench_wake(void)
+{
+    taskENTER_CRITICAL(&s_bench_mux);
+    if (s_bench_dec.task)
+        xTaskNotifyGive(s_bench_dec.task);
+    taskEXIT_CRITICAL(&s_bench_mux);
+}
+
+esp_err_t decoder_bench_start(void)
+{
+    if (!s_worker)
+        return ESP_ERR_INVALID_STATE;
+    if (s_bench_run || s_bench_alive)
+        return ESP_ERR_INVALID_STATE;
+
+    decoder_t *dec = &s_bench_dec;
+    if (!dec->buf[0].sym)
+    {
+        esp_err_t err = dec_register(dec);
+        if (err != ESP_OK)
+            return err;
+        // 1 — длинный высокий + короткий низкий, 0 — наоборот; тики по 10 мкс
+        for (int i = 0; i < BENCH_SYMBOLS; i++)
+        {
+            bool one = (0xA5C3 >> (i % 16)) & 1;
+            s_bench_sym[i] = (rmt_symbol_word_t){
+                .level0 = 1, .duration0 = one ? 70 : 35,
+                .level1 = 0, .duration1 = one ? 35 : 70,
+            };
+        }
+        // разбор символы только читает — один массив на все буферы
+        for (int i = 0; i < DECODER_RX_BUFS; i++)
+        {
+            dec->buf[i].sym = s_bench_sym;
+            spsc_push(&dec->free, (uint8_t)i);
+        }
+        dec->cfg.radio_id = 0xFF;
+    }
+
+    dec->bursts = 0;
+    dec->overruns = 0;
+    s_bench_done = 0;
+    s_bench_decode_us = 0;
+    s_bench_t0 = timebase_mono_us();
+    s_bench_run = true;
+    s_bench_alive = true;
+    TaskHandle_t task;
+    if (xTaskCreatePinnedToCore(bench_task, "rf_bench", 2048, dec, s_pipe.capture_prio,
+                                &task, s_pipe.capture_core) != pdPASS)
+    {
+        s_bench_run = false;
+        s_bench_alive = false;
+        return ESP_ERR_NO_MEM;
+    }
+    // до этого пробуждения пропадают — источник ждёт с таймаутом
+    taskENTER_CRITICAL(&s_bench_mux);
+    dec->task = task;
+    taskEXIT_CRITICAL(&s_bench_mux);
+    return ESP_OK;
+}
+
+esp_err_t decoder_bench_stop(decoder_bench_result_t *out)
+{
+    if (!s_bench_run)
+        return ESP_ERR_INVALID_STATE;
+    s_bench_run = false;
+    // источник выходит из цикла по флагу (ждёт буфер не дольше 10 мс)
+    while (s_bench_alive)
+    {
+        bench_wake();
+        vTaskDelay(pdMS_TO_TICKS(2));
+    }
+    taskENTER_CRITICAL(&s_bench_mux);
+    TaskHandle_t task = s_bench_dec.task;
+    s_bench_dec.task = NULL;
+    taskEXIT_CRITICAL(&s_bench_mux);
+    vTaskDelete(task);
+    // разбор дочищает кольцо
+    for (int i = 0; i < 100 && !spsc_empty(&s_bench_dec.filled); i++)
+        vTaskDelay(pdMS_TO_TICKS(2));
+
+    int64_t elapsed_us = timebase_mono_us() - s_bench_t0;
+    decoder_bench_result_t r = {
+        .captures = s_bench_done,
+        .elapsed_ms = (uint32_t)(elapsed_us / 1000),
+        .per_s = elapsed_us > 0 ? (uint32_t)((uint64_t)s_bench_done * 1000000 / elapsed_us) : 0,
+        .decode_us = s_bench_done ? (uint32_t)(s_bench_decode_us / s_bench_done) : 0,
+        .stalls = s_bench_dec.overruns,
+        .symbols = BENCH_SYMBOLS,
+    };
+    ESP_LOGI(TAG, "bench: %lu captures in %lu ms = %lu/s, decode %lu us, %lu symbols, "
+                  "%lu stalls",
+             (unsigned long)r.captures, (unsigned long)r.elapsed_ms, (unsigned long)r.per_s,
+             (unsigned long)r.decode_us, (unsigned long)r.symbols, (unsigned long)r.stalls);
+    if (out)
+        *out = r;
+    return ESP_OK;
+}
+
+// ------------------------- Разбор (одна задача на все радио) -------------------------
+
+static void process_burst(decoder_t *dec, const decoder_buf_t *b)
+{
+    if (dec->pm_lock)
+        esp_pm_lock_acquire(dec->pm_lock);
+
+    if (!dec->rx_chan)
+    {
+        // бенчмарк: только разбор, наружу ничего
+        uint8_t data[sizeof(((packet_t *)0)->data)];
+        int64_t t0 = timebase_mono_us();
+        decode_pwm(b->sym, b->num_symbols, data, sizeof(data));
+        s_bench_decode_us += (uint64_t)(timebase_mono_us() - t0);
+        s_bench_done++;
+        if (dec->pm_lock)
+            esp_pm_lock_release(dec->pm_lock);
+        return;
+    }
+
+    packet_t pkt = {
+        .len = 0,
+        .radio_id = dec->cfg.radio_id,
+        .freq_hz = dec->cfg.freq_hz,
+        .timestamp_us = b->timestamp_us,
+    };
+
+    // слишком короткий всплеск — шум, для статистики это ложное срабатывание
+    if (b->num_symbols >= 32)
+    {
+        pkt.len = decode_pwm(b->sym, b->num_symbols, pkt.data, sizeof(pkt.data));
+        if (pkt.len > 0)
+            pkt.proto = DECODER_PROTO_PWM;
+        // сырые длительности — для осциллограммы, в том числе не декодированные
+        decoder_capture_add_burst(dec->cfg.radio_id, b->sym, b->num_symbols, b->timestamp_us);
+    }
+
+    if (dec->cfg.burst_cb)
+        dec->cfg.burst_cb(&pkt, b->num_symbols, dec->cfg.burst_cb_ctx);
+
+    if (pkt.len > 0)
+    {
+        // байты в консоль — только на уровне DEBUG: UART не тормозит разбор
+        ESP_LOGD(TAG, "radio %u PWM %d bytes", dec->cfg.radio_id, pkt.len);
+        ESP_LOG_BUFFER_HEX_LEVEL(TAG, pkt.data, pkt.len, ESP_LOG_DEBUG);
+
+        if (s_stream_in && xQueueSend(s_stream_in, &pkt, 0) != pdTRUE)
+            dec->dropped++;
+    }
+
+    if (dec->pm_lock)
+        esp_pm_lock_release(dec->pm_lock);
+}
+
+static void worker_task(void *arg)
+{
+    (void)arg;
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        // по всплеску с каждого радио за проход, пока кольца не опустеют
+        bool more;
+        do
+        {
+            more = false;
+            int n = __atomic_load_n(&s_dec_count, __ATOMIC_ACQUIRE);
+            for (int i = 0; i < n; i++)
+            {
+                decoder_t *dec = s_decs[i];
+                uint8_t idx;
+                if (!spsc_pop(&dec->filled, &idx))
+                    continue;
+                process_burst(dec, &dec->buf[idx]);
+                spsc_push(&dec->free, idx);
+                if (!dec->rx_chan)
+                    bench_wake(); // источник бенчмарка ждёт буфер
+                more = true;
+            }
+        } while (more);
+    }
+}
+
+esp_err_t decoder_pipeline_init(const decoder_pipeline_cfg_t *cfg)
+{
+    if (!cfg)
+        return ESP_ERR_INVALID_ARG;
+    if (s_worker)
+        return ESP_OK;
+    s_pipe = *cfg;
+    if (xTaskCreatePinnedToCore(worker_task, "rf_decode", 4096, NULL, s_pipe.worker_prio,
+                                &s_worker, s_pipe.worker_core) != pdPASS)
+        return ESP_ERR_NO_MEM;
+    ESP_LOGI(TAG, "pipeline: capture core %d prio %u, decode core %d prio %u, "
+                  "stream core %d prio %u",
+             (int)s_pipe.capture_core, (unsigned)s_pipe.capture_prio,
+             (int)s_pipe.worker_core, (unsigned)s_pipe.worker_prio,
+             (int)s_pipe.stream_core, (unsigned)s_pipe.stream_prio);
+    return ESP_OK;
+}
+
+// ------------------------- Захват (по одному на радио) -------------------------
+
+// Канал создаётся из задачи захвата: прерывание RMT выделяется на ядре
+// того, кто создаёт канал, — пусть это будет ядро захвата
+// (уведомления вызывающей задачи не трогаем — у задачи LVGL они свои)
+static SemaphoreHandle_t s_start_done = NULL;
+static esp_err_t s_start_err = ESP_OK;
+
+static esp_err_t channel_open(decoder_t *dec)
 {
-    // 1. Создаем канал прямо здесь (раз ты не делаешь этого в main)
     rmt_rx_channel_config_t rx_chan_config = {
-        .clk_src = RMT_CLK_SRC_DEFAULT,
-        .gpio_num = PIN_CC_GDO0,
+        .clk_src = RMT_CLK_SRC_XTAL, // см. decoder.h: не APB, чтобы не держать APB max
+        .gpio_num = dec->cfg.gpio_num,
         .mem_block_symbols = 64,
         .resolution_hz = 100000, // 100 кГц (1 тик = 10 мкс)
     };
+    esp_err_t err = rmt_new_rx_channel(&rx_chan_config, &dec->rx_chan);
+    if (err != ESP_OK)
+    {
+        dec->rx_chan = NULL;
+        return err;
+    }
 
-    rmt_channel_handle_t rx_chan = NULL;
-    ESP_ERROR_CHECK(rmt_new_rx_channel(&rx_chan_config, &rx_chan));
-
-    // 2. Очередь событий
-    rmt_rx_evt_queue = xQueueCreate(10, sizeof(size_t));
-
-    // 3. Коллбэки
     rmt_rx_event_callbacks_t cbs = {.on_recv_done = rmt_rx_done_callback};
-    rmt_rx_register_event_callbacks(rx_chan, &cbs, NULL);
+    err = rmt_rx_register_event_callbacks(dec->rx_chan, &cbs, dec);
+    if (err == ESP_OK)
+        err = rmt_enable(dec->rx_chan);
+    if (err != ESP_OK)
+    {
+        // канал не включён — удаляется сразу, GPIO свободен для повтора
+        rmt_del_channel(dec->rx_chan);
+        dec->rx_chan = NULL;
+    }
+    return err;
+}
 
-    // 4. Включаем канал
-    ESP_ERROR_CHECK(rmt_enable(rx_chan));
+static void capture_task(void *arg)
+{
+    decoder_t *dec = (decoder_t *)arg;
 
-    // 5. ВАЖНО: static выносит массив из стека в общую память, предотвращая Crash
-    static rmt_symbol_word_t raw_symbols[1000];
+    s_start_err = channel_open(dec);
+    xSemaphoreGive(s_start_done);
+    if (s_start_err != ESP_OK)
+    {
+        vTaskDelete(NULL);
+        return;
+    }
 
-    // 6. Конфиг приема (настраиваем тайм-аут тишины)
+    // Конфиг приема (настраиваем тайм-аут тишины)
     rmt_receive_config_t receive_config = {
         .signal_range_min_ns = 10000,   // 10 мкс минимум
         .signal_range_max_ns = 2000000, // 2 мс максимум
     };
-    decoder_rmt_running = true;
+    const size_t raw_size = DECODER_RAW_SYMBOLS * sizeof(rmt_symbol_word_t);
+
+    uint8_t cur = 0;
+    spsc_pop(&dec->free, &cur); // все буферы свободны
+    bool armed = false;
+    bool enabled = true;
 
-    printf("RMT Декодер инициализирован внутри задачи и запущен!\n");
+    ESP_LOGI(TAG, "radio %u: capture on GPIO %d started", dec->cfg.radio_id, dec->cfg.gpio_num);
     while (1)
     {
-           if (!decoder_rmt_running) {
-        vTaskDelay(pdMS_TO_TICKS(100));
-        continue;
-    }
-        ESP_ERROR_CHECK(rmt_receive(rx_chan, raw_symbols, sizeof(raw_symbols), &receive_config));
+        if (!decoder_rmt_running)
+        {
+            if (enabled)
+            {
+                // останавливаем незавершённый приём, иначе буфер остаётся за драйвером
+                rmt_disable(dec->rx_chan);
+                xQueueReset(dec->evt_queue);
+                enabled = false;
+                armed = false;
+            }
+            // до decoder_wake из rf_start_rx: на паузе задача не просыпается
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        if (!enabled)
+        {
+            ESP_ERROR_CHECK(rmt_enable(dec->rx_chan));
+            enabled = true;
+        }
+        if (!armed)
+        {
+            ESP_ERROR_CHECK(rmt_receive(dec->rx_chan, dec->buf[cur].sym, raw_size, &receive_config));
+            armed = true;
+        }
 
-        size_t num_symbols = 0;
+        rx_evt_t evt;
         // Ждем сообщения из коллбэка о том, что прием окончен
-        if (xQueueReceive(rmt_rx_evt_queue, &num_symbols, portMAX_DELAY))
-        {
-            if (num_symbols < 32)
-                continue;
-            printf("\n--- Пакет PWM ---\n");
+        if (xQueueReceive(dec->evt_queue, &evt, pdMS_TO_TICKS(100)) != pdTRUE)
+            continue;
+        dec->bursts++;
 
-            uint32_t last_dur = 0;
-            int last_lvl = -1;
-            uint8_t current_byte = 0;
-            int bit_count = 0;
-            int bytes_printed = 0; // Теперь переменная на месте
+        // Сразу перевзводим приём в свободный буфер: пока этот разбирают,
+        // канал уже слушает эфир. Свободного нет — разбор отстал, этот
+        // всплеск перезаписывается.
+        uint8_t filled = cur;
+        bool handoff = spsc_pop(&dec->free, &cur);
+        if (!handoff)
+            dec->overruns++;
+        armed = (rmt_receive(dec->rx_chan, dec->buf[cur].sym, raw_size, &receive_config) == ESP_OK);
 
-            for (size_t i = 0; i < num_symbols; i++)
-            {
-                uint32_t durs[2] = {raw_symbols[i].duration0, raw_symbols[i].duration1};
-                int lvls[2] = {raw_symbols[i].level0, raw_symbols[i].level1};
+        if (handoff)
+        {
+            dec->buf[filled].num_symbols = evt.num_symbols;
+            dec->buf[filled].timestamp_us = evt.timestamp_us;
+            spsc_push(&dec->filled, filled); // буферов столько же, сколько мест
+            xTaskNotifyGive(s_worker);
+        }
+    }
+}
 
-                for (int j = 0; j < 2; j++)
-                {
-                    if (durs[j] == 0)
-                        continue;
+void decoder_wake(decoder_t *dec)
+{
+    if (dec && dec->task)
+        xTaskNotifyGive(dec->task);
+}
 
-                    if (last_lvl == -1)
-                    {
-                        last_lvl = lvls[j];
-                        last_dur = durs[j];
-                    }
-                    else if (lvls[j] == last_lvl)
-                    {
-                        last_dur += durs[j];
-                    }
-                    else
-                    {
-                        // Реальный переход уровня
-                        if (durs[j] > 5)
-                        { // Игнорируем совсем мелкий шум
+esp_err_t decoder_start(decoder_t *dec, const decoder_cfg_t *cfg)
+{
+    if (!dec || !cfg)
+        return ESP_ERR_INVALID_ARG;
+    if (!s_worker)
+        return ESP_ERR_INVALID_STATE;
+    if (s_dec_count >= (int)(sizeof(s_decs) / sizeof(s_decs[0])))
+        return ESP_ERR_NO_MEM;
+    memset(dec, 0, sizeof(*dec));
+    dec->cfg = *cfg;
 
-                            // Нас интересует только длительность ПОЛОЖИТЕЛЬНОГО импульса
-                            if (last_lvl == 1)
-                            {
-                                int bit = -1;
-                                if (last_dur >= 25 && last_dur <= 45)
-                                    bit = 0; // ~350 мкс
-                                else if (last_dur >= 60 && last_dur <= 85)
-                                    bit = 1; // ~700 мкс
+    // без CONFIG_PM_ENABLE — ESP_ERR_NOT_SUPPORTED, разбор без блокировки
+    if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "decoder", &dec->pm_lock) != ESP_OK)
+        dec->pm_lock = NULL;
 
-                                if (bit != -1)
-                                {
-                                    current_byte = (current_byte << 1) | bit;
-                                    bit_count++;
-
-                                    if (bit_count == 8)
-                                    {
-                                        if (bytes_printed < sizeof(last_pkt.data))
-                                        {
-                                            last_pkt.data[bytes_printed] = current_byte;
-                                        }
-                                        bytes_printed++; // Считаем байты
-
-                                        // Твой старый printf остается
-                                        printf("%02X ", current_byte);
-
-                                        bit_count = 0;
-                                        current_byte = 0;
-                                    }
-                                }
-                            }
+    esp_err_t err = ESP_ERR_NO_MEM;
+    dec->evt_queue = xQueueCreate(4, sizeof(rx_evt_t));
+    if (!s_start_done)
+        s_start_done = xSemaphoreCreateBinary();
+    if (!dec->evt_queue || !s_start_done)
+        goto fail;
+    // буферы в куче, а не на стеке задачи (по 4 КБ)
+    for (int i = 0; i < DECODER_RX_BUFS; i++)
+    {
+        dec->buf[i].sym = calloc(DECODER_RAW_SYMBOLS, sizeof(rmt_symbol_word_t));
+        if (!dec->buf[i].sym)
+            goto fail;
+        spsc_push(&dec->free, (uint8_t)i);
+    }
 
-                            last_lvl = lvls[j];
-                            last_dur = durs[j];
-                        }
-                    }
-                }
-            }
-            last_pkt.len = bytes_printed;
-            last_pkt.updated = true;
-            printf("\n--- Конец пакета ---\n");
-        }
+    if (xTaskCreatePinnedToCore(capture_task, "rmt_capture", 3072, dec, s_pipe.capture_prio,
+                                &dec->task, s_pipe.capture_core) != pdPASS)
+    {
+        dec->task = NULL;
+        goto fail;
+    }
+    xSemaphoreTake(s_start_done, portMAX_DELAY);
+    if (s_start_err != ESP_OK)
+    {
+        // задача удаляет себя сама, канал закрыт в channel_open
+        dec->task = NULL;
+        err = s_start_err;
+        goto fail;
+    }
+    return dec_register(dec);
+
+fail:
+    for (int i = 0; i < DECODER_RX_BUFS; i++)
+    {
+        free(dec->buf[i].sym);
+        dec->buf[i].sym = NULL;
+    }
+    if (dec->evt_queue)
+    {
+        vQueueDelete(dec->evt_queue);
+        dec->evt_queue = NULL;
     }
-}
\ No newline at end of file
+    if (dec->pm_lock)
+    {
+        esp_pm_lock_delete(dec->pm_lock);
+        dec->pm_lock = NULL;
+    }
+    return err;
+}
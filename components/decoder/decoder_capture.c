@@ -0,0 +1,168 @@
+#include "decoder_capture.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "CAPTURE";
+
+#define CAPTURE_WRITE_WAIT_MS 2
+// всплеск заканчивается по тишине signal_range_max_ns (decoder.c)
+#define CAPTURE_RX_IDLE_US 2000
+
+static uint16_t *s_dur = NULL;
+static uint32_t s_cap = 0;
+static int64_t s_gap_us = 0;
+static SemaphoreHandle_t s_mutex = NULL;
+
+static decoder_capture_t s_cur;
+static int64_t s_last_end_us = 0;
+static volatile uint32_t s_seq = 0;
+static volatile bool s_hold = false;
+static uint32_t s_lost = 0;
+
+esp_err_t decoder_capture_init(uint32_t max_edges, uint32_t gap_ms)
+{
+    if (s_dur)
+        return ESP_OK;
+    if (!max_edges)
+        return ESP_ERR_INVALID_ARG;
+
+    s_mutex = xSemaphoreCreateMutex();
+    if (!s_mutex)
+        return ESP_ERR_NO_MEM;
+
+    s_dur = heap_caps_malloc(max_edges * sizeof(uint16_t), MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+    if (!s_dur)
+    {
+        vSemaphoreDelete(s_mutex);
+        s_mutex = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_cap = max_edges;
+    s_gap_us = (int64_t)gap_ms * 1000;
+    memset(&s_cur, 0, sizeof(s_cur));
+    s_cur.dur = s_dur;
+    ESP_LOGI(TAG, "%lu edges (%u KB), gap %lu ms", (unsigned long)s_cap,
+             (unsigned)(s_cap * sizeof(uint16_t) / 1024), (unsigned long)gap_ms);
+    return ESP_OK;
+}
+
+// Дописать уровень: тот же, что последний, — удлинить, иначе новый фронт.
+// total_ticks — ровно сумма сохранённых длительностей (с насыщением).
+static void push_level(int level, uint32_t ticks)
+{
+    if (s_cur.truncated)
+        return;
+    if (ticks > UINT16_MAX)
+        ticks = UINT16_MAX;
+    if (s_cur.count)
+    {
+        int last = s_cur.first_level ^ ((s_cur.count - 1) & 1);
+        if (last == level)
+        {
+            uint16_t *d = &s_dur[s_cur.count - 1];
+            uint32_t add = (uint32_t)UINT16_MAX - *d;
+            if (add > ticks)
+                add = ticks;
+            *d += (uint16_t)add;
+            s_cur.total_ticks += add;
+            return;
+        }
+    }
+    else
+    {
+        s_cur.first_level = (uint8_t)level;
+    }
+
+    if (s_cur.count >= s_cap)
+    {
+        s_cur.truncated = true;
+        return;
+    }
+    s_dur[s_cur.count++] = (uint16_t)ticks;
+    s_cur.total_ticks += ticks;
+}
+
+void decoder_capture_add_burst(uint8_t radio_id, const rmt_symbol_word_t *sym,
+                               size_t num_symbols, int64_t end_us)
+{
+    if (!s_dur || s_hold || !num_symbols)
+        return;
+    if (xSemaphoreTake(s_mutex, pdMS_TO_TICKS(CAPTURE_WRITE_WAIT_MS)) != pdTRUE)
+    {
+        s_lost++;
+        return;
+    }
+
+    uint32_t burst_ticks = 0;
+    for (size_t i = 0; i < num_symbols; i++)
+        burst_ticks += sym[i].duration0 + sym[i].duration1;
+    int64_t start_us = end_us - CAPTURE_RX_IDLE_US - (int64_t)burst_ticks * DECODER_CAPTURE_TICK_US;
+
+    bool fresh = !s_cur.count || radio_id != s_cur.radio_id ||
+                 start_us - s_last_end_us > s_gap_us;
+    if (fresh)
+    {
+        s_cur.count = 0;
+        s_cur.total_ticks = 0;
+        s_cur.truncated = false;
+        s_cur.bursts = 0;
+        s_cur.radio_id = radio_id;
+    }
+    else
+    {
+        // пауза между всплесками — низкий уровень
+        int64_t gap = (start_us - s_last_end_us) / DECODER_CAPTURE_TICK_US;
+        push_level(0, gap > 0 ? (uint32_t)gap : 1);
+    }
+
+    for (size_t i = 0; i < num_symbols; i++)
+    {
+        if (!sym[i].duration0)
+            break;
+        push_level(sym[i].level0, sym[i].duration0);
+        if (!sym[i].duration1)
+            break;
+        push_level(sym[i].level1, sym[i].duration1);
+    }
+    if (s_cur.bursts < UINT8_MAX)
+        s_cur.bursts++;
+    s_last_end_us = end_us - CAPTURE_RX_IDLE_US;
+    s_cur.end_us = s_last_end_us;
+    s_cur.seq = ++s_seq;
+
+    xSemaphoreGive(s_mutex);
+}
+
+uint32_t decoder_capture_seq(void)
+{
+    return s_seq;
+}
+
+bool decoder_capture_take(decoder_capture_t *out, TickType_t wait)
+{
+    if (!s_dur || !out)
+        return false;
+    if (xSemaphoreTake(s_mutex, wait) != pdTRUE)
+        return false;
+    *out = s_cur;
+    return true;
+}
+
+void decoder_capture_give(void)
+{
+    if (s_mutex)
+        xSemaphoreGive(s_mutex);
+}
+
+void decoder_capture_hold(bool hold)
+{
+    if (s_hold != hold && s_lost)
+        ESP_LOGW(TAG, "%lu bursts lost while capture was busy", (unsigned long)s_lost);
+    s_hold = hold;
+}
@@ -3,22 +3,139 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "driver/rmt_rx.h"
+#include "esp_pm.h"
 #include "freertos/queue.h"
 
 #include "esp_log.h"
 
 
+// Чем декодирован пакет (индекс хранилища захватов фильтрует по нему)
+typedef enum {
+    DECODER_PROTO_NONE = 0, // не декодирован: только сырой захват
+    DECODER_PROTO_PWM,
+    DECODER_PROTO_COUNT,
+} decoder_proto_t;
+
 typedef struct {
     uint8_t data[128]; // Буфер для HEX данных
     int len;           // Кол-во принятых байт
     bool updated;      // Флаг для main.c
+    uint8_t radio_id;  // с какого CC1101 пришёл пакет
+    uint8_t proto;     // decoder_proto_t
+    uint32_t freq_hz;
+    int64_t timestamp_us; // конец всплеска, timebase_mono_us (метка из ISR RMT)
 } packet_t;
 
 // extern говорит компилятору: "сама переменная в другом файле, просто знай о ней"
+// Последний пакет из общего (упорядоченного по времени) потока.
 extern packet_t last_pkt;
 
+// Общая пауза приёма для всех декодеров (экран RF закрыт)
 extern bool decoder_rmt_running;
 
-void rmt_rx_loop_task(void *arg);
+// Вызывается из задачи декодера после каждого принятого всплеска (burst).
+// pkt->len == 0 означает, что всплеск не декодировался (ложное срабатывание).
+typedef void (*decoder_burst_cb_t)(const packet_t *pkt, size_t num_symbols, void *ctx);
+
+#define DECODER_RAW_SYMBOLS 1000
+#define DECODER_RX_BUFS 4 // на радио: один у RMT, остальные ждут разбора (степень 2)
+#define DECODER_MAX_RADIOS 2
+
+// Конвейер приёма:
+//   захват — задача на радио: только перевзвести RMT в свободный буфер и
+//       отдать заполненный дальше; высокий приоритет, ядро RMT ISR;
+//   разбор — одна задача на все радио: PWM, сырой захват, burst_cb,
+//       передача в общий поток; на другом ядре;
+//   общий поток — упорядочивание по времени и раздача подписчикам (UI,
+//       хранилище): у них свои очереди и задачи с приоритетом ниже.
+// Захват и разбор обмениваются индексами буферов через два кольца SPSC
+// (заполненные туда, освобождённые обратно) — без блокировок и без
+// копирования символов. Нет свободного буфера — всплеск перезаписывается
+// (overruns), приём не останавливается.
+typedef struct {
+    UBaseType_t capture_prio;
+    BaseType_t capture_core;
+    UBaseType_t worker_prio;
+    BaseType_t worker_core;
+    UBaseType_t stream_prio;
+    BaseType_t stream_core; // tskNO_AFFINITY — без привязки
+} decoder_pipeline_cfg_t;
+
+// Кольцо индексов буферов: head двигает только производитель, tail —
+// только потребитель
+typedef struct {
+    uint8_t slot[DECODER_RX_BUFS];
+    uint32_t head;
+    uint32_t tail;
+} decoder_spsc_t;
+
+typedef struct {
+    rmt_symbol_word_t *sym;
+    size_t num_symbols;
+    int64_t timestamp_us; // конец всплеска (метка из ISR RMT)
+} decoder_buf_t;
+
+typedef struct {
+    int gpio_num;        // GDO0 (async serial data)
+    uint8_t radio_id;
+    uint32_t freq_hz;    // только для меток в пакетах
+    decoder_burst_cb_t burst_cb;
+    void *burst_cb_ctx;
+} decoder_cfg_t;
+
+// Один экземпляр на CC1101: свой RMT-канал, свои буферы, своя задача захвата.
+// RMT тактируется от XTAL: разрешение не зависит от DFS, а драйвер, пока
+// канал включён, держит только запрет light sleep — частота CPU между
+// всплесками может падать. На разбор всплеска берётся CPU max.
+typedef struct {
+    decoder_cfg_t cfg;
+    rmt_channel_handle_t rx_chan;       // NULL — источник бенчмарка
+    QueueHandle_t evt_queue;            // ISR -> задача захвата
+    decoder_buf_t buf[DECODER_RX_BUFS];
+    decoder_spsc_t filled;              // захват -> разбор
+    decoder_spsc_t free;                // разбор -> захват
+    TaskHandle_t task;
+    esp_pm_lock_handle_t pm_lock;       // CPU max на разбор всплеска; NULL без CONFIG_PM_ENABLE
+    uint32_t bursts;
+    uint32_t overruns;                  // разбор не успел: буфер перезаписан
+    uint32_t dropped;                   // не влезли в общий поток
+} decoder_t;
+
+// Один раз до decoder_stream_init / decoder_start: размещение стадий и
+// задача разбора
+esp_err_t decoder_pipeline_init(const decoder_pipeline_cfg_t *cfg);
+
+// Создаёт RMT-канал и задачу захвата (ядро и приоритет — из конвейера)
+esp_err_t decoder_start(decoder_t *dec, const decoder_cfg_t *cfg);
+
+// Будит задачу захвата после смены decoder_rmt_running: на паузе она
+// спит на уведомлении, а не опрашивает флаг
+void decoder_wake(decoder_t *dec);
+
+// Бенчмарк пропускной способности: синтетический источник на месте
+// захвата (то же ядро и приоритет) гонит через кольца готовый PWM-всплеск
+// так быстро, как освобождаются буферы; разбор — та же задача, что у радио.
+// В общий поток, захват осциллограммы и burst_cb бенчмарк не попадает.
+// Живые радио продолжают работать.
+typedef struct {
+    uint32_t captures;    // разобрано
+    uint32_t elapsed_ms;
+    uint32_t per_s;       // captures / s
+    uint32_t decode_us;   // среднее время разбора одного
+    uint32_t stalls;      // источник ждал свободный буфер
+    uint32_t symbols;     // длина всплеска
+} decoder_bench_result_t;
+
+esp_err_t decoder_bench_start(void);
+// Останавливает источник и дожидается разбора хвоста
+esp_err_t decoder_bench_stop(decoder_bench_result_t *out);
+
+// --- Общий поток пакетов со всех радио, упорядоченный по timestamp_us ---
+// Пакеты придерживаются hold_ms (больше, чем задержка декодирования),
+// чтобы всплеск, закончившийся раньше на другом радио, не вышел позже.
+typedef void (*decoder_stream_cb_t)(const packet_t *pkt, void *ctx);
+
+esp_err_t decoder_stream_init(uint32_t hold_ms);
+esp_err_t decoder_stream_subscribe(decoder_stream_cb_t cb, void *ctx);
 
-#endif
\ No newline at end of file
+#endif
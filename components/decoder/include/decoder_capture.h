@@ -0,0 +1,54 @@
+#ifndef DECODER_CAPTURE_H
+#define DECODER_CAPTURE_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "driver/rmt_rx.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+// Сырой таймлайн последнего захвата — для осциллограммы.
+//
+// Захват — всплески одного радио подряд, паузы между которыми короче gap_ms
+// (пульт шлёт посылку несколько раз). Хранится как длительности уровней
+// в тиках RMT (10 мкс), уровни чередуются начиная с first_level — 2 байта
+// на фронт. Пауза между всплесками — обычный интервал низкого уровня.
+// Новый захват затирает предыдущий.
+
+#define DECODER_CAPTURE_TICK_US 10
+#define DECODER_CAPTURE_EDGES 4096 // 8 КБ; длиннее — truncated
+#define DECODER_CAPTURE_GAP_MS 250
+
+typedef struct {
+    const uint16_t *dur;  // count длительностей, тики
+    uint32_t count;
+    uint8_t first_level;
+    uint8_t radio_id;
+    uint8_t bursts;       // всплесков в захвате
+    bool truncated;       // не влез в буфер, хвост потерян
+    uint64_t total_ticks;
+    int64_t end_us;       // конец последнего всплеска, timebase_mono_us
+    uint32_t seq;         // растёт при каждом изменении захвата
+} decoder_capture_t;
+
+// Один раз (повторный вызов ничего не делает). Буфер — ровно max_edges
+// фронтов, не хватило памяти — ESP_ERR_NO_MEM.
+esp_err_t decoder_capture_init(uint32_t max_edges, uint32_t gap_ms);
+
+// Из задачи декодера: принятый всплеск, end_us — метка конца из ISR
+void decoder_capture_add_burst(uint8_t radio_id, const rmt_symbol_word_t *sym,
+                               size_t num_symbols, int64_t end_us);
+
+// Номер текущего захвата без блокировки (изменился — пора перечитать)
+uint32_t decoder_capture_seq(void);
+
+// Доступ к буферу. Пока захват взят, декодер новые всплески не пишет
+// (ждёт не дольше пары мс, потом теряет всплеск) — держать недолго.
+bool decoder_capture_take(decoder_capture_t *out, TickType_t wait);
+void decoder_capture_give(void);
+
+// Заморозить захват: новые всплески не пишутся, пока hold
+void decoder_capture_hold(bool hold);
+
+#endif
@@ -0,0 +1,363 @@
+#include "i2c_bus.h"
+
+#include <string.h>
+
+#include "driver/i2c_master.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+static const char *TAG = "I2C_BUS";
+
+#define RECOVER_CLOCKS 9
+#define RECOVER_HALF_US 5           // ~100 кГц
+
+typedef struct
+{
+    const uint8_t *tx;
+    size_t tx_len;
+    uint8_t *rx;
+    size_t rx_len;
+    int64_t queued_us;
+    esp_err_t result;
+} i2c_req_t;
+
+struct i2c_bus_dev
+{
+    i2c_bus_dev_config_t cfg;
+    i2c_master_dev_handle_t hw;
+    SemaphoreHandle_t lock;         // у устройства в очереди не больше одного запроса
+    SemaphoreHandle_t done;
+    i2c_req_t req;
+
+    // статистика (пишет только исполнитель)
+    uint32_t txns;
+    uint32_t errors;                // не удалось и с повторами
+    uint32_t retries;
+    uint32_t timeouts;
+    uint64_t lat_sum_us;            // от постановки в очередь до результата
+    uint32_t lat_max_us;
+    uint64_t bus_sum_us;
+    esp_err_t last_err;
+};
+
+static i2c_bus_config_t s_cfg;
+static i2c_master_bus_handle_t s_bus = NULL;
+static struct i2c_bus_dev s_devs[I2C_BUS_MAX_DEVICES];
+static int s_dev_count = 0;
+static SemaphoreHandle_t s_add_lock = NULL;
+
+static QueueHandle_t s_q[I2C_BUS_PRIO_COUNT];
+static SemaphoreHandle_t s_pending = NULL;
+
+static uint32_t s_timeouts_in_row = 0;
+static uint32_t s_recoveries = 0;
+
+// ------------------------- железо -------------------------
+
+static esp_err_t bus_create(void)
+{
+    i2c_master_bus_config_t bus_cfg = {
+        .i2c_port = -1, // auto-select
+        .sda_io_num = s_cfg.sda,
+        .scl_io_num = s_cfg.scl,
+        .clk_source = I2C_CLK_SRC_DEFAULT,
+        .glitch_ignore_cnt = 7,
+        .flags.enable_internal_pullup = s_cfg.internal_pullup,
+    };
+    return i2c_new_master_bus(&bus_cfg, &s_bus);
+}
+
+static esp_err_t dev_attach(struct i2c_bus_dev *d)
+{
+    i2c_device_config_t dev_cfg = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = d->cfg.addr,
+        .scl_speed_hz = d->cfg.scl_hz,
+    };
+    return i2c_master_bus_add_device(s_bus, &dev_cfg, &d->hw);
+}
+
+// Ведомый, сброшенный посреди чтения, держит SDA в нуле и ждёт тактов:
+// дотактировать байт вручную и выдать STOP
+static bool bus_clock_out(void)
+{
+    gpio_config_t io = {
+        .pin_bit_mask = (1ULL << s_cfg.scl) | (1ULL << s_cfg.sda),
+        .mode = GPIO_MODE_INPUT_OUTPUT_OD,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    gpio_config(&io);
+    gpio_set_level(s_cfg.sda, 1);
+    gpio_set_level(s_cfg.scl, 1);
+    esp_rom_delay_us(RECOVER_HALF_US);
+
+    for (int i = 0; i < RECOVER_CLOCKS && !gpio_get_level(s_cfg.sda); i++)
+    {
+        gpio_set_level(s_cfg.scl, 0);
+        esp_rom_delay_us(RECOVER_HALF_US);
+        gpio_set_level(s_cfg.scl, 1);
+        esp_rom_delay_us(RECOVER_HALF_US);
+    }
+
+    // STOP: SDA 0 -> 1 при SCL = 1
+    gpio_set_level(s_cfg.scl, 0);
+    esp_rom_delay_us(RECOVER_HALF_US);
+    gpio_set_level(s_cfg.sda, 0);
+    esp_rom_delay_us(RECOVER_HALF_US);
+    gpio_set_level(s_cfg.scl, 1);
+    esp_rom_delay_us(RECOVER_HALF_US);
+    gpio_set_level(s_cfg.sda, 1);
+    esp_rom_delay_us(RECOVER_HALF_US);
+
+    bool released = gpio_get_level(s_cfg.sda) != 0;
+    gpio_reset_pin(s_cfg.sda);
+    gpio_reset_pin(s_cfg.scl);
+    return released;
+}
+
+// Только из исполнителя (или до его запуска)
+static esp_err_t bus_recover_locked(void)
+{
+    int64_t t0 = esp_timer_get_time();
+    for (int i = 0; i < s_dev_count; i++)
+    {
+        if (s_devs[i].hw)
+            i2c_master_bus_rm_device(s_devs[i].hw);
+        s_devs[i].hw = NULL;
+    }
+    if (s_bus)
+        i2c_del_master_bus(s_bus);
+    s_bus = NULL;
+
+    bool released = bus_clock_out();
+
+    esp_err_t err = bus_create();
+    for (int i = 0; err == ESP_OK && i < s_dev_count; i++)
+        err = dev_attach(&s_devs[i]);
+
+    s_recoveries++;
+    s_timeouts_in_row = 0;
+    ESP_LOGW(TAG, "bus recovery #%lu: SDA %s, %s in %lld us", (unsigned long)s_recoveries,
+             released ? "released" : "still low", esp_err_to_name(err),
+             (long long)(esp_timer_get_time() - t0));
+    return err;
+}
+
+// ------------------------- исполнитель -------------------------
+
+static esp_err_t xfer_once(struct i2c_bus_dev *d)
+{
+    if (!d->hw)
+        return ESP_ERR_INVALID_STATE; // восстановление не удалось
+    const i2c_req_t *r = &d->req;
+    if (r->rx_len)
+        return i2c_master_transmit_receive(d->hw, r->tx, r->tx_len, r->rx, r->rx_len,
+                                           (int)d->cfg.timeout_ms);
+    return i2c_master_transmit(d->hw, r->tx, r->tx_len, (int)d->cfg.timeout_ms);
+}
+
+static void execute(struct i2c_bus_dev *d)
+{
+    esp_err_t err = ESP_FAIL;
+    int64_t t0 = esp_timer_get_time();
+
+    for (int attempt = 0; attempt <= I2C_BUS_RETRIES; attempt++)
+    {
+        if (attempt)
+        {
+            d->retries++;
+            vTaskDelay(pdMS_TO_TICKS(I2C_BUS_BACKOFF_MS << (attempt - 1)));
+        }
+        err = xfer_once(d);
+        if (err == ESP_OK || err == ESP_ERR_INVALID_ARG)
+            break;
+
+        if (err == ESP_ERR_TIMEOUT)
+        {
+            d->timeouts++;
+            if (++s_timeouts_in_row >= I2C_BUS_RECOVER_AFTER)
+                bus_recover_locked();
+        }
+    }
+    if (err == ESP_OK)
+        s_timeouts_in_row = 0;
+
+    int64_t now = esp_timer_get_time();
+    uint32_t lat = (uint32_t)(now - d->req.queued_us);
+    d->txns++;
+    d->bus_sum_us += (uint64_t)(now - t0);
+    d->lat_sum_us += lat;
+    if (lat > d->lat_max_us)
+        d->lat_max_us = lat;
+    if (err != ESP_OK)
+    {
+        d->errors++;
+        if (err != d->last_err)
+            ESP_LOGW(TAG, "%s: %s after %d retries", d->cfg.name, esp_err_to_name(err),
+                     I2C_BUS_RETRIES);
+    }
+    d->last_err = err;
+    d->req.result = err;
+}
+
+static void i2c_bus_task(void *arg)
+{
+    (void)arg;
+    while (1)
+    {
+        xSemaphoreTake(s_pending, portMAX_DELAY);
+        struct i2c_bus_dev *d = NULL;
+        for (int p = I2C_BUS_PRIO_COUNT - 1; p >= 0 && !d; p--)
+            if (xQueueReceive(s_q[p], &d, 0) != pdTRUE)
+                d = NULL;
+        if (!d)
+            continue;
+        execute(d);
+        xSemaphoreGive(d->done);
+    }
+}
+
+static esp_err_t submit(struct i2c_bus_dev *d, const uint8_t *tx, size_t tx_len,
+                        uint8_t *rx, size_t rx_len)
+{
+    if (!d || !tx || !tx_len || (rx_len && !rx))
+        return ESP_ERR_INVALID_ARG;
+
+    xSemaphoreTake(d->lock, portMAX_DELAY);
+    d->req = (i2c_req_t){
+        .tx = tx,
+        .tx_len = tx_len,
+        .rx = rx,
+        .rx_len = rx_len,
+        .queued_us = esp_timer_get_time(),
+        .result = ESP_FAIL,
+    };
+    xQueueSend(s_q[d->cfg.prio], &d, portMAX_DELAY);
+    xSemaphoreGive(s_pending);
+    // исполнитель отвечает всегда: каждая попытка ограничена timeout_ms
+    xSemaphoreTake(d->done, portMAX_DELAY);
+    esp_err_t err = d->req.result;
+    xSemaphoreGive(d->lock);
+    return err;
+}
+
+// ------------------------- API -------------------------
+
+esp_err_t i2c_bus_init(const i2c_bus_config_t *cfg)
+{
+    if (!cfg)
+        return ESP_ERR_INVALID_ARG;
+    if (s_bus)
+        return ESP_ERR_INVALID_STATE;
+    s_cfg = *cfg;
+
+    s_add_lock = xSemaphoreCreateMutex();
+    s_pending = xSemaphoreCreateCounting(I2C_BUS_MAX_DEVICES, 0);
+    if (!s_add_lock || !s_pending)
+        return ESP_ERR_NO_MEM;
+    for (int p = 0; p < I2C_BUS_PRIO_COUNT; p++)
+    {
+        s_q[p] = xQueueCreate(I2C_BUS_MAX_DEVICES, sizeof(struct i2c_bus_dev *));
+        if (!s_q[p])
+            return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t err = bus_create();
+    if (err != ESP_OK)
+    {
+        // бывает после сброса посреди транзакции — одна попытка восстановления
+        ESP_LOGW(TAG, "bus create: %s, trying recovery", esp_err_to_name(err));
+        err = bus_recover_locked();
+        if (err != ESP_OK)
+            return err;
+    }
+
+    if (xTaskCreatePinnedToCore(i2c_bus_task, "i2c_bus", 3072, NULL, s_cfg.task_prio, NULL,
+                                s_cfg.task_core) != pdPASS)
+        return ESP_ERR_NO_MEM;
+    ESP_LOGI(TAG, "SDA %d SCL %d", s_cfg.sda, s_cfg.scl);
+    return ESP_OK;
+}
+
+bool i2c_bus_ready(void)
+{
+    return s_bus != NULL;
+}
+
+esp_err_t i2c_bus_add_device(const i2c_bus_dev_config_t *cfg, i2c_bus_dev_t *out)
+{
+    if (!cfg || !out || cfg->prio >= I2C_BUS_PRIO_COUNT)
+        return ESP_ERR_INVALID_ARG;
+    if (!s_bus)
+        return ESP_ERR_INVALID_STATE;
+
+    xSemaphoreTake(s_add_lock, portMAX_DELAY);
+    esp_err_t err = ESP_ERR_NO_MEM;
+    if (s_dev_count < I2C_BUS_MAX_DEVICES)
+    {
+        struct i2c_bus_dev *d = &s_devs[s_dev_count];
+        memset(d, 0, sizeof(*d));
+        d->cfg = *cfg;
+        d->lock = xSemaphoreCreateMutex();
+        d->done = xSemaphoreCreateBinary();
+        err = (d->lock && d->done) ? dev_attach(d) : ESP_ERR_NO_MEM;
+        if (err == ESP_OK)
+        {
+            s_dev_count++;
+            *out = d;
+        }
+    }
+    xSemaphoreGive(s_add_lock);
+    if (err != ESP_OK)
+        ESP_LOGE(TAG, "add %s @0x%02X: %s", cfg->name, cfg->addr, esp_err_to_name(err));
+    return err;
+}
+
+esp_err_t i2c_bus_write(i2c_bus_dev_t dev, const uint8_t *tx, size_t tx_len)
+{
+    return submit(dev, tx, tx_len, NULL, 0);
+}
+
+esp_err_t i2c_bus_write_read(i2c_bus_dev_t dev, const uint8_t *tx, size_t tx_len,
+                             uint8_t *rx, size_t rx_len)
+{
+    if (!rx_len)
+        return ESP_ERR_INVALID_ARG;
+    return submit(dev, tx, tx_len, rx, rx_len);
+}
+
+esp_err_t i2c_bus_recover(void)
+{
+    if (!s_bus || !s_dev_count)
+        return ESP_ERR_INVALID_STATE;
+    // с замками всех устройств ни одного запроса нет ни в очереди, ни
+    // у исполнителя — шину можно пересоздать из этой задачи
+    for (int i = 0; i < s_dev_count; i++)
+        xSemaphoreTake(s_devs[i].lock, portMAX_DELAY);
+    esp_err_t err = bus_recover_locked();
+    for (int i = s_dev_count - 1; i >= 0; i--)
+        xSemaphoreGive(s_devs[i].lock);
+    return err;
+}
+
+void i2c_bus_report(void)
+{
+    ESP_LOGI(TAG, "%lu recoveries", (unsigned long)s_recoveries);
+    for (int i = 0; i < s_dev_count; i++)
+    {
+        const struct i2c_bus_dev *d = &s_devs[i];
+        uint32_t n = d->txns ? d->txns : 1;
+        ESP_LOGI(TAG, "%-8s @0x%02X p%d: %lu txn, %lu err, %lu retry, %lu timeout, "
+                 "latency avg %llu max %lu us, bus avg %llu us",
+                 d->cfg.name, d->cfg.addr, d->cfg.prio, (unsigned long)d->txns,
+                 (unsigned long)d->errors, (unsigned long)d->retries,
+                 (unsigned long)d->timeouts, (unsigned long long)(d->lat_sum_us / n),
+                 (unsigned long)d->lat_max_us, (unsigned long long)(d->bus_sum_us / n));
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+// Общая шина I2C: владеет i2c_master_bus, устройства регистрируются здесь,
+// а не создают шину сами.
+//
+// Транзакции выполняет одна задача-исполнитель; вызывающая задача ставит
+// запрос в очередь своего приоритета и ждёт результат. Из очередей первым
+// берётся запрос с большим приоритетом (у устройства). Ошибка — повтор с
+// удваивающейся паузой; несколько таймаутов подряд — шину считаем
+// зависшей (ведомый держит SDA) и восстанавливаем: SCL вручную до 9
+// импульсов, STOP, шина и устройства создаются заново. Вызывающий всегда
+// получает esp_err_t, ничего не падает.
+
+#define I2C_BUS_MAX_DEVICES 6
+#define I2C_BUS_RETRIES 3           // повторов после первой попытки
+#define I2C_BUS_BACKOFF_MS 10       // пауза перед первым повтором, дальше x2
+#define I2C_BUS_RECOVER_AFTER 3     // таймаутов подряд до восстановления
+
+typedef enum {
+    I2C_BUS_PRIO_LOW = 0,
+    I2C_BUS_PRIO_NORMAL,
+    I2C_BUS_PRIO_HIGH,
+    I2C_BUS_PRIO_COUNT,
+} i2c_bus_prio_t;
+
+typedef struct {
+    gpio_num_t sda;
+    gpio_num_t scl;
+    bool internal_pullup;
+    UBaseType_t task_prio;          // исполнитель: выше, чем у пользователей шины
+    BaseType_t task_core;
+} i2c_bus_config_t;
+
+typedef struct {
+    const char *name;
+    uint16_t addr;                  // 7 бит
+    uint32_t scl_hz;
+    uint32_t timeout_ms;            // на одну попытку
+    i2c_bus_prio_t prio;
+} i2c_bus_dev_config_t;
+
+typedef struct i2c_bus_dev *i2c_bus_dev_t;
+
+esp_err_t i2c_bus_init(const i2c_bus_config_t *cfg);
+bool i2c_bus_ready(void);
+
+esp_err_t i2c_bus_add_device(const i2c_bus_dev_config_t *cfg, i2c_bus_dev_t *out);
+
+// Блокируют вызывающую задачу до конца транзакции (с повторами)
+esp_err_t i2c_bus_write(i2c_bus_dev_t dev, const uint8_t *tx, size_t tx_len);
+esp_err_t i2c_bus_write_read(i2c_bus_dev_t dev, const uint8_t *tx, size_t tx_len,
+                             uint8_t *rx, size_t rx_len);
+
+// Восстановить шину вручную (например, после горячего подключения Grove)
+esp_err_t i2c_bus_recover(void);
+
+// В лог: по каждому устройству транзакции, ошибки, повторы, задержка
+void i2c_bus_report(void);
+
+#endif
@@ -0,0 +1,53 @@
+// lv_conf.h для хостовой сборки UI. Повторяет значимые для отрисовки
+// опции из sdkconfig прошивки (CONFIG_LV_*), чтобы кадры и время рендера
+// на хосте были сопоставимы с платой.
+#ifndef LV_CONF_H
+#define LV_CONF_H
+
+#define LV_COLOR_DEPTH 16
+
+#define LV_USE_STDLIB_MALLOC LV_STDLIB_BUILTIN
+#define LV_USE_STDLIB_STRING LV_STDLIB_BUILTIN
+#define LV_USE_STDLIB_SPRINTF LV_STDLIB_BUILTIN
+#define LV_MEM_SIZE (64 * 1024U)
+
+#define LV_DEF_REFR_PERIOD 33
+#define LV_DPI_DEF 130
+
+#define LV_USE_OS LV_OS_NONE
+
+#define LV_USE_DRAW_SW 1
+#define LV_DRAW_SW_DRAW_UNIT_CNT 1
+#define LV_DRAW_SW_COMPLEX 1
+#define LV_DRAW_SW_CIRCLE_CACHE_SIZE 4
+#define LV_DRAW_LAYER_SIMPLE_BUF_SIZE (24 * 1024)
+#define LV_DRAW_BUF_STRIDE_ALIGN 1
+#define LV_DRAW_BUF_ALIGN 4
+#define LV_GRADIENT_MAX_STOPS 2
+
+#define LV_USE_LOG 0
+#define LV_USE_ASSERT_NULL 1
+#define LV_USE_ASSERT_MALLOC 1
+#define LV_USE_SYSMON 0
+
+#define LV_CACHE_DEF_SIZE 0
+#define LV_IMAGE_HEADER_CACHE_DEF_CNT 0
+
+#define LV_FONT_MONTSERRAT_14 1
+#define LV_FONT_UNSCII_8 1
+#define LV_FONT_DEFAULT &lv_font_montserrat_14
+
+#define LV_USE_CANVAS 1
+#define LV_USE_CHART 1
+#define LV_USE_FLEX 1
+#define LV_USE_GRID 1
+#define LV_USE_OBSERVER 1
+#define LV_USE_THEME_DEFAULT 1
+#define LV_THEME_DEFAULT_DARK 0
+#define LV_THEME_DEFAULT_GROW 1
+#define LV_THEME_DEFAULT_TRANSITION_TIME 80
+
+#define LV_BUILD_EXAMPLES 0
+#define LV_BUILD_DEMOS 0
+
+#endif
@@ -0,0 +1,555 @@
+// Прогон сценариев UI на хосте.
+//
+//   ui_host [опции] сценарий.scn ...
+//     --golden DIR     эталонные кадры (по умолчанию host/golden)
+//     --out DIR        куда писать снятые кадры (по умолчанию .)
+//     --update         переписать эталоны вместо сравнения
+//     --csv FILE       времена кадров по сценариям (по умолчанию ui_host.csv)
+//     --baseline FILE  CSV прошлого прогона: регрессия, если стало хуже
+//     --tolerance PCT  допуск к baseline, % (по умолчанию 25)
+//
+// Каждый сценарий — отдельный дочерний процесс: app_main() с нуля, своё
+// виртуальное время, свой LVGL. Время идёт шагами по 1 мс, после каждого
+// шага — lv_timer_handler(), как задача порта на плате.
+//
+// Время рендера меряется реальными часами хоста от REFR_START до REFR_READY
+// (только кадры, где было что рисовать). Абсолютные значения к плате не
+// приводятся, но отношения между сценариями и прогонами сохраняются.
+// Число отправленных пикселей детерминировано, из него же — оценка времени
+// SPI при pclk активного профиля дисплея.
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "capture_store.h"
+#include "disp_profile.h"
+#include "esp_lvgl_port.h"
+#include "esp_timer.h"
+#include "host_hooks.h"
+#include "lvgl.h"
+#include "ui_bus.h"
+#include "ui_latency.h"
+
+// пины как в main.c
+#define HOST_ENCODER_KEY 0
+#define HOST_KEY_ESC 6
+
+#define MAX_FRAMES 65536
+#define MAX_SCENARIOS 64
+#define PRESS_MS 60 // сколько держим кнопку и ждём после отпускания
+
+void app_main(void);
+
+typedef struct {
+  const char *golden_dir;
+  const char *out_dir;
+  const char *csv;
+  const char *baseline;
+  int tolerance_pct;
+  bool update;
+} opts_t;
+
+typedef struct {
+  char name[64];
+  uint32_t frames;
+  double mean_ms;
+  double p95_ms;
+  double max_ms;
+  uint64_t flushed_px;
+  double spi_ms;
+  int snaps_failed;
+} result_t;
+
+// ------------------------- замер кадров -------------------------
+
+static float *s_frame_ms = NULL;
+static uint32_t s_frames = 0;
+static uint64_t s_flushed_px = 0;
+static struct timespec s_refr_t0;
+static bool s_rendering = false;
+
+static double ts_ms(const struct timespec *a, const struct timespec *b) {
+  return (double)(b->tv_sec - a->tv_sec) * 1e3 +
+         (double)(b->tv_nsec - a->tv_nsec) / 1e6;
+}
+
+static void disp_event_cb(lv_event_t *e) {
+  switch (lv_event_get_code(e)) {
+  case LV_EVENT_REFR_START:
+    clock_gettime(CLOCK_MONOTONIC, &s_refr_t0);
+    s_rendering = false;
+    break;
+  case LV_EVENT_RENDER_START:
+    s_rendering = true;
+    break;
+  case LV_EVENT_FLUSH_START: {
+    const lv_area_t *a = lv_event_get_param(e);
+    if (a)
+      s_flushed_px += (uint64_t)lv_area_get_size(a);
+    break;
+  }
+  case LV_EVENT_REFR_READY:
+    if (s_rendering && s_frames < MAX_FRAMES) {
+      struct timespec t1;
+      clock_gettime(CLOCK_MONOTONIC, &t1);
+      s_frame_ms[s_frames++] = (float)ts_ms(&s_refr_t0, &t1);
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+static int cmp_float(const void *a, const void *b) {
+  float x = *(const float *)a, y = *(const float *)b;
+  return (x > y) - (x < y);
+}
+
+// ------------------------- шаги сценария -------------------------
+
+static void run_ms(uint32_t ms) {
+  static uint32_t store_ms = 0;
+  for (uint32_t i = 0; i < ms; i++) {
+    host_time_advance_us(1000);
+    // задачи на хосте не идут: за задачу хранилища — сброс на флеш раз в
+    // CAPTURE_STORE_FLUSH_MS, как она сбрасывает неполную пачку
+    if (++store_ms >= CAPTURE_STORE_FLUSH_MS) {
+      store_ms = 0;
+      capture_store_flush();
+    }
+    if (host_lvgl_running())
+      lv_timer_handler();
+  }
+}
+
+static void press_enter(void) {
+  host_button_set_pressed(HOST_ENCODER_KEY, true);
+  host_button_emit(HOST_ENCODER_KEY, BUTTON_PRESS_DOWN);
+  run_ms(PRESS_MS);
+  host_button_set_pressed(HOST_ENCODER_KEY, false);
+  host_button_emit(HOST_ENCODER_KEY, BUTTON_PRESS_UP);
+  run_ms(PRESS_MS);
+}
+
+static void press_esc(bool long_press) {
+  host_button_emit(HOST_KEY_ESC, BUTTON_PRESS_DOWN);
+  if (long_press) {
+    run_ms(1500);
+    host_button_emit(HOST_KEY_ESC, BUTTON_LONG_PRESS_START);
+  } else {
+    run_ms(PRESS_MS);
+  }
+  host_button_emit(HOST_KEY_ESC, BUTTON_PRESS_UP);
+  run_ms(PRESS_MS);
+}
+
+static int hex_nibble(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+// Запись пакетов: "<пауза_мс> <радио> <частота_Гц> <hex>", '#' — комментарий.
+// Пустой hex ("-") — всплеск, который не декодировался.
+static int replay_packets(const char *path) {
+  FILE *f = fopen(path, "r");
+  if (!f) {
+    fprintf(stderr, "packets: %s: %s\n", path, strerror(errno));
+    return -1;
+  }
+  char line[512];
+  int sent = 0, lost = 0;
+  while (fgets(line, sizeof(line), f)) {
+    unsigned delay_ms = 0, radio = 0;
+    unsigned long freq = 0;
+    char hex[300];
+    if (line[0] == '#' ||
+        sscanf(line, "%u %u %lu %299s", &delay_ms, &radio, &freq, hex) != 4)
+      continue;
+    run_ms(delay_ms);
+
+    packet_t pkt = {0};
+    pkt.radio_id = (uint8_t)radio;
+    pkt.freq_hz = (uint32_t)freq;
+    pkt.proto = DECODER_PROTO_PWM; // запись — уже декодированные пакеты
+    pkt.timestamp_us = esp_timer_get_time();
+    for (const char *p = hex; p[0] && p[1] && pkt.len < (int)sizeof(pkt.data);
+         p += 2) {
+      int hi = hex_nibble(p[0]), lo = hex_nibble(p[1]);
+      if (hi < 0 || lo < 0)
+        break;
+      pkt.data[pkt.len++] = (uint8_t)(hi << 4 | lo);
+    }
+    if (host_decoder_replay(&pkt))
+      sent++;
+    else
+      lost++;
+  }
+  fclose(f);
+  if (lost)
+    fprintf(stderr, "packets: %d replayed, %d dropped (RX not running)\n",
+            sent, lost);
+  return 0;
+}
+
+// ------------------------- кадры -------------------------
+
+static int write_ppm(const char *path, const uint16_t *fb, int w, int h) {
+  FILE *f = fopen(path, "wb");
+  if (!f)
+    return -1;
+  fprintf(f, "P6\n%d %d\n255\n", w, h);
+  for (int i = 0; i < w * h; i++) {
+    uint16_t c = fb[i];
+    uint8_t rgb[3] = {
+        (uint8_t)(((c >> 11) & 0x1F) * 255 / 31),
+        (uint8_t)(((c >> 5) & 0x3F) * 255 / 63),
+        (uint8_t)((c & 0x1F) * 255 / 31),
+    };
+    fwrite(rgb, 1, 3, f);
+  }
+  return fclose(f);
+}
+
+// Возвращает число отличающихся пикселей, -1 — эталона нет или он битый
+static long compare_ppm(const char *path, const uint16_t *fb, int w, int h) {
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return -1;
+  int gw = 0, gh = 0, maxv = 0;
+  if (fscanf(f, "P6 %d %d %d", &gw, &gh, &maxv) != 3 || gw != w || gh != h ||
+      maxv != 255) {
+    fclose(f);
+    return -1;
+  }
+  fgetc(f); // один пробельный символ после заголовка
+  long diff = 0;
+  for (int i = 0; i < w * h; i++) {
+    uint8_t g[3];
+    if (fread(g, 1, 3, f) != 3) {
+      fclose(f);
+      return -1;
+    }
+    uint16_t c = fb[i];
+    if (g[0] != (uint8_t)(((c >> 11) & 0x1F) * 255 / 31) ||
+        g[1] != (uint8_t)(((c >> 5) & 0x3F) * 255 / 63) ||
+        g[2] != (uint8_t)((c & 0x1F) * 255 / 31))
+      diff++;
+  }
+  fclose(f);
+  return diff;
+}
+
+static int snap(const opts_t *o, const char *scn, const char *name) {
+  int w = 0, h = 0;
+  // всё, что инвалидировано, должно дойти до панели
+  lv_refr_now(NULL);
+  const uint16_t *fb = host_panel_framebuffer(&w, &h);
+  if (!fb)
+    return -1;
+
+  char path[512];
+  snprintf(path, sizeof(path), "%s/%s_%s.ppm", o->out_dir, scn, name);
+  write_ppm(path, fb, w, h);
+
+  snprintf(path, sizeof(path), "%s/%s_%s.ppm", o->golden_dir, scn, name);
+  if (o->update) {
+    if (write_ppm(path, fb, w, h) != 0) {
+      fprintf(stderr, "%s: cannot write %s\n", scn, path);
+      return -1;
+    }
+    return 0;
+  }
+  long diff = compare_ppm(path, fb, w, h);
+  if (diff < 0) {
+    // эталоны создаёт только --update: без эталона кадр — ошибка
+    fprintf(stderr, "%s: no golden %s (record with --update)\n", scn, path);
+    return -1;
+  }
+  if (diff) {
+    fprintf(stderr, "%s: %s differs from golden in %ld px\n", scn, name, diff);
+    return -1;
+  }
+  return 0;
+}
+
+// ------------------------- сценарий -------------------------
+
+static void scenario_name(const char *path, char *out, size_t n) {
+  const char *b = strrchr(path, '/');
+  b = b ? b + 1 : path;
+  snprintf(out, n, "%s", b);
+  char *dot = strrchr(out, '.');
+  if (dot)
+    *dot = '\0';
+}
+
+// относительный путь в сценарии — от каталога сценария
+static void resolve(const char *scn_path, const char *rel, char *out,
+                    size_t n) {
+  const char *slash = strrchr(scn_path, '/');
+  if (rel[0] == '/' || !slash)
+    snprintf(out, n, "%s", rel);
+  else
+    snprintf(out, n, "%.*s/%s", (int)(slash - scn_path), scn_path, rel);
+}
+
+static int run_scenario(const opts_t *o, const char *path, result_t *r) {
+  FILE *f = fopen(path, "r");
+  if (!f) {
+    fprintf(stderr, "%s: %s\n", path, strerror(errno));
+    return -1;
+  }
+  scenario_name(path, r->name, sizeof(r->name));
+
+  s_frame_ms = calloc(MAX_FRAMES, sizeof(float));
+  if (!s_frame_ms) {
+    fclose(f);
+    return -1;
+  }
+
+  app_main();
+  lv_display_t *disp = lv_display_get_default();
+  lv_display_add_event_cb(disp, disp_event_cb, LV_EVENT_ALL, NULL);
+  run_ms(500); // загрузочный экран и первый кадр меню — не в счёт
+  s_frames = 0;
+  s_flushed_px = 0;
+
+  char line[512];
+  int lineno = 0, err = 0;
+  while (!err && fgets(line, sizeof(line), f)) {
+    lineno++;
+    char cmd[32] = "", arg[400] = "";
+    int n = sscanf(line, "%31s %399[^\n]", cmd, arg);
+    if (n < 1 || cmd[0] == '#')
+      continue;
+
+    if (!strcmp(cmd, "wait")) {
+      run_ms((uint32_t)atoi(arg));
+    } else if (!strcmp(cmd, "rotate")) {
+      int steps = atoi(arg);
+      // по одному щелчку, как с настоящей ручки
+      for (int i = 0; i < abs(steps); i++) {
+        host_knob_rotate(steps > 0 ? 1 : -1);
+        run_ms(40);
+      }
+    } else if (!strcmp(cmd, "press")) {
+      press_enter();
+    } else if (!strcmp(cmd, "esc")) {
+      press_esc(false);
+    } else if (!strcmp(cmd, "esc_long")) {
+      press_esc(true);
+    } else if (!strcmp(cmd, "packets")) {
+      char p[512];
+      resolve(path, arg, p, sizeof(p));
+      err = replay_packets(p);
+    } else if (!strcmp(cmd, "battery")) {
+      int soc = 0, mv = 0, ma = 0, chg = 0;
+      if (sscanf(arg, "%d %d %d %d", &soc, &mv, &ma, &chg) != 4) {
+        err = -1;
+      } else {
+        // в прошивке это делает задача опроса питания
+        host_battery_set(soc, mv, ma, chg != 0);
+        ui_evt_battery_t b = {.pct = (uint8_t)soc, .charging = chg != 0};
+        ui_bus_post(UI_EVT_BATTERY, &b, sizeof(b));
+      }
+    } else if (!strcmp(cmd, "rssi")) {
+      host_cc1101_set_rssi_dbm(atoi(arg));
+    } else if (!strcmp(cmd, "snap")) {
+      if (snap(o, r->name, arg) != 0)
+        r->snaps_failed++;
+    } else {
+      fprintf(stderr, "%s:%d: unknown step '%s'\n", path, lineno, cmd);
+      err = -1;
+    }
+  }
+  fclose(f);
+  run_ms(1500); // хвосты трасс задержки: кадр или таймаут «no redraw»
+  ui_latency_report();
+
+  r->frames = s_frames;
+  r->flushed_px = s_flushed_px;
+  if (s_frames) {
+    double sum = 0;
+    for (uint32_t i = 0; i < s_frames; i++)
+      sum += s_frame_ms[i];
+    qsort(s_frame_ms, s_frames, sizeof(float), cmp_float);
+    r->mean_ms = sum / s_frames;
+    r->p95_ms = s_frame_ms[(s_frames * 95) / 100 < s_frames
+                               ? (s_frames * 95) / 100
+                               : s_frames - 1];
+    r->max_ms = s_frame_ms[s_frames - 1];
+  }
+  const disp_profile_t *prof = disp_profile_active();
+  if (prof && prof->pclk_hz)
+    r->spi_ms = (double)s_flushed_px * 16 * 1000 / prof->pclk_hz;
+  free(s_frame_ms);
+  s_frame_ms = NULL;
+  return err;
+}
+
+// ------------------------- CSV и baseline -------------------------
+
+static const char *CSV_HEADER =
+    "scenario,frames,render_mean_ms,render_p95_ms,render_max_ms,flushed_px,"
+    "spi_est_ms\n";
+
+static void csv_write_row(FILE *f, const result_t *r) {
+  fprintf(f, "%s,%u,%.3f,%.3f,%.3f,%llu,%.1f\n", r->name, r->frames,
+          r->mean_ms, r->p95_ms, r->max_ms, (unsigned long long)r->flushed_px,
+          r->spi_ms);
+}
+
+static bool baseline_find(const char *path, const char *name, result_t *out) {
+  FILE *f = fopen(path, "r");
+  if (!f)
+    return false;
+  char line[512];
+  bool found = false;
+  while (!found && fgets(line, sizeof(line), f)) {
+    result_t b = {0};
+    unsigned long long px = 0;
+    if (sscanf(line, "%63[^,],%u,%lf,%lf,%lf,%llu,%lf", b.name, &b.frames,
+               &b.mean_ms, &b.p95_ms, &b.max_ms, &px, &b.spi_ms) == 7 &&
+        !strcmp(b.name, name)) {
+      b.flushed_px = px;
+      *out = b;
+      found = true;
+    }
+  }
+  fclose(f);
+  return found;
+}
+
+// Пиксели детерминированы — рост сверх допуска всегда регрессия.
+// Время хоста шумит, поэтому сравнивается только среднее.
+static int baseline_check(const opts_t *o, const result_t *r) {
+  result_t b;
+  if (!o->baseline || !baseline_find(o->baseline, r->name, &b))
+    return 0;
+  double k = 1.0 + o->tolerance_pct / 100.0;
+  int bad = 0;
+  if (b.flushed_px && (double)r->flushed_px > (double)b.flushed_px * k) {
+    fprintf(stderr, "%s: flushed px %llu vs baseline %llu\n", r->name,
+            (unsigned long long)r->flushed_px,
+            (unsigned long long)b.flushed_px);
+    bad = 1;
+  }
+  if (b.mean_ms > 0 && r->mean_ms > b.mean_ms * k) {
+    fprintf(stderr, "%s: render mean %.3f ms vs baseline %.3f ms\n", r->name,
+            r->mean_ms, b.mean_ms);
+    bad = 1;
+  }
+  return bad;
+}
+
+// ------------------------- main -------------------------
+
+static void usage(void) {
+  fprintf(stderr, "usage: ui_host [--golden DIR] [--out DIR] [--update] "
+                  "[--csv FILE] [--baseline FILE] [--tolerance PCT] "
+                  "scenario.scn ...\n");
+}
+
+int main(int argc, char **argv) {
+  opts_t o = {
+      .golden_dir = UI_HOST_GOLDEN_DIR,
+      .out_dir = ".",
+      .csv = "ui_host.csv",
+      .tolerance_pct = 25,
+  };
+  const char *scenarios[MAX_SCENARIOS];
+  int nscn = 0;
+
+  for (int i = 1; i < argc; i++) {
+    const char *a = argv[i];
+    bool has_val = i + 1 < argc;
+    if (!strcmp(a, "--update"))
+      o.update = true;
+    else if (!strcmp(a, "--golden") && has_val)
+      o.golden_dir = argv[++i];
+    else if (!strcmp(a, "--out") && has_val)
+      o.out_dir = argv[++i];
+    else if (!strcmp(a, "--csv") && has_val)
+      o.csv = argv[++i];
+    else if (!strcmp(a, "--baseline") && has_val)
+      o.baseline = argv[++i];
+    else if (!strcmp(a, "--tolerance") && has_val)
+      o.tolerance_pct = atoi(argv[++i]);
+    else if (a[0] == '-') {
+      usage();
+      return 2;
+    } else if (nscn < MAX_SCENARIOS)
+      scenarios[nscn++] = a;
+  }
+  if (!nscn) {
+    usage();
+    return 2;
+  }
+
+  // часы статус-бара не должны зависеть от пояса машины
+  setenv("TZ", "UTC0", 1);
+  tzset();
+  mkdir(o.out_dir, 0755);
+  if (o.update)
+    mkdir(o.golden_dir, 0755);
+
+  FILE *csv = fopen(o.csv, "w");
+  if (!csv) {
+    fprintf(stderr, "%s: %s\n", o.csv, strerror(errno));
+    return 2;
+  }
+  fputs(CSV_HEADER, csv);
+  fflush(csv);
+
+  int failed = 0;
+  for (int i = 0; i < nscn; i++) {
+    int fds[2];
+    if (pipe(fds) != 0)
+      return 2;
+    fflush(NULL);
+    pid_t pid = fork();
+    if (pid == 0) {
+      close(fds[0]);
+      result_t r = {0};
+      int err = run_scenario(&o, scenarios[i], &r);
+      if (write(fds[1], &r, sizeof(r)) != (ssize_t)sizeof(r))
+        _exit(3);
+      _exit(err || r.snaps_failed ? 1 : 0);
+    }
+    close(fds[1]);
+    result_t r = {0};
+    ssize_t got = read(fds[0], &r, sizeof(r));
+    close(fds[0]);
+    int st = 0;
+    waitpid(pid, &st, 0);
+    bool ok = WIFEXITED(st) && WEXITSTATUS(st) == 0 &&
+              got == (ssize_t)sizeof(r);
+
+    if (got == (ssize_t)sizeof(r)) {
+      csv_write_row(csv, &r);
+      if (baseline_check(&o, &r))
+        ok = false;
+      printf("%-16s %5u frames  mean %7.3f  p95 %7.3f  max %7.3f ms  "
+             "%9llu px  spi ~%.0f ms  %s\n",
+             r.name, r.frames, r.mean_ms, r.p95_ms, r.max_ms,
+             (unsigned long long)r.flushed_px, r.spi_ms, ok ? "ok" : "FAIL");
+    } else {
+      printf("%-16s crashed\n", scenarios[i]);
+    }
+    if (!ok)
+      failed++;
+  }
+  fclose(csv);
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,195 @@
+// Остальные мелочи ESP-IDF для хостовой сборки: имена ошибок, уровень лога,
+// heap_caps поверх malloc, GPIO без железа.
+#include <stdlib.h>
+
+#include "driver/gpio.h"
+#include "driver/ledc.h"
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+
+const char *esp_err_to_name(esp_err_t code) {
+  switch (code) {
+  case ESP_OK:
+    return "ESP_OK";
+  case ESP_FAIL:
+    return "ESP_FAIL";
+  case ESP_ERR_NO_MEM:
+    return "ESP_ERR_NO_MEM";
+  case ESP_ERR_INVALID_ARG:
+    return "ESP_ERR_INVALID_ARG";
+  case ESP_ERR_INVALID_STATE:
+    return "ESP_ERR_INVALID_STATE";
+  case ESP_ERR_INVALID_SIZE:
+    return "ESP_ERR_INVALID_SIZE";
+  case ESP_ERR_NOT_FOUND:
+    return "ESP_ERR_NOT_FOUND";
+  case ESP_ERR_NOT_SUPPORTED:
+    return "ESP_ERR_NOT_SUPPORTED";
+  case ESP_ERR_TIMEOUT:
+    return "ESP_ERR_TIMEOUT";
+  case ESP_ERR_INVALID_RESPONSE:
+    return "ESP_ERR_INVALID_RESPONSE";
+  case ESP_ERR_INVALID_CRC:
+    return "ESP_ERR_INVALID_CRC";
+  case ESP_ERR_INVALID_VERSION:
+    return "ESP_ERR_INVALID_VERSION";
+  case ESP_ERR_NOT_FINISHED:
+    return "ESP_ERR_NOT_FINISHED";
+  default:
+    return "UNKNOWN ERROR";
+  }
+}
+
+int host_log_level(void) {
+  static int level = -1;
+  if (level < 0) {
+    const char *env = getenv("UI_HOST_LOG");
+    level = env ? atoi(env) : 2;
+  }
+  return level;
+}
+
+// ------------------------- heap_caps -------------------------
+
+void *heap_caps_malloc(size_t size, uint32_t caps) {
+  (void)caps;
+  return malloc(size);
+}
+
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps) {
+  (void)caps;
+  return calloc(n, size);
+}
+
+void heap_caps_free(void *ptr) { free(ptr); }
+
+// кучу хоста не меряем — числа только чтобы логи не падали
+size_t heap_caps_get_free_size(uint32_t caps) {
+  (void)caps;
+  return 256 * 1024;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+  (void)caps;
+  return 128 * 1024;
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps) {
+  (void)caps;
+  return 256 * 1024;
+}
+
+// ------------------------- GPIO -------------------------
+
+static uint8_t s_levels[GPIO_NUM_MAX];
+
+esp_err_t gpio_config(const gpio_config_t *cfg) {
+  return cfg ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio, uint32_t level) {
+  if (gpio < 0 || gpio >= GPIO_NUM_MAX)
+    return ESP_ERR_INVALID_ARG;
+  s_levels[gpio] = level ? 1 : 0;
+  return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio) {
+  if (gpio < 0 || gpio >= GPIO_NUM_MAX)
+    return 0;
+  return s_levels[gpio];
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio) { return gpio_set_level(gpio, 0); }
+
+void esp_rom_delay_us(uint32_t us) { (void)us; }
+
+esp_err_t gpio_install_isr_service(int flags) {
+  (void)flags;
+  return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio, gpio_isr_t isr, void *arg) {
+  (void)gpio;
+  (void)isr;
+  (void)arg;
+  return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio) {
+  (void)gpio;
+  return ESP_OK;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio, gpio_int_type_t type) {
+  (void)type;
+  return (gpio < 0 || gpio >= GPIO_NUM_MAX) ? ESP_ERR_INVALID_ARG : ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t gpio) {
+  return (gpio < 0 || gpio >= GPIO_NUM_MAX) ? ESP_ERR_INVALID_ARG : ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t gpio) {
+  return (gpio < 0 || gpio >= GPIO_NUM_MAX) ? ESP_ERR_INVALID_ARG : ESP_OK;
+}
+
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio, gpio_int_type_t type) {
+  if (type != GPIO_INTR_LOW_LEVEL && type != GPIO_INTR_HIGH_LEVEL)
+    return ESP_ERR_INVALID_ARG;
+  return gpio_set_intr_type(gpio, type);
+}
+
+// ---- LEDC: только запоминаем duty ----
+
+static uint32_t s_ledc_duty[LEDC_CHANNEL_MAX];
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t *cfg) {
+  return cfg ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t *cfg) {
+  if (!cfg || cfg->channel >= LEDC_CHANNEL_MAX)
+    return ESP_ERR_INVALID_ARG;
+  s_ledc_duty[cfg->channel] = cfg->duty;
+  return ESP_OK;
+}
+
+esp_err_t ledc_fade_func_install(int intr_alloc_flags) {
+  (void)intr_alloc_flags;
+  return ESP_OK;
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t mode, ledc_channel_t ch, uint32_t duty) {
+  (void)mode;
+  if (ch >= LEDC_CHANNEL_MAX)
+    return ESP_ERR_INVALID_ARG;
+  s_ledc_duty[ch] = duty;
+  return ESP_OK;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t mode, ledc_channel_t ch) {
+  (void)mode;
+  return ch < LEDC_CHANNEL_MAX ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+// переход мгновенный — время виртуальное
+esp_err_t ledc_set_fade_with_time(ledc_mode_t mode, ledc_channel_t ch,
+                                  uint32_t duty, int ms) {
+  (void)ms;
+  return ledc_set_duty(mode, ch, duty);
+}
+
+esp_err_t ledc_fade_start(ledc_mode_t mode, ledc_channel_t ch,
+                          ledc_fade_mode_t fade_mode) {
+  (void)mode;
+  (void)fade_mode;
+  return ch < LEDC_CHANNEL_MAX ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t ledc_fade_stop(ledc_mode_t mode, ledc_channel_t ch) {
+  (void)mode;
+  return ch < LEDC_CHANNEL_MAX ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
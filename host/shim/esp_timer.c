@@ -0,0 +1,139 @@
+// Виртуальное время хостовой сборки.
+//
+// esp_timer_get_time() и настенные часы (time/gettimeofday/settimeofday,
+// подменяются через -Wl,--wrap) идут только вперёд по host_time_advance_us.
+// Таймеры срабатывают внутри host_time_advance_us в порядке дедлайнов —
+// прогон сценария детерминирован и не зависит от скорости машины.
+#include "esp_timer.h"
+
+#include <stdlib.h>
+#include <sys/time.h>
+#include <time.h>
+
+struct esp_timer {
+  esp_timer_cb_t cb;
+  void *arg;
+  const char *name;
+  int64_t deadline; // < 0 — не взведён
+  uint64_t period;  // 0 — однократный
+  struct esp_timer *next;
+};
+
+static int64_t s_now_us = 0;
+static int64_t s_wall_offset_us = 0; // настенное время = s_now_us + offset
+static struct esp_timer *s_timers = NULL;
+
+int64_t esp_timer_get_time(void) { return s_now_us; }
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args,
+                           esp_timer_handle_t *out) {
+  if (!args || !args->callback || !out)
+    return ESP_ERR_INVALID_ARG;
+  struct esp_timer *t = calloc(1, sizeof(*t));
+  if (!t)
+    return ESP_ERR_NO_MEM;
+  t->cb = args->callback;
+  t->arg = args->arg;
+  t->name = args->name;
+  t->deadline = -1;
+  t->next = s_timers;
+  s_timers = t;
+  *out = t;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeout_us) {
+  if (!t)
+    return ESP_ERR_INVALID_ARG;
+  if (t->deadline >= 0)
+    return ESP_ERR_INVALID_STATE;
+  t->deadline = s_now_us + (int64_t)timeout_us;
+  t->period = 0;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t t, uint64_t period_us) {
+  if (!t || !period_us)
+    return ESP_ERR_INVALID_ARG;
+  if (t->deadline >= 0)
+    return ESP_ERR_INVALID_STATE;
+  t->deadline = s_now_us + (int64_t)period_us;
+  t->period = period_us;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t t) {
+  if (!t)
+    return ESP_ERR_INVALID_ARG;
+  if (t->deadline < 0)
+    return ESP_ERR_INVALID_STATE;
+  t->deadline = -1;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t t) {
+  if (!t)
+    return ESP_ERR_INVALID_ARG;
+  for (struct esp_timer **pp = &s_timers; *pp; pp = &(*pp)->next) {
+    if (*pp == t) {
+      *pp = t->next;
+      free(t);
+      return ESP_OK;
+    }
+  }
+  return ESP_ERR_NOT_FOUND;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t t) { return t && t->deadline >= 0; }
+
+static struct esp_timer *earliest_due(int64_t until) {
+  struct esp_timer *best = NULL;
+  for (struct esp_timer *t = s_timers; t; t = t->next)
+    if (t->deadline >= 0 && t->deadline <= until &&
+        (!best || t->deadline < best->deadline))
+      best = t;
+  return best;
+}
+
+void host_time_advance_us(int64_t us) {
+  if (us < 0)
+    return;
+  int64_t until = s_now_us + us;
+  struct esp_timer *t;
+  while ((t = earliest_due(until)) != NULL) {
+    s_now_us = t->deadline;
+    if (t->period)
+      t->deadline += (int64_t)t->period;
+    else
+      t->deadline = -1;
+    t->cb(t->arg); // колбэк может перевзвести или удалить таймер
+  }
+  s_now_us = until;
+}
+
+// ------------------------- настенные часы -------------------------
+
+int __wrap_gettimeofday(struct timeval *tv, void *tz) {
+  (void)tz;
+  if (tv) {
+    int64_t wall = s_now_us + s_wall_offset_us;
+    tv->tv_sec = (time_t)(wall / 1000000);
+    tv->tv_usec = (suseconds_t)(wall % 1000000);
+  }
+  return 0;
+}
+
+int __wrap_settimeofday(const struct timeval *tv, const void *tz) {
+  (void)tz;
+  if (tv)
+    s_wall_offset_us =
+        (int64_t)tv->tv_sec * 1000000 + tv->tv_usec - s_now_us;
+  return 0;
+}
+
+time_t __wrap_time(time_t *out) {
+  time_t t = (time_t)((s_now_us + s_wall_offset_us) / 1000000);
+  if (out)
+    *out = t;
+  return t;
+}
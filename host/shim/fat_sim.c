@@ -0,0 +1,58 @@
+// FATFS на хосте: каталог в папке сборки (CAPTURE_STORE_BASE_PATH) вместо
+// раздела. Монтирование очищает его — каждый сценарий начинает с пустого
+// раздела, как NVS в nvs_sim.c. Размер раздела — как в partitions.csv.
+#include <dirent.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "esp_vfs_fat.h"
+
+#define FAT_SIM_TOTAL (11ull * 1024 * 1024)
+#define FAT_SIM_CLUSTER 4096ull
+
+static uint64_t dir_used(const char *base, bool wipe) {
+  DIR *dir = opendir(base);
+  if (!dir)
+    return 0;
+  uint64_t used = 0;
+  struct dirent *de;
+  char path[512];
+  while ((de = readdir(dir)) != NULL) {
+    if (de->d_name[0] == '.')
+      continue;
+    snprintf(path, sizeof(path), "%s/%s", base, de->d_name);
+    struct stat st;
+    if (wipe) {
+      unlink(path);
+    } else if (stat(path, &st) == 0) {
+      used += ((uint64_t)st.st_size + FAT_SIM_CLUSTER - 1) / FAT_SIM_CLUSTER *
+              FAT_SIM_CLUSTER;
+    }
+  }
+  closedir(dir);
+  return used;
+}
+
+esp_err_t esp_vfs_fat_spiflash_mount_rw_wl(const char *base_path,
+                                           const char *partition_label,
+                                           const esp_vfs_fat_mount_config_t *cfg,
+                                           wl_handle_t *wl_handle) {
+  (void)partition_label;
+  (void)cfg;
+  mkdir(base_path, 0755);
+  dir_used(base_path, true);
+  if (wl_handle)
+    *wl_handle = 0;
+  return ESP_OK;
+}
+
+esp_err_t esp_vfs_fat_info(const char *base_path, uint64_t *out_total_bytes,
+                           uint64_t *out_free_bytes) {
+  uint64_t used = dir_used(base_path, false);
+  if (out_total_bytes)
+    *out_total_bytes = FAT_SIM_TOTAL;
+  if (out_free_bytes)
+    *out_free_bytes = used < FAT_SIM_TOTAL ? FAT_SIM_TOTAL - used : 0;
+  return ESP_OK;
+}
@@ -0,0 +1,242 @@
+// Однопоточная имитация FreeRTOS для хостовой сборки UI.
+// Задачи регистрируются, но их тела не выполняются: всё, что в прошивке
+// делают фоновые задачи (декодер, шина UI, опрос питания), на хосте
+// вызывает сценарий напрямую. Очереди — кольцевые буферы без ожидания.
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "freertos/timers.h"
+
+struct host_task {
+  const char *name;
+  uint32_t notify;
+};
+
+struct host_queue {
+  uint8_t *buf;
+  UBaseType_t len;
+  UBaseType_t item_size;
+  UBaseType_t head;
+  UBaseType_t count;
+};
+
+struct host_sem {
+  int count;
+  int max;
+};
+
+// «текущая» задача для xTaskGetCurrentTaskHandle и уведомлений
+static struct host_task s_main_task = {.name = "main"};
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name,
+                                   uint32_t stack, void *arg, UBaseType_t prio,
+                                   TaskHandle_t *out, BaseType_t core) {
+  (void)fn;
+  (void)stack;
+  (void)arg;
+  (void)prio;
+  (void)core;
+  struct host_task *t = calloc(1, sizeof(*t));
+  if (!t)
+    return pdFAIL;
+  t->name = name;
+  if (out)
+    *out = t;
+  return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t t) {
+  if (t && t != &s_main_task)
+    free(t);
+}
+
+// задержка в однопоточной модели — просто ход виртуального времени
+void vTaskDelay(TickType_t ticks) {
+  host_time_advance_us((int64_t)ticks * portTICK_PERIOD_MS * 1000);
+}
+
+TickType_t xTaskGetTickCount(void) {
+  return (TickType_t)(esp_timer_get_time() / 1000 / portTICK_PERIOD_MS);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) { return &s_main_task; }
+
+BaseType_t xTaskNotify(TaskHandle_t t, uint32_t value, eNotifyAction action) {
+  if (!t)
+    return pdFAIL;
+  switch (action) {
+  case eSetBits:
+    t->notify |= value;
+    break;
+  case eIncrement:
+    t->notify++;
+    break;
+  case eSetValueWithOverwrite:
+  case eSetValueWithoutOverwrite:
+    t->notify = value;
+    break;
+  default:
+    break;
+  }
+  return pdPASS;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t t, uint32_t value,
+                              eNotifyAction action, BaseType_t *woken) {
+  if (woken)
+    *woken = pdFALSE;
+  return xTaskNotify(t, value, action);
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit,
+                           uint32_t *value, TickType_t wait) {
+  (void)wait;
+  struct host_task *t = &s_main_task;
+  t->notify &= ~clear_on_entry;
+  if (value)
+    *value = t->notify;
+  BaseType_t got = t->notify ? pdTRUE : pdFALSE;
+  t->notify &= ~clear_on_exit;
+  return got;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait) {
+  (void)wait;
+  uint32_t v = s_main_task.notify;
+  if (clear)
+    s_main_task.notify = 0;
+  else if (v)
+    s_main_task.notify--;
+  return v;
+}
+
+// ------------------------- очереди -------------------------
+
+QueueHandle_t xQueueCreate(UBaseType_t len, UBaseType_t item_size) {
+  struct host_queue *q = calloc(1, sizeof(*q));
+  if (!q)
+    return NULL;
+  q->buf = calloc(len, item_size);
+  if (!q->buf) {
+    free(q);
+    return NULL;
+  }
+  q->len = len;
+  q->item_size = item_size;
+  return q;
+}
+
+void vQueueDelete(QueueHandle_t q) {
+  if (!q)
+    return;
+  free(q->buf);
+  free(q);
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t wait) {
+  (void)wait;
+  if (!q || q->count >= q->len)
+    return pdFAIL;
+  UBaseType_t tail = (q->head + q->count) % q->len;
+  memcpy(q->buf + (size_t)tail * q->item_size, item, q->item_size);
+  q->count++;
+  return pdPASS;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t q, const void *item,
+                             BaseType_t *woken) {
+  if (woken)
+    *woken = pdFALSE;
+  return xQueueSend(q, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t wait) {
+  (void)wait;
+  if (!q || !q->count)
+    return pdFAIL;
+  memcpy(item, q->buf + (size_t)q->head * q->item_size, q->item_size);
+  q->head = (q->head + 1) % q->len;
+  q->count--;
+  return pdPASS;
+}
+
+BaseType_t xQueueReset(QueueHandle_t q) {
+  if (q) {
+    q->head = 0;
+    q->count = 0;
+  }
+  return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+  return q ? q->count : 0;
+}
+
+// ------------------------- семафоры -------------------------
+
+static SemaphoreHandle_t sem_new(int count, int max) {
+  struct host_sem *s = calloc(1, sizeof(*s));
+  if (s) {
+    s->count = count;
+    s->max = max;
+  }
+  return s;
+}
+
+// мьютекс в одном потоке не может быть занят другим — разрешаем вложенность
+SemaphoreHandle_t xSemaphoreCreateMutex(void) { return sem_new(1, 0); }
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void) { return sem_new(1, 0); }
+SemaphoreHandle_t xSemaphoreCreateBinary(void) { return sem_new(0, 1); }
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial) {
+  return sem_new((int)initial, (int)max);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t wait) {
+  (void)wait;
+  if (!s)
+    return pdFAIL;
+  if (s->max == 0)
+    return pdPASS;
+  if (s->count <= 0)
+    return pdFAIL;
+  s->count--;
+  return pdPASS;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s) {
+  if (!s)
+    return pdFAIL;
+  if (s->max && s->count < s->max)
+    s->count++;
+  return pdPASS;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t s, BaseType_t *woken) {
+  if (woken)
+    *woken = pdFALSE;
+  return xSemaphoreGive(s);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t s) { free(s); }
+
+// ---- отложенные вызовы ----
+
+BaseType_t xTimerPendFunctionCall(PendedFunction_t fn, void *arg1,
+                                  uint32_t arg2, TickType_t wait) {
+  (void)wait;
+  fn(arg1, arg2);
+  return pdPASS;
+}
+
+BaseType_t xTimerPendFunctionCallFromISR(PendedFunction_t fn, void *arg1,
+                                         uint32_t arg2, BaseType_t *woken) {
+  if (woken)
+    *woken = pdFALSE;
+  fn(arg1, arg2);
+  return pdPASS;
+}
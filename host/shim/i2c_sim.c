@@ -0,0 +1,224 @@
+// I2C на хосте: шина с двумя моделями регистров — BQ27220 (0x55,
+// 16-битные стандартные команды, little-endian) и BQ25896 (0x6B, 8 бит).
+// Значения задаёт сценарий через host_battery_set; записи прошивки
+// просто сохраняются. Устройства по другим адресам не отвечают (NACK).
+// У гейджа ещё модель доступа к памяти данных: ключи UNSEAL, CONFIG
+// UPDATE и блок MAC с суммой для пары параметров (умолчания чипа).
+#include <stdlib.h>
+#include <string.h>
+
+#include "driver/i2c_master.h"
+#include "host_hooks.h"
+
+#define GAUGE_ADDR 0x55
+#define CHARGER_ADDR 0x6B
+
+struct i2c_master_bus_t {
+  int unused;
+};
+
+struct i2c_master_dev_t {
+  uint16_t addr;
+  uint8_t *regs;
+  size_t nregs;
+};
+
+static uint8_t s_gauge[0x80];
+static uint8_t s_charger[0x15];
+
+static void gauge_put16(uint8_t reg, int v) {
+  s_gauge[reg] = (uint8_t)(v & 0xFF);
+  s_gauge[reg + 1] = (uint8_t)((v >> 8) & 0xFF);
+}
+
+// ---- память данных гейджа ----
+
+#define OPST_INITCOMP 0x0020
+#define OPST_SEC_SEALED 0x0006
+#define OPST_SEC_UNSEALED 0x0004
+#define OPST_CFGUPDATE 0x0400
+
+static struct {
+  uint16_t addr;
+  uint8_t val[2]; // big-endian, как в чипе
+} s_dm[] = {
+    {0x929F, {0x0B, 0xB8}}, // DesignCapacity 3000 мАч
+    {0x92A1, {0x2B, 0x5C}}, // DesignEnergy 11100 мВт·ч
+};
+static uint16_t s_opst = OPST_INITCOMP | OPST_SEC_SEALED;
+static uint16_t s_last_key = 0;
+
+static int dm_find(uint16_t addr) {
+  for (size_t i = 0; i < sizeof(s_dm) / sizeof(s_dm[0]); i++)
+    if (s_dm[i].addr == addr)
+      return (int)i;
+  return -1;
+}
+
+static uint8_t dm_sum(const uint8_t *p, size_t n) {
+  uint8_t sum = 0;
+  for (size_t i = 0; i < n; i++)
+    sum += p[i];
+  return (uint8_t)(0xFF - sum);
+}
+
+static void gauge_control(uint16_t cmd) {
+  uint16_t sec = s_opst & OPST_SEC_SEALED;
+  if (cmd == 0x3672 && s_last_key == 0x0414 && sec == OPST_SEC_SEALED)
+    s_opst = (uint16_t)((s_opst & ~OPST_SEC_SEALED) | OPST_SEC_UNSEALED);
+  else if (cmd == 0x0030)
+    s_opst |= OPST_SEC_SEALED;
+  else if (cmd == 0x0090 && sec != OPST_SEC_SEALED)
+    s_opst |= OPST_CFGUPDATE;
+  else if (cmd == 0x0091 || cmd == 0x0092)
+    s_opst &= (uint16_t)~OPST_CFGUPDATE;
+  s_last_key = cmd;
+}
+
+// Выбор адреса: блок MACData, сумма и длина, как их отдаёт чип
+static void gauge_mac_select(uint16_t addr) {
+  memset(&s_gauge[0x40], 0, 32);
+  int i = dm_find(addr);
+  if (i >= 0)
+    memcpy(&s_gauge[0x40], s_dm[i].val, 2);
+  s_gauge[0x60] = dm_sum(&s_gauge[0x3E], 2 + 32);
+  s_gauge[0x61] = 32 + 4;
+}
+
+// Сумма и длина записаны: данные из 0x40 — в память, если всё сходится
+static void gauge_mac_commit(void) {
+  uint8_t len = s_gauge[0x61];
+  if (len < 4 || len > 36 || !(s_opst & OPST_CFGUPDATE))
+    return;
+  if (dm_sum(&s_gauge[0x3E], len - 2) != s_gauge[0x60])
+    return;
+  int i = dm_find((uint16_t)(s_gauge[0x3E] | (s_gauge[0x3F] << 8)));
+  if (i >= 0 && len >= 6)
+    memcpy(s_dm[i].val, &s_gauge[0x40], 2);
+}
+
+static void gauge_after_write(uint8_t reg, size_t n) {
+  if (reg == 0x00 && n >= 2)
+    gauge_control((uint16_t)(s_gauge[0x00] | (s_gauge[0x01] << 8)));
+  else if (reg == 0x3E && n == 2)
+    gauge_mac_select((uint16_t)(s_gauge[0x3E] | (s_gauge[0x3F] << 8)));
+  else if (reg == 0x60 && n >= 2)
+    gauge_mac_commit();
+  gauge_put16(0x3A, s_opst); // OperationStatus
+}
+
+void host_battery_set(int soc, int mv, int ma, bool charging) {
+  gauge_put16(0x2C, soc); // StateOfCharge
+  gauge_put16(0x08, mv);  // Voltage
+  gauge_put16(0x0C, ma);  // Current, со знаком
+  gauge_put16(0x14, ma);  // AverageCurrent
+  // REG0B: CHRG_STAT[4:3] = fast charge, PG_STAT[2]
+  s_charger[0x0B] = charging ? (uint8_t)((2 << 3) | (1 << 2)) : 0;
+  // REG0E: BATV = 2304 + 20 мВ * n
+  int n = (mv - 2304) / 20;
+  s_charger[0x0E] = (uint8_t)(n < 0 ? 0 : n > 127 ? 127 : n);
+  // REG12: ICHGR = 50 мА * n
+  int ichg = charging && ma > 0 ? ma / 50 : 0;
+  s_charger[0x12] = (uint8_t)(ichg > 127 ? 127 : ichg);
+}
+
+esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t *cfg,
+                             i2c_master_bus_handle_t *out) {
+  if (!cfg || !out)
+    return ESP_ERR_INVALID_ARG;
+  static struct i2c_master_bus_t bus;
+  static bool defaults = false;
+  if (!defaults) {
+    host_battery_set(80, 3950, -120, false);
+    gauge_put16(0x3A, s_opst);
+    defaults = true;
+  }
+  *out = &bus;
+  return ESP_OK;
+}
+
+esp_err_t i2c_del_master_bus(i2c_master_bus_handle_t bus) {
+  return bus ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus,
+                                    const i2c_device_config_t *cfg,
+                                    i2c_master_dev_handle_t *out) {
+  if (!bus || !cfg || !out)
+    return ESP_ERR_INVALID_ARG;
+  struct i2c_master_dev_t *d = calloc(1, sizeof(*d));
+  if (!d)
+    return ESP_ERR_NO_MEM;
+  d->addr = cfg->device_address;
+  if (d->addr == GAUGE_ADDR) {
+    d->regs = s_gauge;
+    d->nregs = sizeof(s_gauge);
+  } else if (d->addr == CHARGER_ADDR) {
+    d->regs = s_charger;
+    d->nregs = sizeof(s_charger);
+  }
+  *out = d;
+  return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_rm_device(i2c_master_dev_handle_t dev) {
+  free(dev);
+  return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_reset(i2c_master_bus_handle_t bus) {
+  return bus ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t i2c_master_probe(i2c_master_bus_handle_t bus, uint16_t addr,
+                           int timeout_ms) {
+  (void)timeout_ms;
+  if (!bus)
+    return ESP_ERR_INVALID_ARG;
+  return addr == GAUGE_ADDR || addr == CHARGER_ADDR ? ESP_OK
+                                                    : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t dev, const uint8_t *tx,
+                              size_t tx_len, int timeout_ms) {
+  (void)timeout_ms;
+  if (!dev || !tx || !tx_len)
+    return ESP_ERR_INVALID_ARG;
+  if (!dev->regs)
+    return ESP_FAIL;
+  for (size_t i = 1; i < tx_len; i++) {
+    size_t r = tx[0] + i - 1;
+    if (r < dev->nregs)
+      dev->regs[r] = tx[i];
+  }
+  if (dev->regs == s_gauge)
+    gauge_after_write(tx[0], tx_len - 1);
+  return ESP_OK;
+}
+
+esp_err_t i2c_master_receive(i2c_master_dev_handle_t dev, uint8_t *rx,
+                             size_t rx_len, int timeout_ms) {
+  (void)timeout_ms;
+  if (!dev || !rx)
+    return ESP_ERR_INVALID_ARG;
+  if (!dev->regs)
+    return ESP_FAIL;
+  memset(rx, 0, rx_len);
+  return ESP_OK;
+}
+
+esp_err_t i2c_master_transmit_receive(i2c_master_dev_handle_t dev,
+                                      const uint8_t *tx, size_t tx_len,
+                                      uint8_t *rx, size_t rx_len,
+                                      int timeout_ms) {
+  (void)timeout_ms;
+  if (!dev || !tx || !tx_len || !rx)
+    return ESP_ERR_INVALID_ARG;
+  if (!dev->regs)
+    return ESP_FAIL;
+  for (size_t i = 0; i < rx_len; i++) {
+    size_t r = tx[0] + i;
+    rx[i] = r < dev->nregs ? dev->regs[r] : 0;
+  }
+  return ESP_OK;
+}
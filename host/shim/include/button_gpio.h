@@ -0,0 +1,20 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "iot_button.h"
+
+typedef struct {
+  int32_t gpio_num;
+  uint8_t active_level;
+  bool enable_power_save;
+  bool disable_pull;
+} button_gpio_config_t;
+
+esp_err_t iot_button_new_gpio_device(const button_config_t *cfg,
+                                     const button_gpio_config_t *gpio_cfg,
+                                     button_handle_t *out);
+
+// --- только для хоста: состояние кнопки для энкодера LVGL ---
+bool host_button_is_pressed(button_handle_t btn);
+void host_button_set_pressed(int gpio_num, bool pressed);
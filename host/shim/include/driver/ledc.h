@@ -0,0 +1,58 @@
+#pragma once
+#include <stdint.h>
+
+#include "driver/gpio.h"
+#include "esp_err.h"
+
+typedef enum { LEDC_LOW_SPEED_MODE = 0, LEDC_SPEED_MODE_MAX } ledc_mode_t;
+typedef enum {
+  LEDC_TIMER_0 = 0, LEDC_TIMER_1, LEDC_TIMER_2, LEDC_TIMER_3, LEDC_TIMER_MAX
+} ledc_timer_t;
+typedef enum {
+  LEDC_CHANNEL_0 = 0, LEDC_CHANNEL_1, LEDC_CHANNEL_2, LEDC_CHANNEL_3,
+  LEDC_CHANNEL_4, LEDC_CHANNEL_5, LEDC_CHANNEL_6, LEDC_CHANNEL_7,
+  LEDC_CHANNEL_MAX
+} ledc_channel_t;
+typedef enum {
+  LEDC_TIMER_1_BIT = 1, LEDC_TIMER_8_BIT = 8, LEDC_TIMER_9_BIT = 9,
+  LEDC_TIMER_10_BIT = 10,
+  LEDC_TIMER_12_BIT = 12, LEDC_TIMER_14_BIT = 14
+} ledc_timer_bit_t;
+typedef enum { LEDC_AUTO_CLK = 0, LEDC_USE_RC_FAST_CLK } ledc_clk_cfg_t;
+typedef enum {
+  LEDC_SLEEP_MODE_NO_ALIVE_NO_PD = 0,
+  LEDC_SLEEP_MODE_NO_ALIVE_ALLOW_PD,
+  LEDC_SLEEP_MODE_KEEP_ALIVE,
+} ledc_sleep_mode_t;
+typedef enum { LEDC_INTR_DISABLE = 0, LEDC_INTR_FADE_END } ledc_intr_type_t;
+typedef enum { LEDC_FADE_NO_WAIT = 0, LEDC_FADE_WAIT_DONE } ledc_fade_mode_t;
+
+typedef struct {
+  ledc_mode_t speed_mode;
+  ledc_timer_bit_t duty_resolution;
+  ledc_timer_t timer_num;
+  uint32_t freq_hz;
+  ledc_clk_cfg_t clk_cfg;
+} ledc_timer_config_t;
+
+typedef struct {
+  int gpio_num;
+  ledc_mode_t speed_mode;
+  ledc_channel_t channel;
+  ledc_intr_type_t intr_type;
+  ledc_timer_t timer_sel;
+  uint32_t duty;
+  int hpoint;
+  ledc_sleep_mode_t sleep_mode;
+} ledc_channel_config_t;
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t *cfg);
+esp_err_t ledc_channel_config(const ledc_channel_config_t *cfg);
+esp_err_t ledc_fade_func_install(int intr_alloc_flags);
+esp_err_t ledc_set_duty(ledc_mode_t mode, ledc_channel_t ch, uint32_t duty);
+esp_err_t ledc_update_duty(ledc_mode_t mode, ledc_channel_t ch);
+esp_err_t ledc_set_fade_with_time(ledc_mode_t mode, ledc_channel_t ch,
+                                  uint32_t duty, int ms);
+esp_err_t ledc_fade_start(ledc_mode_t mode, ledc_channel_t ch,
+                          ledc_fade_mode_t fade_mode);
+esp_err_t ledc_fade_stop(ledc_mode_t mode, ledc_channel_t ch);
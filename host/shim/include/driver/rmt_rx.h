@@ -0,0 +1,16 @@
+#pragma once
+// На хосте декодер заменён воспроизведением записанных пакетов,
+// от RMT нужны только типы из decoder.h
+#include <stdint.h>
+
+typedef struct rmt_channel_t *rmt_channel_handle_t;
+
+typedef union {
+  struct {
+    uint16_t duration0 : 15;
+    uint16_t level0 : 1;
+    uint16_t duration1 : 15;
+    uint16_t level1 : 1;
+  };
+  uint32_t val;
+} rmt_symbol_word_t;
@@ -0,0 +1,18 @@
+#pragma once
+#include "esp_err.h"
+#include "esp_lcd_types.h"
+
+typedef struct {
+  int reset_gpio_num;
+  lcd_rgb_element_order_t rgb_ele_order;
+  int data_endian;
+  uint32_t bits_per_pixel;
+  struct {
+    unsigned int reset_active_high : 1;
+  } flags;
+  void *vendor_config;
+} esp_lcd_panel_dev_config_t;
+
+esp_err_t esp_lcd_new_panel_st7789(esp_lcd_panel_io_handle_t io,
+                                   const esp_lcd_panel_dev_config_t *cfg,
+                                   esp_lcd_panel_handle_t *out);
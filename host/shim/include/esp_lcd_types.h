@@ -0,0 +1,11 @@
+#pragma once
+#include <stdint.h>
+
+typedef struct esp_lcd_panel_io_t *esp_lcd_panel_io_handle_t;
+typedef struct esp_lcd_panel_t *esp_lcd_panel_handle_t;
+typedef int esp_lcd_spi_bus_handle_t;
+
+typedef enum {
+  LCD_RGB_ELEMENT_ORDER_RGB = 0,
+  LCD_RGB_ELEMENT_ORDER_BGR,
+} lcd_rgb_element_order_t;
@@ -0,0 +1,18 @@
+#pragma once
+#include <stdio.h>
+
+// На хосте лог идёт в stderr, уровень — переменная окружения UI_HOST_LOG
+// (0 — тихо, 1 — E, 2 — W, 3 — I, 4 — D; по умолчанию 2)
+int host_log_level(void);
+
+#define HOST_LOG_(lvl, ch, tag, fmt, ...)                                      \
+  do {                                                                         \
+    if (host_log_level() >= (lvl))                                             \
+      fprintf(stderr, ch " (%s) " fmt "\n", tag, ##__VA_ARGS__);               \
+  } while (0)
+
+#define ESP_LOGE(tag, fmt, ...) HOST_LOG_(1, "E", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) HOST_LOG_(2, "W", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) HOST_LOG_(3, "I", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) HOST_LOG_(4, "D", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) HOST_LOG_(5, "V", tag, fmt, ##__VA_ARGS__)
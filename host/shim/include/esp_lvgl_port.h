@@ -0,0 +1,81 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "button_gpio.h"
+#include "esp_err.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_ops.h"
+#include "iot_button.h"
+#include "knob.h"
+#include "lvgl.h"
+
+// Хостовая замена esp_lvgl_port: без своей задачи (lv_timer_handler
+// крутит сценарий), дисплей пишет в кадровый буфер панели-заглушки,
+// энкодер читает состояние, которое выставляет сценарий.
+
+typedef struct {
+  int task_priority;
+  int task_stack;
+  int task_affinity;
+  int task_max_sleep_ms;
+  unsigned int task_stack_caps;
+  int timer_period_ms;
+} lvgl_port_cfg_t;
+
+typedef struct {
+  bool swap_xy;
+  bool mirror_x;
+  bool mirror_y;
+} lvgl_port_rotation_cfg_t;
+
+typedef struct {
+  esp_lcd_panel_io_handle_t io_handle;
+  esp_lcd_panel_handle_t panel_handle;
+  esp_lcd_panel_handle_t control_handle;
+  uint32_t buffer_size;
+  bool double_buffer;
+  uint32_t trans_size;
+  uint32_t hres;
+  uint32_t vres;
+  bool monochrome;
+  lvgl_port_rotation_cfg_t rotation;
+  lv_color_format_t color_format;
+  struct {
+    unsigned int buff_dma : 1;
+    unsigned int buff_spiram : 1;
+    unsigned int sw_rotate : 1;
+    unsigned int swap_bytes : 1;
+    unsigned int full_refresh : 1;
+    unsigned int direct_mode : 1;
+  } flags;
+} lvgl_port_display_cfg_t;
+
+typedef struct {
+  lv_display_t *disp;
+  const knob_config_t *encoder_a_b;
+  button_handle_t encoder_enter;
+} lvgl_port_encoder_cfg_t;
+
+typedef enum {
+  LVGL_PORT_EVENT_DISPLAY = 0x01,
+  LVGL_PORT_EVENT_TOUCH = 0x02,
+  LVGL_PORT_EVENT_USER = 0x80,
+} lvgl_port_event_type_t;
+
+esp_err_t lvgl_port_init(const lvgl_port_cfg_t *cfg);
+esp_err_t lvgl_port_deinit(void);
+lv_display_t *lvgl_port_add_disp(const lvgl_port_display_cfg_t *cfg);
+lv_indev_t *lvgl_port_add_encoder(const lvgl_port_encoder_cfg_t *cfg);
+bool lvgl_port_lock(uint32_t timeout_ms);
+void lvgl_port_unlock(void);
+esp_err_t lvgl_port_task_wake(lvgl_port_event_type_t event, void *param);
+esp_err_t lvgl_port_stop(void);
+esp_err_t lvgl_port_resume(void);
+
+// --- только для хоста ---
+void host_knob_rotate(int steps);
+// false между lvgl_port_stop и lvgl_port_resume
+bool host_lvgl_running(void);
+// Кадровый буфер панели (RGB565, hres x vres после поворота)
+const uint16_t *host_panel_framebuffer(int *w, int *h);
@@ -0,0 +1,57 @@
+#pragma once
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "esp_err.h"
+
+// Хост: как прошивка с выключенным CONFIG_PM_ENABLE — блокировок нет,
+// частота не меняется, вызывающий работает без них.
+
+typedef enum {
+  ESP_PM_CPU_FREQ_MAX,
+  ESP_PM_APB_FREQ_MAX,
+  ESP_PM_NO_LIGHT_SLEEP,
+} esp_pm_lock_type_t;
+
+typedef struct esp_pm_lock *esp_pm_lock_handle_t;
+
+typedef struct {
+  int max_freq_mhz;
+  int min_freq_mhz;
+  bool light_sleep_enable;
+} esp_pm_config_t;
+
+static inline esp_err_t esp_pm_configure(const void *config) {
+  (void)config;
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+static inline esp_err_t esp_pm_lock_create(esp_pm_lock_type_t type, int arg,
+                                           const char *name,
+                                           esp_pm_lock_handle_t *out) {
+  (void)type;
+  (void)arg;
+  (void)name;
+  *out = NULL;
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+static inline esp_err_t esp_pm_lock_delete(esp_pm_lock_handle_t h) {
+  (void)h;
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+static inline esp_err_t esp_pm_lock_acquire(esp_pm_lock_handle_t h) {
+  (void)h;
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+static inline esp_err_t esp_pm_lock_release(esp_pm_lock_handle_t h) {
+  (void)h;
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+static inline esp_err_t esp_pm_dump_locks(FILE *stream) {
+  (void)stream;
+  return ESP_ERR_NOT_SUPPORTED;
+}
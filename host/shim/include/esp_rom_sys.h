@@ -0,0 +1,5 @@
+#pragma once
+#include <stdint.h>
+
+// Виртуальное время хоста не идёт от задержек в микросекундах
+void esp_rom_delay_us(uint32_t us);
@@ -0,0 +1,9 @@
+#pragma once
+#include <stdint.h>
+
+#include "esp_timer.h"
+
+// RTC-таймер на хосте — то же виртуальное время (deep sleep нет)
+static inline uint64_t esp_rtc_get_time_us(void) {
+  return (uint64_t)esp_timer_get_time();
+}
@@ -0,0 +1,5 @@
+#pragma once
+#include "esp_err.h"
+
+// Хост не спит: источники пробуждения только принимаются
+static inline esp_err_t esp_sleep_enable_gpio_wakeup(void) { return ESP_OK; }
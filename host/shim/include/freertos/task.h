@@ -0,0 +1,32 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+typedef enum {
+  eNoAction = 0,
+  eSetBits,
+  eIncrement,
+  eSetValueWithOverwrite,
+  eSetValueWithoutOverwrite,
+} eNotifyAction;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name,
+                                   uint32_t stack, void *arg, UBaseType_t prio,
+                                   TaskHandle_t *out, BaseType_t core);
+#define xTaskCreate(fn, name, stack, arg, prio, out)                           \
+  xTaskCreatePinnedToCore(fn, name, stack, arg, prio, out, tskNO_AFFINITY)
+
+void vTaskDelete(TaskHandle_t t);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+BaseType_t xTaskNotify(TaskHandle_t t, uint32_t value, eNotifyAction action);
+BaseType_t xTaskNotifyFromISR(TaskHandle_t t, uint32_t value,
+                              eNotifyAction action, BaseType_t *woken);
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit,
+                           uint32_t *value, TickType_t wait);
+#define xTaskNotifyGive(t) xTaskNotify((t), 0, eIncrement)
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait);
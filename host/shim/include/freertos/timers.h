@@ -0,0 +1,10 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+// Отложенный вызов «в задаче таймеров» — на хосте выполняется сразу
+typedef void (*PendedFunction_t)(void *arg1, uint32_t arg2);
+
+BaseType_t xTimerPendFunctionCall(PendedFunction_t fn, void *arg1,
+                                  uint32_t arg2, TickType_t wait);
+BaseType_t xTimerPendFunctionCallFromISR(PendedFunction_t fn, void *arg1,
+                                         uint32_t arg2, BaseType_t *woken);
@@ -0,0 +1,18 @@
+#pragma once
+// Управление симуляцией из сценария (только хостовая сборка).
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "decoder.h"
+
+// CC1101 (shim/spi_cc1101_sim.c)
+void host_cc1101_set_rssi_dbm(int dbm);
+void host_cc1101_set_freqest(int8_t v);
+uint32_t host_cc1101_reg_writes(void);
+
+// BQ27220 + BQ25896 (shim/i2c_sim.c): регистры, которые читает прошивка
+void host_battery_set(int soc, int mv, int ma, bool charging);
+
+// Декодер (stubs/decoder_host.c): пакет проходит тем же путём, что и с
+// RMT — burst_cb радио, затем общий поток. Без rf_start_rx пакет теряется.
+bool host_decoder_replay(const packet_t *pkt);
@@ -0,0 +1,41 @@
+#pragma once
+#include <stdint.h>
+
+#include "esp_err.h"
+
+// Кнопки на хосте нажимает сценарий (host_button_emit)
+
+typedef struct button_dev_t *button_handle_t;
+typedef void (*button_cb_t)(void *button_handle, void *usr_data);
+
+typedef enum {
+  BUTTON_PRESS_DOWN = 0,
+  BUTTON_PRESS_UP,
+  BUTTON_PRESS_REPEAT,
+  BUTTON_PRESS_REPEAT_DONE,
+  BUTTON_SINGLE_CLICK,
+  BUTTON_DOUBLE_CLICK,
+  BUTTON_MULTIPLE_CLICK,
+  BUTTON_LONG_PRESS_START,
+  BUTTON_LONG_PRESS_HOLD,
+  BUTTON_LONG_PRESS_UP,
+  BUTTON_PRESS_END,
+  BUTTON_EVENT_MAX,
+  BUTTON_NONE_PRESS,
+} button_event_t;
+
+// в прошивке используется как «событие» с аргументом времени
+#define BUTTON_LONG_PRESS_TIME_MS BUTTON_LONG_PRESS_HOLD
+
+typedef struct {
+  uint16_t long_press_time;
+  uint16_t short_press_time;
+} button_config_t;
+
+esp_err_t iot_button_register_cb(button_handle_t btn, int event,
+                                 void *event_args, button_cb_t cb,
+                                 void *usr_data);
+esp_err_t iot_button_delete(button_handle_t btn);
+
+// --- только для хоста ---
+void host_button_emit(int gpio_num, int event);
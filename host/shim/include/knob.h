@@ -0,0 +1,10 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+  uint8_t default_direction;
+  uint8_t gpio_encoder_a;
+  uint8_t gpio_encoder_b;
+  bool enable_power_save;
+} knob_config_t;
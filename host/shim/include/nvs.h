@@ -0,0 +1,24 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "nvs_flash.h"
+
+typedef uint32_t nvs_handle_t;
+
+typedef enum {
+  NVS_READONLY,
+  NVS_READWRITE,
+} nvs_open_mode_t;
+
+esp_err_t nvs_open(const char *ns, nvs_open_mode_t mode, nvs_handle_t *out);
+void nvs_close(nvs_handle_t h);
+esp_err_t nvs_commit(nvs_handle_t h);
+
+esp_err_t nvs_set_i32(nvs_handle_t h, const char *key, int32_t v);
+esp_err_t nvs_set_u32(nvs_handle_t h, const char *key, uint32_t v);
+esp_err_t nvs_set_i64(nvs_handle_t h, const char *key, int64_t v);
+esp_err_t nvs_get_i32(nvs_handle_t h, const char *key, int32_t *out);
+esp_err_t nvs_get_u32(nvs_handle_t h, const char *key, uint32_t *out);
+esp_err_t nvs_get_i64(nvs_handle_t h, const char *key, int64_t *out);
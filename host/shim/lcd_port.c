@@ -0,0 +1,392 @@
+// Хостовые esp_lcd, iot_button/knob и esp_lvgl_port.
+//
+// Панель — кадровый буфер RGB565 в логической ориентации (hres x vres
+// дисплея LVGL), draw_bitmap копирует в него прямоугольник. Порт LVGL не
+// заводит своей задачи: lv_timer_handler вызывает сценарий, lvgl_port_lock
+// всегда успешен. Энкодер читает шаги и состояние кнопки, которые выставляет
+// сценарий через host_knob_rotate / host_button_set_pressed.
+#include <stdlib.h>
+#include <string.h>
+
+#include "driver/spi_master.h"
+
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_ops.h"
+#include "esp_lcd_panel_vendor.h"
+#include "esp_log.h"
+#include "esp_lvgl_port.h"
+
+static const char *TAG = "host_lcd";
+
+#define HOST_MAX_BUTTONS 4
+
+// ------------------------- панель -------------------------
+
+struct esp_lcd_panel_io_t {
+  unsigned int pclk_hz;
+};
+
+struct esp_lcd_panel_t {
+  int w, h;
+  uint16_t *fb;
+  bool on;
+};
+
+static struct esp_lcd_panel_t *s_panel = NULL;
+
+esp_err_t esp_lcd_new_panel_io_spi(esp_lcd_spi_bus_handle_t bus,
+                                   const esp_lcd_panel_io_spi_config_t *cfg,
+                                   esp_lcd_panel_io_handle_t *out) {
+  (void)bus;
+  if (!cfg || !out)
+    return ESP_ERR_INVALID_ARG;
+  struct esp_lcd_panel_io_t *io = calloc(1, sizeof(*io));
+  if (!io)
+    return ESP_ERR_NO_MEM;
+  io->pclk_hz = cfg->pclk_hz;
+  *out = io;
+  return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_tx_param(esp_lcd_panel_io_handle_t io, int cmd,
+                                    const void *param, size_t size) {
+  (void)cmd;
+  (void)param;
+  (void)size;
+  return io ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_lcd_panel_io_register_event_callbacks(
+    esp_lcd_panel_io_handle_t io, const esp_lcd_panel_io_callbacks_t *cbs,
+    void *user_ctx) {
+  (void)user_ctx;
+  if (!io || !cbs)
+    return ESP_ERR_INVALID_ARG;
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_lcd_new_panel_st7789(esp_lcd_panel_io_handle_t io,
+                                   const esp_lcd_panel_dev_config_t *cfg,
+                                   esp_lcd_panel_handle_t *out) {
+  if (!io || !cfg || !out)
+    return ESP_ERR_INVALID_ARG;
+  struct esp_lcd_panel_t *p = calloc(1, sizeof(*p));
+  if (!p)
+    return ESP_ERR_NO_MEM;
+  s_panel = p;
+  *out = p;
+  return ESP_OK;
+}
+
+// размер буфера становится известен в lvgl_port_add_disp (после поворота)
+static esp_err_t panel_alloc(struct esp_lcd_panel_t *p, int w, int h) {
+  if (p->fb && p->w == w && p->h == h)
+    return ESP_OK;
+  free(p->fb);
+  p->fb = calloc((size_t)w * h, sizeof(uint16_t));
+  if (!p->fb)
+    return ESP_ERR_NO_MEM;
+  p->w = w;
+  p->h = h;
+  return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_reset(esp_lcd_panel_handle_t panel) {
+  return panel ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_lcd_panel_init(esp_lcd_panel_handle_t panel) {
+  return panel ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_lcd_panel_del(esp_lcd_panel_handle_t panel) {
+  if (!panel)
+    return ESP_ERR_INVALID_ARG;
+  if (panel == s_panel)
+    s_panel = NULL;
+  free(panel->fb);
+  free(panel);
+  return ESP_OK;
+}
+
+// x_end/y_end — не включительно, как в esp_lcd
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start,
+                                    int y_start, int x_end, int y_end,
+                                    const void *color_data) {
+  if (!panel || !color_data)
+    return ESP_ERR_INVALID_ARG;
+  if (!panel->fb)
+    return ESP_OK;
+  const uint16_t *src = color_data;
+  int w = x_end - x_start;
+  for (int y = y_start; y < y_end; y++, src += w) {
+    if (y < 0 || y >= panel->h)
+      continue;
+    int x0 = x_start < 0 ? 0 : x_start;
+    int x1 = x_end > panel->w ? panel->w : x_end;
+    if (x1 > x0)
+      memcpy(&panel->fb[(size_t)y * panel->w + x0], &src[x0 - x_start],
+             (size_t)(x1 - x0) * sizeof(uint16_t));
+  }
+  return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_invert_color(esp_lcd_panel_handle_t panel, bool on) {
+  (void)on;
+  return panel ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_lcd_panel_set_gap(esp_lcd_panel_handle_t panel, int x_gap,
+                                int y_gap) {
+  (void)x_gap;
+  (void)y_gap;
+  return panel ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_lcd_panel_disp_on_off(esp_lcd_panel_handle_t panel, bool on) {
+  if (!panel)
+    return ESP_ERR_INVALID_ARG;
+  panel->on = on;
+  return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_disp_sleep(esp_lcd_panel_handle_t panel, bool sleep) {
+  (void)sleep;
+  return panel ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+const uint16_t *host_panel_framebuffer(int *w, int *h) {
+  if (!s_panel || !s_panel->fb)
+    return NULL;
+  if (w)
+    *w = s_panel->w;
+  if (h)
+    *h = s_panel->h;
+  return s_panel->fb;
+}
+
+// ------------------------- SPI шина -------------------------
+
+esp_err_t spi_bus_initialize(spi_host_device_t host,
+                             const spi_bus_config_t *cfg, int dma_chan) {
+  (void)host;
+  (void)dma_chan;
+  return cfg ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+// ------------------------- кнопки и энкодер -------------------------
+
+struct button_dev_t {
+  int gpio;
+  bool pressed;
+  struct {
+    int event;
+    button_cb_t cb;
+    void *usr_data;
+  } cbs[8];
+  int cb_count;
+};
+
+static struct button_dev_t *s_buttons[HOST_MAX_BUTTONS];
+static int s_knob_steps = 0;
+
+esp_err_t iot_button_new_gpio_device(const button_config_t *cfg,
+                                     const button_gpio_config_t *gpio_cfg,
+                                     button_handle_t *out) {
+  (void)cfg;
+  if (!gpio_cfg || !out)
+    return ESP_ERR_INVALID_ARG;
+  for (int i = 0; i < HOST_MAX_BUTTONS; i++) {
+    if (s_buttons[i])
+      continue;
+    struct button_dev_t *b = calloc(1, sizeof(*b));
+    if (!b)
+      return ESP_ERR_NO_MEM;
+    b->gpio = gpio_cfg->gpio_num;
+    s_buttons[i] = b;
+    *out = b;
+    return ESP_OK;
+  }
+  return ESP_ERR_NO_MEM;
+}
+
+esp_err_t iot_button_register_cb(button_handle_t btn, int event,
+                                 void *event_args, button_cb_t cb,
+                                 void *usr_data) {
+  (void)event_args;
+  if (!btn || !cb)
+    return ESP_ERR_INVALID_ARG;
+  if (btn->cb_count >= (int)(sizeof(btn->cbs) / sizeof(btn->cbs[0])))
+    return ESP_ERR_NO_MEM;
+  btn->cbs[btn->cb_count].event = event;
+  btn->cbs[btn->cb_count].cb = cb;
+  btn->cbs[btn->cb_count].usr_data = usr_data;
+  btn->cb_count++;
+  return ESP_OK;
+}
+
+esp_err_t iot_button_delete(button_handle_t btn) {
+  for (int i = 0; i < HOST_MAX_BUTTONS; i++)
+    if (s_buttons[i] == btn)
+      s_buttons[i] = NULL;
+  free(btn);
+  return ESP_OK;
+}
+
+static struct button_dev_t *button_by_gpio(int gpio) {
+  for (int i = 0; i < HOST_MAX_BUTTONS; i++)
+    if (s_buttons[i] && s_buttons[i]->gpio == gpio)
+      return s_buttons[i];
+  return NULL;
+}
+
+void host_button_emit(int gpio_num, int event) {
+  struct button_dev_t *b = button_by_gpio(gpio_num);
+  if (!b)
+    return;
+  for (int i = 0; i < b->cb_count; i++)
+    if (b->cbs[i].event == event)
+      b->cbs[i].cb(b, b->cbs[i].usr_data);
+}
+
+bool host_button_is_pressed(button_handle_t btn) {
+  return btn && btn->pressed;
+}
+
+void host_button_set_pressed(int gpio_num, bool pressed) {
+  struct button_dev_t *b = button_by_gpio(gpio_num);
+  if (b)
+    b->pressed = pressed;
+}
+
+void host_knob_rotate(int steps) { s_knob_steps += steps; }
+
+// ------------------------- порт LVGL -------------------------
+
+static bool s_port_inited = false;
+static lv_display_render_mode_t s_render_mode = LV_DISPLAY_RENDER_MODE_PARTIAL;
+
+esp_err_t lvgl_port_init(const lvgl_port_cfg_t *cfg) {
+  if (!cfg)
+    return ESP_ERR_INVALID_ARG;
+  if (!s_port_inited) {
+    lv_init();
+    s_port_inited = true;
+  }
+  return ESP_OK;
+}
+
+esp_err_t lvgl_port_deinit(void) {
+  if (s_port_inited) {
+    lv_deinit();
+    s_port_inited = false;
+  }
+  return ESP_OK;
+}
+
+static void flush_cb(lv_display_t *disp, const lv_area_t *area,
+                     uint8_t *px_map) {
+  esp_lcd_panel_handle_t panel = lv_display_get_user_data(disp);
+  // в direct/full буфер размером с экран: строка буфера — строка дисплея
+  if (s_render_mode != LV_DISPLAY_RENDER_MODE_PARTIAL) {
+    int32_t hres = lv_display_get_horizontal_resolution(disp);
+    const uint16_t *fb = (const uint16_t *)px_map;
+    for (int32_t y = area->y1; y <= area->y2; y++)
+      esp_lcd_panel_draw_bitmap(panel, area->x1, y, area->x2 + 1, y + 1,
+                                &fb[(size_t)y * hres + area->x1]);
+  } else {
+    esp_lcd_panel_draw_bitmap(panel, area->x1, area->y1, area->x2 + 1,
+                              area->y2 + 1, px_map);
+  }
+  lv_display_flush_ready(disp);
+}
+
+lv_display_t *lvgl_port_add_disp(const lvgl_port_display_cfg_t *cfg) {
+  if (!cfg || !cfg->panel_handle || !s_port_inited)
+    return NULL;
+  if (panel_alloc(cfg->panel_handle, (int)cfg->hres, (int)cfg->vres) !=
+      ESP_OK)
+    return NULL;
+
+  lv_display_render_mode_t mode = LV_DISPLAY_RENDER_MODE_PARTIAL;
+  uint32_t buf_px = cfg->buffer_size;
+  if (cfg->flags.full_refresh || cfg->flags.direct_mode) {
+    mode = cfg->flags.direct_mode ? LV_DISPLAY_RENDER_MODE_DIRECT
+                                  : LV_DISPLAY_RENDER_MODE_FULL;
+    buf_px = cfg->hres * cfg->vres;
+  }
+  size_t bytes = (size_t)buf_px * sizeof(uint16_t);
+  void *buf1 = malloc(bytes);
+  void *buf2 = cfg->double_buffer ? malloc(bytes) : NULL;
+  if (!buf1 || (cfg->double_buffer && !buf2)) {
+    free(buf1);
+    free(buf2);
+    return NULL;
+  }
+
+  lv_display_t *disp = lv_display_create((int32_t)cfg->hres,
+                                         (int32_t)cfg->vres);
+  if (!disp) {
+    free(buf1);
+    free(buf2);
+    return NULL;
+  }
+  lv_display_set_color_format(disp, LV_COLOR_FORMAT_RGB565);
+  lv_display_set_buffers(disp, buf1, buf2, (uint32_t)bytes, mode);
+  s_render_mode = mode;
+  lv_display_set_user_data(disp, cfg->panel_handle);
+  lv_display_set_flush_cb(disp, flush_cb);
+  ESP_LOGI(TAG, "display %lux%lu, %lu px buffer%s", (unsigned long)cfg->hres,
+           (unsigned long)cfg->vres, (unsigned long)buf_px,
+           cfg->double_buffer ? " x2" : "");
+  return disp;
+}
+
+static void encoder_read_cb(lv_indev_t *indev, lv_indev_data_t *data) {
+  button_handle_t enter = lv_indev_get_user_data(indev);
+  data->enc_diff = (int16_t)s_knob_steps;
+  s_knob_steps = 0;
+  data->state = host_button_is_pressed(enter) ? LV_INDEV_STATE_PRESSED
+                                              : LV_INDEV_STATE_RELEASED;
+}
+
+lv_indev_t *lvgl_port_add_encoder(const lvgl_port_encoder_cfg_t *cfg) {
+  if (!cfg || !cfg->disp)
+    return NULL;
+  lv_indev_t *indev = lv_indev_create();
+  if (!indev)
+    return NULL;
+  lv_indev_set_type(indev, LV_INDEV_TYPE_ENCODER);
+  lv_indev_set_display(indev, cfg->disp);
+  lv_indev_set_user_data(indev, cfg->encoder_enter);
+  lv_indev_set_read_cb(indev, encoder_read_cb);
+  return indev;
+}
+
+bool lvgl_port_lock(uint32_t timeout_ms) {
+  (void)timeout_ms;
+  return true;
+}
+
+void lvgl_port_unlock(void) {}
+
+esp_err_t lvgl_port_task_wake(lvgl_port_event_type_t event, void *param) {
+  (void)event;
+  (void)param;
+  return ESP_OK;
+}
+
+// остановленный порт не крутит lv_timer_handler (см. run_ms в раннере)
+static bool s_lvgl_running = true;
+
+esp_err_t lvgl_port_stop(void) {
+  s_lvgl_running = false;
+  return ESP_OK;
+}
+
+esp_err_t lvgl_port_resume(void) {
+  s_lvgl_running = true;
+  return ESP_OK;
+}
+
+bool host_lvgl_running(void) { return s_lvgl_running; }
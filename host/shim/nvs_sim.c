@@ -0,0 +1,113 @@
+// NVS на хосте: пары ключ/значение в памяти процесса. Каждый сценарий —
+// свой процесс, так что прогон начинается с чистого раздела, как после
+// прошивки с erase.
+#include <string.h>
+
+#include "nvs.h"
+
+#define NVS_SIM_MAX 32
+#define NVS_SIM_NS_MAX 8
+
+static struct {
+  uint8_t ns;
+  char key[16];
+  int64_t val;
+} s_items[NVS_SIM_MAX];
+static int s_count = 0;
+static char s_ns[NVS_SIM_NS_MAX][16];
+static int s_ns_count = 0;
+
+esp_err_t nvs_flash_init(void) { return ESP_OK; }
+
+esp_err_t nvs_flash_erase(void) {
+  s_count = 0;
+  s_ns_count = 0;
+  return ESP_OK;
+}
+
+// handle — номер пространства имён + 1
+esp_err_t nvs_open(const char *ns, nvs_open_mode_t mode, nvs_handle_t *out) {
+  if (!ns || !out)
+    return ESP_ERR_INVALID_ARG;
+  for (int i = 0; i < s_ns_count; i++) {
+    if (strncmp(s_ns[i], ns, sizeof(s_ns[i])) == 0) {
+      *out = (nvs_handle_t)(i + 1);
+      return ESP_OK;
+    }
+  }
+  if (mode == NVS_READONLY)
+    return ESP_ERR_NVS_NOT_FOUND;
+  if (s_ns_count >= NVS_SIM_NS_MAX)
+    return ESP_ERR_NO_MEM;
+  strncpy(s_ns[s_ns_count], ns, sizeof(s_ns[0]) - 1);
+  *out = (nvs_handle_t)(++s_ns_count);
+  return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t h) { (void)h; }
+
+esp_err_t nvs_commit(nvs_handle_t h) { return h ? ESP_OK : ESP_ERR_INVALID_ARG; }
+
+static int find(nvs_handle_t h, const char *key) {
+  for (int i = 0; i < s_count; i++)
+    if (s_items[i].ns == h && strncmp(s_items[i].key, key, 15) == 0)
+      return i;
+  return -1;
+}
+
+static esp_err_t set(nvs_handle_t h, const char *key, int64_t v) {
+  if (!h || !key)
+    return ESP_ERR_INVALID_ARG;
+  int i = find(h, key);
+  if (i < 0) {
+    if (s_count >= NVS_SIM_MAX)
+      return ESP_ERR_NO_MEM;
+    i = s_count++;
+    s_items[i].ns = (uint8_t)h;
+    strncpy(s_items[i].key, key, sizeof(s_items[i].key) - 1);
+  }
+  s_items[i].val = v;
+  return ESP_OK;
+}
+
+static esp_err_t get(nvs_handle_t h, const char *key, int64_t *v) {
+  if (!h || !key || !v)
+    return ESP_ERR_INVALID_ARG;
+  int i = find(h, key);
+  if (i < 0)
+    return ESP_ERR_NVS_NOT_FOUND;
+  *v = s_items[i].val;
+  return ESP_OK;
+}
+
+esp_err_t nvs_set_i32(nvs_handle_t h, const char *key, int32_t v) {
+  return set(h, key, v);
+}
+
+esp_err_t nvs_set_u32(nvs_handle_t h, const char *key, uint32_t v) {
+  return set(h, key, v);
+}
+
+esp_err_t nvs_set_i64(nvs_handle_t h, const char *key, int64_t v) {
+  return set(h, key, v);
+}
+
+esp_err_t nvs_get_i32(nvs_handle_t h, const char *key, int32_t *out) {
+  int64_t v;
+  esp_err_t err = get(h, key, &v);
+  if (err == ESP_OK && out)
+    *out = (int32_t)v;
+  return err;
+}
+
+esp_err_t nvs_get_u32(nvs_handle_t h, const char *key, uint32_t *out) {
+  int64_t v;
+  esp_err_t err = get(h, key, &v);
+  if (err == ESP_OK && out)
+    *out = (uint32_t)v;
+  return err;
+}
+
+esp_err_t nvs_get_i64(nvs_handle_t h, const char *key, int64_t *out) {
+  return get(h, key, out);
+}
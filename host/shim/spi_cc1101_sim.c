@@ -0,0 +1,190 @@
+// SPI на хосте: каждое устройство на шине — модель регистров CC1101.
+//
+// Настоящий компонент cc1101 (пресеты, AGC, FOC) работает поверх этой
+// модели без изменений. Заголовочный байт: 0x80 — чтение, 0x40 — burst;
+// одиночный байт >= 0x30 — строб; адреса 0x30..0x3D с burst-битом —
+// регистры статуса. Запись в регистры запоминается, MARCSTATE следует
+// за стробами SIDLE/SRX, RSSI и FREQEST задаёт сценарий.
+#include <stdlib.h>
+#include <string.h>
+
+#include "driver/spi_master.h"
+#include "host_hooks.h"
+
+#define CC_SRES 0x30
+#define CC_SRX 0x34
+#define CC_SIDLE 0x36
+#define CC_PATABLE 0x3E
+#define CC_FIFO 0x3F
+
+#define CC_PARTNUM 0x30
+#define CC_VERSION 0x31
+#define CC_FREQEST 0x32
+#define CC_RSSI 0x34
+#define CC_MARCSTATE 0x35
+
+#define MARC_IDLE 0x01
+#define MARC_RX 0x0D
+
+#define HOST_MAX_SPI_DEVS 4
+
+struct spi_device_t {
+  int cs;
+  uint8_t regs[0x30];
+  uint8_t patable[8];
+  uint8_t marcstate;
+  uint32_t writes;
+};
+
+static struct spi_device_t *s_devs[HOST_MAX_SPI_DEVS];
+static uint8_t s_rssi_raw = 0xCC; // -100 dBm
+static uint8_t s_freqest = 0;
+
+esp_err_t spi_bus_add_device(spi_host_device_t host,
+                             const spi_device_interface_config_t *cfg,
+                             spi_device_handle_t *out) {
+  (void)host;
+  if (!cfg || !out)
+    return ESP_ERR_INVALID_ARG;
+  for (int i = 0; i < HOST_MAX_SPI_DEVS; i++) {
+    if (s_devs[i])
+      continue;
+    struct spi_device_t *d = calloc(1, sizeof(*d));
+    if (!d)
+      return ESP_ERR_NO_MEM;
+    d->cs = cfg->spics_io_num;
+    d->marcstate = MARC_IDLE;
+    s_devs[i] = d;
+    *out = d;
+    return ESP_OK;
+  }
+  return ESP_ERR_NO_MEM;
+}
+
+esp_err_t spi_bus_remove_device(spi_device_handle_t dev) {
+  for (int i = 0; i < HOST_MAX_SPI_DEVS; i++) {
+    if (s_devs[i] != dev)
+      continue;
+    free(dev);
+    s_devs[i] = NULL;
+    return ESP_OK;
+  }
+  return ESP_ERR_INVALID_ARG;
+}
+
+static uint8_t status_byte(const struct spi_device_t *d) {
+  // STATE[2:0] в битах 6:4: 0 — IDLE, 1 — RX
+  return d->marcstate == MARC_RX ? 0x10 : 0x00;
+}
+
+static void strobe(struct spi_device_t *d, uint8_t s) {
+  switch (s) {
+  case CC_SRES:
+    memset(d->regs, 0, sizeof(d->regs));
+    d->marcstate = MARC_IDLE;
+    break;
+  case CC_SRX:
+    d->marcstate = MARC_RX;
+    break;
+  case CC_SIDLE:
+    d->marcstate = MARC_IDLE;
+    break;
+  default:
+    break;
+  }
+}
+
+static uint8_t read_status_reg(const struct spi_device_t *d, uint8_t addr) {
+  switch (addr) {
+  case CC_PARTNUM:
+    return 0x00;
+  case CC_VERSION:
+    return 0x14;
+  case CC_FREQEST:
+    return s_freqest;
+  case CC_RSSI:
+    return s_rssi_raw;
+  case CC_MARCSTATE:
+    return d->marcstate;
+  default:
+    return 0x00;
+  }
+}
+
+esp_err_t spi_device_polling_transmit(spi_device_handle_t dev,
+                                      spi_transaction_t *t) {
+  if (!dev || !t || !t->length)
+    return ESP_ERR_INVALID_ARG;
+  size_t n = t->length / 8;
+  const uint8_t *tx = (t->flags & SPI_TRANS_USE_TXDATA) ? t->tx_data
+                                                         : t->tx_buffer;
+  uint8_t *rx = (t->flags & SPI_TRANS_USE_RXDATA) ? t->rx_data : t->rx_buffer;
+  if (!tx)
+    return ESP_ERR_INVALID_ARG;
+
+  uint8_t hdr = tx[0];
+  uint8_t addr = hdr & 0x3F;
+  bool read = hdr & 0x80;
+  bool burst = hdr & 0x40;
+
+  if (rx)
+    rx[0] = status_byte(dev);
+
+  if (n == 1 && addr >= 0x30) {
+    strobe(dev, addr);
+    return ESP_OK;
+  }
+
+  for (size_t i = 1; i < n; i++) {
+    if (addr == CC_PATABLE) {
+      size_t k = (i - 1) % sizeof(dev->patable);
+      if (read && rx)
+        rx[i] = dev->patable[k];
+      else if (!read)
+        dev->patable[k] = tx[i];
+      continue;
+    }
+    if (addr == CC_FIFO) {
+      if (read && rx)
+        rx[i] = 0;
+      continue;
+    }
+    // статус-регистры читаются только burst-заголовком
+    if (addr >= 0x30) {
+      if (rx)
+        rx[i] = read && burst ? read_status_reg(dev, addr) : 0;
+      continue;
+    }
+    uint8_t a = burst ? (uint8_t)(addr + i - 1) : addr;
+    if (a >= sizeof(dev->regs))
+      break;
+    if (read) {
+      if (rx)
+        rx[i] = dev->regs[a];
+    } else {
+      dev->regs[a] = tx[i];
+      dev->writes++;
+    }
+  }
+  return ESP_OK;
+}
+
+esp_err_t spi_device_transmit(spi_device_handle_t dev, spi_transaction_t *t) {
+  return spi_device_polling_transmit(dev, t);
+}
+
+void host_cc1101_set_rssi_dbm(int dbm) {
+  // обратное к cc1101_read_rssi_dbm: dBm = raw_signed / 2 - 74
+  int raw = (dbm + 74) * 2;
+  s_rssi_raw = (uint8_t)(int8_t)raw;
+}
+
+void host_cc1101_set_freqest(int8_t v) { s_freqest = (uint8_t)v; }
+
+uint32_t host_cc1101_reg_writes(void) {
+  uint32_t total = 0;
+  for (int i = 0; i < HOST_MAX_SPI_DEVS; i++)
+    if (s_devs[i])
+      total += s_devs[i]->writes;
+  return total;
+}
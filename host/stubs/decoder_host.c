@@ -0,0 +1,119 @@
+// Декодер на хосте: вместо RMT и разбора длительностей — воспроизведение
+// уже декодированных пакетов из записи (host_decoder_replay). Пакет
+// проходит тот же путь, что и в прошивке: burst_cb своего радио (AGC/FOC
+// поверх модели CC1101), last_pkt, затем подписчики общего потока.
+// Упорядочивание по времени не нужно — запись уже упорядочена.
+// Для осциллограммы байты пакета превращаются обратно в PWM-всплеск
+// (decode_pwm наоборот) и идут в decoder_capture, как из decoder_task.
+#include <string.h>
+
+#include "decoder.h"
+#include "decoder_capture.h"
+#include "host_hooks.h"
+
+static const char *TAG = "decoder";
+
+#define HOST_MAX_DECODERS 2
+#define HOST_MAX_STREAM_SUBS 4
+
+packet_t last_pkt;
+bool decoder_rmt_running = false;
+
+static decoder_t *s_decoders[HOST_MAX_DECODERS];
+static int s_decoder_count = 0;
+
+static struct {
+  decoder_stream_cb_t cb;
+  void *ctx;
+} s_subs[HOST_MAX_STREAM_SUBS];
+static int s_sub_count = 0;
+static bool s_stream_ready = false;
+
+esp_err_t decoder_pipeline_init(const decoder_pipeline_cfg_t *cfg) {
+  return cfg ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+// конвейера нет — мерить нечего (задачи на хосте не запускаются)
+esp_err_t decoder_bench_start(void) { return ESP_ERR_NOT_SUPPORTED; }
+
+esp_err_t decoder_bench_stop(decoder_bench_result_t *out) {
+  (void)out;
+  return ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t decoder_start(decoder_t *dec, const decoder_cfg_t *cfg) {
+  if (!dec || !cfg)
+    return ESP_ERR_INVALID_ARG;
+  if (s_decoder_count >= HOST_MAX_DECODERS)
+    return ESP_ERR_NO_MEM;
+  memset(dec, 0, sizeof(*dec));
+  dec->cfg = *cfg;
+  s_decoders[s_decoder_count++] = dec;
+  ESP_LOGI(TAG, "replay decoder for radio %u", cfg->radio_id);
+  return ESP_OK;
+}
+
+// задачи захвата нет — будить некого
+void decoder_wake(decoder_t *dec) { (void)dec; }
+
+esp_err_t decoder_stream_init(uint32_t hold_ms) {
+  (void)hold_ms;
+  s_stream_ready = true;
+  return ESP_OK;
+}
+
+esp_err_t decoder_stream_subscribe(decoder_stream_cb_t cb, void *ctx) {
+  if (!cb)
+    return ESP_ERR_INVALID_ARG;
+  if (s_sub_count >= HOST_MAX_STREAM_SUBS)
+    return ESP_ERR_NO_MEM;
+  s_subs[s_sub_count].cb = cb;
+  s_subs[s_sub_count].ctx = ctx;
+  s_sub_count++;
+  return ESP_OK;
+}
+
+// 1 — длинный высокий + короткий низкий, 0 — наоборот; тики по 10 мкс
+#define PWM_SHORT 35
+#define PWM_LONG 70
+
+static void replay_capture(const packet_t *pkt) {
+  static rmt_symbol_word_t sym[sizeof(pkt->data) * 8];
+  size_t n = 0;
+  for (int i = 0; i < pkt->len && i < (int)sizeof(pkt->data); i++) {
+    for (int b = 7; b >= 0; b--, n++) {
+      bool one = (pkt->data[i] >> b) & 1;
+      sym[n].level0 = 1;
+      sym[n].duration0 = one ? PWM_LONG : PWM_SHORT;
+      sym[n].level1 = 0;
+      sym[n].duration1 = one ? PWM_SHORT : PWM_LONG;
+    }
+  }
+  if (n >= 32)
+    decoder_capture_add_burst(pkt->radio_id, sym, n, pkt->timestamp_us);
+}
+
+bool host_decoder_replay(const packet_t *pkt) {
+  if (!pkt || !decoder_rmt_running || !s_stream_ready)
+    return false;
+
+  decoder_t *dec = NULL;
+  for (int i = 0; i < s_decoder_count; i++)
+    if (s_decoders[i]->cfg.radio_id == pkt->radio_id)
+      dec = s_decoders[i];
+  if (!dec)
+    return false;
+
+  dec->bursts++;
+  replay_capture(pkt);
+  if (dec->cfg.burst_cb)
+    dec->cfg.burst_cb(pkt, (size_t)pkt->len * 8, dec->cfg.burst_cb_ctx);
+  if (pkt->len <= 0)
+    return true; // ложное срабатывание: только статистика
+
+  last_pkt = *pkt;
+  last_pkt.updated = true;
+  for (int i = 0; i < s_sub_count; i++)
+    s_subs[i].cb(pkt, s_subs[i].ctx);
+  return true;
+}
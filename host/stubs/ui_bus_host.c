@@ -0,0 +1,41 @@
+// Шина UI на хосте: без задачи-диспетчера, подписчики вызываются прямо
+// из ui_bus_post (в однопоточной модели это и есть «контекст LVGL»).
+// Схлопывание повторов не моделируется — каждое событие доходит.
+#include "ui_bus.h"
+
+#define UI_BUS_MAX_SUBS 4
+
+static struct {
+  ui_evt_handler_t cb;
+  void *ctx;
+} s_subs[UI_EVT_COUNT][UI_BUS_MAX_SUBS];
+static uint8_t s_sub_count[UI_EVT_COUNT];
+static bool s_started = false;
+
+esp_err_t ui_bus_init(UBaseType_t prio, BaseType_t core) {
+  (void)prio;
+  (void)core;
+  s_started = true;
+  return ESP_OK;
+}
+
+esp_err_t ui_bus_subscribe(ui_evt_type_t type, ui_evt_handler_t cb, void *ctx) {
+  if (type >= UI_EVT_COUNT || !cb)
+    return ESP_ERR_INVALID_ARG;
+  if (s_sub_count[type] >= UI_BUS_MAX_SUBS)
+    return ESP_ERR_NO_MEM;
+  s_subs[type][s_sub_count[type]].cb = cb;
+  s_subs[type][s_sub_count[type]].ctx = ctx;
+  s_sub_count[type]++;
+  return ESP_OK;
+}
+
+esp_err_t ui_bus_post(ui_evt_type_t type, const void *data, size_t len) {
+  if (type >= UI_EVT_COUNT || len > UI_EVT_DATA_MAX || (len && !data))
+    return ESP_ERR_INVALID_ARG;
+  if (!s_started)
+    return ESP_ERR_INVALID_STATE;
+  for (int i = 0; i < s_sub_count[type]; i++)
+    s_subs[type][i].cb(type, len ? data : NULL, s_subs[type][i].ctx);
+  return ESP_OK;
+}
@@ -0,0 +1,654 @@
+"""Растеризация глифов TrueType/CFF для gen_assets.py.
+
+Читает .ttf/.otf и WOFF 1.0 (исходники lvgl/scripts/built_in_font),
+без хинтинга — как lv_font_conv: контуры масштабируются в пиксели и
+заливаются по правилу nonzero с покрытием по 16 подстрокам на пиксель.
+Только стандартная библиотека, сеть и Node.js не нужны.
+"""
+
+import math
+import struct
+import zlib
+
+SUBSAMPLES = 16     # подстрок на пиксель по вертикали
+FLATTEN_TOL = 0.05  # допуск спрямления кривых, px
+
+
+def u8(b, p):
+    return b[p]
+
+
+def u16(b, p):
+    return struct.unpack_from(">H", b, p)[0]
+
+
+def s16(b, p):
+    return struct.unpack_from(">h", b, p)[0]
+
+
+def u32(b, p):
+    return struct.unpack_from(">I", b, p)[0]
+
+
+def f2dot14(b, p):
+    return s16(b, p) / 16384.0
+
+
+def read_tables(data, path):
+    tag = data[:4]
+    tables = {}
+    if tag == b"wOFF":
+        for i in range(u16(data, 12)):
+            e = 44 + 20 * i
+            off, comp, orig = struct.unpack_from(">III", data, e + 4)
+            raw = data[off:off + comp]
+            tables[data[e:e + 4].decode("latin-1")] = (
+                zlib.decompress(raw) if comp < orig else raw)
+        return tables
+    if tag in (b"\x00\x01\x00\x00", b"OTTO", b"true"):
+        for i in range(u16(data, 4)):
+            e = 12 + 16 * i
+            off, length = struct.unpack_from(">II", data, e + 8)
+            tables[data[e:e + 4].decode("latin-1")] = data[off:off + length]
+        return tables
+    raise ValueError("%s: unsupported font container %r" % (path, tag))
+
+
+# ------------------------------ cmap ------------------------------
+
+def cmap_lookup_fmt4(t, off, code):
+    if code > 0xFFFF:
+        return 0
+    seg2 = u16(t, off + 6)
+    ends = off + 14
+    starts = ends + seg2 + 2
+    deltas = starts + seg2
+    ranges = deltas + seg2
+    for i in range(seg2 // 2):
+        if code > u16(t, ends + 2 * i):
+            continue
+        start = u16(t, starts + 2 * i)
+        if code < start:
+            return 0
+        delta = u16(t, deltas + 2 * i)
+        ro = u16(t, ranges + 2 * i)
+        if ro == 0:
+            return (code + delta) & 0xFFFF
+        g = u16(t, ranges + 2 * i + ro + 2 * (code - start))
+        return (g + delta) & 0xFFFF if g else 0
+    return 0
+
+
+def cmap_lookup_fmt12(t, off, code):
+    for i in range(u32(t, off + 12)):
+        start, end, gid = struct.unpack_from(">III", t, off + 16 + 12 * i)
+        if start <= code <= end:
+            return gid + code - start
+    return 0
+
+
+def pick_cmap(t, path):
+    subs = {}
+    for i in range(u16(t, 2)):
+        pid, eid, off = struct.unpack_from(">HHI", t, 4 + 8 * i)
+        subs.setdefault((pid, eid), off)
+    # полный Unicode (format 12) раньше BMP (format 4)
+    for want in (12, 4):
+        for key in ((3, 10), (0, 6), (0, 4), (3, 1), (0, 3), (0, 2),
+                    (0, 1), (0, 0)):
+            if key in subs and u16(t, subs[key]) == want:
+                return want, subs[key]
+    raise ValueError("%s: no Unicode cmap" % path)
+
+
+# ------------------------------ glyf ------------------------------
+
+def tt_contour(pts):
+    """Контур TrueType (x, y, on) -> (start, [('L', p) | ('Q', c, p)])."""
+    on = [i for i, p in enumerate(pts) if p[2]]
+    if on:
+        k = on[0]
+        pts = pts[k:] + pts[:k]
+    else:
+        a, b = pts[0], pts[1]
+        pts = [((a[0] + b[0]) / 2, (a[1] + b[1]) / 2, True)] + pts
+    start = pts[0][:2]
+    segs = []
+    ctrl = None
+    for x, y, is_on in pts[1:] + pts[:1]:
+        if is_on:
+            segs.append(("Q", ctrl, (x, y)) if ctrl else ("L", (x, y)))
+            ctrl = None
+        else:
+            if ctrl:
+                segs.append(("Q", ctrl, ((ctrl[0] + x) / 2,
+                                         (ctrl[1] + y) / 2)))
+            ctrl = (x, y)
+    return start, segs
+
+
+class Glyf:
+    def __init__(self, font):
+        self.glyf = font.tables["glyf"]
+        loca = font.tables["loca"]
+        n = font.num_glyphs + 1
+        if font.loca_long:
+            self.offs = [u32(loca, 4 * i) for i in range(n)]
+        else:
+            self.offs = [2 * u16(loca, 2 * i) for i in range(n)]
+
+    def points(self, gid, depth=0):
+        """Контуры глифа точками (x, y, on) в единицах шрифта."""
+        g = self.glyf[self.offs[gid]:self.offs[gid + 1]]
+        if not g:
+            return []
+        nc = s16(g, 0)
+        if nc >= 0:
+            return self._simple(g, nc)
+        if depth > 8:
+            raise ValueError("glyf: composite nesting too deep")
+        return self._composite(g, depth)
+
+    @staticmethod
+    def _simple(g, nc):
+        ends = [u16(g, 10 + 2 * i) for i in range(nc)]
+        npts = ends[-1] + 1 if nc else 0
+        p = 12 + 2 * nc + u16(g, 10 + 2 * nc)
+        flags = []
+        while len(flags) < npts:
+            f = g[p]
+            p += 1
+            flags.append(f)
+            if f & 0x08:
+                flags.extend([f] * g[p])
+                p += 1
+        coords = []
+        for short, same in ((0x02, 0x10), (0x04, 0x20)):
+            v = 0
+            vals = []
+            for f in flags:
+                if f & short:
+                    v += g[p] if f & same else -g[p]
+                    p += 1
+                elif not f & same:
+                    v += s16(g, p)
+                    p += 2
+                vals.append(v)
+            coords.append(vals)
+        xs, ys = coords
+        contours = []
+        first = 0
+        for end in ends:
+            contours.append([(xs[i], ys[i], bool(flags[i] & 1))
+                             for i in range(first, end + 1)])
+            first = end + 1
+        return contours
+
+    def _composite(self, g, depth):
+        contours = []
+        p = 10
+        while True:
+            flags, gid = u16(g, p), u16(g, p + 2)
+            p += 4
+            if flags & 0x0001:
+                dx, dy = s16(g, p), s16(g, p + 2)
+                p += 4
+            else:
+                dx, dy = struct.unpack_from(">bb", g, p)
+                p += 2
+            if not flags & 0x0002:
+                raise ValueError("glyf: point-matched components")
+            a, b, c, d = 1.0, 0.0, 0.0, 1.0
+            if flags & 0x0008:
+                a = d = f2dot14(g, p)
+                p += 2
+            elif flags & 0x0040:
+                a, d = f2dot14(g, p), f2dot14(g, p + 2)
+                p += 4
+            elif flags & 0x0080:
+                a, b, c, d = (f2dot14(g, p + 2 * i) for i in range(4))
+                p += 8
+            for cont in self.points(gid, depth + 1):
+                contours.append([(a * x + c * y + dx, b * x + d * y + dy, on)
+                                 for x, y, on in cont])
+            if not flags & 0x0020:
+                return contours
+
+    def outline(self, gid):
+        return [tt_contour(c) for c in self.points(gid) if c]
+
+
+# ------------------------------ CFF -------------------------------
+
+def cff_index(d, p):
+    """INDEX -> (список элементов, позиция после него)."""
+    count = u16(d, p)
+    if count == 0:
+        return [], p + 2
+    osz = d[p + 2]
+    offs = [int.from_bytes(d[p + 3 + i * osz:p + 3 + (i + 1) * osz], "big")
+            for i in range(count + 1)]
+    base = p + 3 + (count + 1) * osz - 1
+    return [d[base + offs[i]:base + offs[i + 1]] for i in range(count)], \
+        base + offs[-1]
+
+
+def cff_real(b, i):
+    s = ""
+    nib = "0123456789.EE?-"
+    while True:
+        for n in (b[i] >> 4, b[i] & 15):
+            if n == 15:
+                return float(s or 0), i + 1
+            s += {0xC: "E-"}.get(n, nib[n])
+        i += 1
+
+
+def cff_dict(b):
+    out = {}
+    ops = []
+    i = 0
+    while i < len(b):
+        v = b[i]
+        if v <= 21:
+            if v == 12:
+                out[1200 + b[i + 1]] = ops
+                i += 2
+            else:
+                out[v] = ops
+                i += 1
+            ops = []
+        elif v == 28:
+            ops.append(s16(b, i + 1))
+            i += 3
+        elif v == 29:
+            ops.append(struct.unpack_from(">i", b, i + 1)[0])
+            i += 5
+        elif v == 30:
+            val, i = cff_real(b, i + 1)
+            ops.append(val)
+        elif v <= 246:
+            ops.append(v - 139)
+            i += 1
+        elif v <= 250:
+            ops.append((v - 247) * 256 + b[i + 1] + 108)
+            i += 2
+        elif v <= 254:
+            ops.append(-(v - 251) * 256 - b[i + 1] - 108)
+            i += 2
+        else:
+            raise ValueError("CFF: bad DICT byte %d" % v)
+    return out
+
+
+def subr_bias(subrs):
+    n = len(subrs)
+    return 107 if n < 1240 else 1131 if n < 33900 else 32768
+
+
+class Cff:
+    def __init__(self, d):
+        p = d[2]
+        _, p = cff_index(d, p)
+        top, p = cff_index(d, p)
+        _, p = cff_index(d, p)
+        self.gsubrs, p = cff_index(d, p)
+        top = cff_dict(top[0])
+        if 1230 in top:
+            raise ValueError("CFF: CID-keyed fonts are not supported")
+        if top.get(1206, [2])[0] != 2:
+            raise ValueError("CFF: only Type 2 charstrings")
+        self.charstrings, _ = cff_index(d, top[17][0])
+        self.subrs = []
+        if 18 in top:
+            size, off = top[18]
+            priv = cff_dict(d[off:off + size])
+            if 19 in priv:
+                self.subrs, _ = cff_index(d, off + priv[19][0])
+
+    def outline(self, gid):
+        return Type2(self).run(self.charstrings[gid])
+
+
+class Type2:
+    """Интерпретатор Type 2 charstring: только контуры, хинты пропускаются."""
+
+    def __init__(self, cff):
+        self.cff = cff
+        self.stack = []
+        self.nstems = 0
+        self.x = self.y = 0.0
+        self.contours = []
+        self.cur = None
+        self.width_seen = False
+        self.done = False
+
+    def drop_width(self, has_width):
+        if not self.width_seen and has_width:
+            self.stack.pop(0)
+        self.width_seen = True
+
+    def move(self, dx, dy):
+        self.x += dx
+        self.y += dy
+        self.cur = ((self.x, self.y), [])
+        self.contours.append(self.cur)
+
+    def line(self, dx, dy):
+        self.x += dx
+        self.y += dy
+        self.cur[1].append(("L", (self.x, self.y)))
+
+    def curve(self, dx1, dy1, dx2, dy2, dx3, dy3):
+        c1 = (self.x + dx1, self.y + dy1)
+        c2 = (c1[0] + dx2, c1[1] + dy2)
+        self.x, self.y = c2[0] + dx3, c2[1] + dy3
+        self.cur[1].append(("C", c1, c2, (self.x, self.y)))
+
+    def alt_curves(self, a, horiz):
+        i = 0
+        while i + 4 <= len(a):
+            last = len(a) - i == 5
+            e = a[i + 4] if last else 0
+            if horiz:
+                self.curve(a[i], 0, a[i + 1], a[i + 2], e, a[i + 3])
+            else:
+                self.curve(0, a[i], a[i + 1], a[i + 2], a[i + 3], e)
+            i += 5 if last else 4
+            horiz = not horiz
+
+    def alt_lines(self, a, horiz):
+        for v in a:
+            if horiz:
+                self.line(v, 0)
+            else:
+                self.line(0, v)
+            horiz = not horiz
+
+    def run(self, code):
+        self.exec(code)
+        return [c for c in self.contours if c[1]]
+
+    def exec(self, code):
+        s = self.stack
+        i = 0
+        while i < len(code) and not self.done:
+            v = code[i]
+            if v == 28:
+                s.append(s16(code, i + 1))
+                i += 3
+                continue
+            if v >= 32:
+                if v <= 246:
+                    s.append(v - 139)
+                    i += 1
+                elif v <= 250:
+                    s.append((v - 247) * 256 + code[i + 1] + 108)
+                    i += 2
+                elif v <= 254:
+                    s.append(-(v - 251) * 256 - code[i + 1] - 108)
+                    i += 2
+                else:
+                    s.append(struct.unpack_from(">i", code, i + 1)[0] /
+                             65536.0)
+                    i += 5
+                continue
+            i += 1
+            if v in (1, 3, 18, 23):            # hstem vstem hstemhm vstemhm
+                self.drop_width(len(s) % 2)
+                self.nstems += len(s) // 2
+            elif v in (19, 20):                # hintmask cntrmask
+                self.drop_width(len(s) % 2)
+                self.nstems += len(s) // 2
+                i += (self.nstems + 7) // 8
+            elif v == 21:                      # rmoveto
+                self.drop_width(len(s) > 2)
+                self.move(s[0], s[1])
+            elif v == 22:                      # hmoveto
+                self.drop_width(len(s) > 1)
+                self.move(s[0], 0)
+            elif v == 4:                       # vmoveto
+                self.drop_width(len(s) > 1)
+                self.move(0, s[0])
+            elif v == 5:                       # rlineto
+                for k in range(0, len(s) - 1, 2):
+                    self.line(s[k], s[k + 1])
+            elif v == 6:                       # hlineto
+                self.alt_lines(s, True)
+            elif v == 7:                       # vlineto
+                self.alt_lines(s, False)
+            elif v == 8:                       # rrcurveto
+                for k in range(0, len(s) - 5, 6):
+                    self.curve(*s[k:k + 6])
+            elif v == 24:                      # rcurveline
+                k = 0
+                while len(s) - k >= 8:
+                    self.curve(*s[k:k + 6])
+                    k += 6
+                self.line(s[k], s[k + 1])
+            elif v == 25:                      # rlinecurve
+                k = 0
+                while len(s) - k > 6:
+                    self.line(s[k], s[k + 1])
+                    k += 2
+                self.curve(*s[k:k + 6])
+            elif v == 26:                      # vvcurveto
+                k = len(s) % 2
+                dx1 = s[0] if k else 0
+                while k + 4 <= len(s):
+                    self.curve(dx1, s[k], s[k + 1], s[k + 2], 0, s[k + 3])
+                    dx1 = 0
+                    k += 4
+            elif v == 27:                      # hhcurveto
+                k = len(s) % 2
+                dy1 = s[0] if k else 0
+                while k + 4 <= len(s):
+                    self.curve(s[k], dy1, s[k + 1], s[k + 2], s[k + 3], 0)
+                    dy1 = 0
+                    k += 4
+            elif v == 30:                      # vhcurveto
+                self.alt_curves(s, False)
+            elif v == 31:                      # hvcurveto
+                self.alt_curves(s, True)
+            elif v in (10, 29):                # callsubr callgsubr
+                subrs = self.cff.subrs if v == 10 else self.cff.gsubrs
+                idx = int(s.pop()) + subr_bias(subrs)
+                self.exec(subrs[idx])
+                continue
+            elif v == 11:                      # return
+                return
+            elif v == 14:                      # endchar
+                if not self.width_seen and len(s) >= 4:
+                    raise ValueError("CFF: seac accents are not supported")
+                self.drop_width(len(s) % 2)
+                self.done = True
+            elif v == 12:
+                self.flex(code[i], s)
+                i += 1
+            else:
+                raise ValueError("CFF: operator %d" % v)
+            del s[:]
+
+    def flex(self, op, s):
+        if op == 35:                           # flex
+            self.curve(*s[0:6])
+            self.curve(*s[6:12])
+        elif op == 34:                         # hflex
+            self.curve(s[0], 0, s[1], s[2], s[3], 0)
+            self.curve(s[4], 0, s[5], -s[2], s[6], 0)
+        elif op == 36:                         # hflex1
+            self.curve(s[0], s[1], s[2], s[3], s[4], 0)
+            self.curve(s[5], 0, s[6], s[7], s[8], -(s[1] + s[3] + s[7]))
+        elif op == 37:                         # flex1
+            dx = sum(s[0:10:2])
+            dy = sum(s[1:10:2])
+            self.curve(*s[0:6])
+            if abs(dx) > abs(dy):
+                self.curve(s[6], s[7], s[8], s[9], s[10], -dy)
+            else:
+                self.curve(s[6], s[7], s[8], s[9], -dx, s[10])
+        else:
+            raise ValueError("CFF: operator 12 %d" % op)
+
+
+# ------------------------------ шрифт -----------------------------
+
+class Font:
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.tables = read_tables(f.read(), path)
+        self.path = path
+        head = self.tables["head"]
+        hhea = self.tables["hhea"]
+        self.upem = u16(head, 18)
+        self.loca_long = s16(head, 50) == 1
+        self.ascender = s16(hhea, 4)
+        self.descender = s16(hhea, 6)
+        self.num_glyphs = u16(self.tables["maxp"], 4)
+        hmtx = self.tables["hmtx"]
+        self.advances = [u16(hmtx, 4 * i) for i in range(u16(hhea, 34))]
+        self.cmap_fmt, self.cmap_off = pick_cmap(self.tables["cmap"], path)
+        if "glyf" in self.tables:
+            self.shapes = Glyf(self)
+        elif "CFF " in self.tables:
+            self.shapes = Cff(self.tables["CFF "])
+        else:
+            raise ValueError("%s: neither glyf nor CFF outlines" % path)
+
+    def glyph_id(self, code):
+        look = cmap_lookup_fmt12 if self.cmap_fmt == 12 else cmap_lookup_fmt4
+        return look(self.tables["cmap"], self.cmap_off, code)
+
+    def advance(self, gid):
+        return self.advances[min(gid, len(self.advances) - 1)]
+
+
+class Glyph:
+    """Глиф в формате lv_font_fmt_txt: покрытие 0..255 построчно."""
+
+    def __init__(self, code, adv_w, box_w, box_h, ofs_x, ofs_y, alpha):
+        self.code = code
+        self.adv_w = adv_w      # в 1/16 px
+        self.box_w = box_w
+        self.box_h = box_h
+        self.ofs_x = ofs_x
+        self.ofs_y = ofs_y      # низ бокса от базовой линии, вверх
+        self.alpha = alpha      # box_w * box_h байт
+
+
+def flatten(contour, scale):
+    """Контур -> ломаная в пикселях (y вверх)."""
+    (sx, sy), segs = contour
+    pts = [(sx * scale, sy * scale)]
+    for seg in segs:
+        p0 = pts[-1]
+        q = [(x * scale, y * scale) for x, y in seg[1:]]
+        if seg[0] == "L":
+            pts.append(q[0])
+            continue
+        if seg[0] == "Q":
+            c, p = q
+            dd = math.hypot(p0[0] - 2 * c[0] + p[0], p0[1] - 2 * c[1] + p[1])
+            n = max(1, int(math.ceil(math.sqrt(dd / (8 * FLATTEN_TOL)))))
+            for k in range(1, n + 1):
+                t = k / n
+                u = 1 - t
+                pts.append((u * u * p0[0] + 2 * u * t * c[0] + t * t * p[0],
+                            u * u * p0[1] + 2 * u * t * c[1] + t * t * p[1]))
+        else:
+            c1, c2, p = q
+            dd = max(math.hypot(p0[0] - 2 * c1[0] + c2[0],
+                                p0[1] - 2 * c1[1] + c2[1]),
+                     math.hypot(c1[0] - 2 * c2[0] + p[0],
+                                c1[1] - 2 * c2[1] + p[1]))
+            n = max(1, int(math.ceil(math.sqrt(0.75 * dd / FLATTEN_TOL))))
+            for k in range(1, n + 1):
+                t = k / n
+                u = 1 - t
+                a, b, cc, d = u * u * u, 3 * u * u * t, 3 * u * t * t, t * t * t
+                pts.append((a * p0[0] + b * c1[0] + cc * c2[0] + d * p[0],
+                            a * p0[1] + b * c1[1] + cc * c2[1] + d * p[1]))
+    return pts
+
+
+def coverage(polys, x0, y1, w, h):
+    """Доля площади каждого пикселя внутри контуров (nonzero), 0..1."""
+    edges = []
+    for poly in polys:
+        for (ax, ay), (bx, by) in zip(poly, poly[1:] + poly[:1]):
+            if ay == by:
+                continue
+            d = 1 if by > ay else -1
+            if ay > by:
+                ax, ay, bx, by = bx, by, ax, ay
+            edges.append((ay, by, ax, (bx - ax) / (by - ay), d))
+    cov = [0.0] * (w * h)
+    for row in range(h):
+        top = y1 - row
+        base = row * w
+        for s in range(SUBSAMPLES):
+            y = top - (s + 0.5) / SUBSAMPLES
+            xs = sorted((ex + (y - ey0) * k, d)
+                        for ey0, ey1, ex, k, d in edges if ey0 <= y < ey1)
+            wind = 0
+            xa = 0.0
+            for x, d in xs:
+                prev = wind
+                wind += d
+                if prev == 0 and wind != 0:
+                    xa = x - x0
+                elif prev != 0 and wind == 0:
+                    span(cov, base, w, xa, x - x0)
+    return [min(1.0, c / SUBSAMPLES) for c in cov]
+
+
+def span(cov, base, w, a, b):
+    a = max(a, 0.0)
+    b = min(b, float(w))
+    if b <= a:
+        return
+    ia = int(a)
+    ib = int(b)
+    if ia == ib:
+        cov[base + ia] += b - a
+        return
+    cov[base + ia] += ia + 1 - a
+    for k in range(ia + 1, ib):
+        cov[base + k] += 1.0
+    if ib < w:
+        cov[base + ib] += b - ib
+
+
+def render(font, code, size, levels=255):
+    """Глиф code кеглем size px; покрытие квантуется до levels."""
+    gid = font.glyph_id(code)
+    if not gid:
+        raise ValueError("%s: no glyph for U+%04X" % (font.path, code))
+    scale = size / font.upem
+    adv_w = int(round(font.advance(gid) * scale * 16))
+    polys = [flatten(c, scale) for c in font.shapes.outline(gid)]
+    pts = [p for poly in polys for p in poly]
+    if not pts:
+        return Glyph(code, adv_w, 0, 0, 0, 0, b"")
+    x0 = int(math.floor(min(p[0] for p in pts)))
+    x1 = int(math.ceil(max(p[0] for p in pts)))
+    y0 = int(math.floor(min(p[1] for p in pts)))
+    y1 = int(math.ceil(max(p[1] for p in pts)))
+    w, h = x1 - x0, y1 - y0
+    q = [int(round(c * levels)) for c in coverage(polys, x0, y1, w, h)]
+    rows = [r for r in range(h) if any(q[r * w:(r + 1) * w])]
+    cols = [c for c in range(w) if any(q[r * w + c] for r in range(h))]
+    if not rows:
+        return Glyph(code, adv_w, 0, 0, 0, 0, b"")
+    r0, r1, c0, c1 = rows[0], rows[-1], cols[0], cols[-1]
+    alpha = bytes(q[r * w + c] for r in range(r0, r1 + 1)
+                  for c in range(c0, c1 + 1))
+    return Glyph(code, adv_w, c1 - c0 + 1, r1 - r0 + 1, x0 + c0,
+                 y1 - r1 - 1, alpha)
+
+
+def line_metrics(fonts, size):
+    """line_height и base_line строки из нескольких шрифтов."""
+    asc = max(int(round(f.ascender * size / f.upem)) for f in fonts)
+    desc = max(int(round(-f.descender * size / f.upem)) for f in fonts)
+    return asc + desc, desc
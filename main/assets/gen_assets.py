@@ -0,0 +1,241 @@
+#!/usr/bin/env python3
+"""Генерация UI-ассетов: шрифты-подмножества и иконки A8.
+
+Вместо полных lv_font_montserrat_18/48 в прошивку идут только глифы,
+которые UI реально рисует:
+
+  ui_font_18   цифры Montserrat (счётчик бенчмарка) + значки батареи
+               FontAwesome (статус-бар), 4 bpp, формат lv_font_conv;
+  ui_icon_*    иконки карточек меню, заранее отрисованные в A8
+               (lv_image_dsc_t): без поиска глифа и распаковки 4 bpp,
+               цвет задаёт image_recolor.
+
+Глифы растеризует font_raster.py (TrueType/CFF, .ttf/.otf/WOFF) —
+только стандартная библиотека, без Node.js и сети, поэтому генерация
+идёт обычным шагом сборки.
+
+  gen_assets.py --fonts-dir <lvgl>/scripts/built_in_font --out <dir>
+"""
+
+import argparse
+import os
+import sys
+
+import font_raster
+
+MONTSERRAT = "Montserrat-Medium.ttf"
+FONTAWESOME = "FontAwesome5-Solid+Brands+Regular.woff"
+
+# name, size, bpp, [(font file, коды символов)]
+FONTS = [
+    ("ui_font_18", 18, 4, [
+        (MONTSERRAT, [ord(c) for c in "0123456789"]),
+        # LV_SYMBOL_BATTERY_FULL .. LV_SYMBOL_BATTERY_EMPTY
+        (FONTAWESOME, list(range(0xF240, 0xF245))),
+    ]),
+]
+
+# Иконки карточек меню: тот же глиф, что LV_SYMBOL_* в montserrat_48
+ICON_SIZE = 48
+ICONS = [
+    ("ui_icon_gps", 0xF124),        # LV_SYMBOL_GPS
+    ("ui_icon_wifi", 0xF1EB),       # LV_SYMBOL_WIFI
+    ("ui_icon_bluetooth", 0xF293),  # LV_SYMBOL_BLUETOOTH
+    ("ui_icon_drive", 0xF01C),      # LV_SYMBOL_DRIVE
+    ("ui_icon_settings", 0xF013),   # LV_SYMBOL_SETTINGS
+]
+
+HEADER = "// Сгенерировано main/assets/gen_assets.py, не править руками"
+
+
+def pack(alpha, bpp):
+    """Покрытие 0..255 -> поток bpp-битных значений, старшие биты первыми."""
+    levels = (1 << bpp) - 1
+    out = bytearray()
+    acc = nbits = 0
+    for a in alpha:
+        acc = (acc << bpp) | ((a * levels + 127) // 255)
+        nbits += bpp
+        if nbits == 8:
+            out.append(acc)
+            acc = nbits = 0
+    if nbits:
+        out.append(acc << (8 - nbits))
+    return out
+
+
+def cmap_ranges(codes):
+    """Подряд идущие коды -> [(start, length)] для FORMAT0_TINY."""
+    ranges = []
+    for code in codes:
+        if ranges and ranges[-1][0] + ranges[-1][1] == code:
+            ranges[-1][1] += 1
+        else:
+            ranges.append([code, 1])
+    return ranges
+
+
+def font_source(name, size, bpp, glyphs, line_height, base_line):
+    """Шрифт lv_font_fmt_txt (LVGL 9) без сжатия и кернинга."""
+    bitmap = bytearray()
+    dsc = ["    {.bitmap_index = 0, .adv_w = 0, .box_w = 0, .box_h = 0, "
+           ".ofs_x = 0, .ofs_y = 0} /* id = 0 reserved */,"]
+    rows = []
+    for g in glyphs:
+        data = pack(g.alpha, bpp)
+        dsc.append("    {.bitmap_index = %d, .adv_w = %d, .box_w = %d, "
+                   ".box_h = %d, .ofs_x = %d, .ofs_y = %d}, /* U+%04X */" %
+                   (len(bitmap), g.adv_w, g.box_w, g.box_h, g.ofs_x, g.ofs_y,
+                    g.code))
+        rows += ["    /* U+%04X */" % g.code, c_array(data)]
+        bitmap += data
+    cmaps = []
+    gid = 1
+    for start, length in cmap_ranges([g.code for g in glyphs]):
+        cmaps += ["    {",
+                  "        .range_start = %d, .range_length = %d, "
+                  ".glyph_id_start = %d," % (start, length, gid),
+                  "        .unicode_list = NULL, .glyph_id_ofs_list = NULL, "
+                  ".list_length = 0,",
+                  "        .type = LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY",
+                  "    },"]
+        gid += length
+    out = [HEADER,
+           "// %d px, %d bpp, %d glyphs" % (size, bpp, len(glyphs)),
+           '#include "ui_assets.h"', "",
+           "static LV_ATTRIBUTE_LARGE_CONST const uint8_t glyph_bitmap[] = {"]
+    out += [r for r in rows if r] + ["};", "",
+            "static const lv_font_fmt_txt_glyph_dsc_t glyph_dsc[] = {"]
+    out += dsc + ["};", "", "static const lv_font_fmt_txt_cmap_t cmaps[] = {"]
+    out += cmaps + ["};", "",
+                    "static const lv_font_fmt_txt_dsc_t font_dsc = {",
+                    "    .glyph_bitmap = glyph_bitmap,",
+                    "    .glyph_dsc = glyph_dsc,",
+                    "    .cmaps = cmaps,",
+                    "    .kern_dsc = NULL,",
+                    "    .kern_scale = 0,",
+                    "    .cmap_num = %d," % (len(cmaps) // 5),
+                    "    .bpp = %d," % bpp,
+                    "    .kern_classes = 0,",
+                    "    .bitmap_format = 0,",
+                    "};", "",
+                    "const lv_font_t %s = {" % name,
+                    "    .get_glyph_dsc = lv_font_get_glyph_dsc_fmt_txt,",
+                    "    .get_glyph_bitmap = lv_font_get_bitmap_fmt_txt,",
+                    "    .line_height = %d," % line_height,
+                    "    .base_line = %d," % base_line,
+                    "    .subpx = LV_FONT_SUBPX_NONE,",
+                    "    .underline_position = -1,",
+                    "    .underline_thickness = 1,",
+                    "    .dsc = &font_dsc,",
+                    "    .fallback = NULL,",
+                    "    .user_data = NULL,",
+                    "};", ""]
+    return "\n".join(out), len(bitmap)
+
+
+def compose_icon(line_height, base_line, g):
+    """Глиф на холсте той же геометрии, что строка лейбла с этим шрифтом."""
+    adv = (g.adv_w + 15) // 16
+    x0 = max(g.ofs_x, 0)
+    y0 = max(line_height - base_line - g.box_h - g.ofs_y, 0)
+    w = max(adv, x0 + g.box_w)
+    h = max(line_height, y0 + g.box_h)
+    img = bytearray(w * h)
+    for y in range(g.box_h):
+        row = (y0 + y) * w + x0
+        img[row:row + g.box_w] = g.alpha[y * g.box_w:(y + 1) * g.box_w]
+    return w, h, img
+
+
+def c_array(data, indent="    ", per_line=16):
+    lines = []
+    for i in range(0, len(data), per_line):
+        lines.append(indent + ", ".join("0x%02x" % b
+                                        for b in data[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def write_if_changed(path, text):
+    # не трогаем mtime без нужды — иначе пересобирается весь main
+    if os.path.exists(path):
+        with open(path, encoding="utf-8") as f:
+            if f.read() == text:
+                return
+    with open(path, "w", encoding="utf-8") as f:
+        f.write(text)
+
+
+def load_fonts(fonts_dir, names):
+    fonts = {}
+    for name in names:
+        if name not in fonts:
+            fonts[name] = font_raster.Font(os.path.join(fonts_dir, name))
+    return fonts
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--fonts-dir", required=True,
+                    help="lvgl/scripts/built_in_font")
+    ap.add_argument("--out", required=True)
+    args = ap.parse_args()
+    os.makedirs(args.out, exist_ok=True)
+
+    fonts = load_fonts(args.fonts_dir, [MONTSERRAT, FONTAWESOME])
+    report = []
+
+    # ---- шрифты-подмножества ----
+    for name, size, bpp, sources in FONTS:
+        glyphs = sorted((font_raster.render(fonts[font], code, size)
+                         for font, codes in sources for code in codes),
+                        key=lambda g: g.code)
+        line_height, base_line = font_raster.line_metrics(
+            [fonts[font] for font, _ in sources], size)
+        src, nbytes = font_source(name, size, bpp, glyphs, line_height,
+                                  base_line)
+        write_if_changed(os.path.join(args.out, name + ".c"), src)
+        report.append("%s: %d glyphs, %d B bitmap" %
+                      (name, len(glyphs), nbytes))
+
+    # ---- иконки A8 ----
+    fa = fonts[FONTAWESOME]
+    line_height, base_line = font_raster.line_metrics([fa], ICON_SIZE)
+    out = [HEADER, '#include "ui_assets.h"', ""]
+    total = 0
+    for name, code in ICONS:
+        g = font_raster.render(fa, code, ICON_SIZE)
+        w, h, img = compose_icon(line_height, base_line, g)
+        total += len(img)
+        out += ["static LV_ATTRIBUTE_LARGE_CONST const uint8_t %s_map[] = {" %
+                name, c_array(img), "};", "",
+                "const lv_image_dsc_t %s = {" % name,
+                "    .header = {",
+                "        .magic = LV_IMAGE_HEADER_MAGIC,",
+                "        .cf = LV_COLOR_FORMAT_A8,",
+                "        .w = %d," % w,
+                "        .h = %d," % h,
+                "        .stride = %d," % w,
+                "    },",
+                "    .data_size = sizeof(%s_map)," % name,
+                "    .data = %s_map," % name,
+                "};", ""]
+    write_if_changed(os.path.join(args.out, "ui_icons.c"), "\n".join(out))
+    report.append("icons: %d x A8 %dpx, %d B" %
+                  (len(ICONS), ICON_SIZE, total))
+
+    hdr = [HEADER, "#pragma once", '#include "lvgl.h"', ""]
+    hdr += ["LV_FONT_DECLARE(%s)" % name for name, *_ in FONTS]
+    hdr += [""] + ["LV_IMAGE_DECLARE(%s);" % name for name, _ in ICONS]
+    hdr += [""] + ["// " + line for line in report] + [""]
+    write_if_changed(os.path.join(args.out, "ui_assets.h"), "\n".join(hdr))
+
+    for line in report:
+        print("ui_assets: " + line)
+
+
+if __name__ == "__main__":
+    try:
+        main()
+    except (OSError, ValueError) as e:
+        sys.exit("gen_assets: %s" % e)
@@ -0,0 +1,37 @@
+# Шрифты-подмножества и иконки UI (gen_assets.py), генерируются при сборке.
+# Общий для прошивки (main/CMakeLists.txt) и хостовой сборки (host/).
+#
+#   ui_assets_generate(<out_dir> <fonts_dir> <srcs_var>)
+#
+# fonts_dir — lvgl/scripts/built_in_font (Montserrat + FontAwesome, те же
+# исходники, из которых собраны встроенные lv_font_montserrat_*).
+# Python берётся из UI_ASSETS_PYTHON (в IDF — его python), иначе ищется.
+# Растеризатор свой (font_raster.py, только stdlib): Node.js и сеть не нужны.
+
+set(UI_ASSETS_DIR "${CMAKE_CURRENT_LIST_DIR}")
+
+function(ui_assets_generate out_dir fonts_dir srcs_var)
+  if(NOT UI_ASSETS_PYTHON)
+    find_package(Python3 COMPONENTS Interpreter REQUIRED)
+    set(UI_ASSETS_PYTHON "${Python3_EXECUTABLE}")
+  endif()
+  set(fonts
+    "${fonts_dir}/Montserrat-Medium.ttf"
+    "${fonts_dir}/FontAwesome5-Solid+Brands+Regular.woff")
+  foreach(f ${fonts})
+    if(NOT EXISTS "${f}")
+      message(FATAL_ERROR "ui_assets: ${f} not found")
+    endif()
+  endforeach()
+
+  set(srcs "${out_dir}/ui_font_18.c" "${out_dir}/ui_icons.c")
+  add_custom_command(
+    OUTPUT ${srcs} "${out_dir}/ui_assets.h"
+    COMMAND "${UI_ASSETS_PYTHON}" "${UI_ASSETS_DIR}/gen_assets.py"
+            --fonts-dir "${fonts_dir}" --out "${out_dir}"
+    DEPENDS "${UI_ASSETS_DIR}/gen_assets.py" "${UI_ASSETS_DIR}/font_raster.py"
+            ${fonts}
+    COMMENT "Generating UI subset fonts and icons"
+    VERBATIM)
+  set(${srcs_var} ${srcs} PARENT_SCOPE)
+endfunction()
@@ -0,0 +1,87 @@
+#include "backlight.h"
+
+#include "driver/ledc.h"
+#include "esp_log.h"
+
+static const char *TAG = "backlight";
+
+#define BL_MODE LEDC_LOW_SPEED_MODE
+#define BL_TIMER LEDC_TIMER_0
+#define BL_CHANNEL LEDC_CHANNEL_0
+// Таймер от RC_FAST (~17.5 МГц), а не от APB: при DFS частота APB
+// меняется, а в light sleep RC_FAST остаётся включённым и ШИМ не
+// прерывается. 20 кГц x 2^9 укладывается в RC_FAST, 10 бит — уже нет.
+#define BL_RES LEDC_TIMER_9_BIT
+#define BL_DUTY_MAX ((1u << 9) - 1)
+#define BL_FREQ_HZ 20000 // выше слышимого, без писка дросселя
+
+static bool s_inited = false;
+static uint8_t s_pct = 0;
+
+static uint32_t pct_to_duty(uint8_t pct) {
+  if (pct > 100)
+    pct = 100;
+  uint32_t duty = (uint32_t)pct * pct * BL_DUTY_MAX / 10000;
+  return (pct && !duty) ? 1 : duty;
+}
+
+esp_err_t backlight_init(gpio_num_t gpio, uint8_t pct) {
+  if (s_inited)
+    return ESP_ERR_INVALID_STATE;
+
+  const ledc_timer_config_t tcfg = {
+      .speed_mode = BL_MODE,
+      .duty_resolution = BL_RES,
+      .timer_num = BL_TIMER,
+      .freq_hz = BL_FREQ_HZ,
+      .clk_cfg = LEDC_USE_RC_FAST_CLK,
+  };
+  esp_err_t err = ledc_timer_config(&tcfg);
+  if (err != ESP_OK)
+    return err;
+
+  const ledc_channel_config_t ccfg = {
+      .gpio_num = gpio,
+      .speed_mode = BL_MODE,
+      .channel = BL_CHANNEL,
+      .intr_type = LEDC_INTR_DISABLE,
+      .timer_sel = BL_TIMER,
+      .duty = pct_to_duty(pct),
+      .hpoint = 0,
+      .sleep_mode = LEDC_SLEEP_MODE_KEEP_ALIVE,
+  };
+  err = ledc_channel_config(&ccfg);
+  if (err != ESP_OK)
+    return err;
+  err = ledc_fade_func_install(0);
+  if (err != ESP_OK)
+    return err;
+
+  s_pct = pct;
+  s_inited = true;
+  ESP_LOGI(TAG, "LEDC %d Hz on GPIO%d, %u%%", BL_FREQ_HZ, gpio, pct);
+  return ESP_OK;
+}
+
+esp_err_t backlight_set(uint8_t pct, uint32_t ramp_ms) {
+  if (!s_inited)
+    return ESP_ERR_INVALID_STATE;
+  if (pct > 100)
+    pct = 100;
+
+  s_pct = pct;
+
+  // драйвер LEDC сам сериализует доступ к каналу (задача LVGL, колбэки
+  // кнопок); ledc_fade_stop снимает незаконченный переход
+  ledc_fade_stop(BL_MODE, BL_CHANNEL);
+  uint32_t duty = pct_to_duty(pct);
+  if (!ramp_ms) {
+    esp_err_t err = ledc_set_duty(BL_MODE, BL_CHANNEL, duty);
+    return err == ESP_OK ? ledc_update_duty(BL_MODE, BL_CHANNEL) : err;
+  }
+  esp_err_t err = ledc_set_fade_with_time(BL_MODE, BL_CHANNEL, duty, ramp_ms);
+  return err == ESP_OK ? ledc_fade_start(BL_MODE, BL_CHANNEL, LEDC_FADE_NO_WAIT)
+                       : err;
+}
+
+uint8_t backlight_get(void) { return s_pct; }
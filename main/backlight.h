@@ -0,0 +1,20 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "driver/gpio.h"
+#include "esp_err.h"
+
+// Подсветка дисплея через LEDC: яркость 0..100 % с плавными переходами
+// (аппаратный fade, задача не блокируется). Шкала перцептивная — duty
+// растёт квадратично, шаги 10 % на глаз примерно равные.
+
+#define BACKLIGHT_RAMP_MS 250 // типичная длительность перехода
+
+esp_err_t backlight_init(gpio_num_t gpio, uint8_t pct);
+
+// ramp_ms = 0 — сразу. Новый переход прерывает текущий.
+esp_err_t backlight_set(uint8_t pct, uint32_t ramp_ms);
+
+// Целевая яркость последнего backlight_set
+uint8_t backlight_get(void);
@@ -0,0 +1,61 @@
+#include "disp_profile.h"
+
+#include <stddef.h>
+
+#define MHZ (1000 * 1000)
+
+static const disp_profile_t s_profiles[DISP_PROFILE_COUNT] = {
+    [DISP_PROFILE_PARTIAL_20] = {.name = "partial-20",
+                                 .buf_lines = 20,
+                                 .double_buffer = true,
+                                 .pclk_hz = 40 * MHZ,
+                                 .lvgl_core = -1},
+    [DISP_PROFILE_PARTIAL_50] = {.name = "partial-50",
+                                 .buf_lines = 50,
+                                 .double_buffer = true,
+                                 .pclk_hz = 40 * MHZ,
+                                 .lvgl_core = -1},
+    [DISP_PROFILE_PARTIAL_85] = {.name = "partial-85",
+                                 .buf_lines = 85,
+                                 .double_buffer = true,
+                                 .pclk_hz = 40 * MHZ,
+                                 .lvgl_core = -1},
+    // 320x170x2 = 106 КБ одним куском DMA-памяти
+    [DISP_PROFILE_FULL] = {.name = "full",
+                           .buf_lines = 170,
+                           .double_buffer = false,
+                           .full_refresh = true,
+                           .pclk_hz = 40 * MHZ,
+                           .lvgl_core = -1},
+    // два полных кадра (212 КБ): LVGL сам копирует dirty-области
+    // из предыдущего буфера, по SPI уходит только изменённое
+    [DISP_PROFILE_DIRECT] = {.name = "direct",
+                             .buf_lines = 170,
+                             .double_buffer = true,
+                             .direct_mode = true,
+                             .pclk_hz = 40 * MHZ,
+                             .lvgl_core = -1},
+    [DISP_PROFILE_PARTIAL_50_CORE0] = {.name = "partial-50-core0",
+                                       .buf_lines = 50,
+                                       .double_buffer = true,
+                                       .pclk_hz = 40 * MHZ,
+                                       .lvgl_core = 0},
+    // SCLK/MOSI идут через GPIO matrix: работает не на каждой плате
+    [DISP_PROFILE_PARTIAL_50_80M] = {.name = "partial-50-80M",
+                                     .buf_lines = 50,
+                                     .double_buffer = true,
+                                     .pclk_hz = 80 * MHZ,
+                                     .lvgl_core = -1},
+};
+
+static const disp_profile_t *s_active = NULL;
+
+const disp_profile_t *disp_profile_get(disp_profile_id_t id) {
+  if (id >= DISP_PROFILE_COUNT)
+    return NULL;
+  return &s_profiles[id];
+}
+
+const disp_profile_t *disp_profile_active(void) { return s_active; }
+
+void disp_profile_set_active(const disp_profile_t *p) { s_active = p; }
@@ -0,0 +1,38 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Профили конвейера отрисовки: размер/число буферов LVGL, режим
+// (частичный / полный кадр / direct), частота SPI и ядро задачи LVGL.
+// Какой лучше — зависит от платы, см. экран бенчмарка (ui_bench).
+
+typedef enum {
+  DISP_PROFILE_PARTIAL_20 = 0, // 2 x 320x20, минимум DMA-памяти
+  DISP_PROFILE_PARTIAL_50,     // 2 x 320x50 (стоковый)
+  DISP_PROFILE_PARTIAL_85,     // 2 x 320x85, пол-экрана
+  DISP_PROFILE_FULL,           // 1 x полный кадр, full_refresh
+  DISP_PROFILE_DIRECT,         // 2 x полный кадр, direct + синхронизация dirty-областей
+  DISP_PROFILE_PARTIAL_50_CORE0, // как стоковый, LVGL на ядре 0 (RF — на 1)
+  DISP_PROFILE_PARTIAL_50_80M,   // как стоковый, pclk 80 МГц
+  DISP_PROFILE_COUNT,
+} disp_profile_id_t;
+
+#ifndef DISP_PROFILE
+#define DISP_PROFILE DISP_PROFILE_PARTIAL_50
+#endif
+
+typedef struct {
+  const char *name;
+  uint32_t buf_lines; // высота буфера в строках экрана (ширина — hres)
+  bool double_buffer;
+  bool full_refresh;
+  bool direct_mode; // буферы обязаны быть на весь экран
+  uint32_t pclk_hz;
+  int lvgl_core; // -1 — без привязки
+} disp_profile_t;
+
+const disp_profile_t *disp_profile_get(disp_profile_id_t id);
+
+// Профиль, с которым реально поднят дисплей (после возможного отката)
+const disp_profile_t *disp_profile_active(void);
+void disp_profile_set_active(const disp_profile_t *p);
@@ -1,6 +1,7 @@
 #include "esp_check.h"
 #include "esp_log.h"
 #include "esp_pm.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/idf_additions.h"
 #include "freertos/task.h"
@@ -31,13 +32,27 @@
 #include "knob.h"
 #endif
 
-#include "bq25896.h"
-#include "bq27220.h"
-#include "cc1101.h"
-#include "cc1101_presets.h"
-#include "cc1101_regs.h"
+#include "backlight.h"
+#include "capture_store.h"
 #include "decoder.h"
-#include "rtc.h"
+#include "disp_profile.h"
+#include "i2c_bus.h"
+#include "power_governor.h"
+#include "power_history.h"
+#include "power_mgmt.h"
+#include "power_monitor.h"
+#include "rf.h"
+#include "timebase.h"
+#include "ui_assets.h"
+#include "ui_bench.h"
+#include "ui_bus.h"
+#include "ui_drive.h"
+#include "ui_latency.h"
+#include "ui_packet_list.h"
+#include "ui_power_graph.h"
+#include "ui_sleep.h"
+#include "ui_status_bar.h"
+#include "ui_waveform.h"
 
 static const char *TAG = "main";
 
@@ -54,27 +69,36 @@ static const char *TAG = "main";
 #define LCD_H_RES 170
 #define LCD_V_RES 320
 
+#define UI_SCREEN_ANIM_MS 120 // смена экранов, если профиль питания разрешает
+
 // ===== Encoder pins =====
 #define ENCODER_A GPIO_NUM_4
 #define ENCODER_B GPIO_NUM_5
 #define ENCODER_KEY GPIO_NUM_0
 #define KEY_ESC GPIO_NUM_6
 
-// ===== CC1101 pins =====
-#define PIN_CC_CS 12 // manual CS
-#define PIN_CC_GDO0 3
-#define PIN_CC_GDO2 38
+// ===== I2C (Grove): гейдж, зарядник =====
+#define PIN_NUM_I2C_SDA GPIO_NUM_8
+#define PIN_NUM_I2C_SCL GPIO_NUM_18
+
+// ===== Power =====
+// INT зарядника BQ25896 (открытый сток). Не разведён — только опрос.
+#ifndef PIN_NUM_CHG_INT
+#define PIN_NUM_CHG_INT GPIO_NUM_NC
+#endif
 
 // ===== LVGL handles =====
 static lv_display_t *s_disp = NULL;
 static lv_indev_t *s_encoder = NULL;
-
-TaskHandle_t decoder_task_handle = NULL;
+static esp_lcd_panel_io_handle_t s_panel_io = NULL;
+static esp_lcd_panel_handle_t s_panel = NULL;
 
 static button_handle_t s_esc_btn = NULL;
 // Menu data
-const char *icons[] = {LV_SYMBOL_GPS, LV_SYMBOL_WIFI, LV_SYMBOL_BLUETOOTH,
-                       LV_SYMBOL_DRIVE, LV_SYMBOL_SETTINGS};
+// иконки — A8-битмапы из main/assets (глифы LV_SYMBOL_* 48 px)
+const lv_image_dsc_t *icons[] = {&ui_icon_gps, &ui_icon_wifi,
+                                 &ui_icon_bluetooth, &ui_icon_drive,
+                                 &ui_icon_settings};
 const char *names[] = {"RF", "WiFi", "Bluetooth", "Drive", "Settings"};
 
 // Direction invert if needed
@@ -84,116 +108,22 @@ static const int invert_dir = 0;
 
 static int batt_proc = 50; // 0..100 (you will update this from your code)
 
-static void ui_set_battery_percent(int pct, bool isCharge);
+// из задачи опроса питания, на каждый снимок
+static void power_snapshot_cb(const power_snapshot_t *snap, void *ctx) {
+  (void)ctx;
+  static ui_evt_battery_t shown = {.pct = 0xFF};
 
-static void fuel_gauge_task(void *arg) {
-  (void)arg;
-  static bq27220_t bq_cfg;
-  static bq25896_t s_charger;
-  // пробуем стартовать I2C + девайс
-  if (i2c_bq27220_init(&bq_cfg) != ESP_OK) {
-    ESP_LOGE("BQ27220", "I2C init failed");
-    vTaskDelete(NULL);
-    return;
-  } else {
-    ESP_LOGI("BQ27220", "Sending Soft Reset to recalibrate SOC...");
-    bq_write_subcmd(0x0042, &bq_cfg);
-    vTaskDelay(pdMS_TO_TICKS(500)); // Даем время чипу очнуться
+  if (snap->gauge_ok) {
+    batt_proc = snap->soc_pct;
+    // ток батареи по гейджу — для оценки экономии от приглушения и сна
+    ui_sleep_power_sample(snap->current_ma);
   }
 
-  if (bq25896_init(&s_charger, bq_cfg.s_i2c_bus) != ESP_OK) {
-    ESP_LOGE("BQ25896", "I2C init failed");
-    vTaskDelete(NULL);
-    return;
-  } else {
-    ESP_LOGI(TAG, "Configuring BQ25896...");
-
-    // Используем простую проверку, чтобы не "падать"
-    if (bq25896_write_reg(&s_charger, 0x03, 0x1A) != ESP_OK)
-      ESP_LOGE(TAG, "WD fix failed");
-    if (bq25896_write_reg(&s_charger, 0x00, 0x28) != ESP_OK)
-      ESP_LOGE(TAG, "IINLIM fix failed");
-    if (bq25896_write_reg(&s_charger, 0x04, 0x10) != ESP_OK)
-      ESP_LOGE(TAG, "ICHG fix failed");
-    if (bq25896_write_reg(&s_charger, 0x06, 0x5E) != ESP_OK)
-      ESP_LOGE(TAG, "VREG fix failed");
-  }
-  // ESP_ERROR_CHECK(bq25896_init(&s_charger, bq_cfg.s_i2c_bus,
-  // BQ25896_SLAVE_ADDRESS, 400000));
-
-  bool orange;
-  bq25896_status_t st;
-
-  while (1) {
-    uint16_t soc = 0, mv = 0;
-
-    esp_err_t e1 = bq_read_u16(BQ27220_REG_SOC, &soc, &bq_cfg);
-    esp_err_t e2 = bq_read_u16(BQ27220_REG_VOLTAGE, &mv, &bq_cfg);
-
-    if (e1 == ESP_OK) {
-      int pct = (int)soc;
-      if (pct < 0)
-        pct = 0;
-      if (pct > 100)
-        pct = 100;
-      batt_proc = pct;
-    } else {
-      ESP_LOGW("BQ27220", "SOC read err: %s", esp_err_to_name(e1));
-    }
-
-    if (e2 == ESP_OK) {
-      ESP_LOGI("BQ27220", "SOC=%u%%  V=%umV", (unsigned)soc, (unsigned)mv);
-    } else {
-      ESP_LOGW("BQ27220", "V read err: %s", esp_err_to_name(e2));
-    }
-
-    uint8_t fault_reg = 0;
-    bq25896_read_reg(&s_charger, 0x0C, &fault_reg);
-    ESP_LOGI("BQ25896", "Fault Register: 0x%02X", fault_reg);
-
-    // --- СЕКЦИЯ ПОДДЕРЖАНИЯ ЗАРЯДКИ ---
-    // Каждые 2 секунды принудительно гасим Watchdog и ставим лимиты
-    // Это "костыль", который лечит любые сбросы чипа
-    bq25896_write_reg(&s_charger, 0x03, 0x1A); // WD off + Charge Enable
-    bq25896_write_reg(&s_charger, 0x00, 0x28); // IINLIM 2A
-
-    // Запускаем конверсию АЦП, чтобы видеть актуальный ток
-    // REG02: бит 7 (CONV_START)
-    uint8_t reg02 = 0;
-    bq25896_read_reg(&s_charger, 0x02, &reg02);
-    bq25896_write_reg(&s_charger, 0x02, reg02 | 0x80);
-
-    // --- СЕКЦИЯ ЧТЕНИЯ ДАННЫХ ---
-    uint16_t soc1 = 0;
-    uint16_t mv1 = 0;
-    bq25896_status_t st;
-    uint8_t ichg_raw = 0;
-
-    bq_read_u16(BQ27220_REG_SOC, &soc1, &bq_cfg);
-    bq_read_u16(BQ27220_REG_VOLTAGE, &mv1, &bq_cfg);
-    bq25896_get_status(&s_charger, &st);
-    bq25896_read_reg(&s_charger, 0x12, &ichg_raw);
-
-    uint8_t fault = 0;
-    bq25896_read_reg(&s_charger, 0x0C, &fault);
-
-    int current_ma = (ichg_raw & 0x7F) * 50;
-
-    ESP_LOGI(TAG, "SOC=%d%% V=%dmV Fault=0x%02X Current=%dmA", soc1, mv1, fault,
-             current_ma);
-
-    orange = bq25896_is_charging_active(&st);
-
-    // обновляем UI безопасно через lock
-    if (lvgl_port_lock(0)) {
-      if (bq25896_get_status(&s_charger, &st) == ESP_OK) {
-        ui_set_battery_percent(batt_proc, orange);
-      }
-
-      lvgl_port_unlock();
-    }
-
-    vTaskDelay(pdMS_TO_TICKS(2000));
+  // в UI — только изменения, без захвата lvgl_port_lock из этой задачи
+  ui_evt_battery_t b = {.pct = (uint8_t)batt_proc, .charging = snap->charging};
+  if (b.pct != shown.pct || b.charging != shown.charging) {
+    if (ui_bus_post(UI_EVT_BATTERY, &b, sizeof(b)) == ESP_OK)
+      shown = b;
   }
 }
 
@@ -213,7 +143,29 @@ static lv_indev_t *s_nav_btns = NULL; // опционально, если зах
 
 lv_indev_t *enc;
 
-static void create_beautiful_menu(void);
+// Экраны верхнего уровня: строятся один раз при первом показе и дальше
+// только переключаются через lv_screen_load, у каждого своя группа фокуса
+typedef enum {
+  UI_SCR_MENU = 0,
+  UI_SCR_RF,
+  UI_SCR_BENCH,
+  UI_SCR_WAVE,
+  UI_SCR_SETTINGS,
+  UI_SCR_POWER,
+  UI_SCR_DRIVE,
+  UI_SCR_COUNT,
+} ui_screen_id_t;
+
+typedef struct {
+  const char *name;
+  void (*build)(lv_obj_t *scr, lv_group_t *group);
+  void (*on_show)(void);
+  void (*on_hide)(void);
+  lv_obj_t *scr;
+  lv_group_t *group;
+} ui_screen_t;
+
+static void ui_show_screen(ui_screen_id_t id);
 static void ui_back_to_menu_group(void);
 static void init_esc_button(void);
 static void esc_btn_cb(void *button_handle, void *usr_data);
@@ -225,7 +177,9 @@ static void esc_btn_cb(void *button_handle, void *usr_data) {
   if (!s_in_submenu)
     return;
 
+  ui_latency_input(UI_LAT_SRC_ESC);
   if (lvgl_port_lock(0)) {
+    ui_latency_handled(UI_LAT_SRC_ESC);
     ui_back_to_menu_group();
     lvgl_port_unlock();
   }
@@ -233,12 +187,16 @@ static void esc_btn_cb(void *button_handle, void *usr_data) {
 
 // DISPLAY LED
 
-static bool s_backlight_on = true;
 static bool s_ignore_next_up = false;
+static bool s_esc_woke = false; // это нажатие разбудило экран
+
+static void esc_down_cb(void *btn_handle, void *usr_data) {
+  (void)btn_handle;
+  (void)usr_data;
 
-static inline void backlight_set(bool on) {
-  s_backlight_on = on;
-  gpio_set_level(PIN_NUM_BK_LIGHT, on ? 1 : 0);
+  s_esc_woke = ui_sleep_wake(UI_WAKE_INPUT);
+  if (s_esc_woke)
+    s_ignore_next_up = true; // нажатие только будит
 }
 
 static void esc_short_up_cb(void *btn_handle, void *usr_data) {
@@ -250,7 +208,9 @@ static void esc_short_up_cb(void *btn_handle, void *usr_data) {
     return;
   }
 
+  ui_latency_input(UI_LAT_SRC_ESC);
   if (lvgl_port_lock(0)) {
+    ui_latency_handled(UI_LAT_SRC_ESC);
     ui_back_to_menu_group();
     lvgl_port_unlock();
   }
@@ -261,7 +221,8 @@ static void esc_long_cb(void *btn_handle, void *usr_data) {
   (void)usr_data;
 
   s_ignore_next_up = true; // чтобы отпускание не сделало "назад"
-  backlight_set(!s_backlight_on); // toggle подсветки
+  if (!s_esc_woke)
+    ui_sleep_now(); // погасить экран сразу, не дожидаясь таймаута
   // esp_restart();
 }
 //---- DISPLAY LED X ----
@@ -270,6 +231,8 @@ static void init_esc_button(void) {
   static const button_gpio_config_t esc_cfg = {
       .gpio_num = KEY_ESC,
       .active_level = 0, // active-low
+      // опрос только пока кнопка нажата, иначе — пробуждение по GPIO
+      .enable_power_save = true,
   };
   static const button_config_t btn_cfg = {0};
 
@@ -283,152 +246,228 @@ static void init_esc_button(void) {
                                          NULL, esc_long_cb, NULL));
   ESP_ERROR_CHECK(iot_button_register_cb(s_esc_btn, BUTTON_PRESS_UP, NULL,
                                          esc_short_up_cb, NULL));
+  ESP_ERROR_CHECK(iot_button_register_cb(s_esc_btn, BUTTON_PRESS_DOWN, NULL,
+                                         esc_down_cb, NULL));
 }
 
-static void ui_back_to_menu_group(void) {
-  s_in_submenu = false;
+static void ui_back_to_menu_group(void) { ui_show_screen(UI_SCR_MENU); }
 
-  // убрать подменю
-  lv_obj_clean(lv_scr_act());
-
-  // восстановить меню
-  create_beautiful_menu();
+static lv_style_t s_style_focus;
+static bool s_style_focus_inited = false;
 
-  // вернуть управление энкодера меню
+static void back_to_menu_cb(lv_event_t *e) {
+  (void)e;
+  ui_show_screen(UI_SCR_MENU);
 }
 
-static lv_style_t s_style_focus;
-static bool s_style_focus_inited = false;
+static void open_settings_cb(lv_event_t *e) {
+  (void)e;
+  ui_show_screen(UI_SCR_SETTINGS);
+}
 
-static lv_obj_t *s_rf_label = NULL;
-static lv_timer_t *s_rf_timer = NULL;
+static void open_wave_cb(lv_event_t *e) {
+  (void)e;
+  ui_show_screen(UI_SCR_WAVE);
+}
 
-static void rf_screen_close(void) {
-  if (s_rf_timer) {
-    lv_timer_del(s_rf_timer);
-    s_rf_timer = NULL;
-  }
-  s_rf_label = NULL;
+static void rf_screen_build(lv_obj_t *scr, lv_group_t *group) {
+  // Заголовок
+  lv_obj_t *title = lv_label_create(scr);
+  lv_label_set_text(title, "RF");
+  lv_obj_align(title, LV_ALIGN_TOP_MID, 0, 0);
+  lv_obj_t *btn = lv_btn_create(scr);
+  lv_obj_set_size(btn, 80, 20);
+  lv_obj_align(btn, LV_ALIGN_TOP_LEFT, 3, 3);
+  lv_obj_add_event_cb(btn, back_to_menu_cb, LV_EVENT_CLICKED, NULL);
+  lv_group_add_obj(group, btn);
+
+  lv_obj_t *lbl = lv_label_create(btn);
+  lv_label_set_text(lbl, LV_SYMBOL_LEFT " Back");
+  lv_obj_center(lbl);
+
+  // Список пакетов (после кнопки — в группе идёт вторым)
+  lv_obj_t *list = ui_packet_list_create(scr, group);
+  lv_obj_align(list, LV_ALIGN_TOP_LEFT, 0, 26);
+
+  lv_obj_t *wave = lv_btn_create(scr);
+  lv_obj_set_size(wave, 80, 20);
+  lv_obj_align(wave, LV_ALIGN_TOP_RIGHT, -3, 3);
+  lv_obj_add_event_cb(wave, open_wave_cb, LV_EVENT_CLICKED, NULL);
+  lv_group_add_obj(group, wave);
+
+  lbl = lv_label_create(wave);
+  lv_label_set_text(lbl, "Wave " LV_SYMBOL_RIGHT);
+  lv_obj_center(lbl);
 }
 
-static void rf_timer_cb(lv_timer_t *t) {
-  (void)t;
-  if (!s_rf_label)
-    return;
+static void rf_screen_show(void) {
+  if (rf_start_rx() != ESP_OK)
+    ESP_LOGE(TAG, "RF receive start failed");
+  // дальше список обновляется событиями UI_EVT_PACKET
+  ui_packet_list_update();
+}
 
-  if (!last_pkt.updated)
-    return;
+static void rf_screen_hide(void) { rf_pause_rx(); }
 
-  // ---------------------------------------------------------------------------
+// Осциллограмма открывается с RF (живой захват) или с Drive (сохранённый)
+static ui_screen_id_t s_wave_back = UI_SCR_RF;
+static lv_obj_t *s_wave_back_lbl = NULL;
 
-  char hex[3 * 128 + 1]; // "AA " * 128 + '\0'
-  size_t p = 0;
+static void wave_back_cb(lv_event_t *e) {
+  (void)e;
+  ui_show_screen(s_wave_back);
+}
 
-  int n = last_pkt.len;
-  if (n < 0)
-    n = 0;
-  if (n > 128)
-    n = 128;
+static void wave_screen_build(lv_obj_t *scr, lv_group_t *group) {
+  lv_obj_t *title = lv_label_create(scr);
+  lv_label_set_text(title, "Waveform");
+  lv_obj_align(title, LV_ALIGN_TOP_MID, 0, 0);
+  lv_obj_t *btn = lv_btn_create(scr);
+  lv_obj_set_size(btn, 80, 20);
+  lv_obj_align(btn, LV_ALIGN_TOP_LEFT, 3, 3);
+  lv_obj_add_event_cb(btn, wave_back_cb, LV_EVENT_CLICKED, NULL);
+  lv_group_add_obj(group, btn);
+
+  s_wave_back_lbl = lv_label_create(btn);
+  lv_label_set_text(s_wave_back_lbl, LV_SYMBOL_LEFT " RF");
+  lv_obj_center(s_wave_back_lbl);
+
+  lv_obj_t *wave = ui_waveform_create(scr, group);
+  lv_obj_align(wave, LV_ALIGN_TOP_LEFT, 0, 30);
+}
 
-  for (int i = 0; i < n && (p + 3) < sizeof(hex); i++) {
-    p += (size_t)snprintf(hex + p, sizeof(hex) - p, "%02X ", last_pkt.data[i]);
-  }
-  hex[p] = 0;
+// захват пишется, только пока идёт приём; сохранённому приём не нужен
+static void wave_screen_show(void) {
+  bool stored = ui_waveform_is_stored();
+  lv_label_set_text(s_wave_back_lbl,
+                    stored ? LV_SYMBOL_LEFT " Drive" : LV_SYMBOL_LEFT " RF");
+  if (!stored && rf_start_rx() != ESP_OK)
+    ESP_LOGE(TAG, "RF receive start failed");
+  ui_waveform_set_visible(true);
+}
 
-  char text[700];
-  snprintf(text, sizeof(text), "Last packet: %d bytes\n%s", n, hex);
+static void wave_screen_hide(void) {
+  ui_waveform_set_visible(false);
+  if (ui_waveform_is_stored())
+    ui_waveform_close_stored();
+  else
+    rf_pause_rx();
+  s_wave_back = UI_SCR_RF;
+}
 
-  lv_label_set_text(s_rf_label, text);
+static void drive_wave_cb(const capture_index_t *e) {
+  if (ui_waveform_open_stored(e) != ESP_OK)
+    return;
+  s_wave_back = UI_SCR_DRIVE;
+  ui_show_screen(UI_SCR_WAVE);
 }
 
-static void back_to_menu_cb(lv_event_t *e) {
-  rf_screen_close();
-  lv_obj_t *scr = lv_display_get_screen_active(s_disp);
-  lv_obj_clean(scr);
-  s_in_submenu = false;
-  if (lvgl_port_lock(0)) {
-    if (decoder_task_handle != NULL) {
-        printf("DEcoder is %d\n",decoder_rmt_running);
+static void drive_screen_build(lv_obj_t *scr, lv_group_t *group) {
+  lv_obj_t *title = lv_label_create(scr);
+  lv_label_set_text(title, "Drive");
+  lv_obj_align(title, LV_ALIGN_TOP_MID, 0, 0);
+  lv_obj_t *btn = lv_btn_create(scr);
+  lv_obj_set_size(btn, 80, 20);
+  lv_obj_align(btn, LV_ALIGN_TOP_LEFT, 3, 3);
+  lv_obj_add_event_cb(btn, back_to_menu_cb, LV_EVENT_CLICKED, NULL);
+  lv_group_add_obj(group, btn);
+
+  lv_obj_t *lbl = lv_label_create(btn);
+  lv_label_set_text(lbl, LV_SYMBOL_LEFT " Back");
+  lv_obj_center(lbl);
+
+  ui_drive_set_wave_cb(drive_wave_cb);
+  ui_drive_create(scr, group);
+}
 
-      if (decoder_rmt_running) {
-        decoder_rmt_running = false;
-        printf("Decoder suspend\n");
-      }
-    }
+static void drive_screen_show(void) { ui_drive_set_visible(true); }
+static void drive_screen_hide(void) { ui_drive_set_visible(false); }
 
-    create_beautiful_menu();
+void open_rf_screen(void) {
+  if (lvgl_port_lock(0)) {
+    ui_show_screen(UI_SCR_RF);
     lvgl_port_unlock();
   }
 }
 
-void open_rf_screen(void) {
+static void bench_screen_build(lv_obj_t *scr, lv_group_t *group) {
+  lv_obj_t *title = lv_label_create(scr);
+  lv_label_set_text(title, "Display");
+  lv_obj_align(title, LV_ALIGN_TOP_MID, 0, 0);
+  lv_obj_t *btn = lv_btn_create(scr);
+  lv_obj_set_size(btn, 80, 20);
+  lv_obj_align(btn, LV_ALIGN_TOP_LEFT, 3, 3);
+  lv_obj_add_event_cb(btn, open_settings_cb, LV_EVENT_CLICKED, NULL);
+  lv_group_add_obj(group, btn);
+
+  lv_obj_t *lbl = lv_label_create(btn);
+  lv_label_set_text(lbl, LV_SYMBOL_LEFT " Back");
+  lv_obj_center(lbl);
+
+  ui_bench_create(scr, group);
+}
 
-  if (lvgl_port_lock(0)) {
+static void settings_item_cb(lv_event_t *e) {
+  ui_show_screen((ui_screen_id_t)(uintptr_t)lv_event_get_user_data(e));
+}
 
-    if (decoder_task_handle != NULL) {
-
-
-      if (!decoder_rmt_running ) {
-        decoder_rmt_running = true;
-                printf("Decoder resume\n");
-
-      }
-      } else {
-        xTaskCreatePinnedToCore(rmt_rx_loop_task, "rmt_decoder", 4096, NULL, 5,
-                                &decoder_task_handle, 1);
-                                decoder_rmt_running = true;
-                                printf("Decoder run\n");
-      }
-    
-
-    lv_obj_t *scr = lv_display_get_screen_active(s_disp);
-    lv_obj_clean(scr);
-
-    static lv_group_t *rf_group = NULL;
-
-    if (rf_group == NULL) {
-      rf_group = lv_group_create();
-      lv_group_set_default(rf_group);
-    }
-
-    // Заголовок
-    lv_obj_t *title = lv_label_create(scr);
-    lv_label_set_text(title, "RF");
-    lv_obj_align(title, LV_ALIGN_TOP_MID, 0, 0);
-    // Основной лейбл
-    s_rf_label = lv_label_create(scr);
-    lv_label_set_text(s_rf_label, "Waiting for packet...");
-    lv_obj_set_width(s_rf_label, 300);
-    lv_obj_set_style_text_font(s_rf_label, &lv_font_unscii_8, LV_PART_MAIN);
-
-    lv_label_set_long_mode(s_rf_label, LV_LABEL_LONG_WRAP);
-    lv_obj_align(s_rf_label, LV_ALIGN_TOP_LEFT, 20, 40);
-
-    lv_obj_t *btn = lv_btn_create(scr);
-    lv_obj_set_size(btn, 80, 20);
-    lv_obj_align(btn, LV_ALIGN_TOP_LEFT, 3, 3);
-    lv_obj_add_event_cb(btn, back_to_menu_cb, LV_EVENT_CLICKED, NULL);
-    lv_group_add_obj(rf_group, btn);
-
-    lv_obj_t *lbl = lv_label_create(btn);
-    lv_label_set_text(lbl, LV_SYMBOL_LEFT " Back");
+static void settings_screen_build(lv_obj_t *scr, lv_group_t *group) {
+  lv_obj_t *title = lv_label_create(scr);
+  lv_label_set_text(title, "Settings");
+  lv_obj_align(title, LV_ALIGN_TOP_MID, 0, 0);
+  lv_obj_t *btn = lv_btn_create(scr);
+  lv_obj_set_size(btn, 80, 20);
+  lv_obj_align(btn, LV_ALIGN_TOP_LEFT, 3, 3);
+  lv_obj_add_event_cb(btn, back_to_menu_cb, LV_EVENT_CLICKED, NULL);
+  lv_group_add_obj(group, btn);
+
+  lv_obj_t *lbl = lv_label_create(btn);
+  lv_label_set_text(lbl, LV_SYMBOL_LEFT " Back");
+  lv_obj_center(lbl);
+
+  static const struct {
+    const char *text;
+    ui_screen_id_t id;
+  } items[] = {
+      {LV_SYMBOL_BATTERY_FULL " Battery", UI_SCR_POWER},
+      {LV_SYMBOL_IMAGE " Display bench", UI_SCR_BENCH},
+  };
+  for (size_t i = 0; i < sizeof(items) / sizeof(items[0]); i++) {
+    lv_obj_t *item = lv_btn_create(scr);
+    lv_obj_set_size(item, 200, 32);
+    lv_obj_align(item, LV_ALIGN_TOP_MID, 0, 36 + (int32_t)i * 40);
+    lv_obj_add_event_cb(item, settings_item_cb, LV_EVENT_CLICKED,
+                        (void *)(uintptr_t)items[i].id);
+    lv_group_add_obj(group, item);
+
+    lbl = lv_label_create(item);
+    lv_label_set_text(lbl, items[i].text);
     lv_obj_center(lbl);
-
-    lv_indev_set_group(enc, rf_group);
-    lv_group_set_default(rf_group);
-
-    if (s_rf_timer) {
-      lv_timer_del(s_rf_timer);
-      s_rf_timer = NULL;
-    }
-    s_rf_timer = lv_timer_create(rf_timer_cb, 200, NULL); // 20Hz
-    s_in_submenu = true;
-    lvgl_port_unlock();
   }
 }
 
+static void power_screen_build(lv_obj_t *scr, lv_group_t *group) {
+  lv_obj_t *title = lv_label_create(scr);
+  lv_label_set_text(title, "Battery");
+  lv_obj_align(title, LV_ALIGN_TOP_MID, 0, 0);
+  lv_obj_t *btn = lv_btn_create(scr);
+  lv_obj_set_size(btn, 80, 20);
+  lv_obj_align(btn, LV_ALIGN_TOP_LEFT, 3, 3);
+  lv_obj_add_event_cb(btn, open_settings_cb, LV_EVENT_CLICKED, NULL);
+  lv_group_add_obj(group, btn);
+
+  lv_obj_t *lbl = lv_label_create(btn);
+  lv_label_set_text(lbl, LV_SYMBOL_LEFT " Back");
+  lv_obj_center(lbl);
+
+  lv_obj_t *graph = ui_power_graph_create(scr, group);
+  lv_obj_align(graph, LV_ALIGN_TOP_LEFT, 0, 30);
+}
+
+static void power_screen_show(void) { ui_power_graph_set_visible(true); }
+static void power_screen_hide(void) { ui_power_graph_set_visible(false); }
+
 static void card_clicked_cb(lv_event_t *e) {
-  lv_obj_t *card = lv_event_get_target(e);
   uintptr_t idx = (uintptr_t)lv_event_get_user_data(e);
 
   ESP_LOGI("UI", "Card %s clicked", names[idx]);
@@ -443,69 +482,21 @@ static void card_clicked_cb(lv_event_t *e) {
     //   open_bluetooth_screen();
     break;
   case 3:
-    //   open_drive_screen();
+    ui_show_screen(UI_SCR_DRIVE);
     break;
   case 4:
-    //   open_settings_screen();
+    ui_show_screen(UI_SCR_SETTINGS);
     break;
   default:
     ESP_LOGW("UI", "Unknown card index %u", (unsigned)idx);
     break;
   }
-  // TODO: тут переключение экранов / открытие меню / вызов функции
-  // open_rf_screen(); / open_wifi_screen(); / open_settings_screen();
-}
-
-// Add these globals somewhere near your other UI globals
-static lv_obj_t *s_batt_label = NULL;
-
-//-- time
-
-static lv_obj_t *s_time_label = NULL;
-static lv_timer_t *s_time_timer = NULL;
-
-// Simple battery glyph: 0..10 bars inside [..........]
-// You can replace this with LV_SYMBOL_BATTERY_FULL etc. later if you want.
-static const char *battery_symbol_from_percent(int pct) {
-  if (pct < 0)
-    pct = 0;
-  if (pct > 100)
-    pct = 100;
-
-  // 5 levels: empty, 1,2,3, full
-  if (pct <= 5)
-    return LV_SYMBOL_BATTERY_EMPTY;
-  if (pct <= 25)
-    return LV_SYMBOL_BATTERY_1;
-  if (pct <= 50)
-    return LV_SYMBOL_BATTERY_2;
-  if (pct <= 75)
-    return LV_SYMBOL_BATTERY_3;
-  return LV_SYMBOL_BATTERY_FULL;
-}
-
-static void ui_set_battery_percent(int pct, bool isCharge) {
-  if (!s_batt_label)
-    return;
-  lv_label_set_text(s_batt_label, battery_symbol_from_percent(pct));
-  lv_obj_set_style_text_color(
-      s_batt_label, isCharge ? lv_color_hex(0xA5FF00) : lv_color_white(), 0);
 }
 
 lv_obj_t *cont;
 // ------------------------------------------------MENU
 // CREATION---------------------------------------------------------------------------------
-static void create_beautiful_menu(void) {
-  lv_obj_t *scr = lv_display_get_screen_active(s_disp);
-  lv_obj_set_style_bg_color(scr, lv_color_hex(0x000000), 0);
-  lv_obj_set_style_bg_opa(scr, LV_OPA_COVER, 0);
-  static lv_group_t *menu_group = NULL;
-
-  if (menu_group == NULL) {
-    menu_group = lv_group_create();
-    lv_group_set_default(menu_group);
-  }
-
+static void create_beautiful_menu(lv_obj_t *scr, lv_group_t *menu_group) {
   const lv_coord_t view_w = 320;
   const lv_coord_t view_h = 170;
 
@@ -546,17 +537,7 @@ static void create_beautiful_menu(void) {
 
   // focus_style_init_once();
 
-  // ---------------- Battery (top-right) ----------------
-  // Put it on SCR so it doesn't move when cont scrolls
-  s_batt_label = lv_label_create(scr);
-  lv_obj_set_style_text_color(s_batt_label, lv_color_white(), 0);
-  lv_obj_align(s_batt_label, LV_ALIGN_TOP_RIGHT, 0, 4);
-  ui_set_battery_percent(batt_proc, false); // initial draw
-  lv_obj_set_style_text_font(s_batt_label, &lv_font_montserrat_18, 0);
-
-  // ---------------- Time (top-center) ----------------
-  // ui_time_init(scr);
-  // -----------------------------------------------------
+  // батарея и часы — в статус-баре на lv_layer_top (ui_status_bar)
 
   lv_obj_t *first_card = NULL;
 
@@ -588,13 +569,13 @@ static void create_beautiful_menu(void) {
     lv_obj_add_style(card, &style_card_common, 0);
 
     // content
-    lv_obj_t *lbl_icon = lv_label_create(card);
-    lv_label_set_text(lbl_icon, icons[i]);
-    lv_obj_set_style_text_font(lbl_icon, &lv_font_montserrat_48,
-                               LV_PART_MAIN | LV_STATE_DEFAULT);
-    lv_obj_set_style_text_color(lbl_icon, colors[i],
-                                LV_PART_MAIN | LV_STATE_DEFAULT);
-    lv_obj_align(lbl_icon, LV_ALIGN_TOP_MID, 0, 14);
+    lv_obj_t *img_icon = lv_image_create(card);
+    lv_image_set_src(img_icon, icons[i]);
+    lv_obj_set_style_image_recolor(img_icon, colors[i],
+                                   LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_set_style_image_recolor_opa(img_icon, LV_OPA_COVER,
+                                       LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_align(img_icon, LV_ALIGN_TOP_MID, 0, 14);
 
     lv_obj_t *lbl_name = lv_label_create(card);
     lv_label_set_text(lbl_name, names[i]);
@@ -614,8 +595,102 @@ static void create_beautiful_menu(void) {
   if (first_card) {
     lv_group_focus_obj(first_card);
   }
-  lv_indev_set_group(enc, menu_group);
-  lv_group_set_default(menu_group);
+}
+
+// ------------------------- Screens -------------------------
+
+static ui_screen_t s_screens[UI_SCR_COUNT] = {
+    [UI_SCR_MENU] = {.name = "menu", .build = create_beautiful_menu},
+    [UI_SCR_RF] = {.name = "rf",
+                   .build = rf_screen_build,
+                   .on_show = rf_screen_show,
+                   .on_hide = rf_screen_hide},
+    [UI_SCR_BENCH] = {.name = "bench",
+                      .build = bench_screen_build,
+                      .on_hide = ui_bench_stop},
+    [UI_SCR_WAVE] = {.name = "wave",
+                     .build = wave_screen_build,
+                     .on_show = wave_screen_show,
+                     .on_hide = wave_screen_hide},
+    [UI_SCR_SETTINGS] = {.name = "settings", .build = settings_screen_build},
+    [UI_SCR_POWER] = {.name = "power",
+                      .build = power_screen_build,
+                      .on_show = power_screen_show,
+                      .on_hide = power_screen_hide},
+    [UI_SCR_DRIVE] = {.name = "drive",
+                      .build = drive_screen_build,
+                      .on_show = drive_screen_show,
+                      .on_hide = drive_screen_hide},
+};
+static ui_screen_id_t s_cur_screen = UI_SCR_COUNT;
+static int64_t s_switch_t0 = 0; // начало переключения, до первой отрисовки
+
+static uint32_t lv_heap_used(lv_mem_monitor_t *m) {
+  lv_mem_monitor(m);
+  return (uint32_t)(m->total_size - m->free_size);
+}
+
+// Контекст LVGL. Время считается до конца первой отрисовки нового экрана
+// (см. ui_switch_drawn_cb), в лог идёт и рост кучи LVGL.
+static void ui_show_screen(ui_screen_id_t id) {
+  if (id >= UI_SCR_COUNT || id == s_cur_screen)
+    return;
+
+  ui_screen_t *s = &s_screens[id];
+  int64_t t0 = esp_timer_get_time();
+  lv_mem_monitor_t mon;
+  uint32_t used0 = lv_heap_used(&mon);
+
+  bool built = false;
+  if (!s->scr) {
+    s->scr = lv_obj_create(NULL);
+    lv_obj_set_style_bg_color(s->scr, lv_color_hex(0x000000), 0);
+    lv_obj_set_style_bg_opa(s->scr, LV_OPA_COVER, 0);
+    s->group = lv_group_create();
+    // кнопки сами попадают в группу по умолчанию — пусть это будет своя
+    lv_group_set_default(s->group);
+    s->build(s->scr, s->group);
+    built = true;
+  }
+
+  if (s_cur_screen < UI_SCR_COUNT && s_screens[s_cur_screen].on_hide)
+    s_screens[s_cur_screen].on_hide();
+
+  lv_obj_t *old = lv_screen_active();
+  // стартовый экран — без анимации (старый удаляется сразу); дальше — по
+  // профилю power_governor
+  if (s_cur_screen == UI_SCR_COUNT || !power_governor_profile()->anims)
+    lv_screen_load(s->scr);
+  else
+    lv_screen_load_anim(s->scr, LV_SCREEN_LOAD_ANIM_FADE_IN, UI_SCREEN_ANIM_MS,
+                        0, false);
+  // стартовый пустой экран LVGL больше не нужен
+  if (s_cur_screen == UI_SCR_COUNT && old && old != s->scr)
+    lv_obj_delete(old);
+
+  lv_indev_set_group(enc, s->group);
+  lv_group_set_default(s->group);
+  s_cur_screen = id;
+  s_in_submenu = (id != UI_SCR_MENU);
+
+  if (s->on_show)
+    s->on_show();
+
+  uint32_t used1 = lv_heap_used(&mon);
+  s_switch_t0 = t0;
+  ESP_LOGI("UI", "screen %s %s: %lld us, lv heap %lu -> %lu B, frag %u%%",
+           s->name, built ? "built" : "cached",
+           (long long)(esp_timer_get_time() - t0),
+           (unsigned long)used0, (unsigned long)used1, mon.frag_pct);
+}
+
+static void ui_switch_drawn_cb(lv_event_t *e) {
+  (void)e;
+  if (!s_switch_t0)
+    return;
+  ESP_LOGI("UI", "screen switch drawn in %lld us",
+           (long long)(esp_timer_get_time() - s_switch_t0));
+  s_switch_t0 = 0;
 }
 
 // ------------------------- MENU CREATION
@@ -707,11 +782,8 @@ static void create_beautiful_menu(void) {
 
 // ------------------------- Display init (ваш код) -------------------------
 static void init_display(void) {
-  gpio_config_t bk_gpio_config = {};
-  bk_gpio_config.pin_bit_mask = 1ULL << PIN_NUM_BK_LIGHT;
-  bk_gpio_config.mode = GPIO_MODE_OUTPUT;
-  gpio_config(&bk_gpio_config);
-  gpio_set_level((gpio_num_t)PIN_NUM_BK_LIGHT, 1);
+  // подсветка погашена до первого кадра, включает ui_sleep_init
+  ESP_ERROR_CHECK(backlight_init(PIN_NUM_BK_LIGHT, 0));
 
   spi_bus_config_t buscfg = {};
   buscfg.mosi_io_num = PIN_NUM_MOSI;
@@ -723,14 +795,24 @@ static void init_display(void) {
   ESP_ERROR_CHECK(spi_bus_initialize(LCD_HOST, &buscfg, SPI_DMA_CH_AUTO));
 }
 
+static uint32_t lv_tick_from_esp_timer(void) {
+  return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
 static void init_panel(void) {
+  const disp_profile_t *prof = disp_profile_get(DISP_PROFILE);
+  const disp_profile_t *fallback = disp_profile_get(DISP_PROFILE_PARTIAL_50);
+  if (!prof)
+    prof = fallback;
+  ESP_LOGI(TAG, "Display profile: %s", prof->name);
+
   esp_lcd_panel_io_handle_t io_handle = NULL;
 
   vTaskDelay(pdMS_TO_TICKS(5));
   esp_lcd_panel_io_spi_config_t io_config = {};
   io_config.dc_gpio_num = PIN_NUM_DC;
   io_config.cs_gpio_num = PIN_NUM_CS;
-  io_config.pclk_hz = 40 * 1000 * 1000;
+  io_config.pclk_hz = prof->pclk_hz;
   io_config.lcd_cmd_bits = 8;
   io_config.lcd_param_bits = 8;
   io_config.spi_mode = 0;
@@ -747,6 +829,8 @@ static void init_panel(void) {
   panel_config.bits_per_pixel = 16;
   ESP_ERROR_CHECK(
       esp_lcd_new_panel_st7789(io_handle, &panel_config, &panel_handle));
+  s_panel_io = io_handle;
+  s_panel = panel_handle;
   esp_lcd_panel_reset(panel_handle);
   esp_lcd_panel_init(panel_handle);
   esp_lcd_panel_invert_color(panel_handle, true);
@@ -760,43 +844,73 @@ static void init_panel(void) {
   lvgl_port_cfg_t lvgl_cfg = {
       .task_priority = 4,
       .task_stack = 12288, /* LVGL task stack size */
-      .task_affinity = -1, /* LVGL task pinned to core (-1 is no affinity) */
-      .task_max_sleep_ms = 500, /* Maximum sleep in LVGL task */
-      .timer_period_ms = 5      /* LVGL timer tick period in ms */
+      .task_affinity =
+          prof->lvgl_core, /* LVGL task pinned to core (-1 is no affinity) */
+      // задачу LVGL будят ввод, инвалидация и ui_bus; сон ограничен
+      // только ближайшим lv_timer
+      .task_max_sleep_ms = 2000, /* Maximum sleep in LVGL task */
+      // тик берётся из esp_timer (lv_tick_set_cb), периодический таймер
+      // порта больше ни на что не влияет — делаем его редким
+      .timer_period_ms = 1000 /* LVGL timer tick period in ms */
   };
   ESP_ERROR_CHECK(lvgl_port_init(&lvgl_cfg));
+  lv_tick_set_cb(lv_tick_from_esp_timer);
   // Оставляем вашу структуру (без полей, которых нет в вашем заголовке)
 
-  const lvgl_port_display_cfg_t disp_cfg = {.io_handle = io_handle,
-                                            .panel_handle = panel_handle,
-                                            .buffer_size = 320 * 50,
-                                            .double_buffer = true,
-                                            .hres = 320,
-                                            .vres = 170,
-
-                                            .monochrome = false,
-                                            .rotation =
-                                                {
-                                                    .swap_xy = true,
-                                                    .mirror_x = false,
-                                                    .mirror_y = true,
-                                                },
-                                            .flags =
-                                                {
-                                                    .buff_dma = true,
-                                                }
-
-  };
+  lvgl_port_display_cfg_t disp_cfg = {.io_handle = io_handle,
+                                      .panel_handle = panel_handle,
+                                      .buffer_size = 320 * prof->buf_lines,
+                                      .double_buffer = prof->double_buffer,
+                                      .hres = 320,
+                                      .vres = 170,
+
+                                      .monochrome = false,
+                                      .rotation =
+                                          {
+                                              .swap_xy = true,
+                                              .mirror_x = false,
+                                              .mirror_y = true,
+                                          },
+                                      .flags = {
+                                          .buff_dma = true,
+                                          .full_refresh = prof->full_refresh,
+                                          .direct_mode = prof->direct_mode,
+                                      }};
 
   s_disp = lvgl_port_add_disp(&disp_cfg);
+  if (!s_disp && prof != fallback) {
+    // полнокадровым профилям может не хватить DMA-памяти
+    ESP_LOGW(TAG, "Display profile %s failed, falling back to %s", prof->name,
+             fallback->name);
+    prof = fallback;
+    disp_cfg.buffer_size = 320 * prof->buf_lines;
+    disp_cfg.double_buffer = prof->double_buffer;
+    disp_cfg.flags.full_refresh = prof->full_refresh;
+    disp_cfg.flags.direct_mode = prof->direct_mode;
+    s_disp = lvgl_port_add_disp(&disp_cfg);
+  }
   if (!s_disp) {
     ESP_LOGE(TAG, "lvgl_port_add_disp failed");
     abort();
   }
+  disp_profile_set_active(prof);
 }
 
 // ------------------------- Encoder via esp_lvgl_port 2.7.0
 // -------------------------
+static void enc_btn_latency_cb(void *btn_handle, void *usr_data) {
+  (void)btn_handle;
+  (void)usr_data;
+  ui_latency_input(UI_LAT_SRC_ENC_BTN);
+}
+
+// во сне порт не читает кнопку — будим отсюда
+static void enc_btn_wake_cb(void *btn_handle, void *usr_data) {
+  (void)btn_handle;
+  (void)usr_data;
+  ui_sleep_wake(UI_WAKE_INPUT);
+}
+
 static lv_indev_t *init_encoder_via_lvgl_port(void) {
   if (s_encoder)
     return s_encoder;
@@ -805,14 +919,25 @@ static lv_indev_t *init_encoder_via_lvgl_port(void) {
   static const button_gpio_config_t encoder_btn_gpio_cfg = {
       .gpio_num = ENCODER_KEY,
       .active_level = 0, // active-low
+      .enable_power_save = true,
       .disable_pull = true};
   const button_config_t btn_cfg = {0};
 
   button_handle_t encoder_btn_handle = NULL;
   ESP_ERROR_CHECK(iot_button_new_gpio_device(&btn_cfg, &encoder_btn_gpio_cfg,
                                              &encoder_btn_handle));
-
-  // Quadrature knob (A/B)
+  // метки времени для трассировки задержки; сами нажатия читает порт
+  iot_button_register_cb(encoder_btn_handle, BUTTON_PRESS_DOWN, NULL,
+                         enc_btn_latency_cb, NULL);
+  iot_button_register_cb(encoder_btn_handle, BUTTON_PRESS_UP, NULL,
+                         enc_btn_latency_cb, NULL);
+  iot_button_register_cb(encoder_btn_handle, BUTTON_PRESS_DOWN, NULL,
+                         enc_btn_wake_cb, NULL);
+
+  // Quadrature knob (A/B). Без enable_power_save: knob в этом режиме
+  // вешает свой обработчик GPIO на A/B, а там уже пробуждение ui_sleep.
+  // Поэтому его таймер опроса будит CPU и light sleep, пока ручка
+  // подключена, почти не наступает — экономит в основном DFS.
   const knob_config_t encoder_ab_cfg = {
       .default_direction = invert_dir ? 1 : 0,
       .gpio_encoder_a = ENCODER_A,
@@ -834,20 +959,59 @@ static lv_indev_t *init_encoder_via_lvgl_port(void) {
   return s_encoder;
 }
 
+// для сырых захватов: частота радио, с которого они пришли
+static uint32_t radio_freq_hz(uint8_t radio_id) {
+  rf_radio_t *r = rf_radio(radio_id);
+  return r && r->cfg ? r->cfg->freq_hz : 0;
+}
+
 // ------------------------- app_main -------------------------
 void app_main(void) {
+  // DFS и light sleep — до создания задач, блокировки берут все дальше
+  static const power_mgmt_cfg_t pm_cfg = {
+      .max_mhz = POWER_MGMT_MAX_MHZ,
+      .min_mhz = POWER_MGMT_MIN_MHZ,
+      .light_sleep = true,
+  };
+  power_mgmt_init(&pm_cfg); // без CONFIG_PM_ENABLE — постоянная частота
 
-  set_time_to_2026_01_13_17_00_local();
+  // настенное время: RTC-память / NVS / по умолчанию, до первых меток
+  if (timebase_init() != ESP_OK)
+    ESP_LOGE(TAG, "Timebase init failed");
   init_display();
   init_panel();
 
   init_esc_button();
   // lv_timer_set_period(s_disp->refr_timer, 10);
 
+  // до экранов: таймер часов статус-бара шлёт UI_EVT_CLOCK с первой минуты.
+  // Диспетчер читает подписки под lvgl_port_lock — как и пишут их ниже.
+  ESP_ERROR_CHECK(ui_bus_init(4, tskNO_AFFINITY));
+
   if (lvgl_port_lock(0)) {
     // 1) Create LVGL objects
     enc = init_encoder_via_lvgl_port();
-    create_beautiful_menu();
+    lv_display_add_event_cb(s_disp, ui_switch_drawn_cb, LV_EVENT_REFR_READY,
+                            NULL);
+    power_mgmt_attach_display(s_disp);
+    ui_bench_init(s_disp);
+    ui_latency_init(s_disp, enc, s_panel_io);
+    ui_status_bar_create(s_disp, batt_proc);
+    ui_show_screen(UI_SCR_MENU);
+
+    const ui_sleep_cfg_t sleep_cfg = {
+        .disp = s_disp,
+        .encoder = enc,
+        .panel = s_panel,
+        .knob_a = ENCODER_A,
+        .knob_b = ENCODER_B,
+        .dim_ms = UI_SLEEP_DIM_MS,
+        .sleep_ms = UI_SLEEP_OFF_MS,
+        .active_pct = 100,
+        .dim_pct = 20,
+        .wake_on_rf = true,
+    };
+    ESP_ERROR_CHECK(ui_sleep_init(&sleep_cfg));
 
     // 2) Add encoder indev and bind to group (ONE time)
 
@@ -857,41 +1021,50 @@ void app_main(void) {
   ESP_LOGI(TAG, "LVGL Setup Complete");
 
   // -------- CC1101 ----------
-  cc1101_power_on(true);
-
-  cc1101_t cc;
-  cc1101_cfg_t cccfg = {
-      .host = LCD_HOST,
-      .pin_cs = PIN_CC_CS,
-      .clock_hz = 2 * 1000 * 1000,
+  if (rf_init(LCD_HOST) != ESP_OK)
+    ESP_LOGE(TAG, "No CC1101 radio found");
+  if (ui_packet_list_init() != ESP_OK)
+    ESP_LOGE(TAG, "Packet history init failed");
+  if (ui_waveform_init() != ESP_OK)
+    ESP_LOGE(TAG, "Waveform init failed");
+  if (ui_power_graph_init() != ESP_OK)
+    ESP_LOGE(TAG, "Power graph init failed");
+  // пакеты и сырые захваты на флеш; поток и захват поднимет rf_start_rx
+  static const capture_store_cfg_t store_cfg = {
+      .prio = 2, // ниже UI: запись подождёт
+      .core = 0,
+      .radio_freq_hz = radio_freq_hz,
   };
-  ESP_ERROR_CHECK(cc1101_init_dev(&cc, &cccfg));
-
-  ESP_ERROR_CHECK(cc1101_strobe(&cc, CC1101_SRES));
-  vTaskDelay(pdMS_TO_TICKS(5));
-
-  uint8_t part = 0, ver = 0, marc = 0;
-  ESP_ERROR_CHECK(cc1101_read_status(&cc, CC1101_PARTNUM, &part));
-  ESP_ERROR_CHECK(cc1101_read_status(&cc, CC1101_VERSION, &ver));
-  ESP_ERROR_CHECK(cc1101_read_status(&cc, CC1101_MARCSTATE, &marc));
-  ESP_LOGI(TAG, "CC1101 PART=0x%02X VER=0x%02X MARC=0x%02X", part, ver, marc);
-
-  ESP_ERROR_CHECK(cc1101_apply_preset_pairs_then_patable(
-      &cc, subghz_device_cc1101_preset_2fsk_dev12khz_async_regs));
-  vTaskDelay(pdMS_TO_TICKS(40));
-  ESP_ERROR_CHECK(cc1101_set_freq_hz(&cc, 314350000UL)); // 314.35 MHz
-  vTaskDelay(pdMS_TO_TICKS(40));
-  ESP_ERROR_CHECK(cc1101_enter_rx(&cc));
-  vTaskDelay(pdMS_TO_TICKS(40));
-
-  // xTaskCreatePinnedToCore(
-  //     fuel_gauge_task,
-  //     "fuel_gauge",
-  //     4096,
-  //     NULL,
-  //     5,
-  //     NULL,
-  //     0);
+  if (capture_store_init(&store_cfg) != ESP_OK)
+    ESP_LOGE(TAG, "Capture store init failed");
+
+  // исполнитель I2C выше пользователей шины (опрос питания — 5)
+  static const i2c_bus_config_t i2c_cfg = {
+      .sda = PIN_NUM_I2C_SDA,
+      .scl = PIN_NUM_I2C_SCL,
+      .internal_pullup = false, // обычно внешние подтяжки на Grove уже есть
+      .task_prio = 6,
+      .task_core = 0,
+  };
+  if (i2c_bus_init(&i2c_cfg) != ESP_OK)
+    ESP_LOGE(TAG, "I2C bus init failed");
+
+  // батарея в статус-бар + ток для статистики сна дисплея
+  ESP_ERROR_CHECK(power_monitor_subscribe(power_snapshot_cb, NULL));
+  // история в RTC-памяти: восстановить до первого снимка
+  if (power_history_init() != ESP_OK)
+    ESP_LOGE(TAG, "Power history init failed");
+  // профили производительности по SOC / току / внешнему питанию
+  if (power_governor_init(s_disp) != ESP_OK)
+    ESP_LOGE(TAG, "Power governor init failed");
+  static const power_monitor_cfg_t power_cfg = {
+      .period_ms = POWER_MONITOR_PERIOD_MS,
+      .chg_int_gpio = PIN_NUM_CHG_INT,
+      .prio = 5,
+      .core = 0,
+  };
+  if (power_monitor_start(&power_cfg) != ESP_OK)
+    ESP_LOGE(TAG, "Power monitor start failed");
 
   // ESP_LOGI(TAG, "Decoder task started");
 }
@@ -0,0 +1,265 @@
+#include "power_governor.h"
+
+#include <stdio.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+#include "power_mgmt.h"
+#include "power_monitor.h"
+#include "ui_bus.h"
+#include "ui_sleep.h"
+
+static const char *TAG = "governor";
+
+#define GOV_SETTLE_US (4000000) // гейдж усредняет ток ~1 с + период опроса
+
+static const power_profile_t s_profiles[POWER_PROFILE_COUNT] = {
+    [POWER_PROFILE_PERF] = {
+        .name = "perf",
+        .refr_ms = 33,
+        .anims = true,
+        .bl_active_pct = 100,
+        .bl_dim_pct = 20,
+        .rf_scan = RF_SCAN_CONTINUOUS,
+        .cpu_max_mhz = POWER_MGMT_MAX_MHZ,
+    },
+    [POWER_PROFILE_BALANCED] = {
+        .name = "balanced",
+        .refr_ms = 33,
+        .anims = true,
+        .bl_active_pct = 80,
+        .bl_dim_pct = 15,
+        .rf_scan = RF_SCAN_CONTINUOUS,
+        .cpu_max_mhz = POWER_MGMT_MAX_MHZ,
+    },
+    [POWER_PROFILE_SAVER] = {
+        .name = "saver",
+        .refr_ms = 50,
+        .anims = false,
+        .bl_active_pct = 55,
+        .bl_dim_pct = 10,
+        .rf_scan = RF_SCAN_DUTY,
+        .rf_on_ms = 1000,
+        .rf_off_ms = 1000,
+        .cpu_max_mhz = 80,
+    },
+    [POWER_PROFILE_CRITICAL] = {
+        .name = "critical",
+        .refr_ms = 100,
+        .anims = false,
+        .bl_active_pct = 35,
+        .bl_dim_pct = 5,
+        .rf_scan = RF_SCAN_DUTY,
+        .rf_on_ms = 500,
+        .rf_off_ms = 2000,
+        .cpu_max_mhz = 80,
+    },
+};
+
+// Пороги входа в профиль на батарее и выхода из него обратно (на уровень
+// выше). Зазор между ними — гистерезис: SOC после смены нагрузки
+// «прыгает» на пару процентов, TTE — и того больше.
+typedef struct {
+  uint8_t soc_enter;     // SOC <= — сюда
+  uint8_t soc_leave;     // SOC >= — обратно
+  uint16_t tte_enter_min; // при среднем токе разряда хватит меньше — сюда
+  uint16_t tte_leave_min; // хватит на столько — обратно; 0 — не смотреть
+} power_rule_t;
+
+static const power_rule_t s_rules[POWER_PROFILE_COUNT] = {
+    [POWER_PROFILE_SAVER] = {.soc_enter = 30,
+                             .soc_leave = 35,
+                             .tte_enter_min = 90,
+                             .tte_leave_min = 150},
+    [POWER_PROFILE_CRITICAL] = {.soc_enter = 10,
+                                .soc_leave = 15,
+                                .tte_enter_min = 30,
+                                .tte_leave_min = 50},
+};
+
+// Ток в текущем профиле. Пишет только задача опроса питания.
+typedef struct {
+  int64_t sum_ma;
+  uint32_t n;
+} gov_acc_t;
+
+static lv_display_t *s_disp = NULL;
+static volatile power_profile_id_t s_cur = POWER_PROFILE_PERF; // как на старте
+static power_profile_id_t s_soc_lvl = POWER_PROFILE_BALANCED;
+static power_profile_id_t s_tte_lvl = POWER_PROFILE_BALANCED;
+static int64_t s_since_us = 0;
+static gov_acc_t s_acc;
+
+// эффект последней смены: ток до неё, ждём POWER_GOVERNOR_EFFECT_SAMPLES
+static struct {
+  bool pending;
+  power_profile_id_t from;
+  int32_t before_ma;
+  ui_sleep_state_t disp_state;
+} s_effect;
+
+const power_profile_t *power_governor_profile(void) {
+  return &s_profiles[s_cur];
+}
+
+// ------------------------- выбор профиля -------------------------
+
+static uint16_t tte_min(const power_snapshot_t *snap) {
+  if (snap->avg_current_ma >= 0)
+    return UINT16_MAX; // не разряжается
+  uint32_t t = (uint32_t)snap->remaining_mah * 60 / -snap->avg_current_ma;
+  return t < UINT16_MAX ? (uint16_t)t : UINT16_MAX - 1;
+}
+
+// Уровень по одной величине: вниз — пока пройден порог входа следующего
+// профиля, вверх — пока пройден порог выхода текущего
+static power_profile_id_t soc_level(power_profile_id_t lvl, uint8_t soc) {
+  while (lvl + 1 < POWER_PROFILE_COUNT && soc <= s_rules[lvl + 1].soc_enter)
+    lvl++;
+  while (lvl > POWER_PROFILE_BALANCED && soc >= s_rules[lvl].soc_leave)
+    lvl--;
+  return lvl;
+}
+
+static power_profile_id_t tte_level(power_profile_id_t lvl, uint16_t tte) {
+  while (lvl + 1 < POWER_PROFILE_COUNT && s_rules[lvl + 1].tte_enter_min &&
+         tte < s_rules[lvl + 1].tte_enter_min)
+    lvl++;
+  while (lvl > POWER_PROFILE_BALANCED && s_rules[lvl].tte_leave_min &&
+         tte >= s_rules[lvl].tte_leave_min)
+    lvl--;
+  return lvl;
+}
+
+// ------------------------- применение -------------------------
+
+// Контекст LVGL (диспетчер ui_bus)
+static void profile_evt_cb(ui_evt_type_t type, const void *data, void *ctx) {
+  (void)type;
+  (void)ctx;
+  if (!data)
+    return;
+  const power_profile_t *p = &s_profiles[*(const uint8_t *)data];
+  lv_timer_t *refr = lv_display_get_refr_timer(s_disp);
+  if (refr)
+    lv_timer_set_period(refr, p->refr_ms);
+  ui_sleep_set_levels(p->bl_active_pct, p->bl_dim_pct);
+}
+
+static void fmt_avg(char *buf, size_t size, const gov_acc_t *acc) {
+  if (acc->n)
+    snprintf(buf, size, "%ld mA (n=%lu)", (long)(acc->sum_ma / acc->n),
+             (unsigned long)acc->n);
+  else
+    snprintf(buf, size, "n/a");
+}
+
+static void switch_profile(power_profile_id_t to, const power_snapshot_t *snap,
+                           uint16_t tte) {
+  power_profile_id_t from = s_cur;
+  const power_profile_t *a = &s_profiles[from];
+  const power_profile_t *b = &s_profiles[to];
+
+  char before[32];
+  fmt_avg(before, sizeof(before), &s_acc);
+  char tte_txt[16];
+  if (tte == UINT16_MAX)
+    snprintf(tte_txt, sizeof(tte_txt), "-");
+  else
+    snprintf(tte_txt, sizeof(tte_txt), "%u min", tte);
+  char rf_txt[24];
+  if (b->rf_scan == RF_SCAN_DUTY)
+    snprintf(rf_txt, sizeof(rf_txt), "duty %u/%u ms", b->rf_on_ms,
+             b->rf_off_ms);
+  else
+    snprintf(rf_txt, sizeof(rf_txt), "continuous");
+  ESP_LOGI(TAG,
+           "%s -> %s (SOC %u%%, TTE %s, %s): refresh %lu -> %lu ms, anims %s, "
+           "backlight %u/%u%%, rf %s, CPU %d -> %d MHz; before %s",
+           a->name, b->name, snap->soc_pct, tte_txt,
+           snap->power_good ? "ext power" : "battery",
+           (unsigned long)a->refr_ms, (unsigned long)b->refr_ms,
+           b->anims ? "on" : "off", b->bl_active_pct, b->bl_dim_pct, rf_txt,
+           a->cpu_max_mhz, b->cpu_max_mhz, before);
+
+  s_effect.pending = s_acc.n > 0;
+  s_effect.from = from;
+  s_effect.before_ma = s_acc.n ? (int32_t)(s_acc.sum_ma / s_acc.n) : 0;
+  s_effect.disp_state = ui_sleep_state();
+
+  s_cur = to;
+  s_since_us = esp_timer_get_time();
+  s_acc = (gov_acc_t){0};
+
+  if (b->cpu_max_mhz != a->cpu_max_mhz) {
+    esp_err_t err = power_mgmt_set_max_mhz(b->cpu_max_mhz);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) // без DFS — не в счёт
+      ESP_LOGW(TAG, "CPU cap: %s", esp_err_to_name(err));
+  }
+  rf_set_scan(b->rf_scan, b->rf_on_ms, b->rf_off_ms);
+  uint8_t id = (uint8_t)to;
+  if (ui_bus_post(UI_EVT_PROFILE, &id, sizeof(id)) != ESP_OK)
+    ESP_LOGW(TAG, "display settings not applied");
+}
+
+static void effect_check(void) {
+  if (!s_effect.pending || s_acc.n < POWER_GOVERNOR_EFFECT_SAMPLES)
+    return;
+  s_effect.pending = false;
+  int32_t after = (int32_t)(s_acc.sum_ma / s_acc.n);
+  int32_t delta = after - s_effect.before_ma; // разряд < 0: > 0 — экономия
+  // приглушение или сон экрана посреди замера меняет ток сильнее профиля
+  bool same_disp = ui_sleep_state() == s_effect.disp_state;
+  ESP_LOGI(TAG, "%s: %ld mA vs %ld mA in %s, %+ld mA%s", s_profiles[s_cur].name,
+           (long)after, (long)s_effect.before_ma,
+           s_profiles[s_effect.from].name, (long)delta,
+           same_disp ? "" : " (display state changed, not comparable)");
+}
+
+static void snapshot_cb(const power_snapshot_t *snap, void *ctx) {
+  (void)ctx;
+  if (!snap->gauge_ok)
+    return;
+
+  int64_t now = esp_timer_get_time();
+  if (snap->src == POWER_SRC_POLL && now - s_since_us >= GOV_SETTLE_US) {
+    s_acc.sum_ma += snap->current_ma;
+    s_acc.n++;
+    effect_check();
+  }
+
+  uint16_t tte = tte_min(snap);
+  power_profile_id_t target;
+  if (snap->power_good) {
+    target = POWER_PROFILE_PERF;
+  } else {
+    s_soc_lvl = soc_level(s_soc_lvl, snap->soc_pct);
+    s_tte_lvl = tte_level(s_tte_lvl, tte);
+    target = s_soc_lvl > s_tte_lvl ? s_soc_lvl : s_tte_lvl;
+  }
+  if (target == s_cur)
+    return;
+  // экономнее — сразу; обратно — если профиль продержался DWELL
+  if (target < s_cur && now - s_since_us < POWER_GOVERNOR_DWELL_MS * 1000LL)
+    return;
+  switch_profile(target, snap, tte);
+}
+
+esp_err_t power_governor_init(lv_display_t *disp) {
+  if (!disp)
+    return ESP_ERR_INVALID_ARG;
+  if (s_disp)
+    return ESP_ERR_INVALID_STATE;
+  s_disp = disp;
+  s_since_us = esp_timer_get_time();
+  esp_err_t err = ui_bus_subscribe(UI_EVT_PROFILE, profile_evt_cb, NULL);
+  if (err != ESP_OK)
+    return err;
+  err = power_monitor_subscribe(snapshot_cb, NULL);
+  if (err != ESP_OK)
+    return err;
+  ESP_LOGI(TAG, "start in %s", s_profiles[s_cur].name);
+  return ESP_OK;
+}
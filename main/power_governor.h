@@ -0,0 +1,51 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "lvgl.h"
+
+#include "rf.h"
+
+// Губернатор производительности по состоянию батареи.
+//
+// Профили и правила перехода — таблицы в power_governor.c. От внешнего
+// питания (power_good) — PERF, на батарее уровень выбирается отдельно по
+// SOC и по времени до разряда при текущем среднем токе, берётся более
+// экономный. У каждого порога свой гистерезис (порог выхода выше порога
+// входа), на более экономный профиль переходим сразу, обратно — не чаще
+// раза в POWER_GOVERNOR_DWELL_MS.
+//
+// Решение принимается в задаче опроса питания: CPU и радио переключаются
+// там же, LVGL (период обновления, анимации, подсветка) — через ui_bus.
+// Каждая смена профиля — в лог вместе со средним током до неё, через
+// POWER_GOVERNOR_EFFECT_SAMPLES опросов — ток в новом профиле и разница.
+
+#define POWER_GOVERNOR_DWELL_MS 60000
+#define POWER_GOVERNOR_EFFECT_SAMPLES 15 // ~30 с при опросе раз в 2 с
+
+typedef enum {
+  POWER_PROFILE_PERF = 0, // внешнее питание
+  POWER_PROFILE_BALANCED,
+  POWER_PROFILE_SAVER,
+  POWER_PROFILE_CRITICAL,
+  POWER_PROFILE_COUNT,
+} power_profile_id_t;
+
+typedef struct {
+  const char *name;
+  uint32_t refr_ms; // период обновления дисплея LVGL
+  bool anims;       // анимация смены экранов
+  uint8_t bl_active_pct;
+  uint8_t bl_dim_pct;
+  rf_scan_mode_t rf_scan;
+  uint16_t rf_on_ms; // RF_SCAN_DUTY: в приёме
+  uint16_t rf_off_ms; // RF_SCAN_DUTY: в IDLE
+  int cpu_max_mhz;
+} power_profile_t;
+
+// До power_monitor_start и ui_bus_init; disp — чей таймер обновления менять
+esp_err_t power_governor_init(lv_display_t *disp);
+
+// Текущий профиль (из любой задачи)
+const power_profile_t *power_governor_profile(void);
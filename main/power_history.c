@@ -0,0 +1,355 @@
+#include "power_history.h"
+
+#include <string.h>
+
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_rtc_time.h"
+#include "freertos/FreeRTOS.h"
+
+#include "power_monitor.h"
+#include "ui_bus.h"
+
+static const char *TAG = "power_hist";
+
+#define HIST_MAGIC 0x50485354u // "PHST"
+#define HIST_VERSION 1
+
+#define LEN_10S 360   // 1 ч
+#define LEN_5MIN 288  // 24 ч
+#define LEN_30MIN 336 // 7 суток
+#define HIST_ENTRIES (LEN_10S + LEN_5MIN + LEN_30MIN)
+
+// окно тренда: последние 30 мин десятисекундных точек, при нехватке —
+// сколько есть, но не меньше 5 мин
+#define TREND_MAX_PTS 180
+#define TREND_MIN_PTS 30
+#define TREND_FULL_MIN 30 // окно, с которого тренд весит полностью
+#define EST_SMOOTH_PCT 25 // доля нового значения в сглаживании
+
+typedef struct {
+  uint32_t period_s;
+  uint16_t len;
+  uint16_t offset; // начало кольца в entries
+} tier_def_t;
+
+static const tier_def_t s_tiers[POWER_HIST_TIERS] = {
+    [POWER_HIST_10S] = {10, LEN_10S, 0},
+    [POWER_HIST_5MIN] = {300, LEN_5MIN, LEN_10S},
+    [POWER_HIST_30MIN] = {1800, LEN_30MIN, LEN_10S + LEN_5MIN},
+};
+
+typedef struct {
+  uint16_t head; // следующая запись
+  uint16_t count;
+  uint32_t newest_s; // время самой новой точки, с (RTC-таймер)
+} tier_state_t;
+
+typedef struct {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t entries;
+  tier_state_t tier[POWER_HIST_TIERS];
+  uint32_t check; // сумма полей выше, обновляется с каждой точкой
+  uint32_t data[HIST_ENTRIES];
+} hist_rtc_t;
+
+RTC_NOINIT_ATTR static hist_rtc_t s_rtc;
+
+// Накопление текущей точки уровня (в RAM: незаконченная точка при
+// перезагрузке теряется, это не больше одного периода). Точки привязаны
+// к границам периода: slot = время / период.
+typedef struct {
+  int32_t soc, mv, ma, temp;
+  uint16_t n;
+  uint32_t slot;
+} acc_t;
+
+static acc_t s_acc[POWER_HIST_TIERS];
+
+static portMUX_TYPE s_est_lock = portMUX_INITIALIZER_UNLOCKED;
+static power_estimate_t s_est;
+static bool s_est_valid = false;
+
+// ------------------------- RTC-заголовок -------------------------
+
+static uint32_t header_sum(void) {
+  uint32_t sum = s_rtc.magic ^ ((uint32_t)s_rtc.version << 16) ^ s_rtc.entries;
+  for (int t = 0; t < POWER_HIST_TIERS; t++) {
+    const tier_state_t *st = &s_rtc.tier[t];
+    sum = sum * 31 + st->head;
+    sum = sum * 31 + st->count;
+    sum = sum * 31 + st->newest_s;
+  }
+  return sum;
+}
+
+static bool header_valid(uint32_t now_s) {
+  if (s_rtc.magic != HIST_MAGIC || s_rtc.version != HIST_VERSION ||
+      s_rtc.entries != HIST_ENTRIES || s_rtc.check != header_sum())
+    return false;
+  for (int t = 0; t < POWER_HIST_TIERS; t++) {
+    const tier_state_t *st = &s_rtc.tier[t];
+    if (st->head >= s_tiers[t].len || st->count > s_tiers[t].len ||
+        st->newest_s > now_s)
+      return false;
+  }
+  return true;
+}
+
+static void history_reset(void) {
+  memset(&s_rtc, 0, sizeof(s_rtc));
+  s_rtc.magic = HIST_MAGIC;
+  s_rtc.version = HIST_VERSION;
+  s_rtc.entries = HIST_ENTRIES;
+  s_rtc.check = header_sum();
+}
+
+static inline uint32_t now_s(void) {
+  return (uint32_t)(esp_rtc_get_time_us() / 1000000);
+}
+
+// ------------------------- кольца -------------------------
+
+static void tier_put(power_hist_tier_t t, uint32_t raw, uint32_t at_s) {
+  const tier_def_t *d = &s_tiers[t];
+  tier_state_t *st = &s_rtc.tier[t];
+  s_rtc.data[d->offset + st->head] = raw;
+  st->head = (uint16_t)((st->head + 1) % d->len);
+  if (st->count < d->len)
+    st->count++;
+  st->newest_s = at_s;
+  s_rtc.check = header_sum();
+}
+
+// Пропуск длиннее периода — пустые точки, чтобы ось времени не съезжала
+static void tier_fill_gap(power_hist_tier_t t, uint32_t slot) {
+  tier_state_t *st = &s_rtc.tier[t];
+  uint32_t period = s_tiers[t].period_s;
+  if (!st->count)
+    return;
+  uint32_t missed = slot - st->newest_s / period;
+  if (missed <= 1)
+    return;
+  missed--;
+  if (missed > s_tiers[t].len)
+    missed = s_tiers[t].len;
+  for (uint32_t i = 0; i < missed; i++)
+    tier_put(t, POWER_HIST_EMPTY, st->newest_s + period);
+}
+
+static power_hist_entry_t acc_entry(const acc_t *a) {
+  int32_t n = a->n;
+  int32_t mv10 = (a->mv / n - 2500) / 10;
+  int32_t ma20 = a->ma / n / 20;
+  int32_t temp = a->temp / n;
+  power_hist_entry_t e = {
+      .soc = (uint8_t)(a->soc / n),
+      .mv10 = (uint8_t)(mv10 < 0 ? 0 : mv10 > 254 ? 254 : mv10),
+      .ma20 = (int8_t)(ma20 < -127 ? -127 : ma20 > 127 ? 127 : ma20),
+      .temp_c = (int8_t)(temp < -127 ? -127 : temp > 127 ? 127 : temp),
+  };
+  return e;
+}
+
+static void estimate_update(const power_snapshot_t *snap);
+
+// Значение в уровень t. Первое значение нового интервала закрывает
+// накопленную точку: она уходит в кольцо и сама становится значением
+// уровня t + 1. true — в уровне t появилась точка.
+static bool tier_add(power_hist_tier_t t, int32_t soc, int32_t mv, int32_t ma,
+                     int32_t temp, uint32_t at_s) {
+  acc_t *a = &s_acc[t];
+  uint32_t period = s_tiers[t].period_s;
+  uint32_t slot = at_s / period;
+  bool emitted = false;
+
+  if (a->n && slot != a->slot) {
+    power_hist_entry_t e = acc_entry(a);
+    uint32_t start_s = a->slot * period;
+    tier_fill_gap(t, a->slot);
+    tier_put(t, e.raw, start_s);
+    if (t + 1 < POWER_HIST_TIERS)
+      tier_add((power_hist_tier_t)(t + 1), e.soc, power_hist_mv(e),
+               power_hist_ma(e), e.temp_c, start_s);
+    memset(a, 0, sizeof(*a));
+    emitted = true;
+  }
+
+  a->slot = slot;
+  a->soc += soc;
+  a->mv += mv;
+  a->ma += ma;
+  a->temp += temp;
+  a->n++;
+  return emitted;
+}
+
+static void on_snapshot(const power_snapshot_t *snap, void *ctx) {
+  (void)ctx;
+  if (!snap->gauge_ok || snap->src != POWER_SRC_POLL)
+    return;
+
+  if (!tier_add(POWER_HIST_10S, snap->soc_pct, snap->voltage_mv,
+                snap->current_ma, snap->temp_dc / 10, now_s()))
+    return;
+
+  estimate_update(snap);
+  ui_bus_post(UI_EVT_POWER_HIST, NULL, 0);
+}
+
+// ------------------------- оценка -------------------------
+
+// Наклон SOC (%/мин) по последним десятисекундным точкам, МНК.
+// r2 — качество прямой, 0..100.
+static bool soc_trend(float *slope, int *r2, uint16_t *window_min) {
+  uint16_t n = power_history_count(POWER_HIST_10S);
+  if (n > TREND_MAX_PTS)
+    n = TREND_MAX_PTS;
+
+  float sx = 0, sy = 0, sxx = 0, sxy = 0, syy = 0;
+  int m = 0;
+  for (uint16_t i = 0; i < n; i++) {
+    power_hist_entry_t e = power_history_at(POWER_HIST_10S, i);
+    if (e.raw == POWER_HIST_EMPTY)
+      break; // тренд — только по непрерывному куску
+    float x = -(float)i * s_tiers[POWER_HIST_10S].period_s / 60.0f;
+    float y = e.soc;
+    sx += x;
+    sy += y;
+    sxx += x * x;
+    sxy += x * y;
+    syy += y * y;
+    m++;
+  }
+  if (m < TREND_MIN_PTS)
+    return false;
+
+  float vx = m * sxx - sx * sx;
+  float vy = m * syy - sy * sy;
+  if (vx <= 0)
+    return false;
+  *slope = (m * sxy - sx * sy) / vx;
+  // SOC может не сдвинуться за всё окно — это «очень долго», а не «плохо»
+  *r2 = vy > 0 ? (int)(100.0f * (m * sxy - sx * sy) * (m * sxy - sx * sy) /
+                       (vx * vy))
+               : 100;
+  *window_min = (uint16_t)(m * s_tiers[POWER_HIST_10S].period_s / 60);
+  return true;
+}
+
+static uint16_t clamp_min(float v) {
+  if (v < 0 || v >= 0xFFFE)
+    return 0xFFFE;
+  return (uint16_t)v;
+}
+
+static uint16_t smooth(uint16_t prev, uint16_t next) {
+  if (prev == 0xFFFF || next == 0xFFFF)
+    return next;
+  return (uint16_t)((prev * (100 - EST_SMOOTH_PCT) + next * EST_SMOOTH_PCT) /
+                    100);
+}
+
+static void estimate_update(const power_snapshot_t *snap) {
+  bool charging = snap->current_ma > 0;
+  power_estimate_t est = {
+      .tte_min = 0xFFFF,
+      .ttf_min = 0xFFFF,
+      .gauge_min = 0xFFFF,
+      .trend_min = 0xFFFF,
+  };
+
+  // гейдж: его TTE/TTF, а если их нет — остаток / средний ток
+  uint16_t g = charging ? snap->ttf_min : snap->tte_min;
+  int avg = snap->avg_current_ma;
+  if (g != 0xFFFF && g != 0)
+    est.gauge_min = g;
+  else if (avg < 0 && !charging)
+    est.gauge_min = clamp_min(snap->remaining_mah * 60.0f / (float)-avg);
+  else if (avg > 0 && charging && snap->full_mah > snap->remaining_mah)
+    est.gauge_min = clamp_min((snap->full_mah - snap->remaining_mah) * 60.0f /
+                              (float)avg);
+
+  float slope;
+  int r2;
+  if (soc_trend(&slope, &r2, &est.window_min)) {
+    float left = charging ? 100.0f - snap->soc_pct : snap->soc_pct;
+    float rate = charging ? slope : -slope;
+    if (rate > 0.001f) {
+      est.trend_min = clamp_min(left / rate);
+      int w = est.window_min * 100 / TREND_FULL_MIN;
+      w = (w > 100 ? 100 : w) * r2 / 100;
+      est.trend_weight = (uint8_t)w;
+    }
+  }
+
+  uint16_t fused = est.gauge_min;
+  if (est.trend_min != 0xFFFF) {
+    if (est.gauge_min == 0xFFFF)
+      fused = est.trend_min;
+    else
+      fused = (uint16_t)(((uint32_t)est.gauge_min * (100 - est.trend_weight) +
+                          (uint32_t)est.trend_min * est.trend_weight) /
+                         100);
+  }
+
+  taskENTER_CRITICAL(&s_est_lock);
+  if (charging)
+    est.ttf_min = smooth(s_est_valid ? s_est.ttf_min : 0xFFFF, fused);
+  else
+    est.tte_min = smooth(s_est_valid ? s_est.tte_min : 0xFFFF, fused);
+  s_est = est;
+  s_est_valid = true;
+  taskEXIT_CRITICAL(&s_est_lock);
+}
+
+// ------------------------- API -------------------------
+
+esp_err_t power_history_init(void) {
+  uint32_t t = now_s();
+  if (header_valid(t)) {
+    ESP_LOGI(TAG, "restored: %u / %u / %u points, last %lu s ago",
+             s_rtc.tier[0].count, s_rtc.tier[1].count, s_rtc.tier[2].count,
+             (unsigned long)(t - s_rtc.tier[0].newest_s));
+  } else {
+    history_reset();
+    ESP_LOGI(TAG, "new history, %u B in RTC memory", (unsigned)sizeof(s_rtc));
+  }
+  return power_monitor_subscribe(on_snapshot, NULL);
+}
+
+uint16_t power_history_count(power_hist_tier_t tier) {
+  return tier < POWER_HIST_TIERS ? s_rtc.tier[tier].count : 0;
+}
+
+uint16_t power_history_capacity(power_hist_tier_t tier) {
+  return tier < POWER_HIST_TIERS ? s_tiers[tier].len : 0;
+}
+
+uint32_t power_history_period_s(power_hist_tier_t tier) {
+  return tier < POWER_HIST_TIERS ? s_tiers[tier].period_s : 0;
+}
+
+power_hist_entry_t power_history_at(power_hist_tier_t tier, uint16_t i) {
+  power_hist_entry_t e = {.raw = POWER_HIST_EMPTY};
+  if (tier >= POWER_HIST_TIERS)
+    return e;
+  const tier_def_t *d = &s_tiers[tier];
+  const tier_state_t *st = &s_rtc.tier[tier];
+  if (i >= st->count)
+    return e;
+  uint16_t idx = (uint16_t)((st->head + d->len - 1 - i) % d->len);
+  e.raw = s_rtc.data[d->offset + idx];
+  return e;
+}
+
+bool power_history_estimate(power_estimate_t *out) {
+  if (!out)
+    return false;
+  taskENTER_CRITICAL(&s_est_lock);
+  *out = s_est;
+  bool ok = s_est_valid;
+  taskEXIT_CRITICAL(&s_est_lock);
+  return ok;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+// История питания в RTC-памяти (RTC_NOINIT): переживает перезагрузку и
+// deep sleep, теряется только с питанием — тогда не сходится заголовок и
+// история начинается заново.
+//
+// Три кольца фиксированного размера, каждое следующее грубее: снимки
+// power_monitor усредняются в точку раз в 10 с, десятисекундные — в точку
+// раз в 5 мин, пятиминутные — раз в 30 мин. Точка — 4 байта (SOC,
+// напряжение, ток, температура), пропуски (устройство было выключено)
+// хранятся как пустые точки. Всего ~4 КБ.
+//
+// Поверх — оценка времени до разряда / до полного заряда: TTE/TTF гейджа
+// (по его AverageCurrent) смешивается с наклоном SOC по истории; вес
+// тренда растёт с длиной окна и качеством прямой.
+
+typedef enum {
+  POWER_HIST_10S = 0, // час
+  POWER_HIST_5MIN,    // сутки
+  POWER_HIST_30MIN,   // неделя
+  POWER_HIST_TIERS,
+} power_hist_tier_t;
+
+typedef union {
+  struct {
+    uint8_t soc;   // %
+    uint8_t mv10;  // (мВ - 2500) / 10
+    int8_t ma20;   // мА / 20, разряд < 0
+    int8_t temp_c;
+  };
+  uint32_t raw; // точка пишется одним словом — читатель не видит половину
+} power_hist_entry_t;
+
+#define POWER_HIST_EMPTY 0xFFFFFFFFu // пропуск
+
+static inline uint16_t power_hist_mv(power_hist_entry_t e) {
+  return (uint16_t)(2500 + e.mv10 * 10);
+}
+static inline int16_t power_hist_ma(power_hist_entry_t e) {
+  return (int16_t)(e.ma20 * 20);
+}
+
+typedef struct {
+  uint16_t tte_min;       // итог; 0xFFFF — не разряжается
+  uint16_t ttf_min;       // итог; 0xFFFF — не заряжается
+  uint16_t gauge_min;     // вклад гейджа (TTE или TTF по направлению)
+  uint16_t trend_min;     // вклад тренда SOC; 0xFFFF — мало данных
+  uint8_t trend_weight;   // 0..100 %
+  uint16_t window_min;    // длина окна тренда
+} power_estimate_t;
+
+// Один раз, до power_monitor_start: восстановление или сброс RTC-колец
+// и подписка на снимки
+esp_err_t power_history_init(void);
+
+// Чтение без копирования колец, из любой задачи. i = 0 — самая новая точка.
+// Пока точки читаются, новая может вытеснить старую — это лишь сдвиг
+// картинки на одну точку, каждая точка всегда целая.
+uint16_t power_history_count(power_hist_tier_t tier);
+uint16_t power_history_capacity(power_hist_tier_t tier);
+uint32_t power_history_period_s(power_hist_tier_t tier);
+power_hist_entry_t power_history_at(power_hist_tier_t tier, uint16_t i);
+
+// Последняя оценка (пересчитывается с каждой десятисекундной точкой)
+bool power_history_estimate(power_estimate_t *out);
@@ -0,0 +1,150 @@
+#include "power_mgmt.h"
+
+#include <stdio.h>
+
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+#include "power_monitor.h"
+
+static const char *TAG = "pm";
+
+#define REPORT_EVERY 30 // снимков питания между сводками (~1 мин)
+
+static bool s_enabled = false;
+static esp_pm_config_t s_pm;
+static int s_max_mhz = 0; // из power_mgmt_init
+static esp_pm_lock_handle_t s_render_lock = NULL;
+
+static bool s_render_held = false; // только задача LVGL
+static int64_t s_render_t0 = 0;
+
+// окно сводки: пишут задача LVGL и задача опроса питания — спинлок
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+typedef struct {
+  int64_t t0;
+  int64_t render_us;
+  uint32_t frames;
+  int64_t sum_ma;
+  uint32_t samples;
+} window_t;
+
+static window_t s_win;
+
+// RENDER_START .. RENDER_READY: от первого рисуемого участка до последнего
+// (с частичными буферами внутри — и ожидание отправки предыдущей полосы)
+static void render_event_cb(lv_event_t *e) {
+  bool start = lv_event_get_code(e) == LV_EVENT_RENDER_START;
+  if (start == s_render_held)
+    return;
+  int64_t now = esp_timer_get_time();
+  if (start) {
+    esp_pm_lock_acquire(s_render_lock);
+    s_render_held = true;
+    s_render_t0 = now;
+    return;
+  }
+  s_render_held = false;
+  esp_pm_lock_release(s_render_lock);
+  taskENTER_CRITICAL(&s_lock);
+  s_win.render_us += now - s_render_t0;
+  s_win.frames++;
+  taskEXIT_CRITICAL(&s_lock);
+}
+
+static void snapshot_cb(const power_snapshot_t *snap, void *ctx) {
+  (void)ctx;
+  if (!snap->gauge_ok || snap->src != POWER_SRC_POLL)
+    return;
+  taskENTER_CRITICAL(&s_lock);
+  s_win.sum_ma += snap->current_ma;
+  bool report = ++s_win.samples >= REPORT_EVERY;
+  taskEXIT_CRITICAL(&s_lock);
+  if (report)
+    power_mgmt_report();
+}
+
+esp_err_t power_mgmt_init(const power_mgmt_cfg_t *cfg) {
+  if (!cfg)
+    return ESP_ERR_INVALID_ARG;
+  s_win.t0 = esp_timer_get_time();
+  esp_err_t err = power_monitor_subscribe(snapshot_cb, NULL);
+  if (err != ESP_OK)
+    return err;
+
+  const esp_pm_config_t pm = {
+      .max_freq_mhz = cfg->max_mhz ? cfg->max_mhz : POWER_MGMT_MAX_MHZ,
+      .min_freq_mhz = cfg->min_mhz ? cfg->min_mhz : POWER_MGMT_MIN_MHZ,
+      .light_sleep_enable = cfg->light_sleep,
+  };
+  err = esp_pm_configure(&pm);
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "esp_pm_configure: %s, fixed CPU clock",
+             esp_err_to_name(err));
+    return err;
+  }
+  err = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "lvgl", &s_render_lock);
+  if (err != ESP_OK)
+    return err;
+  s_pm = pm;
+  s_max_mhz = pm.max_freq_mhz;
+  s_enabled = true;
+  ESP_LOGI(TAG, "DFS %d..%d MHz, light sleep %s", pm.min_freq_mhz,
+           pm.max_freq_mhz, pm.light_sleep_enable ? "on" : "off");
+  return ESP_OK;
+}
+
+esp_err_t power_mgmt_attach_display(lv_display_t *disp) {
+  if (!disp)
+    return ESP_ERR_INVALID_ARG;
+  if (!s_enabled)
+    return ESP_ERR_INVALID_STATE;
+  lv_display_add_event_cb(disp, render_event_cb, LV_EVENT_RENDER_START, NULL);
+  lv_display_add_event_cb(disp, render_event_cb, LV_EVENT_RENDER_READY, NULL);
+  return ESP_OK;
+}
+
+esp_err_t power_mgmt_set_max_mhz(int max_mhz) {
+  if (!s_enabled)
+    return ESP_ERR_INVALID_STATE;
+  esp_pm_config_t pm = s_pm;
+  pm.max_freq_mhz = max_mhz ? max_mhz : s_max_mhz;
+  if (pm.max_freq_mhz < pm.min_freq_mhz)
+    pm.max_freq_mhz = pm.min_freq_mhz;
+  if (pm.max_freq_mhz == s_pm.max_freq_mhz)
+    return ESP_OK;
+  esp_err_t err = esp_pm_configure(&pm);
+  if (err != ESP_OK)
+    return err;
+  s_pm = pm;
+  ESP_LOGI(TAG, "DFS %d..%d MHz", pm.min_freq_mhz, pm.max_freq_mhz);
+  return ESP_OK;
+}
+
+void power_mgmt_report(void) {
+  int64_t now = esp_timer_get_time();
+  taskENTER_CRITICAL(&s_lock);
+  window_t w = s_win;
+  s_win = (window_t){.t0 = now};
+  taskEXIT_CRITICAL(&s_lock);
+
+  int64_t window_us = now - w.t0;
+  if (window_us <= 0)
+    return;
+  char cur[24];
+  if (w.samples)
+    snprintf(cur, sizeof(cur), "%ld mA",
+             (long)(w.sum_ma / (int64_t)w.samples));
+  else
+    snprintf(cur, sizeof(cur), "n/a");
+  ESP_LOGI(TAG,
+           "%s: battery %s over %lld s, render %lu frames, CPU max %lld.%lld%%",
+           s_enabled ? "DFS" : "fixed clock", cur,
+           (long long)(window_us / 1000000), (unsigned long)w.frames,
+           (long long)(w.render_us * 100 / window_us),
+           (long long)(w.render_us * 1000 / window_us % 10));
+  if (s_enabled)
+    esp_pm_dump_locks(stdout);
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <stdbool.h>
+
+#include "esp_err.h"
+#include "lvgl.h"
+
+// Управление питанием: DFS + автоматический light sleep (esp_pm).
+//
+// Частота по умолчанию — минимальная, в паузах — light sleep. Каждый, кому
+// нужна скорость, держит блокировку esp_pm ровно на время работы:
+//   decoder   — CPU max на разбор всплеска (RMT от XTAL, DFS ему не мешает)
+//   cc1101    — APB max, пока взят cc1101_lock (цепочки SPI-транзакций)
+//   LVGL      — CPU max от начала до конца отрисовки кадра (здесь); DMA
+//               отправки держит сам драйвер SPI
+//   power_mon — без light sleep на время опроса I2C
+// Драйверы SPI, I2C, RMT и LEDC (подсветка от RC_FAST) свои блокировки
+// берут сами.
+//
+// Ток по гейджу усредняется за окно между сводками; в сводке — ещё доля
+// времени, которое отрисовка держала CPU max, и esp_pm_dump_locks.
+//
+// НЕ ИЗМЕРЕНО на плате (открытые пункты):
+//   - ток простоя до/после DFS + light sleep: средний ток из сводки при
+//     закрытом экране RF и погашенной подсветке, CONFIG_PM_ENABLE=y и n;
+//   - тайминги RMT под DFS: тот же пульт на экране RF с частотой,
+//     прыгающей 40..160 МГц, — длительности импульсов в сыром захвате и
+//     доля декодированных (AGC ok%) не должны отличаться от прогона с
+//     power_mgmt_set_max_mhz(POWER_MGMT_MIN_MHZ) и без light sleep.
+// Пока цифр нет, экономия и корректность захвата под DFS не подтверждены.
+
+#define POWER_MGMT_MAX_MHZ 160
+#define POWER_MGMT_MIN_MHZ 40 // XTAL без делителя
+
+typedef struct {
+  int max_mhz;      // 0 — POWER_MGMT_MAX_MHZ
+  int min_mhz;      // 0 — POWER_MGMT_MIN_MHZ
+  bool light_sleep; // автоматический light sleep в простое
+} power_mgmt_cfg_t;
+
+// Как можно раньше в app_main, до power_monitor_start.
+// ESP_ERR_NOT_SUPPORTED — CONFIG_PM_ENABLE выключен, всё работает на
+// постоянной частоте.
+esp_err_t power_mgmt_init(const power_mgmt_cfg_t *cfg);
+
+// Контекст LVGL: блокировка CPU max на время отрисовки кадров disp
+esp_err_t power_mgmt_attach_display(lv_display_t *disp);
+
+// Новый потолок частоты (power_governor), 0 — из power_mgmt_init. Блокировки
+// CPU_FREQ_MAX дальше поднимают частоту только до него.
+// ESP_ERR_INVALID_STATE — DFS не включён.
+esp_err_t power_mgmt_set_max_mhz(int max_mhz);
+
+// В лог: средний ток за окно, отрисовка, блокировки esp_pm
+void power_mgmt_report(void);
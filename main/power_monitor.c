@@ -0,0 +1,475 @@
+#include "power_monitor.h"
+
+#include <string.h>
+
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+
+#include "bq27220.h"
+#include "bq27220_regs.h"
+#include "i2c_bus.h"
+#include "timebase.h"
+
+static const char *TAG = "power";
+
+// блоки регистров, читаемые за опрос
+#define GAUGE_BLK0 COMMAND_TEMPERATURE // .. TimeToFull включительно
+#define GAUGE_BLK0_LEN (COMMAND_TIME_TO_FULL + 2 - COMMAND_TEMPERATURE)
+#define GAUGE_BLK1 COMMAND_STATE_OF_CHARGE // + StateOfHealth
+#define GAUGE_BLK1_LEN 4
+#define CHG_REGS 0x15 // REG00..REG14
+// по INT: статус, ошибка, VINDPM и АЦП
+#define CHG_EVT_FIRST BQ25896_REG_SYS_STATUS
+#define CHG_EVT_LEN (BQ25896_REG_ICHGR - BQ25896_REG_SYS_STATUS + 1)
+
+#define REPORT_EVERY 30 // опросов между сводками в лог
+
+// Настройки зарядника: после сброса чипа (watchdog, обрыв питания)
+// возвращаются к умолчаниям — сверяем с прочитанным блоком каждый опрос
+// и пишем только отличающиеся. mask — биты, которые сравниваем.
+typedef struct {
+  uint8_t reg;
+  uint8_t val;
+  uint8_t mask;
+  const char *name;
+} chg_setting_t;
+
+static const chg_setting_t s_chg_settings[] = {
+    {0x03, 0x1A, 0xBF, "WD/CHG_CONFIG"}, // бит 6 WD_RST сбрасывается сам
+    {0x00, 0x28, 0xFF, "IINLIM 2A"},
+    {0x04, 0x10, 0xFF, "ICHG"},
+    {0x06, 0x5E, 0xFF, "VREG"},
+};
+
+// Параметры гейджа в его памяти данных (аккумулятор платы 1300 мАч).
+// Пишутся, только если отличаются: CONFIG UPDATE с reinit пересчитывает
+// SOC, а RESET ещё и сбрасывает выученную ёмкость.
+#define BATT_DESIGN_MAH 1300
+#define BATT_DESIGN_MWH 4810 // x 3.7 В
+
+static const bq27220_dm_param_t s_gauge_params[] = {
+    {DM_GAS_GAUGING_DESIGN_CAPACITY, BATT_DESIGN_MAH, "DesignCapacity"},
+    {DM_GAS_GAUGING_DESIGN_ENERGY, BATT_DESIGN_MWH, "DesignEnergy"},
+};
+
+static bq27220_t s_gauge;
+static bool s_gauge_ready = false; // INITCOMP: SOC уже осмысленный
+static bq25896_t s_charger;
+static power_monitor_cfg_t s_cfg;
+static TaskHandle_t s_task = NULL;
+static esp_pm_lock_handle_t s_pm_lock = NULL; // без light sleep на время опроса
+static bq25896_adc_mode_t s_adc_mode = BQ25896_ADC_ONESHOT;
+static bool s_adc_mode_set = false;
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static power_snapshot_t s_snap;
+static uint32_t s_seq = 0;
+
+static volatile int64_t s_int_us = 0; // время первого необработанного INT
+
+static struct {
+  power_monitor_cb_t cb;
+  void *ctx;
+} s_subs[POWER_MONITOR_MAX_SUBS];
+static int s_sub_count = 0;
+
+static struct {
+  uint32_t polls;
+  uint32_t txns;
+  uint64_t bus_us;
+  uint32_t max_bus_us;
+  uint32_t errors;
+  uint32_t rewrites;
+  uint32_t ints;
+  uint32_t int_max_us; // INT -> снимок опубликован
+  uint64_t int_sum_us;
+  uint32_t cfg_ms;       // проверка/запись памяти данных гейджа
+  uint32_t first_soc_ms; // от загрузки до первого SOC после INITCOMP
+} s_stats;
+
+// ------------------------- разбор -------------------------
+
+static inline uint16_t le16(const uint8_t *p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static void parse_gauge(power_snapshot_t *s, const uint8_t *b0,
+                        const uint8_t *b1) {
+#define G0(cmd) le16(&b0[(cmd) - GAUGE_BLK0])
+  s->temp_dc = (int16_t)(G0(COMMAND_TEMPERATURE) - 2731); // 0.1 K
+  s->voltage_mv = G0(COMMAND_VOLTAGE);
+  s->batt_status = G0(COMMAND_BATTERY_STATUS);
+  s->current_ma = (int16_t)G0(COMMAND_CURRENT);
+  s->remaining_mah = G0(COMMAND_REMAINING_CAPACITY);
+  s->full_mah = G0(COMMAND_FULL_CHARGE_CAPACITY);
+  s->avg_current_ma = (int16_t)G0(COMMAND_AVERAGE_CURRENT);
+  s->tte_min = G0(COMMAND_TIME_TO_EMPTY);
+  s->ttf_min = G0(COMMAND_TIME_TO_FULL);
+#undef G0
+  uint16_t soc = le16(&b1[0]);
+  uint16_t soh = le16(&b1[2]);
+  s->soc_pct = (uint8_t)(soc > 100 ? 100 : soc);
+  s->soh_pct = (uint8_t)(soh > 100 ? 100 : soh);
+}
+
+// r — регистры начиная с REG0B
+static void parse_charger(power_snapshot_t *s, const uint8_t *r) {
+  bq25896_decode_status(r[0], &s->chg);
+  bq25896_decode_fault(r[BQ25896_REG_FAULT - BQ25896_REG_SYS_STATUS],
+                       &s->fault);
+  bq25896_decode_adc(&r[BQ25896_ADC_FIRST - BQ25896_REG_SYS_STATUS], &s->adc);
+  s->power_good = bq25896_is_power_present(&s->chg);
+  s->charging = bq25896_is_charging_active(&s->chg);
+}
+
+// ------------------------- опрос -------------------------
+
+// Транзакция в счёт снимка: время шины и ошибки
+static esp_err_t txn_end(power_snapshot_t *s, int64_t t0, esp_err_t err) {
+  s->bus_us += (uint16_t)(esp_timer_get_time() - t0);
+  s->txns++;
+  if (err != ESP_OK)
+    s->errors++;
+  return err;
+}
+
+static void fix_charger_settings(power_snapshot_t *s, const uint8_t *r) {
+  for (size_t i = 0; i < sizeof(s_chg_settings) / sizeof(s_chg_settings[0]);
+       i++) {
+    const chg_setting_t *c = &s_chg_settings[i];
+    if ((r[c->reg] & c->mask) == (c->val & c->mask))
+      continue;
+    uint8_t v = (uint8_t)((r[c->reg] & ~c->mask) | (c->val & c->mask));
+    int64_t t0 = esp_timer_get_time();
+    esp_err_t err = txn_end(s, t0, bq25896_write_reg(&s_charger, c->reg, v));
+    s_stats.rewrites++;
+    ESP_LOGW(TAG, "charger %s reset (REG%02X=0x%02X), rewrite: %s", c->name,
+             c->reg, r[c->reg], esp_err_to_name(err));
+  }
+}
+
+// От VBUS АЦП крутится сам; от батареи непрерывный режим зря ест ток —
+// одиночное преобразование после каждого опроса, к следующему готово
+static void adc_after_poll(power_snapshot_t *s, uint8_t reg02) {
+  bq25896_adc_mode_t want =
+      s->power_good ? BQ25896_ADC_CONTINUOUS : BQ25896_ADC_ONESHOT;
+  bool is_cont = (reg02 & BQ25896_CONV_RATE) != 0;
+  int64_t t0;
+
+  if (!s_adc_mode_set || want != s_adc_mode ||
+      is_cont != (want == BQ25896_ADC_CONTINUOUS)) {
+    t0 = esp_timer_get_time();
+    if (txn_end(s, t0, bq25896_set_adc_mode(&s_charger, want)) == ESP_OK) {
+      if (s_adc_mode_set && want != s_adc_mode)
+        ESP_LOGI(TAG, "charger ADC: %s",
+                 want == BQ25896_ADC_CONTINUOUS ? "continuous" : "one-shot");
+      s_adc_mode = want;
+      s_adc_mode_set = true;
+    }
+  }
+  if (s_adc_mode == BQ25896_ADC_ONESHOT && !(reg02 & BQ25896_CONV_START)) {
+    t0 = esp_timer_get_time();
+    txn_end(s, t0,
+            bq25896_write_reg(&s_charger, BQ25896_REG_ADC_CTRL,
+                              (reg02 & ~BQ25896_CONV_RATE) |
+                                  BQ25896_CONV_START));
+  }
+}
+
+static void poll(power_snapshot_t *s) {
+  uint8_t g0[GAUGE_BLK0_LEN], g1[GAUGE_BLK1_LEN], chg[CHG_REGS];
+
+  int64_t t0 = esp_timer_get_time();
+  // до конца инициализации гейджа (после включения или reinit) SOC и
+  // ёмкости — нули; подписчикам их не отдаём
+  if (!s_gauge_ready) {
+    uint16_t st = 0;
+    if (txn_end(s, t0, bq_read_u16(COMMAND_OPERATION_STATUS, &st,
+                                   &s_gauge)) == ESP_OK)
+      s_gauge_ready = (st & OPERATION_STATUS_INITCOMP) != 0;
+    t0 = esp_timer_get_time();
+  }
+  s->gauge_ok = s_gauge_ready &&
+                txn_end(s, t0, bq_read_block(GAUGE_BLK0, g0, sizeof(g0),
+                                             &s_gauge)) == ESP_OK;
+  if (s->gauge_ok) {
+    t0 = esp_timer_get_time();
+    s->gauge_ok = txn_end(s, t0, bq_read_block(GAUGE_BLK1, g1, sizeof(g1),
+                                               &s_gauge)) == ESP_OK;
+  }
+  if (s->gauge_ok) {
+    parse_gauge(s, g0, g1);
+    if (!s_stats.first_soc_ms) {
+      s_stats.first_soc_ms = (uint32_t)(esp_timer_get_time() / 1000);
+      ESP_LOGI(TAG, "first valid SOC %u%% at %lu ms after boot (gauge config "
+                    "%lu ms)",
+               s->soc_pct, (unsigned long)s_stats.first_soc_ms,
+               (unsigned long)s_stats.cfg_ms);
+    }
+  }
+
+  t0 = esp_timer_get_time();
+  s->charger_ok = txn_end(s, t0, bq25896_read_regs(&s_charger, 0x00, chg,
+                                                   sizeof(chg))) == ESP_OK;
+  if (s->charger_ok) {
+    parse_charger(s, &chg[BQ25896_REG_SYS_STATUS]);
+    fix_charger_settings(s, chg);
+    adc_after_poll(s, chg[BQ25896_REG_ADC_CTRL]);
+  }
+  s->timestamp_us = timebase_mono_us();
+}
+
+// По INT: только зарядник, гейдж остаётся из прошлого снимка
+static void charger_event(power_snapshot_t *s) {
+  uint8_t r[CHG_EVT_LEN];
+  int64_t t0 = esp_timer_get_time();
+  s->charger_ok = txn_end(s, t0, bq25896_read_regs(&s_charger, CHG_EVT_FIRST,
+                                                   r, sizeof(r))) == ESP_OK;
+  if (s->charger_ok)
+    parse_charger(s, r);
+  s->timestamp_us = timebase_mono_us();
+}
+
+static void publish(power_snapshot_t *s) {
+  s->seq = ++s_seq;
+  taskENTER_CRITICAL(&s_lock);
+  s_snap = *s;
+  taskEXIT_CRITICAL(&s_lock);
+
+  if (s->src == POWER_SRC_POLL)
+    s_stats.polls++;
+  s_stats.txns += s->txns;
+  s_stats.bus_us += s->bus_us;
+  if (s->bus_us > s_stats.max_bus_us)
+    s_stats.max_bus_us = s->bus_us;
+  s_stats.errors += s->errors;
+
+  for (int i = 0; i < s_sub_count; i++)
+    s_subs[i].cb(s, s_subs[i].ctx);
+}
+
+// ------------------------- INT -------------------------
+
+// Импульс 256 мкс на любое изменение REG0B/REG0C. Прерывание по уровню:
+// только уровень будит из light sleep. Пока импульс не кончился, оно
+// выключено — включает обратно задача после чтения зарядника.
+static void IRAM_ATTR chg_int_isr(void *arg) {
+  (void)arg;
+  gpio_intr_disable(s_cfg.chg_int_gpio);
+  if (!s_int_us)
+    s_int_us = esp_timer_get_time();
+  BaseType_t woken = pdFALSE;
+  xTaskNotifyFromISR(s_task, 0, eIncrement, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+static esp_err_t chg_int_init(gpio_num_t pin) {
+  gpio_config_t io = {
+      .pin_bit_mask = 1ULL << pin,
+      .mode = GPIO_MODE_INPUT,
+      .pull_up_en = GPIO_PULLUP_ENABLE, // INT — открытый сток
+      .pull_down_en = GPIO_PULLDOWN_DISABLE,
+      .intr_type = GPIO_INTR_LOW_LEVEL,
+  };
+  esp_err_t err = gpio_config(&io);
+  if (err != ESP_OK)
+    return err;
+  err = gpio_install_isr_service(0);
+  if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) // уже установлен
+    return err;
+  err = gpio_isr_handler_add(pin, chg_int_isr, NULL);
+  if (err != ESP_OK)
+    return err;
+  // без INT зарядник и так опрашивается, так что пробуждение — не повод
+  // отказываться от прерывания
+  if (gpio_wakeup_enable(pin, GPIO_INTR_LOW_LEVEL) != ESP_OK ||
+      esp_sleep_enable_gpio_wakeup() != ESP_OK)
+    ESP_LOGW(TAG, "charger INT won't wake from light sleep");
+  return ESP_OK;
+}
+
+// ------------------------- задача -------------------------
+
+static esp_err_t devices_init(void) {
+  if (!i2c_bus_ready()) {
+    ESP_LOGE(TAG, "I2C bus not initialised");
+    return ESP_ERR_INVALID_STATE;
+  }
+  esp_err_t err = i2c_bq27220_init(&s_gauge);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "BQ27220 init failed: %s", esp_err_to_name(err));
+    return err;
+  }
+  // без сброса: выученная ёмкость и SOC сохраняются, запись — только
+  // если параметры аккумулятора отличаются (новый или чистый гейдж)
+  int64_t t0 = esp_timer_get_time();
+  size_t written = 0;
+  err = bq_config_apply(s_gauge_params,
+                        sizeof(s_gauge_params) / sizeof(s_gauge_params[0]),
+                        &written, &s_gauge);
+  s_stats.cfg_ms = (uint32_t)((esp_timer_get_time() - t0) / 1000);
+  if (err != ESP_OK)
+    ESP_LOGW(TAG, "BQ27220 config: %s, running with chip defaults",
+             esp_err_to_name(err));
+  else
+    ESP_LOGI(TAG, "BQ27220 config: %u of %u parameters written, %lu ms",
+             (unsigned)written,
+             (unsigned)(sizeof(s_gauge_params) / sizeof(s_gauge_params[0])),
+             (unsigned long)s_stats.cfg_ms);
+
+  err = bq25896_init(&s_charger);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "BQ25896 init failed: %s", esp_err_to_name(err));
+    return err;
+  }
+  // настройки зарядника выставит первый же опрос (fix_charger_settings)
+
+  if (s_cfg.chg_int_gpio != GPIO_NUM_NC) {
+    err = chg_int_init(s_cfg.chg_int_gpio);
+    if (err != ESP_OK) {
+      ESP_LOGW(TAG, "charger INT on GPIO %d: %s, polling only",
+               s_cfg.chg_int_gpio, esp_err_to_name(err));
+      s_cfg.chg_int_gpio = GPIO_NUM_NC;
+    }
+  }
+  return ESP_OK;
+}
+
+static void log_snapshot(const power_snapshot_t *s) {
+  if (s->src == POWER_SRC_CHARGER_INT) {
+    ESP_LOGI(TAG, "charger INT: PG=%d chg=%d fault=0x%02X VBUS=%umV",
+             s->power_good, s->chg.chg_state, s->fault.raw, s->adc.vbus_mv);
+    return;
+  }
+  ESP_LOGI(TAG,
+           "SOC=%u%% V=%umV I=%dmA T=%d.%dC chg=%d ICHG=%umA VBUS=%umV "
+           "fault=0x%02X | %u txn %u us",
+           s->soc_pct, s->voltage_mv, s->current_ma, s->temp_dc / 10,
+           (s->temp_dc < 0 ? -s->temp_dc : s->temp_dc) % 10, s->charging,
+           s->adc.ichg_ma, s->adc.vbus_mv, s->fault.raw, s->txns, s->bus_us);
+}
+
+static void power_monitor_task(void *arg) {
+  (void)arg;
+  if (devices_init() != ESP_OK) {
+    vTaskDelete(NULL);
+    return;
+  }
+
+  const TickType_t period = pdMS_TO_TICKS(s_cfg.period_ms);
+  TickType_t next_poll = xTaskGetTickCount();
+  power_snapshot_t last = {0};
+
+  while (1) {
+    // спим до опроса или до INT
+    TickType_t now = xTaskGetTickCount();
+    TickType_t wait = (TickType_t)(next_poll - now) <= period
+                          ? (TickType_t)(next_poll - now)
+                          : 0;
+    bool irq = ulTaskNotifyTake(pdTRUE, wait) > 0;
+
+    power_snapshot_t s = last;
+    s.txns = 0;
+    s.bus_us = 0;
+    s.errors = 0;
+    // транзакции опроса идут подряд — без засыпаний между ними
+    if (s_pm_lock)
+      esp_pm_lock_acquire(s_pm_lock);
+    if (irq) {
+      int64_t t_int = s_int_us;
+      s.src = POWER_SRC_CHARGER_INT;
+      charger_event(&s);
+      publish(&s);
+      s_int_us = 0;
+      gpio_intr_enable(s_cfg.chg_int_gpio);
+      uint32_t lat = (uint32_t)(esp_timer_get_time() - t_int);
+      s_stats.ints++;
+      s_stats.int_sum_us += lat;
+      if (lat > s_stats.int_max_us)
+        s_stats.int_max_us = lat;
+    } else {
+      s.src = POWER_SRC_POLL;
+      poll(&s);
+      publish(&s);
+      next_poll = xTaskGetTickCount() + period;
+      if (s_stats.polls % REPORT_EVERY == 0) {
+        power_monitor_report();
+        i2c_bus_report();
+      }
+    }
+    if (s_pm_lock)
+      esp_pm_lock_release(s_pm_lock);
+    log_snapshot(&s);
+    last = s;
+  }
+}
+
+// ------------------------- API -------------------------
+
+esp_err_t power_monitor_start(const power_monitor_cfg_t *cfg) {
+  if (!cfg)
+    return ESP_ERR_INVALID_ARG;
+  if (s_task)
+    return ESP_ERR_INVALID_STATE;
+  s_cfg = *cfg;
+  if (!s_cfg.period_ms)
+    s_cfg.period_ms = POWER_MONITOR_PERIOD_MS;
+  // без CONFIG_PM_ENABLE — ESP_ERR_NOT_SUPPORTED, опрос без блокировки
+  if (esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "power_mon", &s_pm_lock) !=
+      ESP_OK)
+    s_pm_lock = NULL;
+  BaseType_t ok = xTaskCreatePinnedToCore(power_monitor_task, "power_mon",
+                                          4096, NULL, s_cfg.prio, &s_task,
+                                          s_cfg.core);
+  return ok == pdPASS ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t power_monitor_subscribe(power_monitor_cb_t cb, void *ctx) {
+  if (!cb)
+    return ESP_ERR_INVALID_ARG;
+  if (s_sub_count >= POWER_MONITOR_MAX_SUBS)
+    return ESP_ERR_NO_MEM;
+  s_subs[s_sub_count].cb = cb;
+  s_subs[s_sub_count].ctx = ctx;
+  s_sub_count++;
+  return ESP_OK;
+}
+
+bool power_monitor_get(power_snapshot_t *out) {
+  if (!out)
+    return false;
+  taskENTER_CRITICAL(&s_lock);
+  *out = s_snap;
+  taskEXIT_CRITICAL(&s_lock);
+  return out->seq != 0;
+}
+
+void power_monitor_report(void) {
+  uint32_t n = s_stats.polls;
+  if (!n) {
+    ESP_LOGI(TAG, "no polls yet");
+    return;
+  }
+  ESP_LOGI(TAG,
+           "%lu polls + %lu INT: %lu.%lu txn/snapshot, bus %llu us/snapshot "
+           "(max %lu), %lu errors, %lu charger rewrites, ADC %s",
+           (unsigned long)n, (unsigned long)s_stats.ints,
+           (unsigned long)(s_stats.txns / (n + s_stats.ints)),
+           (unsigned long)(s_stats.txns * 10 / (n + s_stats.ints) % 10),
+           (unsigned long long)(s_stats.bus_us / (n + s_stats.ints)),
+           (unsigned long)s_stats.max_bus_us, (unsigned long)s_stats.errors,
+           (unsigned long)s_stats.rewrites,
+           s_adc_mode == BQ25896_ADC_CONTINUOUS ? "continuous" : "one-shot");
+  if (s_stats.first_soc_ms)
+    ESP_LOGI(TAG, "boot -> first valid SOC %lu ms (gauge config %lu ms)",
+             (unsigned long)s_stats.first_soc_ms,
+             (unsigned long)s_stats.cfg_ms);
+  if (s_stats.ints)
+    ESP_LOGI(TAG, "charger INT -> snapshot: avg %llu us, max %lu us",
+             (unsigned long long)(s_stats.int_sum_us / s_stats.ints),
+             (unsigned long)s_stats.int_max_us);
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#include "bq25896.h"
+
+// Опрос питания: гейдж BQ27220 + зарядник BQ25896 на общей I2C.
+//
+// Раз в period_ms читаются блоки регистров целиком, по одной транзакции
+// на блок: у гейджа Temperature..TimeToFull и StateOfCharge..StateOfHealth,
+// у зарядника REG00..REG14 (настройки, статус, ошибки, АЦП). Из одного
+// опроса собирается снимок power_snapshot_t и публикуется целиком —
+// читатель никогда не видит SOC из одного опроса, а ток из другого.
+// Настройки зарядника перезаписываются, только если чип их сбросил.
+//
+// Изменение статуса или ошибка зарядника — импульс на его INT: задача
+// просыпается сразу, одной транзакцией читает REG0B..REG12 и публикует
+// снимок с src = POWER_SRC_CHARGER_INT, не дожидаясь опроса. АЦП зарядника
+// от VBUS работает непрерывно, от батареи — одиночными преобразованиями,
+// запускаемыми после опроса (к следующему готово).
+//
+// Гейдж при старте не сбрасывается: параметры аккумулятора в его памяти
+// данных сверяются и пишутся только при отличии (bq_config_apply). Пока
+// гейдж не закончил инициализацию (OperationStatus.INITCOMP), gauge_ok
+// в снимках false. Время от загрузки до первого SOC — в лог и в сводку.
+
+#define POWER_MONITOR_PERIOD_MS 2000
+#define POWER_MONITOR_MAX_SUBS 4
+
+typedef enum {
+  POWER_SRC_POLL = 0,
+  POWER_SRC_CHARGER_INT, // гейдж — из предыдущего опроса
+} power_src_t;
+
+typedef struct {
+  uint32_t seq; // номер снимка, 0 — снимка ещё нет
+  int64_t timestamp_us; // timebase_mono_us
+  power_src_t src;
+
+  // BQ27220
+  bool gauge_ok;
+  uint16_t voltage_mv;
+  int16_t current_ma; // со знаком, разряд < 0
+  int16_t avg_current_ma;
+  int16_t temp_dc;    // 0.1 °C
+  uint16_t remaining_mah;
+  uint16_t full_mah;
+  uint16_t tte_min;   // 0xFFFF — не разряжается
+  uint16_t ttf_min;   // 0xFFFF — не заряжается
+  uint16_t batt_status;
+  uint8_t soc_pct;
+  uint8_t soh_pct;
+
+  // BQ25896
+  bool charger_ok;
+  bool power_good;
+  bool charging; // precharge или fast charge
+  bq25896_status_t chg;
+  bq25896_fault_t fault;
+  bq25896_adc_t adc;
+
+  // цена этого снимка
+  uint8_t txns;
+  uint16_t bus_us;
+  uint8_t errors;
+} power_snapshot_t;
+
+typedef struct {
+  uint32_t period_ms;      // 0 — POWER_MONITOR_PERIOD_MS
+  gpio_num_t chg_int_gpio; // INT зарядника, GPIO_NUM_NC — только опрос
+  UBaseType_t prio;
+  BaseType_t core;
+} power_monitor_cfg_t;
+
+// Вызывается из задачи опроса после публикации снимка — не блокировать
+typedef void (*power_monitor_cb_t)(const power_snapshot_t *snap, void *ctx);
+
+// Оба чипа на общей шине (i2c_bus_init — раньше), INT и задача опроса
+esp_err_t power_monitor_start(const power_monitor_cfg_t *cfg);
+
+// Подписка — до power_monitor_start
+esp_err_t power_monitor_subscribe(power_monitor_cb_t cb, void *ctx);
+
+// Копия последнего снимка из любой задачи; false — опросов ещё не было
+bool power_monitor_get(power_snapshot_t *out);
+
+// В лог: опросов, транзакций и времени шины на опрос, ошибки, перезаписи,
+// события INT и задержка от INT до публикации
+void power_monitor_report(void);
@@ -0,0 +1,321 @@
+#include "rf.h"
+
+#include "esp_check.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "cc1101_regs.h"
+#include "decoder_capture.h"
+#include "ui_bus.h"
+
+static const char *TAG = "rf";
+
+// ===== CC1101 pins =====
+#define PIN_CC_CS 12 // manual CS
+#define PIN_CC_GDO0 3
+#define PIN_CC_GDO2 38
+#define PIN_CC_POWER_EN 15
+
+// второй модуль (RF_DUAL_RADIO): питание с общей линии, GDO2 не разведён
+#define PIN_CC2_CS 13
+#define PIN_CC2_GDO0 14
+#define PIN_CC2_GDO2 -1
+
+// Пакеты из общего потока держим столько мс, чтобы упорядочить их по времени
+#define RF_STREAM_HOLD_MS 20
+
+static const rf_radio_cfg_t s_radio_cfg[RF_RADIO_COUNT] = {
+    {
+        .name = "315",
+        .pin_cs = PIN_CC_CS,
+        .pin_gdo0 = PIN_CC_GDO0,
+        .pin_gdo2 = PIN_CC_GDO2,
+        .pin_power_en = PIN_CC_POWER_EN,
+        .freq_hz = 314350000UL, // 314.35 MHz
+        // PWM-декодер работает по огибающей — нужен OOK, а не 2-FSK
+        .preset = &cc1101_preset_am650,
+    },
+#if RF_DUAL_RADIO
+    {
+        .name = "433",
+        .pin_cs = PIN_CC2_CS,
+        .pin_gdo0 = PIN_CC2_GDO0,
+        .pin_gdo2 = PIN_CC2_GDO2,
+        .pin_power_en = -1,
+        .freq_hz = 433920000UL,
+        .preset = &cc1101_preset_am650,
+    },
+#endif
+};
+
+static rf_radio_t s_radios[RF_RADIO_COUNT];
+static bool s_rx_started = false;
+static TaskHandle_t s_agc_task = NULL;
+
+#define RF_AGC_PERIOD_MS 100
+
+// режим приёма: пишет power_governor, читает задача AGC
+static volatile rf_scan_mode_t s_scan_mode = RF_SCAN_CONTINUOUS;
+static volatile uint16_t s_scan_on_ms = 0;
+static volatile uint16_t s_scan_off_ms = 0;
+static bool s_radios_idle = false; // только задача AGC
+
+rf_radio_t *rf_radio(int idx) {
+  if (idx < 0 || idx >= RF_RADIO_COUNT)
+    return NULL;
+  return &s_radios[idx];
+}
+
+// из задачи разбора: каждый всплеск идёт в статистику AGC,
+// а FREQEST читаем сразу, пока оценка ещё относится к этому всплеску
+static void rf_burst_cb(const packet_t *pkt, size_t num_symbols, void *ctx) {
+  rf_radio_t *r = (rf_radio_t *)ctx;
+
+  // разбор положил всплеск в захват (см. process_burst) — осциллограмме
+  if (num_symbols >= 32)
+    ui_bus_post(UI_EVT_CAPTURE, NULL, 0);
+
+  if (r->agc_ready)
+    cc1101_agc_note_burst(&r->agc, pkt->len > 0);
+
+  if (r->foc_ready && pkt->len > 0) {
+    size_t n = pkt->len < (int)sizeof(pkt->data) ? (size_t)pkt->len
+                                                 : sizeof(pkt->data);
+    esp_err_t err = cc1101_foc_on_burst(&r->foc, pkt->data, n);
+    if (err != ESP_OK)
+      ESP_LOGW(TAG, "[%s] FOC update failed: %s", r->cfg->name,
+               esp_err_to_name(err));
+  }
+}
+
+// Задача AGC: IDLE на паузу скважности, SRX (с калибровкой) — после неё
+static void rf_radios_set_idle(bool idle) {
+  for (int i = 0; i < RF_RADIO_COUNT; i++) {
+    rf_radio_t *r = &s_radios[i];
+    if (!r->ready)
+      continue;
+    esp_err_t err = idle ? cc1101_strobe(&r->cc, CC1101_SIDLE)
+                         : cc1101_enter_rx(&r->cc);
+    if (err != ESP_OK)
+      ESP_LOGW(TAG, "[%s] %s failed: %s", r->cfg->name, idle ? "idle" : "rx",
+               esp_err_to_name(err));
+  }
+  s_radios_idle = idle;
+}
+
+static void rf_agc_task(void *arg) {
+  (void)arg;
+  uint32_t tick = 0;
+  uint32_t rx_ms = 0; // в RX с конца последней паузы скважности
+
+  while (1) {
+    // приём на паузе — RSSI не нужен: не будим CPU и шину SPI до
+    // rf_start_rx (иначе 10 пробуждений в секунду мешают light sleep)
+    if (!decoder_rmt_running) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      continue;
+    }
+    if (s_scan_mode == RF_SCAN_DUTY && s_scan_on_ms && s_scan_off_ms &&
+        rx_ms >= s_scan_on_ms) {
+      rf_radios_set_idle(true);
+      // rf_set_scan будит раньше, если скважность сняли
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(s_scan_off_ms));
+      rx_ms = 0;
+    }
+    if (s_radios_idle)
+      rf_radios_set_idle(false);
+    tick++;
+    for (int i = 0; i < RF_RADIO_COUNT; i++) {
+      rf_radio_t *r = &s_radios[i];
+      if (!r->agc_ready)
+        continue;
+
+      // одно чтение RSSI каждые 100 мс, подстройка раз в 2 с
+      cc1101_agc_sample(&r->agc);
+      if (tick % 20 == 0) {
+        esp_err_t err = cc1101_agc_tune(&r->agc);
+        if (err != ESP_OK)
+          ESP_LOGW(TAG, "[%s] AGC tune failed: %s", r->cfg->name,
+                   esp_err_to_name(err));
+      }
+      if (tick % 100 == 0) {
+        cc1101_agc_stats_t st;
+        cc1101_agc_get_stats(&r->agc, &st);
+        ESP_LOGI(TAG,
+                 "[%s] AGC nf=%d dBm margin=%u ok=%u.%u%% false=%u.%u%% "
+                 "bursts=%lu writes=%lu regs=%02X/%02X/%02X dropped=%lu "
+                 "overruns=%lu",
+                 r->cfg->name, st.noise_floor_dbm, st.margin_db,
+                 st.success_permille / 10, st.success_permille % 10,
+                 st.false_trigger_permille / 10,
+                 st.false_trigger_permille % 10, (unsigned long)st.bursts,
+                 (unsigned long)st.reg_writes, st.agcctrl2, st.agcctrl1,
+                 st.agcctrl0, (unsigned long)r->dec.dropped,
+                 (unsigned long)r->dec.overruns);
+        if (r->foc_ready)
+          cc1101_foc_log(&r->foc);
+      }
+    }
+    vTaskDelay(pdMS_TO_TICKS(RF_AGC_PERIOD_MS));
+    rx_ms += RF_AGC_PERIOD_MS;
+  }
+}
+
+static esp_err_t rf_radio_init(rf_radio_t *r, spi_host_device_t host) {
+  const rf_radio_cfg_t *c = r->cfg;
+  cc1101_t *cc = &r->cc;
+
+  cc1101_cfg_t cccfg = {
+      .host = host,
+      .pin_cs = c->pin_cs,
+      .clock_hz = 2 * 1000 * 1000,
+      .pin_power_en = c->pin_power_en,
+      .pin_gdo0 = c->pin_gdo0,
+      .pin_gdo2 = c->pin_gdo2,
+  };
+  ESP_RETURN_ON_ERROR(cc1101_init_dev(cc, &cccfg), TAG, "[%s] init", c->name);
+  cc1101_power_on(cc, true);
+
+  // дальше при ошибке — питание выключить и снять устройство с шины
+  esp_err_t ret = ESP_OK;
+  ESP_GOTO_ON_ERROR(cc1101_strobe(cc, CC1101_SRES), fail, TAG, "[%s] reset",
+                    c->name);
+  vTaskDelay(pdMS_TO_TICKS(5));
+
+  uint8_t part = 0, ver = 0, marc = 0;
+  ESP_GOTO_ON_ERROR(cc1101_read_status(cc, CC1101_PARTNUM, &part), fail, TAG,
+                    "[%s] PARTNUM", c->name);
+  cc1101_read_status(cc, CC1101_VERSION, &ver);
+  cc1101_read_status(cc, CC1101_MARCSTATE, &marc);
+  ESP_LOGI(TAG, "[%s] CC1101 PART=0x%02X VER=0x%02X MARC=0x%02X", c->name,
+           part, ver, marc);
+  ESP_GOTO_ON_FALSE(ver != 0x00 && ver != 0xFF, ESP_ERR_NOT_FOUND, fail, TAG,
+                    "[%s] no CC1101 on CS %d", c->name, c->pin_cs);
+
+  ESP_GOTO_ON_ERROR(cc1101_apply_preset(cc, c->preset), fail, TAG,
+                    "[%s] preset", c->name);
+  vTaskDelay(pdMS_TO_TICKS(40));
+  ESP_GOTO_ON_ERROR(cc1101_set_freq_hz(cc, c->freq_hz), fail, TAG, "[%s] freq",
+                    c->name);
+  vTaskDelay(pdMS_TO_TICKS(40));
+  ESP_GOTO_ON_ERROR(cc1101_enter_rx(cc), fail, TAG, "[%s] rx", c->name);
+  vTaskDelay(pdMS_TO_TICKS(40));
+
+  // трекер смещения частоты: FSCTRL0 по FREQEST после каждого всплеска.
+  // FREQEST считает только FSK-демодулятор, для OOK-пресетов не включаем.
+  if (cc1101_preset_is_fsk(c->preset)) {
+    r->foc_ready = (cc1101_foc_init(&r->foc, cc) == ESP_OK);
+    if (!r->foc_ready)
+      ESP_LOGE(TAG, "[%s] FOC init failed", c->name);
+  }
+
+  // AGC стартует с регистров пресета и дальше подстраивается под эфир
+  r->agc_ready = (cc1101_agc_init(&r->agc, cc, NULL) == ESP_OK);
+  if (!r->agc_ready)
+    ESP_LOGE(TAG, "[%s] AGC init failed", c->name);
+
+  return ESP_OK;
+
+fail:
+  cc1101_deinit_dev(cc);
+  return ret;
+}
+
+esp_err_t rf_init(spi_host_device_t host) {
+  // задача разбора ждёт всплесков и без радио: её гоняет и бенчмарк
+  static const decoder_pipeline_cfg_t pipe_cfg = {
+      .capture_prio = RF_CAPTURE_PRIO,
+      .capture_core = RF_CAPTURE_CORE,
+      .worker_prio = RF_DECODE_PRIO,
+      .worker_core = RF_DECODE_CORE,
+      .stream_prio = RF_STREAM_PRIO,
+      .stream_core = RF_STREAM_CORE,
+  };
+  ESP_RETURN_ON_ERROR(decoder_pipeline_init(&pipe_cfg), TAG, "pipeline");
+
+  int ok = 0;
+  for (int i = 0; i < RF_RADIO_COUNT; i++) {
+    rf_radio_t *r = &s_radios[i];
+    r->cfg = &s_radio_cfg[i];
+    r->id = (uint8_t)i;
+    r->ready = (rf_radio_init(r, host) == ESP_OK);
+    if (r->ready)
+      ok++;
+  }
+  if (!ok)
+    return ESP_ERR_NOT_FOUND;
+
+  xTaskCreatePinnedToCore(rf_agc_task, "rf_agc", 3072, NULL, 3, &s_agc_task,
+                          0);
+  return ESP_OK;
+}
+
+esp_err_t rf_start_rx(void) {
+  if (s_rx_started) {
+    if (!decoder_rmt_running) {
+      decoder_rmt_running = true;
+      if (s_agc_task)
+        xTaskNotifyGive(s_agc_task);
+      for (int i = 0; i < RF_RADIO_COUNT; i++)
+        if (s_radios[i].rx_started)
+          decoder_wake(&s_radios[i].dec);
+      ESP_LOGI(TAG, "Decoder resume");
+    }
+    return ESP_OK;
+  }
+
+  ESP_RETURN_ON_ERROR(decoder_stream_init(RF_STREAM_HOLD_MS), TAG, "stream");
+  // без буфера захвата приём работает, только осциллограмма пустая
+  esp_err_t err =
+      decoder_capture_init(DECODER_CAPTURE_EDGES, DECODER_CAPTURE_GAP_MS);
+  if (err != ESP_OK)
+    ESP_LOGW(TAG, "capture buffer: %s", esp_err_to_name(err));
+
+  decoder_rmt_running = true;
+  if (s_agc_task)
+    xTaskNotifyGive(s_agc_task);
+  for (int i = 0; i < RF_RADIO_COUNT; i++) {
+    rf_radio_t *r = &s_radios[i];
+    // после частичной неудачи повторный вызов добирает только остальные
+    if (!r->ready || r->rx_started)
+      continue;
+    decoder_cfg_t dcfg = {
+        .gpio_num = r->cfg->pin_gdo0,
+        .radio_id = r->id,
+        .freq_hz = r->cfg->freq_hz,
+        .burst_cb = rf_burst_cb,
+        .burst_cb_ctx = r,
+    };
+    // у каждого радио своя задача захвата, разбор — общий
+    ESP_RETURN_ON_ERROR(decoder_start(&r->dec, &dcfg), TAG, "[%s] decoder",
+                        r->cfg->name);
+    r->rx_started = true;
+  }
+  s_rx_started = true;
+  ESP_LOGI(TAG, "Decoder run");
+  return ESP_OK;
+}
+
+void rf_pause_rx(void) {
+  if (decoder_rmt_running) {
+    decoder_rmt_running = false;
+    // задача захвата увидит флаг по тайм-ауту очереди (100 мс), выключит
+    // канал и уснёт до decoder_wake
+    ESP_LOGI(TAG, "Decoder suspend");
+  }
+}
+
+void rf_set_scan(rf_scan_mode_t mode, uint16_t on_ms, uint16_t off_ms) {
+  if (mode == s_scan_mode && on_ms == s_scan_on_ms && off_ms == s_scan_off_ms)
+    return;
+  s_scan_on_ms = on_ms;
+  s_scan_off_ms = off_ms;
+  s_scan_mode = mode;
+  if (s_agc_task)
+    xTaskNotifyGive(s_agc_task);
+  if (mode == RF_SCAN_DUTY)
+    ESP_LOGI(TAG, "scan: duty %u ms rx / %u ms idle", on_ms, off_ms);
+  else
+    ESP_LOGI(TAG, "scan: continuous");
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "driver/spi_master.h"
+#include "esp_err.h"
+
+#include "cc1101.h"
+#include "cc1101_agc.h"
+#include "cc1101_foc.h"
+#include "cc1101_presets.h"
+#include "decoder.h"
+
+// Второй CC1101 на отдельном CS (например 315 + 433.92 МГц одновременно).
+// На стоковой плате модуль один.
+#ifndef RF_DUAL_RADIO
+#define RF_DUAL_RADIO 0
+#endif
+
+#define RF_RADIO_COUNT (RF_DUAL_RADIO ? 2 : 1)
+
+// Размещение конвейера приёма (decoder.h). Захват — рядом с прерыванием
+// RMT, выше всего на своём ядре; разбор и общий поток — на другом ядре,
+// выше UI (LVGL 4, ui_bus 4) и хранилища (2), разбор — вровень с
+// исполнителем I2C (6), опрос питания (5) его не вытесняет.
+#ifndef RF_CAPTURE_CORE
+#define RF_CAPTURE_CORE 1
+#endif
+#ifndef RF_CAPTURE_PRIO
+#define RF_CAPTURE_PRIO 10
+#endif
+#ifndef RF_DECODE_CORE
+#define RF_DECODE_CORE 0
+#endif
+#ifndef RF_DECODE_PRIO
+#define RF_DECODE_PRIO 6
+#endif
+#ifndef RF_STREAM_CORE
+#define RF_STREAM_CORE 0
+#endif
+#ifndef RF_STREAM_PRIO
+#define RF_STREAM_PRIO 5
+#endif
+
+typedef enum {
+  RF_SCAN_CONTINUOUS = 0, // все радио в RX, пока приём не на паузе
+  RF_SCAN_DUTY,           // on_ms в RX, off_ms в IDLE; всплески в паузе теряются
+} rf_scan_mode_t;
+
+typedef struct {
+  const char *name;
+  int pin_cs;
+  int pin_gdo0;
+  int pin_gdo2;
+  int pin_power_en;
+  uint32_t freq_hz;
+  const cc1101_preset_t *preset;
+} rf_radio_cfg_t;
+
+typedef struct {
+  const rf_radio_cfg_t *cfg;
+  uint8_t id;
+  bool ready;
+  cc1101_t cc;
+  cc1101_agc_t agc;
+  bool agc_ready;
+  cc1101_foc_t foc;
+  bool foc_ready;
+  decoder_t dec;
+  bool rx_started; // decoder_start прошёл: dec живой, повторно не стартуем
+} rf_radio_t;
+
+// Поднимает все радио на шине host: reset, пресет, частота, RX, AGC/FOC
+esp_err_t rf_init(spi_host_device_t host);
+
+// Декодеры + общий поток; первый вызов создаёт задачи, дальше только resume
+esp_err_t rf_start_rx(void);
+void rf_pause_rx(void);
+
+// Из любой задачи: режим приёма (power_governor). Шаг скважности — период
+// задачи AGC (100 мс). В IDLE модуль берёт ~1.7 мА вместо ~16 мА в RX.
+void rf_set_scan(rf_scan_mode_t mode, uint16_t on_ms, uint16_t off_ms);
+
+rf_radio_t *rf_radio(int idx);
@@ -0,0 +1,438 @@
+#include "ui_bench.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "decoder.h"
+#include "disp_profile.h"
+#include "ui_assets.h"
+
+static const char *TAG = "bench";
+
+#define BENCH_FRAMES 60 // кадров на сцену
+#define BENCH_WARMUP 3  // первые кадры сцены не считаем
+#define AREA_W 320
+#define AREA_H 144
+
+#define WF_W 256 // водопад
+#define WF_H 64
+
+typedef enum {
+  SCENE_FILL = 0,
+  SCENE_MENU_SCROLL,
+  SCENE_WATERFALL,
+  SCENE_LABEL,
+  SCENE_COUNT,
+} bench_scene_t;
+
+static const char *const s_scene_names[SCENE_COUNT] = {"fill", "menu", "wfall",
+                                                       "label"};
+
+// Накопители одной сцены; пишутся из событий дисплея (контекст LVGL)
+typedef struct {
+  uint32_t frames;
+  uint32_t frame_max_us;
+  uint64_t frame_us;
+  uint64_t render_us; // RENDER_START..READY минус ожидание SPI
+  uint64_t wait_us;   // LVGL стоит и ждёт окончания flush
+  uint64_t px;
+  int64_t t_first, t_last;
+} bench_acc_t;
+
+static lv_display_t *s_disp = NULL;
+
+static lv_obj_t *s_area = NULL;
+static lv_obj_t *s_report = NULL;
+static lv_obj_t *s_scene_root = NULL;
+static lv_timer_t *s_step_timer = NULL;
+
+static bool s_running = false;
+static bool s_rf_bench = false; // параллельно гоняется конвейер приёма
+static bench_scene_t s_scene;
+static bench_acc_t s_acc;
+static bool s_frame_done = false;
+
+// внутрикадровые отметки
+static int64_t s_t_refr = 0, s_t_render = 0, s_t_wait = 0;
+static uint64_t s_frame_wait_us = 0, s_frame_px = 0;
+
+// объекты сцен
+static lv_obj_t *s_menu_cont = NULL;
+static int32_t s_menu_dir = 1;
+static lv_obj_t *s_wf_canvas = NULL;
+static uint16_t *s_wf_buf = NULL;
+static uint32_t s_wf_seed = 1;
+static lv_obj_t *s_counter = NULL;
+static uint32_t s_step = 0;
+
+static char s_report_text[768];
+static size_t s_report_len = 0;
+
+// ------------------------- события дисплея -------------------------
+
+static void disp_event_cb(lv_event_t *e) {
+  if (!s_running)
+    return;
+
+  int64_t now = esp_timer_get_time();
+  switch (lv_event_get_code(e)) {
+  case LV_EVENT_REFR_START:
+    s_t_refr = now;
+    s_frame_wait_us = 0;
+    s_frame_px = 0;
+    break;
+  case LV_EVENT_RENDER_START:
+    s_t_render = now;
+    break;
+  case LV_EVENT_FLUSH_START: {
+    const lv_area_t *a = lv_event_get_param(e);
+    if (a)
+      s_frame_px += (uint64_t)lv_area_get_size(a);
+    break;
+  }
+  case LV_EVENT_FLUSH_WAIT_START:
+    s_t_wait = now;
+    break;
+  case LV_EVENT_FLUSH_WAIT_FINISH:
+    if (s_t_wait)
+      s_frame_wait_us += (uint64_t)(now - s_t_wait);
+    s_t_wait = 0;
+    break;
+  case LV_EVENT_RENDER_READY:
+    if (s_t_render && s_t_refr) {
+      uint64_t span = (uint64_t)(now - s_t_render);
+      if (s_frame_px && s_acc.frames >= BENCH_WARMUP)
+        s_acc.render_us += span > s_frame_wait_us ? span - s_frame_wait_us : 0;
+    }
+    s_t_render = 0;
+    break;
+  case LV_EVENT_REFR_READY: {
+    // пустые проходы (ничего не инвалидировано) — не кадры
+    if (!s_t_refr || !s_frame_px)
+      break;
+    uint32_t dt = (uint32_t)(now - s_t_refr);
+    if (s_acc.frames >= BENCH_WARMUP) {
+      if (!s_acc.t_first)
+        s_acc.t_first = s_t_refr;
+      s_acc.t_last = now;
+      s_acc.frame_us += dt;
+      if (dt > s_acc.frame_max_us)
+        s_acc.frame_max_us = dt;
+      s_acc.wait_us += s_frame_wait_us;
+      s_acc.px += s_frame_px;
+    }
+    s_acc.frames++;
+    s_frame_done = true;
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+void ui_bench_init(lv_display_t *disp) {
+  s_disp = disp;
+
+  static const lv_event_code_t codes[] = {
+      LV_EVENT_REFR_START,       LV_EVENT_RENDER_START,
+      LV_EVENT_FLUSH_START,      LV_EVENT_FLUSH_WAIT_START,
+      LV_EVENT_FLUSH_WAIT_FINISH, LV_EVENT_RENDER_READY,
+      LV_EVENT_REFR_READY,
+  };
+  for (size_t i = 0; i < sizeof(codes) / sizeof(codes[0]); i++)
+    lv_display_add_event_cb(disp, disp_event_cb, codes[i], NULL);
+}
+
+// ------------------------- сцены -------------------------
+
+static uint16_t wf_color(uint8_t v) {
+  // синий -> жёлтый, RGB565
+  uint16_t r = v >> 3, g = v >> 2, b = (uint16_t)(255 - v) >> 3;
+  return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void scene_create(bench_scene_t sc) {
+  s_scene_root = lv_obj_create(s_area);
+  lv_obj_remove_style_all(s_scene_root);
+  lv_obj_set_size(s_scene_root, AREA_W, AREA_H);
+  lv_obj_set_style_bg_opa(s_scene_root, LV_OPA_COVER, 0);
+  lv_obj_set_style_bg_color(s_scene_root, lv_color_hex(0x000000), 0);
+  lv_obj_remove_flag(s_scene_root, LV_OBJ_FLAG_SCROLLABLE);
+  s_step = 0;
+
+  switch (sc) {
+  case SCENE_FILL:
+    break;
+
+  case SCENE_MENU_SCROLL:
+    // та же геометрия, что у карточек главного меню
+    s_menu_cont = lv_obj_create(s_scene_root);
+    lv_obj_set_size(s_menu_cont, AREA_W, AREA_H);
+    lv_obj_set_style_bg_opa(s_menu_cont, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_opa(s_menu_cont, LV_OPA_TRANSP, 0);
+    lv_obj_set_scrollbar_mode(s_menu_cont, LV_SCROLLBAR_MODE_OFF);
+    lv_obj_set_scroll_dir(s_menu_cont, LV_DIR_HOR);
+    for (int i = 0; i < 5; i++) {
+      lv_obj_t *card = lv_obj_create(s_menu_cont);
+      lv_obj_set_size(card, 240, 120);
+      lv_obj_set_pos(card, i * 250, 0);
+      lv_obj_set_style_bg_color(card, lv_color_hex(0x1A1A1A), 0);
+      lv_obj_t *icon = lv_image_create(card);
+      lv_image_set_src(icon, &ui_icon_gps);
+      lv_obj_set_style_image_recolor(icon, lv_palette_main(LV_PALETTE_RED), 0);
+      lv_obj_set_style_image_recolor_opa(icon, LV_OPA_COVER, 0);
+      lv_obj_align(icon, LV_ALIGN_TOP_MID, 0, 4);
+    }
+    s_menu_dir = 1;
+    break;
+
+  case SCENE_WATERFALL:
+    s_wf_buf = heap_caps_malloc(WF_W * WF_H * sizeof(uint16_t),
+                                MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+    if (!s_wf_buf)
+      break; // сцена просто не даст кадров
+    memset(s_wf_buf, 0, WF_W * WF_H * sizeof(uint16_t));
+    s_wf_canvas = lv_canvas_create(s_scene_root);
+    lv_canvas_set_buffer(s_wf_canvas, s_wf_buf, WF_W, WF_H,
+                         LV_COLOR_FORMAT_RGB565);
+    lv_obj_center(s_wf_canvas);
+    break;
+
+  case SCENE_LABEL:
+    s_counter = lv_label_create(s_scene_root);
+    lv_obj_set_style_text_color(s_counter, lv_color_white(), 0);
+    lv_obj_set_style_text_font(s_counter, &ui_font_18, 0);
+    lv_obj_center(s_counter);
+    break;
+
+  default:
+    break;
+  }
+}
+
+static void scene_step(bench_scene_t sc) {
+  s_step++;
+  switch (sc) {
+  case SCENE_FILL:
+    // вся область сцены заливается новым цветом
+    lv_obj_set_style_bg_color(s_scene_root,
+                              lv_color_hsv_to_rgb((s_step * 7) % 360, 80, 60),
+                              0);
+    break;
+
+  case SCENE_MENU_SCROLL: {
+    int32_t x = lv_obj_get_scroll_x(s_menu_cont);
+    int32_t max = lv_obj_get_scroll_right(s_menu_cont);
+    if ((s_menu_dir > 0 && max <= 0) || (s_menu_dir < 0 && x <= 0))
+      s_menu_dir = -s_menu_dir;
+    lv_obj_scroll_by(s_menu_cont, -12 * s_menu_dir, 0, LV_ANIM_OFF);
+    break;
+  }
+
+  case SCENE_WATERFALL:
+    if (!s_wf_canvas)
+      break;
+    // сдвиг истории на строку вниз + новая строка «спектра» сверху
+    memmove(&s_wf_buf[WF_W], s_wf_buf, (WF_H - 1) * WF_W * sizeof(uint16_t));
+    for (int x = 0; x < WF_W; x++) {
+      s_wf_seed = s_wf_seed * 1664525u + 1013904223u;
+      uint8_t v = (uint8_t)(s_wf_seed >> 26);
+      if (x > 100 && x < 120)
+        v += 190; // «несущая»
+      s_wf_buf[x] = wf_color(v);
+    }
+    lv_obj_invalidate(s_wf_canvas);
+    break;
+
+  case SCENE_LABEL:
+    lv_label_set_text_fmt(s_counter, "%lu", (unsigned long)s_step);
+    break;
+
+  default:
+    break;
+  }
+}
+
+static void scene_destroy(void) {
+  if (s_scene_root)
+    lv_obj_delete(s_scene_root);
+  s_scene_root = NULL;
+  s_menu_cont = NULL;
+  s_wf_canvas = NULL;
+  s_counter = NULL;
+  if (s_wf_buf)
+    heap_caps_free(s_wf_buf);
+  s_wf_buf = NULL;
+}
+
+// ------------------------- отчёт -------------------------
+
+static void report_add(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+static void report_add(const char *fmt, ...) {
+  if (s_report_len >= sizeof(s_report_text))
+    return;
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(s_report_text + s_report_len,
+                    sizeof(s_report_text) - s_report_len, fmt, ap);
+  va_end(ap);
+  if (n > 0) {
+    ESP_LOGI(TAG, "%.*s", n - 1, s_report_text + s_report_len); // без '\n'
+    s_report_len += (size_t)n;
+    if (s_report_len >= sizeof(s_report_text))
+      s_report_len = sizeof(s_report_text) - 1;
+  }
+}
+
+static void report_scene(bench_scene_t sc) {
+  uint32_t n = s_acc.frames > BENCH_WARMUP ? s_acc.frames - BENCH_WARMUP : 0;
+  if (!n || s_acc.t_last <= s_acc.t_first) {
+    report_add("%-5s   no frames\n", s_scene_names[sc]);
+    return;
+  }
+  uint32_t span = (uint32_t)(s_acc.t_last - s_acc.t_first);
+  uint32_t fps10 = (uint32_t)((uint64_t)n * 10000000ull / span);
+  // времена — в десятых долях мс
+  uint32_t frame = (uint32_t)(s_acc.frame_us / n / 100);
+  uint32_t fmax = s_acc.frame_max_us / 100;
+  uint32_t rend = (uint32_t)(s_acc.render_us / n / 100);
+  uint32_t wait = (uint32_t)(s_acc.wait_us / n / 100);
+  report_add("%-5s %3lu.%lu %3lu.%lu %3lu.%lu %3lu.%lu %3lu.%lu %4lu\n",
+             s_scene_names[sc], (unsigned long)(fps10 / 10),
+             (unsigned long)(fps10 % 10), (unsigned long)(frame / 10),
+             (unsigned long)(frame % 10), (unsigned long)(fmax / 10),
+             (unsigned long)(fmax % 10), (unsigned long)(rend / 10),
+             (unsigned long)(rend % 10), (unsigned long)(wait / 10),
+             (unsigned long)(wait % 10), (unsigned long)(s_acc.px / n / 1000));
+}
+
+// ------------------------- прогон -------------------------
+
+static void bench_set_unthrottled(bool on) {
+  lv_timer_t *refr = lv_display_get_refr_timer(s_disp);
+  if (refr)
+    lv_timer_set_period(refr, on ? 1 : LV_DEF_REFR_PERIOD);
+}
+
+static void bench_finish(bool completed) {
+  s_running = false;
+  if (s_step_timer) {
+    lv_timer_delete(s_step_timer);
+    s_step_timer = NULL;
+  }
+  scene_destroy();
+  bench_set_unthrottled(false);
+
+  // конвейер приёма — под нагрузкой сцен
+  if (s_rf_bench) {
+    decoder_bench_result_t r;
+    s_rf_bench = false;
+    if (decoder_bench_stop(&r) == ESP_OK && completed)
+      report_add("rf %lu cap/s, decode %lu us/%lu sym\n",
+                 (unsigned long)r.per_s, (unsigned long)r.decode_us,
+                 (unsigned long)r.symbols);
+  }
+
+  if (s_report) {
+    lv_obj_remove_flag(s_report, LV_OBJ_FLAG_HIDDEN);
+    lv_label_set_text_static(s_report, s_report_text);
+  }
+}
+
+static void scene_begin(bench_scene_t sc) {
+  memset(&s_acc, 0, sizeof(s_acc));
+  s_t_refr = s_t_render = s_t_wait = 0;
+  s_frame_done = true;
+  s_scene = sc;
+  scene_create(sc);
+}
+
+static void step_timer_cb(lv_timer_t *t) {
+  (void)t;
+  if (!s_running)
+    return;
+
+  if (s_acc.frames >= BENCH_FRAMES + BENCH_WARMUP ||
+      (s_scene == SCENE_WATERFALL && !s_wf_canvas)) {
+    report_scene(s_scene);
+    scene_destroy();
+    if (s_scene + 1 >= SCENE_COUNT) {
+      bench_finish(true);
+      return;
+    }
+    scene_begin((bench_scene_t)(s_scene + 1));
+    return;
+  }
+
+  // одно изменение сцены на один отрисованный кадр
+  if (!s_frame_done)
+    return;
+  s_frame_done = false;
+  scene_step(s_scene);
+}
+
+static void run_clicked_cb(lv_event_t *e) {
+  (void)e;
+  if (s_running || !s_disp)
+    return;
+
+  const disp_profile_t *p = disp_profile_active();
+  s_report_len = 0;
+  s_report_text[0] = '\0';
+  if (p) {
+    report_add("%s: %lu lines x%d%s%s, %lu MHz, core %d\n", p->name,
+               (unsigned long)p->buf_lines, p->double_buffer ? 2 : 1,
+               p->full_refresh ? " full" : "", p->direct_mode ? " direct" : "",
+               (unsigned long)(p->pclk_hz / 1000000), p->lvgl_core);
+  }
+  report_add("scene   fps frame   max rendr  wait  kpx\n");
+
+  lv_obj_add_flag(s_report, LV_OBJ_FLAG_HIDDEN);
+  bench_set_unthrottled(true);
+  esp_err_t err = decoder_bench_start();
+  s_rf_bench = (err == ESP_OK);
+  if (!s_rf_bench)
+    ESP_LOGW(TAG, "rf pipeline bench: %s", esp_err_to_name(err));
+  s_running = true;
+  scene_begin(SCENE_FILL);
+  s_step_timer = lv_timer_create(step_timer_cb, 0, NULL);
+}
+
+void ui_bench_create(lv_obj_t *parent, lv_group_t *group) {
+  lv_obj_t *btn = lv_btn_create(parent);
+  lv_obj_set_size(btn, 60, 20);
+  // справа сверху — статус-бар
+  lv_obj_align(btn, LV_ALIGN_TOP_LEFT, 90, 3);
+  lv_obj_add_event_cb(btn, run_clicked_cb, LV_EVENT_CLICKED, NULL);
+  if (group)
+    lv_group_add_obj(group, btn);
+  lv_obj_t *lbl = lv_label_create(btn);
+  lv_label_set_text(lbl, LV_SYMBOL_PLAY " Run");
+  lv_obj_center(lbl);
+
+  s_area = lv_obj_create(parent);
+  lv_obj_remove_style_all(s_area);
+  lv_obj_set_size(s_area, AREA_W, AREA_H);
+  lv_obj_align(s_area, LV_ALIGN_BOTTOM_MID, 0, 0);
+  lv_obj_remove_flag(s_area, LV_OBJ_FLAG_SCROLLABLE);
+
+  s_report = lv_label_create(s_area);
+  lv_obj_set_style_text_font(s_report, &lv_font_unscii_8, 0);
+  lv_obj_set_style_text_color(s_report, lv_color_white(), 0);
+  lv_obj_set_width(s_report, AREA_W - 4);
+  lv_obj_set_pos(s_report, 2, 2);
+  lv_label_set_text_static(s_report, "Press Run");
+}
+
+void ui_bench_stop(void) {
+  if (s_running) {
+    report_add("aborted\n");
+    bench_finish(false);
+  }
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "lvgl.h"
+
+// Бенчмарк конвейера отрисовки для активного профиля (disp_profile.h).
+//
+// Прогоняет типовые сцены (заливка, прокрутка меню, водопад, мелкий
+// лейбл) без ограничения частоты кадров и по событиям дисплея LVGL
+// считает FPS, время кадра, чистое время рендера и ожидание SPI. Панелью
+// владеет esp_lvgl_port, поэтому всё идёт через LVGL — сырого потока в
+// панель мимо порта нет. Пока идут сцены, через конвейер приёма гоняется
+// синтетический всплеск (decoder_bench_*): захватов в секунду под
+// нагрузкой UI.
+
+// Один раз после lvgl_port_add_disp (контекст LVGL)
+void ui_bench_init(lv_display_t *disp);
+
+// Содержимое экрана бенчмарка: кнопка Run, область сцен, отчёт
+void ui_bench_create(lv_obj_t *parent, lv_group_t *group);
+
+// Экран скрыт — прерываем прогон и возвращаем частоту обновления
+void ui_bench_stop(void);
@@ -0,0 +1,98 @@
+#include "ui_bus.h"
+
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_lvgl_port.h"
+#include "freertos/task.h"
+
+static const char *TAG = "ui_bus";
+
+#define UI_BUS_MAX_SUBS 4 // подписчиков на один тип
+
+typedef struct {
+  uint8_t data[UI_EVT_DATA_MAX];
+  uint8_t len;
+} ui_slot_t;
+
+static struct {
+  ui_evt_handler_t cb;
+  void *ctx;
+} s_subs[UI_EVT_COUNT][UI_BUS_MAX_SUBS];
+static uint8_t s_sub_count[UI_EVT_COUNT];
+
+// Слоты пишутся производителями, читаются диспетчером — под спинлоком;
+// признак «есть событие» — бит типа в уведомлении задачи
+static ui_slot_t s_slots[UI_EVT_COUNT];
+static portMUX_TYPE s_slot_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static TaskHandle_t s_task = NULL;
+
+static void ui_bus_task(void *arg) {
+  (void)arg;
+  ui_slot_t local[UI_EVT_COUNT];
+
+  while (1) {
+    uint32_t bits = 0;
+    xTaskNotifyWait(0, UINT32_MAX, &bits, portMAX_DELAY);
+    if (!bits)
+      continue;
+
+    taskENTER_CRITICAL(&s_slot_lock);
+    for (int t = 0; t < UI_EVT_COUNT; t++)
+      if (bits & (1u << t))
+        local[t] = s_slots[t];
+    taskEXIT_CRITICAL(&s_slot_lock);
+
+    if (!lvgl_port_lock(0))
+      continue;
+    for (int t = 0; t < UI_EVT_COUNT; t++) {
+      if (!(bits & (1u << t)))
+        continue;
+      for (int i = 0; i < s_sub_count[t]; i++)
+        s_subs[t][i].cb((ui_evt_type_t)t, local[t].len ? local[t].data : NULL,
+                        s_subs[t][i].ctx);
+    }
+    lvgl_port_unlock();
+
+    // задача LVGL могла уснуть до max_sleep — пусть отрисует сразу
+    lvgl_port_task_wake(LVGL_PORT_EVENT_USER, NULL);
+  }
+}
+
+esp_err_t ui_bus_init(UBaseType_t prio, BaseType_t core) {
+  if (s_task)
+    return ESP_OK;
+  if (xTaskCreatePinnedToCore(ui_bus_task, "ui_bus", 4096, NULL, prio, &s_task,
+                              core) != pdPASS)
+    return ESP_ERR_NO_MEM;
+  ESP_LOGI(TAG, "started");
+  return ESP_OK;
+}
+
+esp_err_t ui_bus_subscribe(ui_evt_type_t type, ui_evt_handler_t cb, void *ctx) {
+  if (type >= UI_EVT_COUNT || !cb)
+    return ESP_ERR_INVALID_ARG;
+  if (s_sub_count[type] >= UI_BUS_MAX_SUBS)
+    return ESP_ERR_NO_MEM;
+  s_subs[type][s_sub_count[type]].cb = cb;
+  s_subs[type][s_sub_count[type]].ctx = ctx;
+  s_sub_count[type]++;
+  return ESP_OK;
+}
+
+esp_err_t ui_bus_post(ui_evt_type_t type, const void *data, size_t len) {
+  if (type >= UI_EVT_COUNT || len > UI_EVT_DATA_MAX || (len && !data))
+    return ESP_ERR_INVALID_ARG;
+  if (!s_task)
+    return ESP_ERR_INVALID_STATE;
+
+  taskENTER_CRITICAL(&s_slot_lock);
+  if (len)
+    memcpy(s_slots[type].data, data, len);
+  s_slots[type].len = (uint8_t)len;
+  taskEXIT_CRITICAL(&s_slot_lock);
+
+  xTaskNotify(s_task, 1u << type, eSetBits);
+  return ESP_OK;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+// Шина событий для UI.
+//
+// Производители (декодер, питание, часы) из любой задачи кладут типизированное
+// событие; последнее значение каждого типа хранится в своём слоте, повторные
+// события до обработки схлопываются. Задача-диспетчер просыпается только по
+// событию, под lvgl_port_lock вызывает подписчиков и будит задачу LVGL —
+// без опроса таймерами.
+
+typedef enum {
+  UI_EVT_PACKET = 0, // в истории пакетов есть новые (без данных)
+  UI_EVT_BATTERY,    // ui_evt_battery_t
+  UI_EVT_CLOCK,      // сменилась минута (без данных)
+  UI_EVT_CAPTURE,    // обновился сырой захват decoder_capture (без данных)
+  UI_EVT_POWER_HIST, // новая точка в power_history (без данных)
+  UI_EVT_PROFILE,    // power_governor сменил профиль (uint8_t id)
+  UI_EVT_COUNT,
+} ui_evt_type_t;
+
+#define UI_EVT_DATA_MAX 16 // максимум байт данных события
+
+typedef struct {
+  uint8_t pct;
+  bool charging;
+} ui_evt_battery_t;
+
+// Вызывается в задаче-диспетчере под lvgl_port_lock
+typedef void (*ui_evt_handler_t)(ui_evt_type_t type, const void *data,
+                                 void *ctx);
+
+esp_err_t ui_bus_init(UBaseType_t prio, BaseType_t core);
+
+// Подписка — на старте, до первых событий
+esp_err_t ui_bus_subscribe(ui_evt_type_t type, ui_evt_handler_t cb, void *ctx);
+
+// Из любой задачи (не из ISR). len <= UI_EVT_DATA_MAX, data может быть NULL.
+esp_err_t ui_bus_post(ui_evt_type_t type, const void *data, size_t len);
@@ -0,0 +1,936 @@
+#include "ui_drive.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+#include "decoder.h"
+
+static const char *TAG = "ui_drive";
+
+#define ROW_H 10             // unscii_8 + 2 px
+#define ROW_LEN 40           // 39 символов unscii_8 + '\0'
+#define HDR_H 12
+#define PREVIEW_Y (HDR_H + UI_DRIVE_VISIBLE_ROWS * ROW_H + 2)
+#define NAME_LEN 64
+#define PATH_LEN 128
+#define DIR_CKPT_MAX 128     // страниц каталога с запомненной позицией
+#define HEX_BYTES 8          // байт в строке hex
+#define POLL_MS 1000         // проверка новых захватов, пока экран виден
+#define RETRY_MS 50          // хранилище писало на флеш — прочитать ещё раз
+#define CLOSE_PENDING 2
+#define PAGE_NONE UINT32_MAX
+
+typedef enum {
+  DRIVE_TAB_CAPTURES = 0,
+  DRIVE_TAB_FILES,
+} drive_tab_t;
+
+typedef struct {
+  char name[NAME_LEN];
+  bool is_dir;
+} drive_file_t;
+
+typedef struct {
+  char text[ROW_LEN]; // готовая строка: лейблы указывают прямо сюда
+  union {
+    capture_index_t cap;
+    drive_file_t file;
+  };
+} drive_row_t;
+
+// Страница кэша: ключи [page * PAGE_ROWS, ...), прочитаны [lo, hi).
+// Ключ — номер записи хранилища (захваты) или записи каталога (файлы).
+typedef struct {
+  uint32_t page; // PAGE_NONE — свободна
+  uint32_t used; // отметка LRU
+  uint32_t lo, hi;
+  drive_row_t rows[UI_DRIVE_PAGE_ROWS];
+} drive_page_t;
+
+// Вместо строк страницы, которую не дали прочитать (хранилище пишет)
+static const drive_row_t s_busy_row = {.text = "..."};
+
+static drive_page_t *s_cache = NULL;
+static uint32_t s_lru = 0;
+static uint32_t s_gen = 0; // растёт при любой смене содержимого кэша
+static uint32_t s_page_loads = 0;
+
+static drive_tab_t s_tab = DRIVE_TAB_CAPTURES;
+static uint32_t s_cur = 0; // выбранная строка
+static uint32_t s_top = 0; // первая видимая
+
+// Захваты: [s_first, s_end), строка r — номер s_end - 1 - r
+static uint32_t s_first = 0, s_end = 0;
+
+// Файлы: каталог открыт, пока вкладка видна; s_dir_pos — номер записи,
+// которую вернёт следующий readdir (без "." и "..")
+static char s_path[PATH_LEN] = CAPTURE_STORE_BASE_PATH;
+static uint32_t s_depth = 0; // > 0 — первая строка ".."
+static DIR *s_dir = NULL;
+static uint32_t s_dir_pos = 0;
+static uint32_t s_dir_seen = 0; // столько записей уже видели
+static bool s_dir_eof = false;
+static long s_ckpt[DIR_CKPT_MAX]; // telldir() перед записью p * PAGE_ROWS
+static uint32_t s_ckpt_n = 0;
+
+// Hex: только видимое окно, читается заново при каждом сдвиге
+static struct {
+  bool on;
+  FILE *f; // NULL — запись хранилища
+  capture_index_t e;
+  uint32_t size;
+  uint32_t top; // первая видимая строка
+  char title[ROW_LEN];
+} s_hex;
+static char s_hex_rows[UI_DRIVE_VISIBLE_ROWS][ROW_LEN];
+
+static void (*s_wave_cb)(const capture_index_t *e) = NULL;
+
+static lv_obj_t *s_list = NULL;
+static lv_obj_t *s_hdr = NULL;
+static lv_obj_t *s_sel = NULL;
+static lv_obj_t *s_preview = NULL;
+static lv_obj_t *s_tab_lbl = NULL;
+static lv_obj_t *s_row_lbl[UI_DRIVE_VISIBLE_ROWS];
+static const char *s_row_txt[UI_DRIVE_VISIBLE_ROWS];
+static uint32_t s_drawn_gen = UINT32_MAX;
+static uint32_t s_preview_cur = UINT32_MAX, s_preview_gen = UINT32_MAX;
+static lv_timer_t *s_poll = NULL;
+static lv_timer_t *s_retry = NULL;
+static bool s_visible = false;
+
+// Закрыть файл/каталог на разделе — тоже только без записи хранилища
+static FILE *s_close_f[CLOSE_PENDING];
+static DIR *s_close_d[CLOSE_PENDING];
+static char s_open_pending[NAME_LEN]; // hex файла, открыть при повторе
+
+static uint32_t s_last_key_ms = 0;
+static uint32_t s_key_step = 1;
+
+static const char *const s_proto_names[DECODER_PROTO_COUNT] = {"---", "PWM"};
+
+static const char *proto_name(uint8_t proto) {
+  return proto < DECODER_PROTO_COUNT ? s_proto_names[proto] : "?";
+}
+
+static void fmt_date(char *buf, size_t n, int64_t time_us) {
+  time_t t = (time_t)(time_us / 1000000);
+  struct tm tm;
+  localtime_r(&t, &tm);
+  strftime(buf, n, "%Y-%m-%d %H:%M:%S", &tm);
+}
+
+// ------------------------- раздел -------------------------
+// Пока хранилище пишет на флеш, FatFS держит том: любое чтение ждало бы
+// стирания. Поэтому ничего не ждём — заглушка и повтор через RETRY_MS.
+
+static void retry_later(void) {
+  if (!s_retry)
+    return;
+  lv_timer_reset(s_retry);
+  lv_timer_resume(s_retry);
+}
+
+static bool io_begin(void) {
+  if (!capture_store_io_try_lock()) {
+    retry_later();
+    return false;
+  }
+  for (int i = 0; i < CLOSE_PENDING; i++) {
+    if (s_close_f[i])
+      fclose(s_close_f[i]);
+    if (s_close_d[i])
+      closedir(s_close_d[i]);
+    s_close_f[i] = NULL;
+    s_close_d[i] = NULL;
+  }
+  return true;
+}
+
+static void io_end(void) { capture_store_io_unlock(); }
+
+static void io_close(FILE *f, DIR *d) {
+  if (io_begin()) {
+    if (f)
+      fclose(f);
+    if (d)
+      closedir(d);
+    io_end();
+    return;
+  }
+  for (int i = 0; i < CLOSE_PENDING; i++) {
+    if (f && !s_close_f[i]) {
+      s_close_f[i] = f;
+      f = NULL;
+    }
+    if (d && !s_close_d[i]) {
+      s_close_d[i] = d;
+      d = NULL;
+    }
+  }
+  // некуда отложить — подождём запись
+  if (f)
+    fclose(f);
+  if (d)
+    closedir(d);
+}
+
+static bool close_pending(void) {
+  for (int i = 0; i < CLOSE_PENDING; i++)
+    if (s_close_f[i] || s_close_d[i])
+      return true;
+  return false;
+}
+
+// ------------------------- кэш строк -------------------------
+
+static void cache_drop_all(void) {
+  for (int i = 0; i < UI_DRIVE_CACHE_PAGES; i++) {
+    s_cache[i].page = PAGE_NONE;
+    s_cache[i].used = 0;
+  }
+  s_gen++;
+}
+
+// "HH:MM:SS r MMM.kkk PWM    12B 1A2B3C4D", у сырого — число фронтов
+static void format_capture(char *row, const capture_index_t *e) {
+  time_t t = (time_t)(e->time_us / 1000000);
+  struct tm tm;
+  localtime_r(&t, &tm);
+  bool raw = e->kind == CAPTURE_KIND_RAW;
+  snprintf(row, ROW_LEN, "%02d:%02d:%02d %u %3lu.%03lu %-3s %5u%c %08lX",
+           tm.tm_hour, tm.tm_min, tm.tm_sec, e->radio_id % 10,
+           (unsigned long)(e->freq_khz / 1000),
+           (unsigned long)(e->freq_khz % 1000),
+           raw ? "RAW" : proto_name(e->proto),
+           raw ? e->len / 2u : e->len, raw ? 'e' : 'B',
+           (unsigned long)e->hash);
+}
+
+// false — хранилище занято записью, страница не прочитана
+static bool load_captures(drive_page_t *pg) {
+  uint32_t base = pg->page * UI_DRIVE_PAGE_ROWS;
+  uint32_t lo = base > s_first ? base : s_first;
+  uint32_t hi = base + UI_DRIVE_PAGE_ROWS < s_end ? base + UI_DRIVE_PAGE_ROWS
+                                                  : s_end;
+  pg->lo = pg->hi = lo;
+  if (lo >= hi)
+    return true;
+
+  capture_index_t idx[UI_DRIVE_PAGE_ROWS];
+  size_t got = 0;
+  esp_err_t err = capture_store_read_index(lo, idx, hi - lo, &got);
+  if (err == ESP_ERR_TIMEOUT)
+    return false;
+  if (err != ESP_OK)
+    ESP_LOGW(TAG, "index read at %lu: %s", (unsigned long)lo,
+             esp_err_to_name(err));
+  for (size_t i = 0; i < got; i++) {
+    drive_row_t *row = &pg->rows[lo - base + i];
+    row->cap = idx[i];
+    format_capture(row->text, &idx[i]);
+  }
+  pg->hi = lo + (uint32_t)got;
+  return true;
+}
+
+static void dir_close(void) {
+  if (s_dir)
+    io_close(NULL, s_dir);
+  s_dir = NULL;
+}
+
+// Каталог читается заново: новый путь, вкладка или повторный показ
+static void dir_reset(void) {
+  dir_close();
+  s_open_pending[0] = '\0';
+  s_dir_pos = s_dir_seen = 0;
+  s_dir_eof = false;
+  s_ckpt_n = 0;
+}
+
+static struct dirent *dir_next(void) {
+  for (;;) {
+    if (s_dir_pos % UI_DRIVE_PAGE_ROWS == 0 &&
+        s_dir_pos / UI_DRIVE_PAGE_ROWS == s_ckpt_n && s_ckpt_n < DIR_CKPT_MAX)
+      s_ckpt[s_ckpt_n++] = telldir(s_dir);
+    struct dirent *de = readdir(s_dir);
+    if (!de) {
+      s_dir_eof = true;
+      return NULL;
+    }
+    if (!strcmp(de->d_name, ".") || !strcmp(de->d_name, ".."))
+      continue;
+    s_dir_pos++;
+    if (s_dir_pos > s_dir_seen)
+      s_dir_seen = s_dir_pos;
+    return de;
+  }
+}
+
+// Встать на запись pos: с ближайшей запомненной страницы, дальше вперёд
+static bool dir_seek(uint32_t pos) {
+  if (!s_dir) {
+    s_dir = opendir(s_path);
+    if (!s_dir) {
+      ESP_LOGW(TAG, "opendir %s failed", s_path);
+      s_dir_eof = true;
+      return false;
+    }
+    s_dir_pos = 0;
+    s_ckpt_n = 0;
+  }
+  uint32_t page = pos / UI_DRIVE_PAGE_ROWS;
+  if (page >= s_ckpt_n)
+    page = s_ckpt_n ? s_ckpt_n - 1 : 0;
+  if (s_ckpt_n && (pos < s_dir_pos || page * UI_DRIVE_PAGE_ROWS > s_dir_pos)) {
+    seekdir(s_dir, s_ckpt[page]);
+    s_dir_pos = page * UI_DRIVE_PAGE_ROWS;
+  }
+  while (s_dir_pos < pos)
+    if (!dir_next())
+      return false;
+  return true;
+}
+
+static bool load_files(drive_page_t *pg) {
+  uint32_t base = pg->page * UI_DRIVE_PAGE_ROWS;
+  pg->lo = pg->hi = base;
+  if (s_dir_eof && base >= s_dir_seen)
+    return true;
+  if (!io_begin())
+    return false;
+  if (dir_seek(base)) {
+    for (int i = 0; i < UI_DRIVE_PAGE_ROWS; i++) {
+      struct dirent *de = dir_next();
+      if (!de)
+        break;
+      drive_row_t *row = &pg->rows[i];
+      snprintf(row->file.name, sizeof(row->file.name), "%s", de->d_name);
+      row->file.is_dir = de->d_type == DT_DIR;
+      snprintf(row->text, ROW_LEN, "%s%s", row->file.name,
+               row->file.is_dir ? "/" : "");
+      pg->hi++;
+    }
+  }
+  io_end();
+  return true;
+}
+
+static const drive_row_t *row_get(uint32_t key) {
+  uint32_t page = key / UI_DRIVE_PAGE_ROWS;
+  drive_page_t *pg = NULL, *victim = &s_cache[0];
+  for (int i = 0; i < UI_DRIVE_CACHE_PAGES; i++) {
+    if (s_cache[i].page == page) {
+      pg = &s_cache[i];
+      break;
+    }
+    if (s_cache[i].used < victim->used)
+      victim = &s_cache[i];
+  }
+  if (!pg) {
+    pg = victim;
+    pg->page = page;
+    bool ok = s_tab == DRIVE_TAB_CAPTURES ? load_captures(pg) : load_files(pg);
+    if (!ok) {
+      // не держим: повтор через RETRY_MS прочитает
+      pg->page = PAGE_NONE;
+      pg->used = 0;
+      retry_later();
+      return &s_busy_row;
+    }
+    s_page_loads++;
+    s_gen++;
+  }
+  pg->used = ++s_lru;
+  if (key < pg->lo || key >= pg->hi)
+    return NULL;
+  return &pg->rows[key - page * UI_DRIVE_PAGE_ROWS];
+}
+
+// ------------------------- строки списка -------------------------
+
+static uint32_t row_count(void) {
+  if (s_tab == DRIVE_TAB_CAPTURES)
+    return s_end - s_first;
+  // пока конец каталога не виден — на строку дальше: её страница дочитается
+  return (s_depth ? 1 : 0) + s_dir_seen + (s_dir_eof ? 0 : 1);
+}
+
+// NULL — строка "..", либо её нет
+static const drive_row_t *row_at(uint32_t i) {
+  if (s_tab == DRIVE_TAB_CAPTURES)
+    return i < s_end - s_first ? row_get(s_end - 1 - i) : NULL;
+  if (s_depth) {
+    if (i == 0)
+      return NULL;
+    i--;
+  }
+  return row_get(i);
+}
+
+static bool row_is_up(uint32_t i) {
+  return s_tab == DRIVE_TAB_FILES && s_depth && i == 0;
+}
+
+// Новые захваты встают сверху: выбранный остаётся тем же. Дочитывается
+// только страница, где был конец; удалённые старые просто не видны.
+static bool captures_sync(void) {
+  uint32_t first = 0, end = 0;
+  capture_store_range(&first, &end);
+  if (first == s_first && end == s_end)
+    return false;
+  for (int i = 0; i < UI_DRIVE_CACHE_PAGES; i++) {
+    drive_page_t *pg = &s_cache[i];
+    if (pg->page != PAGE_NONE &&
+        pg->hi < (pg->page + 1) * UI_DRIVE_PAGE_ROWS) {
+      pg->page = PAGE_NONE;
+      pg->used = 0;
+    }
+  }
+  if (s_cur && end > s_end) {
+    s_cur += end - s_end;
+    s_top += end - s_end;
+  }
+  s_first = first;
+  s_end = end;
+  s_gen++;
+  return true;
+}
+
+// ------------------------- подсказка -------------------------
+
+static void preview_capture(const capture_index_t *e) {
+  char date[24];
+  fmt_date(date, sizeof(date), e->time_us);
+  bool raw = e->kind == CAPTURE_KIND_RAW;
+  lv_label_set_text_fmt(
+      s_preview, "%s r%u %lu.%03lu MHz\n%s %u %s seg %lu @%lu%s",
+      date, e->radio_id, (unsigned long)(e->freq_khz / 1000),
+      (unsigned long)(e->freq_khz % 1000), raw ? "RAW" : proto_name(e->proto),
+      raw ? e->len / 2u : e->len, raw ? "edges" : "B", (unsigned long)e->seg,
+      (unsigned long)e->off, (e->flags & CAPTURE_FLAG_TRUNCATED) ? " trunc" : "");
+}
+
+// Сегменты хранилища — из индекса; остальное — stat только выбранного.
+// false — хранилище занято записью
+static bool preview_file(const drive_file_t *f) {
+  if (f->is_dir) {
+    lv_label_set_text_fmt(s_preview, "%s/\ndirectory", f->name);
+    return true;
+  }
+  capture_seg_info_t seg;
+  esp_err_t err = s_depth ? ESP_ERR_NOT_FOUND
+                          : capture_store_file_info(f->name, &seg);
+  if (err == ESP_ERR_TIMEOUT)
+    return false;
+  if (err == ESP_OK) {
+    char from[24] = "-", to[24] = "-";
+    if (seg.entries) {
+      fmt_date(from, sizeof(from), seg.from_us);
+      fmt_date(to, sizeof(to), seg.to_us);
+    }
+    lv_label_set_text_fmt(s_preview, "seg %lu %s: %lu captures, %lu B\n%s ..%s",
+                          (unsigned long)seg.seg, seg.index ? "index" : "data",
+                          (unsigned long)seg.entries,
+                          (unsigned long)(seg.index ? seg.entries * sizeof(capture_index_t)
+                                                    : seg.dat_bytes),
+                          from,
+                          seg.entries ? to + 10 : "");
+    return true;
+  }
+  char path[PATH_LEN + NAME_LEN];
+  snprintf(path, sizeof(path), "%s/%s", s_path, f->name);
+  struct stat st;
+  if (!io_begin())
+    return false;
+  int rc = stat(path, &st);
+  io_end();
+  if (rc != 0) {
+    lv_label_set_text_fmt(s_preview, "%s\n(no info)", f->name);
+    return true;
+  }
+  char date[24];
+  fmt_date(date, sizeof(date), (int64_t)st.st_mtime * 1000000);
+  lv_label_set_text_fmt(s_preview, "%s\n%lu B, %s", f->name,
+                        (unsigned long)st.st_size, date);
+  return true;
+}
+
+static void update_preview(void) {
+  if (s_preview_cur == s_cur && s_preview_gen == s_gen)
+    return;
+  s_preview_cur = s_cur;
+  s_preview_gen = s_gen;
+
+  if (s_cur >= row_count()) {
+    lv_label_set_text_static(s_preview, "");
+    return;
+  }
+  if (row_is_up(s_cur)) {
+    lv_label_set_text_static(s_preview, "..\nparent directory");
+    return;
+  }
+  const drive_row_t *row = row_at(s_cur);
+  if (!row)
+    lv_label_set_text_static(s_preview, "");
+  else if (row == &s_busy_row)
+    s_preview_gen = UINT32_MAX; // строка прочитается — подсказка тоже
+  else if (s_tab == DRIVE_TAB_CAPTURES)
+    preview_capture(&row->cap);
+  else if (!preview_file(&row->file)) {
+    s_preview_gen = UINT32_MAX;
+    retry_later();
+  }
+}
+
+// ------------------------- hex -------------------------
+
+static void hex_close(void) {
+  if (!s_hex.on)
+    return;
+  if (s_hex.f)
+    io_close(s_hex.f, NULL);
+  s_hex.f = NULL;
+  s_hex.on = false;
+  s_drawn_gen = UINT32_MAX; // лейблы снова указывают в кэш
+  s_preview_gen = UINT32_MAX;
+}
+
+// false — хранилище занято записью
+static bool hex_read(uint32_t pos, uint8_t *buf, size_t len, size_t *got) {
+  *got = 0;
+  if (!s_hex.f) {
+    esp_err_t err = capture_store_read(&s_hex.e, pos, buf, len, got);
+    if (err == ESP_ERR_TIMEOUT) {
+      retry_later();
+      return false;
+    }
+    return true;
+  }
+  if (!io_begin())
+    return false;
+  if (fseek(s_hex.f, (long)pos, SEEK_SET) == 0)
+    *got = fread(buf, 1, len, s_hex.f);
+  io_end();
+  return true;
+}
+
+// "OOOOOO HH HH HH HH HH HH HH HH ........"
+static void hex_refresh(void) {
+  static const char digits[] = "0123456789ABCDEF";
+  uint8_t buf[UI_DRIVE_VISIBLE_ROWS * HEX_BYTES];
+  uint32_t pos = s_hex.top * HEX_BYTES;
+  size_t got = 0;
+  if (pos < s_hex.size && !hex_read(pos, buf, sizeof(buf), &got))
+    return; // окно останется прежним до повтора
+
+  for (int r = 0; r < UI_DRIVE_VISIBLE_ROWS; r++) {
+    char *p = s_hex_rows[r];
+    size_t at = (size_t)r * HEX_BYTES;
+    if (at < got) {
+      p += snprintf(p, ROW_LEN, "%06lX", (unsigned long)(pos + at));
+      char *ascii = p + HEX_BYTES * 3 + 1;
+      for (size_t i = 0; i < HEX_BYTES; i++) {
+        *p++ = ' ';
+        if (at + i < got) {
+          uint8_t b = buf[at + i];
+          *p++ = digits[b >> 4];
+          *p++ = digits[b & 0x0F];
+          ascii[i] = (b >= 0x20 && b < 0x7F) ? (char)b : '.';
+        } else {
+          *p++ = ' ';
+          *p++ = ' ';
+          ascii[i] = '\0';
+        }
+      }
+      *p = ' ';
+      ascii[HEX_BYTES] = '\0';
+    } else {
+      *p = '\0';
+    }
+    // тот же буфер, новое содержимое — лейбл пересчитается
+    lv_label_set_text_static(s_row_lbl[r], s_hex_rows[r]);
+    s_row_txt[r] = s_hex_rows[r];
+  }
+  lv_obj_add_flag(s_sel, LV_OBJ_FLAG_HIDDEN);
+  lv_label_set_text_fmt(s_hdr, "%s %lu B @%06lX", s_hex.title,
+                        (unsigned long)s_hex.size, (unsigned long)pos);
+}
+
+static void hex_open_capture(const capture_index_t *e, uint32_t key) {
+  s_hex.f = NULL;
+  s_hex.e = *e;
+  s_hex.size = e->len;
+  s_hex.top = 0;
+  snprintf(s_hex.title, sizeof(s_hex.title), "#%lu", (unsigned long)key);
+  s_hex.on = true;
+}
+
+static void hex_open_file(const char *name) {
+  char path[PATH_LEN + NAME_LEN];
+  snprintf(path, sizeof(path), "%s/%s", s_path, name);
+  if (!io_begin()) {
+    snprintf(s_open_pending, sizeof(s_open_pending), "%s", name);
+    return;
+  }
+  s_open_pending[0] = '\0';
+  FILE *f = fopen(path, "rb");
+  long size = -1;
+  if (f && fseek(f, 0, SEEK_END) == 0)
+    size = ftell(f);
+  if (f && size < 0) {
+    fclose(f);
+    f = NULL;
+  }
+  io_end();
+  if (!f) {
+    ESP_LOGW(TAG, "open %s failed", path);
+    return;
+  }
+  s_hex.f = f;
+  s_hex.size = (uint32_t)size;
+  s_hex.top = 0;
+  snprintf(s_hex.title, sizeof(s_hex.title), "%.24s", name);
+  s_hex.on = true;
+}
+
+// ------------------------- вид -------------------------
+
+static void refresh(void) {
+  if (!s_list || !s_cache)
+    return;
+  if (s_hex.on) {
+    hex_refresh();
+    return;
+  }
+
+  uint32_t count = row_count();
+  if (s_cur >= count)
+    s_cur = count ? count - 1 : 0;
+  if (s_cur < s_top)
+    s_top = s_cur;
+  if (s_cur >= s_top + UI_DRIVE_VISIBLE_ROWS)
+    s_top = s_cur - UI_DRIVE_VISIBLE_ROWS + 1;
+
+  // сначала строки (подгрузка может сменить s_gen), потом лейблы
+  const char *txt[UI_DRIVE_VISIBLE_ROWS];
+  for (int r = 0; r < UI_DRIVE_VISIBLE_ROWS; r++) {
+    uint32_t i = s_top + (uint32_t)r;
+    txt[r] = "";
+    if (i >= row_count())
+      continue;
+    if (row_is_up(i)) {
+      txt[r] = "..";
+      continue;
+    }
+    const drive_row_t *row = row_at(i);
+    if (row)
+      txt[r] = row->text;
+  }
+  // дочитанный каталог мог оказаться короче
+  count = row_count();
+  if (s_cur >= count)
+    s_cur = count ? count - 1 : 0;
+
+  bool all = s_drawn_gen != s_gen;
+  for (int r = 0; r < UI_DRIVE_VISIBLE_ROWS; r++) {
+    if (!all && txt[r] == s_row_txt[r])
+      continue; // строка та же — не трогаем, не инвалидируем
+    s_row_txt[r] = txt[r];
+    lv_label_set_text_static(s_row_lbl[r], txt[r]);
+  }
+  s_drawn_gen = s_gen;
+
+  if (count) {
+    lv_obj_remove_flag(s_sel, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_set_y(s_sel, HDR_H + (int32_t)(s_cur - s_top) * ROW_H);
+  } else {
+    lv_obj_add_flag(s_sel, LV_OBJ_FLAG_HIDDEN);
+  }
+
+  if (s_tab == DRIVE_TAB_CAPTURES) {
+    if (!capture_store_ready())
+      lv_label_set_text_static(s_hdr, "Storage not mounted");
+    else if (!count)
+      lv_label_set_text_static(s_hdr, "No captures");
+    else
+      lv_label_set_text_fmt(s_hdr, "Captures %lu/%lu", (unsigned long)(s_cur + 1),
+                            (unsigned long)count);
+  } else {
+    const char *rel = s_path + strlen(CAPTURE_STORE_BASE_PATH);
+    uint32_t n = s_dir_seen;
+    lv_label_set_text_fmt(s_hdr, "%.26s %lu/%lu%s", *rel ? rel : "/",
+                          (unsigned long)(s_cur + 1 > count ? 0 : s_cur + 1),
+                          (unsigned long)(n + (s_depth ? 1 : 0)),
+                          s_dir_eof ? "" : "+");
+  }
+  update_preview();
+}
+
+static void set_tab(drive_tab_t tab) {
+  hex_close();
+  s_tab = tab;
+  s_cur = s_top = 0;
+  cache_drop_all();
+  if (tab == DRIVE_TAB_FILES)
+    dir_reset();
+  else
+    captures_sync();
+  lv_label_set_text_static(s_tab_lbl,
+                           tab == DRIVE_TAB_CAPTURES ? "Files" : "Captures");
+  refresh();
+}
+
+static void path_enter(const char *name) {
+  size_t len = strlen(s_path);
+  if (len + 1 + strlen(name) >= sizeof(s_path)) {
+    ESP_LOGW(TAG, "path too long: %s/%s", s_path, name);
+    return;
+  }
+  s_path[len] = '/';
+  strcpy(&s_path[len + 1], name);
+  s_depth++;
+  s_cur = s_top = 0;
+  dir_reset();
+  cache_drop_all();
+}
+
+static void path_up(void) {
+  char *slash = strrchr(s_path, '/');
+  if (!s_depth || !slash)
+    return;
+  *slash = '\0';
+  s_depth--;
+  s_cur = s_top = 0;
+  dir_reset();
+  cache_drop_all();
+}
+
+static void open_selected(void) {
+  if (s_cur >= row_count())
+    return;
+  if (row_is_up(s_cur)) {
+    path_up();
+    return;
+  }
+  const drive_row_t *row = row_at(s_cur);
+  if (!row || row == &s_busy_row)
+    return;
+  if (s_tab == DRIVE_TAB_CAPTURES) {
+    if (row->cap.kind == CAPTURE_KIND_RAW && s_wave_cb) {
+      s_wave_cb(&row->cap);
+      return;
+    }
+    hex_open_capture(&row->cap, s_end - 1 - s_cur);
+  } else if (row->file.is_dir) {
+    path_enter(row->file.name);
+  } else {
+    hex_open_file(row->file.name);
+  }
+}
+
+static void move_by(int32_t delta) {
+  if (s_hex.on) {
+    uint32_t rows = (s_hex.size + HEX_BYTES - 1) / HEX_BYTES;
+    int64_t max = rows > UI_DRIVE_VISIBLE_ROWS ? rows - UI_DRIVE_VISIBLE_ROWS : 0;
+    int64_t top = (int64_t)s_hex.top + delta;
+    s_hex.top = (uint32_t)(top < 0 ? 0 : top > max ? max : top);
+  } else {
+    int64_t cur = (int64_t)s_cur + delta;
+    int64_t max = (int64_t)row_count() - 1;
+    if (cur > max)
+      cur = max;
+    s_cur = (uint32_t)(cur < 0 ? 0 : cur);
+  }
+  refresh();
+}
+
+static void list_event_cb(lv_event_t *e) {
+  lv_event_code_t code = lv_event_get_code(e);
+  lv_group_t *g = lv_obj_get_group(lv_event_get_target(e));
+
+  if (code == LV_EVENT_SHORT_CLICKED) {
+    // первое нажатие — режим листания, дальше — открыть / назад из hex
+    if (g && !lv_group_get_editing(g))
+      lv_group_set_editing(g, true);
+    else if (s_hex.on)
+      hex_close();
+    else
+      open_selected();
+    refresh();
+    return;
+  }
+
+  if (code == LV_EVENT_LONG_PRESSED) {
+    hex_close();
+    if (g)
+      lv_group_set_editing(g, false);
+    refresh();
+    return;
+  }
+
+  if (code == LV_EVENT_KEY) {
+    uint32_t key = lv_event_get_key(e);
+    if (key != LV_KEY_LEFT && key != LV_KEY_RIGHT)
+      return;
+
+    // быстрое вращение ускоряет листание: 1, 2, 4 ... 128 строк на щелчок
+    uint32_t now = lv_tick_get();
+    if (now - s_last_key_ms < 60) {
+      if (s_key_step < 128)
+        s_key_step *= 2;
+    } else {
+      s_key_step = 1;
+    }
+    s_last_key_ms = now;
+
+    int32_t step = (int32_t)s_key_step;
+    move_by(key == LV_KEY_RIGHT ? step : -step);
+  }
+}
+
+static void tab_clicked_cb(lv_event_t *e) {
+  (void)e;
+  if (!s_cache)
+    return;
+  set_tab(s_tab == DRIVE_TAB_CAPTURES ? DRIVE_TAB_FILES : DRIVE_TAB_CAPTURES);
+}
+
+static void retry_cb(lv_timer_t *t) {
+  lv_timer_pause(t);
+  if (!s_visible) {
+    // скрыт: только дозакрыть отложенное
+    if (close_pending() && io_begin())
+      io_end();
+    return;
+  }
+  if (s_open_pending[0] && !s_hex.on && s_tab == DRIVE_TAB_FILES) {
+    char name[NAME_LEN];
+    snprintf(name, sizeof(name), "%s", s_open_pending);
+    hex_open_file(name);
+  }
+  refresh();
+}
+
+static void poll_cb(lv_timer_t *t) {
+  (void)t;
+  if (s_tab == DRIVE_TAB_CAPTURES && captures_sync() && !s_hex.on)
+    refresh();
+}
+
+lv_obj_t *ui_drive_create(lv_obj_t *parent, lv_group_t *group) {
+  if (!s_cache) {
+    s_cache = heap_caps_malloc(UI_DRIVE_CACHE_PAGES * sizeof(drive_page_t),
+                               MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+    if (s_cache) {
+      cache_drop_all();
+      ESP_LOGI(TAG, "row cache: %d pages x %d rows, %u bytes",
+               UI_DRIVE_CACHE_PAGES, UI_DRIVE_PAGE_ROWS,
+               (unsigned)(UI_DRIVE_CACHE_PAGES * sizeof(drive_page_t)));
+    } else {
+      ESP_LOGE(TAG, "no memory for row cache");
+    }
+  }
+
+  lv_obj_t *tab = lv_btn_create(parent);
+  lv_obj_set_size(tab, 80, 20);
+  lv_obj_align(tab, LV_ALIGN_TOP_RIGHT, -3, 3);
+  lv_obj_add_event_cb(tab, tab_clicked_cb, LV_EVENT_CLICKED, NULL);
+  s_tab_lbl = lv_label_create(tab);
+  lv_label_set_text_static(s_tab_lbl,
+                           s_tab == DRIVE_TAB_CAPTURES ? "Files" : "Captures");
+  lv_obj_center(s_tab_lbl);
+
+  s_list = lv_obj_create(parent);
+  lv_obj_remove_style_all(s_list);
+  lv_obj_set_size(s_list, 320, PREVIEW_Y + 2 * ROW_H);
+  lv_obj_align(s_list, LV_ALIGN_TOP_LEFT, 0, 26);
+  lv_obj_remove_flag(s_list, LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_set_style_outline_width(s_list, 1, LV_STATE_FOCUS_KEY);
+  lv_obj_set_style_outline_color(s_list, lv_palette_main(LV_PALETTE_BLUE),
+                                 LV_STATE_FOCUS_KEY);
+  lv_obj_set_style_text_font(s_list, &lv_font_unscii_8, 0);
+  lv_obj_set_style_text_color(s_list, lv_color_white(), 0);
+
+  s_sel = lv_obj_create(s_list);
+  lv_obj_remove_style_all(s_sel);
+  lv_obj_set_size(s_sel, 320, ROW_H);
+  lv_obj_set_style_bg_color(s_sel, lv_palette_darken(LV_PALETTE_BLUE, 3), 0);
+  lv_obj_set_style_bg_opa(s_sel, LV_OPA_COVER, 0);
+  lv_obj_add_flag(s_sel, LV_OBJ_FLAG_HIDDEN);
+
+  s_hdr = lv_label_create(s_list);
+  lv_obj_set_pos(s_hdr, 4, 0);
+  lv_label_set_text_static(s_hdr, "");
+
+  for (int r = 0; r < UI_DRIVE_VISIBLE_ROWS; r++) {
+    s_row_lbl[r] = lv_label_create(s_list);
+    lv_label_set_long_mode(s_row_lbl[r], LV_LABEL_LONG_CLIP);
+    lv_obj_set_size(s_row_lbl[r], 312, ROW_H);
+    lv_obj_set_pos(s_row_lbl[r], 4, HDR_H + r * ROW_H);
+    lv_label_set_text_static(s_row_lbl[r], "");
+    s_row_txt[r] = "";
+  }
+
+  s_preview = lv_label_create(s_list);
+  lv_label_set_long_mode(s_preview, LV_LABEL_LONG_CLIP);
+  lv_obj_set_size(s_preview, 312, 2 * ROW_H);
+  lv_obj_set_pos(s_preview, 4, PREVIEW_Y);
+  lv_obj_set_style_text_color(s_preview, lv_palette_main(LV_PALETTE_GREY), 0);
+  lv_label_set_text_static(s_preview, "");
+
+  lv_obj_add_event_cb(s_list, list_event_cb, LV_EVENT_SHORT_CLICKED, NULL);
+  lv_obj_add_event_cb(s_list, list_event_cb, LV_EVENT_LONG_PRESSED, NULL);
+  lv_obj_add_event_cb(s_list, list_event_cb, LV_EVENT_KEY, NULL);
+  // по фокусу: список, потом вкладка
+  if (group) {
+    lv_group_add_obj(group, s_list);
+    lv_group_add_obj(group, tab);
+  }
+
+  s_poll = lv_timer_create(poll_cb, POLL_MS, NULL);
+  lv_timer_pause(s_poll);
+  s_retry = lv_timer_create(retry_cb, RETRY_MS, NULL);
+  lv_timer_pause(s_retry);
+  s_drawn_gen = s_preview_gen = UINT32_MAX;
+  if (!s_cache)
+    lv_label_set_text_static(s_hdr, "No memory");
+  return s_list;
+}
+
+void ui_drive_set_visible(bool visible) {
+  if (!s_list || !s_cache)
+    return;
+  s_visible = visible;
+  if (!visible) {
+    lv_timer_pause(s_poll);
+    s_open_pending[0] = '\0';
+    hex_close();
+    dir_close();
+    ESP_LOGD(TAG, "page loads: %lu", (unsigned long)s_page_loads);
+    return;
+  }
+
+  // хранилище здесь не сбрасываем (это запись на флеш в контексте LVGL):
+  // новые захваты появятся, когда оно сбросит их само
+  if (s_tab == DRIVE_TAB_CAPTURES) {
+    captures_sync();
+  } else {
+    // каталог мог измениться, пока экран был скрыт
+    dir_reset();
+    cache_drop_all();
+  }
+  lv_timer_resume(s_poll);
+  refresh();
+}
+
+void ui_drive_set_wave_cb(void (*cb)(const capture_index_t *e)) {
+  s_wave_cb = cb;
+}
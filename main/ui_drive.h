@@ -0,0 +1,36 @@
+#pragma once
+#include <stdbool.h>
+
+#include "lvgl.h"
+
+#include "capture_store.h"
+
+// Экран Drive: сохранённые захваты (capture_store) и файлы раздела.
+//
+// Ничего не читается целиком. Строки списка подгружаются страницами по
+// UI_DRIVE_PAGE_ROWS в небольшой LRU-кэш (UI_DRIVE_CACHE_PAGES страниц) —
+// только те, что видны. Захваты — из индекса, новые сверху; файлы —
+// readdir каталога, держится открытым, позиции страниц запоминаются
+// (telldir), так что и большой каталог листается без чтения с начала.
+// Подсказка внизу — из индекса (для сегментов хранилища тоже), файл
+// открывается только для просмотра. Раздел не читается, пока хранилище
+// пишет на флеш: вместо строк — "...", повтор через 50 мс.
+//
+// Энкодер: нажатие на списке — режим листания, в нём нажатие открывает
+// выбранное (пакет и файл — hex, сырой захват — осциллограмма, каталог —
+// войти), долгое нажатие — выход из режима. В hex вращение листает,
+// нажатие — назад к списку. Hex читает с флеша только видимое окно.
+
+#define UI_DRIVE_PAGE_ROWS 16
+#define UI_DRIVE_CACHE_PAGES 4
+#define UI_DRIVE_VISIBLE_ROWS 10
+
+lv_obj_t *ui_drive_create(lv_obj_t *parent, lv_group_t *group);
+
+// Контекст LVGL: показ перечитывает изменившееся (новые захваты видны,
+// когда хранилище само сбросит их на флеш); скрытый экран закрывает
+// файлы и каталог
+void ui_drive_set_visible(bool visible);
+
+// Открыть сырой захват (kind RAW) — показывает экран осциллограммы
+void ui_drive_set_wave_cb(void (*cb)(const capture_index_t *e));
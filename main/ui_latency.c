@@ -0,0 +1,391 @@
+#include "ui_latency.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+#if UI_LATENCY_TRACE
+
+static const char *TAG = "latency";
+
+#define LAT_PENDING 8                // событий в полёте одновременно
+#define LAT_TIMEOUT_US (1000 * 1000) // без перерисовки дольше — «no redraw»
+#define LAT_BUCKETS 11
+
+// верхние границы корзин гистограммы, мс (последняя — всё остальное)
+static const uint16_t s_bucket_ms[LAT_BUCKETS - 1] = {4,  8,   16,  33,  50,
+                                                      67, 100, 150, 250, 500};
+
+static const char *const s_src_names[UI_LAT_SRC_COUNT] = {"knob", "enc_btn",
+                                                          "esc"};
+
+typedef enum {
+  TR_FREE = 0,
+  TR_INPUT,   // ждём, пока UI примет событие
+  TR_HANDLED, // ждём кадра с перерисовкой
+  TR_RENDER,  // кадр идёт
+} trace_state_t;
+
+typedef struct {
+  trace_state_t state;
+  ui_lat_src_t src;
+  int64_t t_in, t_handled, t_render, t_ready;
+} trace_t;
+
+typedef struct {
+  uint32_t count;
+  uint32_t no_redraw;
+  uint32_t max_us;
+  uint64_t total_us;
+  uint64_t in_lv_us;     // input -> handled
+  uint64_t lv_render_us; // handled -> render
+  uint64_t render_us;    // render -> ready
+  uint64_t flush_us;     // ready -> flushed
+  uint32_t hist[LAT_BUCKETS];
+} lat_stats_t;
+
+static trace_t s_tr[LAT_PENDING];
+static portMUX_TYPE s_tr_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// пишется только в контексте LVGL
+static lat_stats_t s_stats[UI_LAT_SRC_COUNT];
+static uint32_t s_reported[UI_LAT_SRC_COUNT];
+static uint32_t s_dropped = 0; // не нашлось свободного слота
+
+static esp_lcd_panel_io_handle_t s_io = NULL;
+static lv_indev_read_cb_t s_port_read_cb = NULL;
+static lv_indev_state_t s_enc_state = LV_INDEV_STATE_RELEASED;
+static bool s_frame_rendered = false;
+
+// под s_tr_lock: пишут ISR (фронт ручки, конец передачи) и задача LVGL
+static int64_t s_knob_edge_us = 0;  // последний фронт A/B, 0 — не было
+static bool s_flush_busy = false;   // FLUSH_START .. on_color_trans_done
+static int64_t s_flushed_us = 0;    // конец последней передачи цвета
+
+// кадры, отрисованные, но ещё не ушедшие на панель (контекст LVGL)
+static trace_t s_wait[LAT_PENDING];
+static int s_wait_n = 0;
+
+// ------------------------- слоты -------------------------
+
+// t_handled == 0 — событие ещё не дошло до UI
+static void trace_start(ui_lat_src_t src, int64_t t_in, int64_t t_handled) {
+  taskENTER_CRITICAL(&s_tr_lock);
+  int free_slot = -1;
+  for (int i = 0; i < LAT_PENDING; i++) {
+    if (s_tr[i].state == TR_FREE) {
+      free_slot = i;
+      break;
+    }
+  }
+  if (free_slot >= 0) {
+    trace_t *t = &s_tr[free_slot];
+    t->src = src;
+    t->t_in = t_in;
+    t->t_handled = t_handled;
+    t->t_render = 0;
+    t->t_ready = 0;
+    t->state = t_handled ? TR_HANDLED : TR_INPUT;
+  } else {
+    s_dropped++;
+  }
+  taskEXIT_CRITICAL(&s_tr_lock);
+}
+
+// самое раннее непринятое событие источника
+static void trace_mark_handled(ui_lat_src_t src, int64_t now) {
+  taskENTER_CRITICAL(&s_tr_lock);
+  trace_t *oldest = NULL;
+  for (int i = 0; i < LAT_PENDING; i++) {
+    trace_t *t = &s_tr[i];
+    if (t->state == TR_INPUT && t->src == src &&
+        (!oldest || t->t_in < oldest->t_in))
+      oldest = t;
+  }
+  if (oldest) {
+    oldest->t_handled = now;
+    oldest->state = TR_HANDLED;
+  }
+  taskEXIT_CRITICAL(&s_tr_lock);
+}
+
+void ui_latency_input(ui_lat_src_t src) {
+  if (src >= UI_LAT_SRC_COUNT)
+    return;
+  trace_start(src, esp_timer_get_time(), 0);
+}
+
+void ui_latency_handled(ui_lat_src_t src) {
+  if (src >= UI_LAT_SRC_COUNT)
+    return;
+  trace_mark_handled(src, esp_timer_get_time());
+}
+
+void ui_latency_knob_edge(void) {
+  int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL_ISR(&s_tr_lock);
+  s_knob_edge_us = now;
+  portEXIT_CRITICAL_ISR(&s_tr_lock);
+}
+
+// ------------------------- статистика -------------------------
+
+static void stats_add(const trace_t *t, int64_t t_flushed) {
+  lat_stats_t *s = &s_stats[t->src];
+  uint32_t total = (uint32_t)(t_flushed - t->t_in);
+  s->count++;
+  s->total_us += total;
+  if (total > s->max_us)
+    s->max_us = total;
+  s->in_lv_us += (uint64_t)(t->t_handled - t->t_in);
+  s->lv_render_us += (uint64_t)(t->t_render - t->t_handled);
+  s->render_us += (uint64_t)(t->t_ready - t->t_render);
+  s->flush_us += (uint64_t)(t_flushed - t->t_ready);
+
+  int b = 0;
+  while (b < LAT_BUCKETS - 1 && total > (uint32_t)s_bucket_ms[b] * 1000)
+    b++;
+  s->hist[b]++;
+}
+
+static void expire_stale(int64_t now) {
+  taskENTER_CRITICAL(&s_tr_lock);
+  for (int i = 0; i < LAT_PENDING; i++) {
+    trace_t *t = &s_tr[i];
+    if (t->state != TR_FREE && t->state != TR_RENDER &&
+        now - t->t_in > LAT_TIMEOUT_US) {
+      // событие не изменило картинку (край списка, ESC вне подменю...)
+      s_stats[t->src].no_redraw++;
+      t->state = TR_FREE;
+    }
+  }
+  taskEXIT_CRITICAL(&s_tr_lock);
+}
+
+// «12.3» из микросекунд без float
+static int fmt_ms(char *buf, size_t n, uint64_t us) {
+  return snprintf(buf, n, "%lu.%lu", (unsigned long)(us / 1000),
+                  (unsigned long)((us % 1000) / 100));
+}
+
+void ui_latency_report(void) {
+  for (int src = 0; src < UI_LAT_SRC_COUNT; src++) {
+    const lat_stats_t *s = &s_stats[src];
+    if (!s->count && !s->no_redraw)
+      continue;
+    uint32_t n = s->count ? s->count : 1;
+
+    char mean[12], max[12], in_lv[12], lv_r[12], rend[12], fl[12];
+    fmt_ms(mean, sizeof(mean), s->total_us / n);
+    fmt_ms(max, sizeof(max), s->max_us);
+    fmt_ms(in_lv, sizeof(in_lv), s->in_lv_us / n);
+    fmt_ms(lv_r, sizeof(lv_r), s->lv_render_us / n);
+    fmt_ms(rend, sizeof(rend), s->render_us / n);
+    fmt_ms(fl, sizeof(fl), s->flush_us / n);
+    ESP_LOGI(TAG,
+             "%s: n=%lu no_redraw=%lu mean %s ms max %s ms | in->lv %s, "
+             "lv->render %s, render %s, flush %s",
+             s_src_names[src], (unsigned long)s->count,
+             (unsigned long)s->no_redraw, mean, max, in_lv, lv_r, rend, fl);
+
+    char hist[160];
+    int len = 0;
+    for (int b = 0; b < LAT_BUCKETS && len < (int)sizeof(hist); b++) {
+      if (b < LAT_BUCKETS - 1)
+        len += snprintf(hist + len, sizeof(hist) - len, "<%u:%lu ",
+                        s_bucket_ms[b], (unsigned long)s->hist[b]);
+      else
+        len += snprintf(hist + len, sizeof(hist) - len, ">=%u:%lu",
+                        s_bucket_ms[b - 1], (unsigned long)s->hist[b]);
+    }
+    ESP_LOGI(TAG, "%s: ms %s", s_src_names[src], hist);
+    s_reported[src] = s->count + s->no_redraw;
+  }
+  if (s_dropped)
+    ESP_LOGW(TAG, "%lu events dropped (more than %d in flight)",
+             (unsigned long)s_dropped, LAT_PENDING);
+}
+
+// Кадры, чья последняя передача уже закончилась, — в статистику
+static void flush_collect(void) {
+  if (!s_wait_n)
+    return;
+  taskENTER_CRITICAL(&s_tr_lock);
+  bool busy = s_flush_busy;
+  int64_t t_flushed = s_flushed_us;
+  taskEXIT_CRITICAL(&s_tr_lock);
+  if (busy)
+    return;
+  for (int i = 0; i < s_wait_n; i++) {
+    // передача могла закончиться раньше, чем LVGL дошёл до REFR_READY
+    int64_t t = t_flushed > s_wait[i].t_ready ? t_flushed : s_wait[i].t_ready;
+    stats_add(&s_wait[i], t);
+  }
+  s_wait_n = 0;
+}
+
+static void report_timer_cb(lv_timer_t *t) {
+  (void)t;
+  flush_collect();
+  expire_stale(esp_timer_get_time());
+  for (int src = 0; src < UI_LAT_SRC_COUNT; src++) {
+    if (s_stats[src].count + s_stats[src].no_redraw != s_reported[src]) {
+      ui_latency_report();
+      return;
+    }
+  }
+}
+
+// ------------------------- события дисплея -------------------------
+
+static void disp_event_cb(lv_event_t *e) {
+  int64_t now = esp_timer_get_time();
+  switch (lv_event_get_code(e)) {
+  case LV_EVENT_REFR_START:
+    s_frame_rendered = false;
+    flush_collect();
+    expire_stale(now);
+    break;
+  case LV_EVENT_FLUSH_START:
+    // LVGL уже дождался конца предыдущей передачи: ждущие кадры забираем
+    // до того, как эта передача перепишет s_flushed_us
+    flush_collect();
+    taskENTER_CRITICAL(&s_tr_lock);
+    s_flush_busy = true;
+    taskEXIT_CRITICAL(&s_tr_lock);
+    break;
+  case LV_EVENT_RENDER_START:
+    // первый кадр с перерисовкой после того, как UI принял событие
+    s_frame_rendered = true;
+    taskENTER_CRITICAL(&s_tr_lock);
+    for (int i = 0; i < LAT_PENDING; i++) {
+      if (s_tr[i].state == TR_HANDLED && s_tr[i].t_handled <= now) {
+        s_tr[i].t_render = now;
+        s_tr[i].state = TR_RENDER;
+      }
+    }
+    taskEXIT_CRITICAL(&s_tr_lock);
+    break;
+  case LV_EVENT_REFR_READY:
+    if (!s_frame_rendered)
+      break;
+    // Последний flush кадра ещё может идти по DMA: трассы ждут в s_wait
+    // конца передачи (on_color_trans_done), LVGL не блокируется.
+    taskENTER_CRITICAL(&s_tr_lock);
+    for (int i = 0; i < LAT_PENDING; i++) {
+      if (s_tr[i].state != TR_RENDER)
+        continue;
+      if (s_wait_n < LAT_PENDING) {
+        s_wait[s_wait_n] = s_tr[i];
+        s_wait[s_wait_n].t_ready = now;
+        s_wait_n++;
+      } else {
+        s_dropped++;
+      }
+      s_tr[i].state = TR_FREE;
+    }
+    if (!s_io) // без своего колбэка IO конец передачи не виден
+      s_flush_busy = false;
+    taskEXIT_CRITICAL(&s_tr_lock);
+    flush_collect();
+    break;
+  default:
+    break;
+  }
+}
+
+// Конец передачи цвета (ISR драйвера SPI). Колбэк порта заменён этим:
+// порт без trans_size в своём делает только lv_display_flush_ready.
+static bool color_trans_done_cb(esp_lcd_panel_io_handle_t io,
+                                esp_lcd_panel_io_event_data_t *edata,
+                                void *user_ctx) {
+  (void)io;
+  (void)edata;
+  int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL_ISR(&s_tr_lock);
+  s_flush_busy = false;
+  s_flushed_us = now;
+  portEXIT_CRITICAL_ISR(&s_tr_lock);
+  lv_display_flush_ready((lv_display_t *)user_ctx);
+  return false;
+}
+
+// Ручкой владеет порт (опрос knob по таймеру), поэтому момент вращения —
+// последний фронт A/B до чтения indev, в котором пришёл щелчок: его
+// ставит ui_latency_knob_edge из прерывания. Чтение без щелчка метку
+// сбрасывает — дребезг без шага не тянется в следующий поворот. Для
+// кнопки энкодера смена состояния в чтении — момент, когда LVGL принял
+// нажатие/отпускание.
+static void encoder_read_wrap(lv_indev_t *indev, lv_indev_data_t *data) {
+  s_port_read_cb(indev, data);
+  int64_t now = esp_timer_get_time();
+  taskENTER_CRITICAL(&s_tr_lock);
+  int64_t t_edge = s_knob_edge_us;
+  s_knob_edge_us = 0;
+  taskEXIT_CRITICAL(&s_tr_lock);
+  if (data->enc_diff) // без прерывания на A/B — момент чтения
+    trace_start(UI_LAT_SRC_KNOB, t_edge ? t_edge : now, now);
+  if (data->state != s_enc_state) {
+    s_enc_state = data->state;
+    trace_mark_handled(UI_LAT_SRC_ENC_BTN, now);
+  }
+}
+
+esp_err_t ui_latency_init(lv_display_t *disp, lv_indev_t *encoder,
+                          esp_lcd_panel_io_handle_t io) {
+  if (!disp)
+    return ESP_ERR_INVALID_ARG;
+  if (s_io || s_port_read_cb)
+    return ESP_ERR_INVALID_STATE;
+
+  if (io) {
+    const esp_lcd_panel_io_callbacks_t cbs = {
+        .on_color_trans_done = color_trans_done_cb,
+    };
+    esp_err_t err = esp_lcd_panel_io_register_event_callbacks(io, &cbs, disp);
+    if (err != ESP_OK)
+      ESP_LOGW(TAG, "no flush-done callback (%s), flush stage not traced",
+               esp_err_to_name(err));
+    else
+      s_io = io;
+  }
+
+  lv_display_add_event_cb(disp, disp_event_cb, LV_EVENT_REFR_START, NULL);
+  lv_display_add_event_cb(disp, disp_event_cb, LV_EVENT_RENDER_START, NULL);
+  lv_display_add_event_cb(disp, disp_event_cb, LV_EVENT_FLUSH_START, NULL);
+  lv_display_add_event_cb(disp, disp_event_cb, LV_EVENT_REFR_READY, NULL);
+
+  if (encoder) {
+    s_port_read_cb = lv_indev_get_read_cb(encoder);
+    if (s_port_read_cb)
+      lv_indev_set_read_cb(encoder, encoder_read_wrap);
+  }
+
+  lv_timer_create(report_timer_cb, UI_LAT_REPORT_MS, NULL);
+  ESP_LOGI(TAG, "tracing knob/enc_btn/esc, report every %d s",
+           UI_LAT_REPORT_MS / 1000);
+  return ESP_OK;
+}
+
+#else // !UI_LATENCY_TRACE
+
+esp_err_t ui_latency_init(lv_display_t *disp, lv_indev_t *encoder,
+                          esp_lcd_panel_io_handle_t io) {
+  (void)disp;
+  (void)encoder;
+  (void)io;
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+void ui_latency_input(ui_lat_src_t src) { (void)src; }
+
+void ui_latency_handled(ui_lat_src_t src) { (void)src; }
+
+void ui_latency_knob_edge(void) {}
+
+void ui_latency_report(void) {}
+
+#endif // UI_LATENCY_TRACE
@@ -0,0 +1,52 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_lcd_panel_io.h"
+#include "lvgl.h"
+
+// Трассировка задержки «ввод -> картинка на панели».
+//
+// Каждое событие ввода получает метку времени и проходит этапы:
+//   input   — колбэк кнопки / последний фронт A/B ручки (прерывание)
+//   handled — LVGL получил событие (чтение indev, для ESC — взят lock)
+//   render  — начало первого кадра с перерисовкой после handled
+//   ready   — кадр отрисован и отдан на flush (REFR_READY)
+//   flushed — последняя передача кадра по SPI завершилась
+//             (on_color_trans_done панели, без ожидания в LVGL)
+// Итог по каждому источнику — гистограмма полной задержки и средние
+// по этапам, раз в UI_LAT_REPORT_MS в лог (или ui_latency_report()).
+//
+// По умолчанию выключена: трассировка заменяет колбэк конца передачи
+// порта своим и держит прерывание на A/B ручки включённым наяву. Без
+// неё все функции — пустышки, ui_latency_init — ESP_ERR_NOT_SUPPORTED.
+#ifndef UI_LATENCY_TRACE
+#define UI_LATENCY_TRACE 0
+#endif
+
+typedef enum {
+  UI_LAT_SRC_KNOB = 0, // вращение энкодера
+  UI_LAT_SRC_ENC_BTN,  // кнопка энкодера
+  UI_LAT_SRC_ESC,      // KEY_ESC
+  UI_LAT_SRC_COUNT,
+} ui_lat_src_t;
+
+#define UI_LAT_REPORT_MS 30000
+
+// Контекст LVGL, после lvgl_port_add_disp: подписка на события дисплея,
+// колбэк конца передачи на io и обёртка чтения энкодера
+esp_err_t ui_latency_init(lv_display_t *disp, lv_indev_t *encoder,
+                          esp_lcd_panel_io_handle_t io);
+
+// Из любой задачи (колбэки iot_button): событие произошло сейчас
+void ui_latency_input(ui_lat_src_t src);
+
+// Событие дошло до кода UI (для источников вне indev LVGL)
+void ui_latency_handled(ui_lat_src_t src);
+
+// Из ISR: фронт на A/B ручки (прерывание держит ui_sleep)
+void ui_latency_knob_edge(void);
+
+// Контекст LVGL: сводка в лог, счётчики не сбрасываются
+void ui_latency_report(void);
@@ -0,0 +1,345 @@
+#include "ui_packet_list.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#include "timebase.h"
+#include "ui_bus.h"
+
+static const char *TAG = "ui_pkt";
+
+#define ROW_H 10              // unscii_8 + 2 px
+#define HEX_BYTES_PER_ROW 11  // 22 hex-символа после префикса
+#define ROW_PREFIX_LEN 15     // "HH:MM:SS r LLL "
+#define CONT_INDENT 3         // отступ строки продолжения
+#define HEX_BYTES_PER_CONT 18 // 36 hex-символов после отступа
+#define INBOX_DEPTH 16        // пакетов между двумя update()
+
+#define PKT_DATA_MAX ((int)sizeof(((packet_t *)0)->data))
+#define ROWS_PER_PKT_MAX                                                       \
+  (1 + (PKT_DATA_MAX - HEX_BYTES_PER_ROW + HEX_BYTES_PER_CONT - 1) /           \
+           HEX_BYTES_PER_CONT)
+
+// худший случай: префикс + hex + '\0' и отступ + hex + '\0'
+_Static_assert(ROW_PREFIX_LEN + 2 * HEX_BYTES_PER_ROW + 1 <= UI_PKT_ROW_LEN,
+               "packet row does not fit UI_PKT_ROW_LEN");
+_Static_assert(CONT_INDENT + 2 * HEX_BYTES_PER_CONT + 1 <= UI_PKT_ROW_LEN,
+               "continuation row does not fit UI_PKT_ROW_LEN");
+_Static_assert(UI_PKT_HISTORY >= UI_PKT_VISIBLE_ROWS + 2 * ROWS_PER_PKT_MAX,
+               "UI_PKT_HISTORY too small for a screen of packets");
+
+typedef struct {
+  char text[UI_PKT_ROW_LEN];
+  uint32_t pkt; // номер пакета, которому принадлежит строка
+} row_t;
+
+// Кольцо строк: строка с порядковым номером seq лежит в слоте
+// seq % UI_PKT_HISTORY. Строки пакета пишутся с конца (продолжения, потом
+// первая): вид идёт от новых к старым, и пакет читается сверху вниз.
+static row_t *s_rows = NULL;
+static uint32_t s_total = 0; // сколько строк записано всего
+static uint32_t s_pkts = 0;  // сколько пакетов пришло всего
+
+static QueueHandle_t s_inbox = NULL;
+static uint32_t s_inbox_dropped = 0;
+
+// Вид: сверху самая новая видимая строка (newest - r в строке r)
+static uint32_t s_view_newest = 0;
+static bool s_follow = true; // прилипать к новым пакетам
+
+static lv_obj_t *s_list = NULL;
+static lv_obj_t *s_hdr = NULL;
+static lv_obj_t *s_row_lbl[UI_PKT_VISIBLE_ROWS];
+static uint32_t s_row_seq[UI_PKT_VISIBLE_ROWS]; // что показано, UINT32_MAX = пусто
+static uint32_t s_hdr_total = UINT32_MAX, s_hdr_view = UINT32_MAX;
+
+static uint32_t s_last_key_ms = 0;
+static uint32_t s_key_step = 1;
+
+// ------------------------- hex -------------------------
+// Таблица пар символов: один 16-битный memcpy на байт вместо snprintf
+static uint16_t s_hex_pairs[256];
+
+static void hex_table_init(void) {
+  static const char digits[] = "0123456789ABCDEF";
+  for (int i = 0; i < 256; i++) {
+    char pair[2] = {digits[i >> 4], digits[i & 0x0F]};
+    memcpy(&s_hex_pairs[i], pair, 2);
+  }
+}
+
+static char *hex_encode(char *dst, const uint8_t *src, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    memcpy(dst, &s_hex_pairs[src[i]], 2);
+    dst += 2;
+  }
+  return dst;
+}
+
+static char *put_dec2(char *dst, unsigned v) {
+  memcpy(dst, &s_hex_pairs[((v / 10) << 4) | (v % 10)], 2);
+  return dst + 2;
+}
+
+static row_t *next_row(void) {
+  row_t *row = &s_rows[s_total % UI_PKT_HISTORY];
+  row->pkt = s_pkts;
+  s_total++;
+  return row;
+}
+
+// "HH:MM:SS r LLL 0A1B2C3D4E5F6A7B8C9D0E" — 37 символов
+static void format_row(char *row, const packet_t *pkt, int len) {
+  time_t t = (time_t)(timebase_mono_to_wall_us(pkt->timestamp_us) / 1000000);
+  struct tm tm;
+  localtime_r(&t, &tm);
+
+  char *p = row;
+  p = put_dec2(p, (unsigned)tm.tm_hour);
+  *p++ = ':';
+  p = put_dec2(p, (unsigned)tm.tm_min);
+  *p++ = ':';
+  p = put_dec2(p, (unsigned)tm.tm_sec);
+  *p++ = ' ';
+  *p++ = (char)('0' + (pkt->radio_id % 10));
+  *p++ = ' ';
+  *p++ = (char)('0' + len / 100);
+  p = put_dec2(p, (unsigned)(len % 100));
+  *p++ = ' ';
+
+  int n = len < HEX_BYTES_PER_ROW ? len : HEX_BYTES_PER_ROW;
+  p = hex_encode(p, pkt->data, (size_t)n);
+  *p = '\0';
+}
+
+// "   0A1B2C...": остаток пакета по HEX_BYTES_PER_CONT байт
+static void format_cont(char *row, const uint8_t *data, int n) {
+  memset(row, ' ', CONT_INDENT);
+  char *p = hex_encode(row + CONT_INDENT, data, (size_t)n);
+  *p = '\0';
+}
+
+static void push_packet(const packet_t *pkt) {
+  int len = pkt->len;
+  if (len < 0)
+    len = 0;
+  if (len > PKT_DATA_MAX)
+    len = PKT_DATA_MAX;
+
+  int conts = 0;
+  if (len > HEX_BYTES_PER_ROW)
+    conts = (len - HEX_BYTES_PER_ROW + HEX_BYTES_PER_CONT - 1) /
+            HEX_BYTES_PER_CONT;
+  for (int k = conts - 1; k >= 0; k--) {
+    int off = HEX_BYTES_PER_ROW + k * HEX_BYTES_PER_CONT;
+    int n = len - off < HEX_BYTES_PER_CONT ? len - off : HEX_BYTES_PER_CONT;
+    format_cont(next_row()->text, pkt->data + off, n);
+  }
+  format_row(next_row()->text, pkt, len);
+  s_pkts++;
+}
+
+// ------------------------- producer side -------------------------
+
+static void on_stream_packet(const packet_t *pkt, void *ctx) {
+  (void)ctx;
+  // вызывается из задачи потока декодера: только копия в очередь,
+  // форматирование — в контексте LVGL
+  if (xQueueSend(s_inbox, pkt, 0) != pdTRUE) {
+    s_inbox_dropped++;
+    return;
+  }
+  ui_bus_post(UI_EVT_PACKET, NULL, 0);
+}
+
+static void on_packet_evt(ui_evt_type_t type, const void *data, void *ctx) {
+  (void)type;
+  (void)data;
+  (void)ctx;
+  ui_packet_list_update();
+}
+
+esp_err_t ui_packet_list_init(void) {
+  if (s_rows)
+    return ESP_OK;
+
+  hex_table_init();
+
+  s_rows = heap_caps_malloc(UI_PKT_HISTORY * sizeof(row_t),
+                            MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+  if (!s_rows)
+    return ESP_ERR_NO_MEM;
+
+  s_inbox = xQueueCreate(INBOX_DEPTH, sizeof(packet_t));
+  if (!s_inbox) {
+    heap_caps_free(s_rows);
+    s_rows = NULL;
+    return ESP_ERR_NO_MEM;
+  }
+
+  ESP_LOGI(TAG, "packet history: %d rows, %u bytes", UI_PKT_HISTORY,
+           (unsigned)(UI_PKT_HISTORY * sizeof(row_t)));
+  esp_err_t err = ui_bus_subscribe(UI_EVT_PACKET, on_packet_evt, NULL);
+  if (err != ESP_OK)
+    return err;
+  return decoder_stream_subscribe(on_stream_packet, NULL);
+}
+
+// ------------------------- view -------------------------
+
+// Самая старая строка с целым пакетом. Кольцо затирает пакет с конца
+// (его продолжения записаны первыми), поэтому пакет на краю кольца
+// пропускаем целиком.
+static uint32_t oldest_seq(void) {
+  if (s_total <= UI_PKT_HISTORY)
+    return 0;
+  uint32_t seq = s_total - UI_PKT_HISTORY;
+  uint32_t pkt = s_rows[seq % UI_PKT_HISTORY].pkt;
+  while (seq < s_total && s_rows[seq % UI_PKT_HISTORY].pkt == pkt)
+    seq++;
+  return seq;
+}
+
+static void refresh_rows(void) {
+  uint32_t oldest = oldest_seq();
+  for (int r = 0; r < UI_PKT_VISIBLE_ROWS; r++) {
+    uint32_t seq = UINT32_MAX;
+    if (s_total && (uint32_t)r <= s_view_newest &&
+        s_view_newest - (uint32_t)r >= oldest)
+      seq = s_view_newest - (uint32_t)r;
+
+    if (seq == s_row_seq[r])
+      continue; // строка не изменилась — не трогаем, не инвалидируем
+
+    s_row_seq[r] = seq;
+    if (seq == UINT32_MAX) {
+      lv_label_set_text_static(s_row_lbl[r], "");
+    } else {
+      lv_label_set_text_static(s_row_lbl[r],
+                               s_rows[seq % UI_PKT_HISTORY].text);
+    }
+  }
+
+  // номер пакета верхней строки / всего пакетов
+  uint32_t view = s_total ? s_rows[s_view_newest % UI_PKT_HISTORY].pkt + 1 : 0;
+  if (s_hdr_total != s_pkts || s_hdr_view != view) {
+    s_hdr_total = s_pkts;
+    s_hdr_view = view;
+    if (s_total == 0) {
+      lv_label_set_text_static(s_hdr, "Waiting for packet...");
+    } else {
+      lv_label_set_text_fmt(s_hdr, "%lu/%lu%s", (unsigned long)view,
+                            (unsigned long)s_pkts, s_follow ? "" : " (hold)");
+    }
+  }
+}
+
+static void scroll_by(int32_t delta) {
+  if (!s_total)
+    return;
+  int64_t v = (int64_t)s_view_newest + delta;
+  int64_t lo = (int64_t)oldest_seq() + UI_PKT_VISIBLE_ROWS - 1;
+  int64_t hi = (int64_t)s_total - 1;
+  if (lo > hi)
+    lo = hi;
+  if (v < lo)
+    v = lo;
+  if (v > hi)
+    v = hi;
+  s_view_newest = (uint32_t)v;
+  s_follow = (s_view_newest == s_total - 1);
+  refresh_rows();
+}
+
+static void list_event_cb(lv_event_t *e) {
+  lv_event_code_t code = lv_event_get_code(e);
+  lv_obj_t *obj = lv_event_get_target(e);
+
+  if (code == LV_EVENT_CLICKED) {
+    // нажатие энкодера: вход/выход из режима прокрутки
+    lv_group_t *g = lv_obj_get_group(obj);
+    if (g)
+      lv_group_set_editing(g, !lv_group_get_editing(g));
+    return;
+  }
+
+  if (code == LV_EVENT_KEY) {
+    uint32_t key = lv_event_get_key(e);
+    if (key != LV_KEY_LEFT && key != LV_KEY_RIGHT)
+      return;
+
+    // быстрое вращение ускоряет листание: 1, 2, 4 ... 128 строк на щелчок
+    uint32_t now = lv_tick_get();
+    if (now - s_last_key_ms < 60) {
+      if (s_key_step < 128)
+        s_key_step *= 2;
+    } else {
+      s_key_step = 1;
+    }
+    s_last_key_ms = now;
+
+    int32_t step = (int32_t)s_key_step;
+    scroll_by(key == LV_KEY_RIGHT ? -step : step);
+  }
+}
+
+lv_obj_t *ui_packet_list_create(lv_obj_t *parent, lv_group_t *group) {
+  s_list = lv_obj_create(parent);
+  lv_obj_remove_style_all(s_list);
+  lv_obj_set_size(s_list, 320, UI_PKT_VISIBLE_ROWS * ROW_H + 12);
+  lv_obj_remove_flag(s_list, LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_set_style_outline_width(s_list, 1, LV_STATE_FOCUS_KEY);
+  lv_obj_set_style_outline_color(s_list, lv_palette_main(LV_PALETTE_BLUE),
+                                 LV_STATE_FOCUS_KEY);
+  lv_obj_set_style_text_font(s_list, &lv_font_unscii_8, 0);
+  lv_obj_set_style_text_color(s_list, lv_color_white(), 0);
+
+  s_hdr = lv_label_create(s_list);
+  lv_obj_set_pos(s_hdr, 4, 0);
+
+  for (int r = 0; r < UI_PKT_VISIBLE_ROWS; r++) {
+    s_row_lbl[r] = lv_label_create(s_list);
+    lv_label_set_long_mode(s_row_lbl[r], LV_LABEL_LONG_CLIP);
+    lv_obj_set_size(s_row_lbl[r], 312, ROW_H);
+    lv_obj_set_pos(s_row_lbl[r], 4, 12 + r * ROW_H);
+    lv_label_set_text_static(s_row_lbl[r], "");
+    s_row_seq[r] = UINT32_MAX;
+  }
+  s_hdr_total = s_hdr_view = UINT32_MAX;
+
+  lv_obj_add_event_cb(s_list, list_event_cb, LV_EVENT_CLICKED, NULL);
+  lv_obj_add_event_cb(s_list, list_event_cb, LV_EVENT_KEY, NULL);
+  if (group)
+    lv_group_add_obj(group, s_list);
+
+  refresh_rows();
+  return s_list;
+}
+
+void ui_packet_list_update(void) {
+  if (!s_rows)
+    return;
+
+  packet_t pkt;
+  bool got = false;
+  while (xQueueReceive(s_inbox, &pkt, 0) == pdTRUE) {
+    push_packet(&pkt);
+    got = true;
+  }
+  if (!got || !s_list)
+    return;
+
+  if (s_follow) {
+    s_view_newest = s_total - 1;
+  } else if (s_view_newest < oldest_seq() + UI_PKT_VISIBLE_ROWS - 1) {
+    // просматриваемое затёрто новыми пакетами — сдвигаемся за краем кольца
+    s_view_newest = oldest_seq() + UI_PKT_VISIBLE_ROWS - 1;
+  }
+  refresh_rows();
+}
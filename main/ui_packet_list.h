@@ -0,0 +1,32 @@
+#pragma once
+#include <stdbool.h>
+
+#include "lvgl.h"
+
+#include "decoder.h"
+
+// Виртуальный список пакетов для экрана RF.
+//
+// История — кольцо заранее отформатированных строк (каждый пакет
+// форматируется один раз, при поступлении). Длинный пакет занимает
+// несколько строк: первая — время, радио, длина и начало hex, дальше
+// строки продолжения с остатком, без обрезки. На экране живут только
+// UI_PKT_VISIBLE_ROWS лейблов, которые указывают прямо в кольцо
+// (lv_label_set_text_static) и перерисовываются, только когда в их
+// строке сменилась строка кольца.
+
+#define UI_PKT_HISTORY 256    // строк в истории (пакет — 1..8), ~11 КБ
+#define UI_PKT_ROW_LEN 40     // 39 символов unscii_8 = 312 px + '\0'
+#define UI_PKT_VISIBLE_ROWS 14
+
+// Один раз при старте: память под историю + подписка на поток декодера.
+// Новые пакеты доходят до экрана событием UI_EVT_PACKET (ui_bus).
+esp_err_t ui_packet_list_init(void);
+
+// Создать видимую часть на parent; сам список добавляется в group
+// (нажатие энкодера — режим прокрутки, вращение — листание)
+lv_obj_t *ui_packet_list_create(lv_obj_t *parent, lv_group_t *group);
+
+// Контекст LVGL: забрать новые пакеты, отформатировать, обновить видимые строки
+// (вызывается по событию шины и при показе экрана)
+void ui_packet_list_update(void);
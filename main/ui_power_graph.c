@@ -0,0 +1,217 @@
+#include "ui_power_graph.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "power_history.h"
+#include "ui_bus.h"
+
+#define GRAPH_PAD 4
+#define MA_SCALE_MIN 100 // шкала тока не мельче ±100 мА
+
+static const char *const s_tier_names[POWER_HIST_TIERS] = {"1h", "24h",
+                                                           "7d"};
+
+static lv_obj_t *s_graph = NULL;
+static lv_obj_t *s_info = NULL;
+static bool s_visible = false;
+static power_hist_tier_t s_tier = POWER_HIST_10S;
+
+static void fmt_min(char *buf, size_t len, uint16_t min) {
+  if (min >= 0xFFFE)
+    snprintf(buf, len, "--");
+  else if (min >= 60)
+    snprintf(buf, len, "%uh%02u", min / 60, min % 60);
+  else
+    snprintf(buf, len, "%um", min);
+}
+
+static void info_update(void) {
+  if (!s_info)
+    return;
+  char buf[96];
+  uint16_t n = power_history_count(s_tier);
+  power_hist_entry_t last = power_history_at(s_tier, 0);
+  power_estimate_t est;
+
+  int len = snprintf(buf, sizeof(buf), "%s ", s_tier_names[s_tier]);
+  if (!n || last.raw == POWER_HIST_EMPTY) {
+    snprintf(buf + len, sizeof(buf) - len, "no data yet");
+  } else if (!power_history_estimate(&est)) {
+    snprintf(buf + len, sizeof(buf) - len, "%u%% %umV %dmA", last.soc,
+             power_hist_mv(last), power_hist_ma(last));
+  } else {
+    bool chg = est.ttf_min != 0xFFFF;
+    char t[12], g[12], tr[12];
+    fmt_min(t, sizeof(t), chg ? est.ttf_min : est.tte_min);
+    fmt_min(g, sizeof(g), est.gauge_min);
+    fmt_min(tr, sizeof(tr), est.trend_min);
+    snprintf(buf + len, sizeof(buf) - len,
+             "%u%% %dmA %s %s g%s t%s w%u%%", last.soc,
+             power_hist_ma(last), chg ? "TTF" : "TTE", t, g, tr,
+             est.trend_weight);
+  }
+  lv_label_set_text(s_info, buf);
+}
+
+static void line(lv_layer_t *layer, lv_draw_line_dsc_t *dsc, int32_t x1,
+                 int32_t y1, int32_t x2, int32_t y2) {
+  dsc->p1.x = x1;
+  dsc->p1.y = y1;
+  dsc->p2.x = x2;
+  dsc->p2.y = y2;
+  lv_draw_line(layer, dsc);
+}
+
+// Точки — справа налево от самой новой, всё кольцо на ширину графика.
+// Пустые точки рвут линию; точки, попавшие в тот же столбец, пропускаются.
+static void graph_draw_cb(lv_event_t *e) {
+  lv_obj_t *obj = lv_event_get_target(e);
+  lv_layer_t *layer = lv_event_get_layer(e);
+  lv_area_t a;
+  lv_obj_get_coords(obj, &a);
+
+  int32_t x0 = a.x1 + GRAPH_PAD, x1 = a.x2 - GRAPH_PAD;
+  int32_t y0 = a.y1 + GRAPH_PAD, y1 = a.y2 - GRAPH_PAD;
+  int32_t w = x1 - x0, h = y1 - y0, ymid = (y0 + y1) / 2;
+
+  uint16_t cap = power_history_capacity(s_tier);
+  uint16_t n = power_history_count(s_tier);
+
+  lv_draw_line_dsc_t dsc;
+  lv_draw_line_dsc_init(&dsc);
+  dsc.width = 1;
+
+  // сетка: 25/50/75 % и ноль тока
+  dsc.color = lv_color_hex(0x303030);
+  for (int q = 1; q < 4; q++) {
+    int32_t y = y1 - h * q / 4;
+    line(layer, &dsc, x0, y, x1, y);
+  }
+  dsc.color = lv_color_hex(0x606000);
+  dsc.dash_width = 2;
+  dsc.dash_gap = 3;
+  line(layer, &dsc, x0, ymid, x1, ymid);
+  dsc.dash_width = 0;
+  dsc.dash_gap = 0;
+
+  if (!n || cap < 2)
+    return;
+
+  int32_t ma_max = MA_SCALE_MIN;
+  for (uint16_t i = 0; i < n; i++) {
+    power_hist_entry_t p = power_history_at(s_tier, i);
+    if (p.raw != POWER_HIST_EMPTY && abs(power_hist_ma(p)) > ma_max)
+      ma_max = abs(power_hist_ma(p));
+  }
+
+  dsc.width = 2;
+  for (int trace = 0; trace < 2; trace++) {
+    dsc.color = trace ? lv_palette_main(LV_PALETTE_YELLOW)
+                      : lv_palette_main(LV_PALETTE_GREEN);
+    bool have = false;
+    int32_t px = 0, py = 0;
+    for (uint16_t i = 0; i < n; i++) {
+      power_hist_entry_t p = power_history_at(s_tier, i);
+      if (p.raw == POWER_HIST_EMPTY) {
+        have = false;
+        continue;
+      }
+      int32_t x = x1 - (int32_t)i * w / (cap - 1);
+      int32_t y = trace ? ymid - power_hist_ma(p) * (h / 2) / ma_max
+                        : y1 - (p.soc > 100 ? 100 : p.soc) * h / 100;
+      if (have && x == px)
+        continue;
+      if (have)
+        line(layer, &dsc, px, py, x, y);
+      else
+        line(layer, &dsc, x, y, x, y); // одиночная точка
+      px = x;
+      py = y;
+      have = true;
+    }
+  }
+}
+
+// Нажатие — режим выбора окна (группа в editing, вращение идёт сюда),
+// ещё нажатие или уход фокуса — обратно к навигации
+static void graph_event_cb(lv_event_t *e) {
+  lv_event_code_t code = lv_event_get_code(e);
+  lv_group_t *g = lv_obj_get_group(s_graph);
+
+  if (code == LV_EVENT_CLICKED) {
+    if (g)
+      lv_group_set_editing(g, !lv_group_get_editing(g));
+    return;
+  }
+  if (code == LV_EVENT_DEFOCUSED) {
+    if (g && lv_group_get_editing(g))
+      lv_group_set_editing(g, false);
+    return;
+  }
+  if (code != LV_EVENT_KEY)
+    return;
+
+  uint32_t key = lv_event_get_key(e);
+  if (key == LV_KEY_RIGHT && s_tier + 1 < POWER_HIST_TIERS)
+    s_tier++;
+  else if (key == LV_KEY_LEFT && s_tier > 0)
+    s_tier--;
+  else
+    return;
+  lv_obj_invalidate(s_graph);
+  info_update();
+}
+
+static void hist_evt_cb(ui_evt_type_t type, const void *data, void *ctx) {
+  (void)type;
+  (void)data;
+  (void)ctx;
+  if (!s_visible || !s_graph)
+    return;
+  lv_obj_invalidate(s_graph);
+  info_update();
+}
+
+esp_err_t ui_power_graph_init(void) {
+  return ui_bus_subscribe(UI_EVT_POWER_HIST, hist_evt_cb, NULL);
+}
+
+lv_obj_t *ui_power_graph_create(lv_obj_t *parent, lv_group_t *group) {
+  lv_obj_t *cont = lv_obj_create(parent);
+  lv_obj_remove_style_all(cont);
+  lv_obj_set_size(cont, UI_POWER_GRAPH_W, UI_POWER_GRAPH_H + 24);
+  lv_obj_remove_flag(cont, LV_OBJ_FLAG_SCROLLABLE);
+
+  s_graph = lv_obj_create(cont);
+  lv_obj_remove_style_all(s_graph);
+  lv_obj_set_size(s_graph, UI_POWER_GRAPH_W, UI_POWER_GRAPH_H);
+  lv_obj_set_style_border_width(s_graph, 1, 0);
+  lv_obj_set_style_border_color(s_graph, lv_color_hex(0x404040), 0);
+  lv_obj_set_style_outline_width(s_graph, 1, LV_STATE_FOCUS_KEY);
+  lv_obj_set_style_outline_color(
+      s_graph, lv_palette_main(LV_PALETTE_BLUE), LV_STATE_FOCUS_KEY);
+  lv_obj_remove_flag(s_graph, LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_add_event_cb(s_graph, graph_draw_cb, LV_EVENT_DRAW_MAIN, NULL);
+  lv_obj_add_flag(s_graph, LV_OBJ_FLAG_CLICKABLE);
+  lv_obj_add_event_cb(s_graph, graph_event_cb, LV_EVENT_CLICKED, NULL);
+  lv_obj_add_event_cb(s_graph, graph_event_cb, LV_EVENT_KEY, NULL);
+  lv_obj_add_event_cb(s_graph, graph_event_cb, LV_EVENT_DEFOCUSED, NULL);
+  if (group)
+    lv_group_add_obj(group, s_graph);
+
+  s_info = lv_label_create(cont);
+  lv_obj_set_style_text_font(s_info, &lv_font_unscii_8, 0);
+  lv_obj_set_style_text_color(s_info, lv_color_white(), 0);
+  lv_obj_set_pos(s_info, 4, UI_POWER_GRAPH_H + 4);
+  info_update();
+  return cont;
+}
+
+void ui_power_graph_set_visible(bool visible) {
+  s_visible = visible;
+  if (visible && s_graph) {
+    lv_obj_invalidate(s_graph);
+    info_update();
+  }
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <stdbool.h>
+
+#include "esp_err.h"
+#include "lvgl.h"
+
+// График истории питания (power_history): SOC (зелёный, 0..100 %) и ток
+// (жёлтый, шкала по максимуму модуля в окне, ноль — пунктир посередине),
+// под ним — SOC, оценка TTE/TTF и её составляющие.
+//
+// Своего буфера нет: объект рисуется в LV_EVENT_DRAW_MAIN линиями прямо по
+// точкам колец RTC-памяти. Нажатие энкодера — выбор окна, вращение —
+// час / сутки / неделя.
+
+#define UI_POWER_GRAPH_W 320
+#define UI_POWER_GRAPH_H 100
+
+// Один раз при старте: подписка на UI_EVT_POWER_HIST
+esp_err_t ui_power_graph_init(void);
+
+// График + строка состояния на parent, график добавляется в group
+lv_obj_t *ui_power_graph_create(lv_obj_t *parent, lv_group_t *group);
+
+// Контекст LVGL: экран показан / скрыт (скрытый не перерисовывается)
+void ui_power_graph_set_visible(bool visible);
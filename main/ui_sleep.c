@@ -0,0 +1,362 @@
+#include "ui_sleep.h"
+
+#include <stdio.h>
+
+#include "esp_log.h"
+#include "esp_lvgl_port.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/timers.h"
+
+#include "backlight.h"
+#include "ui_bus.h"
+#include "ui_latency.h"
+
+static const char *TAG = "sleep";
+
+#define SLEEP_POLL_MS 200      // период проверки бездействия
+#define SLEEP_SWALLOW_MS 300   // повороты сразу после пробуждения — мимо UI
+#define PANEL_SLPOUT_MS 5      // ST7789: пауза после SLPOUT до команд
+#define PW_SETTLE_US (3000000) // гейдж усредняет ток ~1 с + период опроса
+
+static const char *const s_state_names[UI_SLEEP_STATE_COUNT] = {
+    "active", "dim", "sleep"};
+static const char *const s_wake_names[] = {"input", "knob", "rf"};
+
+static ui_sleep_cfg_t s_cfg;
+static lv_timer_t *s_timer = NULL;
+static volatile ui_sleep_state_t s_state = UI_SLEEP_ACTIVE;
+static volatile bool s_sleep_req = false;
+static int64_t s_off_since_us = 0;
+// переходы не ждут внутри LVGL: гашение доделывает одноразовый lv_timer,
+// включение панели после SLPOUT — esp_timer
+static lv_timer_t *s_off_timer = NULL; // подсветка гаснет, панель ещё не спит
+static esp_timer_handle_t s_slpout_timer = NULL;
+
+// гашение ввода, разбудившего экран (контекст LVGL)
+static lv_indev_read_cb_t s_enc_read_cb = NULL;
+static int64_t s_swallow_until_us = 0;
+static bool s_hold_release = false;
+
+static volatile bool s_knob_armed = false;
+
+// Ток по состояниям. Пишет задача гейджа, состояние меняет LVGL — спинлок.
+typedef struct {
+  int64_t sum_ma;
+  uint32_t n;
+} pw_acc_t;
+
+static pw_acc_t s_pw[UI_SLEEP_STATE_COUNT];
+static int64_t s_state_since_us = 0;
+static portMUX_TYPE s_pw_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void set_state(ui_sleep_state_t st) {
+  taskENTER_CRITICAL(&s_pw_lock);
+  s_state = st;
+  s_state_since_us = esp_timer_get_time();
+  taskEXIT_CRITICAL(&s_pw_lock);
+}
+
+ui_sleep_state_t ui_sleep_state(void) { return s_state; }
+
+void ui_sleep_set_levels(uint8_t active_pct, uint8_t dim_pct) {
+  s_cfg.active_pct = active_pct;
+  s_cfg.dim_pct = dim_pct;
+  if (!s_timer)
+    return;
+  // во сне подсветка погашена, уровень возьмёт wake_display
+  if (s_state == UI_SLEEP_ACTIVE)
+    backlight_set(active_pct, BACKLIGHT_RAMP_MS * 4);
+  else if (s_state == UI_SLEEP_DIM)
+    backlight_set(dim_pct, BACKLIGHT_RAMP_MS * 4);
+}
+
+void ui_sleep_power_sample(int16_t current_ma) {
+  int64_t now = esp_timer_get_time();
+  taskENTER_CRITICAL(&s_pw_lock);
+  // сразу после перехода гейдж ещё показывает ток прошлого состояния
+  if (now - s_state_since_us >= PW_SETTLE_US) {
+    s_pw[s_state].sum_ma += current_ma;
+    s_pw[s_state].n++;
+  }
+  taskEXIT_CRITICAL(&s_pw_lock);
+}
+
+void ui_sleep_report(void) {
+  pw_acc_t pw[UI_SLEEP_STATE_COUNT];
+  taskENTER_CRITICAL(&s_pw_lock);
+  for (int i = 0; i < UI_SLEEP_STATE_COUNT; i++)
+    pw[i] = s_pw[i];
+  taskEXIT_CRITICAL(&s_pw_lock);
+
+  int32_t avg[UI_SLEEP_STATE_COUNT];
+  char txt[UI_SLEEP_STATE_COUNT][24];
+  for (int i = 0; i < UI_SLEEP_STATE_COUNT; i++) {
+    avg[i] = pw[i].n ? (int32_t)(pw[i].sum_ma / (int64_t)pw[i].n) : 0;
+    if (pw[i].n)
+      snprintf(txt[i], sizeof(txt[i]), "%ld mA (n=%lu)", (long)avg[i],
+               (unsigned long)pw[i].n);
+    else
+      snprintf(txt[i], sizeof(txt[i]), "n/a");
+  }
+  ESP_LOGI(TAG, "battery current: active %s, dim %s, sleep %s",
+           txt[UI_SLEEP_ACTIVE], txt[UI_SLEEP_DIM], txt[UI_SLEEP_OFF]);
+  // разряд отрицательный: экономия = насколько ток ближе к нулю
+  for (int i = UI_SLEEP_DIM; i < UI_SLEEP_STATE_COUNT; i++) {
+    if (pw[UI_SLEEP_ACTIVE].n && pw[i].n)
+      ESP_LOGI(TAG, "%s saves %ld mA vs active", s_state_names[i],
+               (long)(avg[i] - avg[UI_SLEEP_ACTIVE]));
+  }
+}
+
+// ------------------------- ручка во сне -------------------------
+
+static void knob_wake_deferred(void *arg, uint32_t unused) {
+  (void)arg;
+  (void)unused;
+  ui_sleep_wake(UI_WAKE_KNOB);
+}
+
+// Ручку опрашивает knob по таймеру внутри порта, а порт во сне стоит —
+// поэтому на время сна фронт A/B будит через прерывание. С трассировкой
+// задержки прерывание включено и наяву: фронт — метка вращения.
+static void knob_isr(void *arg) {
+  (void)arg;
+  ui_latency_knob_edge();
+  if (!s_knob_armed)
+    return;
+  s_knob_armed = false;
+  BaseType_t woken = pdFALSE;
+  xTimerPendFunctionCallFromISR(knob_wake_deferred, NULL, 0, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+static void knob_irq_arm(bool on) {
+  s_knob_armed = on;
+  const gpio_num_t pins[2] = {s_cfg.knob_a, s_cfg.knob_b};
+  for (int i = 0; i < 2; i++) {
+    if (pins[i] == GPIO_NUM_NC)
+      continue;
+    if (on || UI_LATENCY_TRACE)
+      gpio_intr_enable(pins[i]);
+    else
+      gpio_intr_disable(pins[i]);
+  }
+}
+
+static esp_err_t knob_irq_init(void) {
+  const gpio_num_t pins[2] = {s_cfg.knob_a, s_cfg.knob_b};
+  esp_err_t err = gpio_install_isr_service(0);
+  if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) // уже установлен
+    return err;
+  for (int i = 0; i < 2; i++) {
+    if (pins[i] == GPIO_NUM_NC)
+      continue;
+    gpio_set_intr_type(pins[i], GPIO_INTR_ANYEDGE);
+    err = gpio_isr_handler_add(pins[i], knob_isr, NULL);
+    if (err != ESP_OK)
+      return err;
+  }
+  knob_irq_arm(false);
+  return ESP_OK;
+}
+
+// ------------------------- переходы -------------------------
+
+// Контекст LVGL: подсветка в нуле — панель в SLPIN, LVGL стоп
+static void panel_off_cb(lv_timer_t *t) {
+  (void)t;
+  s_off_timer = NULL; // одноразовый, LVGL удалит сам
+  esp_lcd_panel_disp_on_off(s_cfg.panel, false);
+  esp_lcd_panel_disp_sleep(s_cfg.panel, true);
+  // текущий lv_timer_handler доработает, следующего не будет до resume
+  lvgl_port_stop();
+  ESP_LOGI(TAG, "display off");
+}
+
+// Контекст LVGL
+static void enter_sleep(void) {
+  s_sleep_req = false;
+  if (s_state == UI_SLEEP_OFF)
+    return;
+  set_state(UI_SLEEP_OFF);
+  s_off_since_us = esp_timer_get_time();
+
+  // гасим плавно (аппаратный fade), панель — когда подсветка уже в нуле.
+  // Ручка будит уже сейчас: поворот во время гашения его отменит.
+  backlight_set(0, BACKLIGHT_RAMP_MS);
+  knob_irq_arm(true);
+  s_off_timer = lv_timer_create(panel_off_cb, BACKLIGHT_RAMP_MS, NULL);
+  if (s_off_timer)
+    lv_timer_set_repeat_count(s_off_timer, 1);
+  else
+    panel_off_cb(NULL);
+}
+
+// Под lvgl_port_lock: панель готова принимать кадры
+static void panel_on(void) {
+  esp_lcd_panel_disp_on_off(s_cfg.panel, true);
+  lvgl_port_resume();
+  // GRAM панели во сне сохраняется — картинка та же, подсветку можно сразу
+  backlight_set(s_cfg.active_pct, BACKLIGHT_RAMP_MS);
+}
+
+// Задача esp_timer: PANEL_SLPOUT_MS после SLPOUT. Порт стоит, замок
+// свободен — ждать его недолго.
+static void slpout_timer_cb(void *arg) {
+  (void)arg;
+  if (!lvgl_port_lock(0))
+    return;
+  panel_on();
+  lvgl_port_unlock();
+  lvgl_port_task_wake(LVGL_PORT_EVENT_USER, NULL);
+}
+
+// Под lvgl_port_lock
+static void wake_display(ui_wake_src_t src) {
+  knob_irq_arm(false);
+  if (s_off_timer) {
+    // разбудили во время гашения: панель не засыпала, порт не стоял
+    lv_timer_delete(s_off_timer);
+    s_off_timer = NULL;
+    backlight_set(s_cfg.active_pct, BACKLIGHT_RAMP_MS);
+  } else {
+    // порт стоит до panel_on — до конца паузы SLPOUT кадров в панель нет
+    esp_lcd_panel_disp_sleep(s_cfg.panel, false);
+    if (esp_timer_start_once(s_slpout_timer, PANEL_SLPOUT_MS * 1000) != ESP_OK)
+      panel_on(); // таймер уже взведён — не должно случаться
+  }
+
+  if (src != UI_WAKE_RF) {
+    s_swallow_until_us = esp_timer_get_time() + SLEEP_SWALLOW_MS * 1000;
+    s_hold_release = true;
+  }
+  set_state(UI_SLEEP_ACTIVE);
+
+  ESP_LOGI(TAG, "wake (%s) after %lu s", s_wake_names[src],
+           (unsigned long)((esp_timer_get_time() - s_off_since_us) / 1000000));
+  ui_sleep_report();
+}
+
+bool ui_sleep_wake(ui_wake_src_t src) {
+  if (!s_timer)
+    return false;
+  if (!lvgl_port_lock(0))
+    return false;
+  bool was_off = s_state == UI_SLEEP_OFF;
+  if (was_off)
+    wake_display(src);
+  s_sleep_req = false;
+  lv_display_trigger_activity(s_cfg.disp);
+  lvgl_port_unlock();
+  lvgl_port_task_wake(LVGL_PORT_EVENT_USER, NULL);
+  return was_off;
+}
+
+void ui_sleep_now(void) {
+  if (!s_timer || !lvgl_port_lock(0))
+    return;
+  // сам переход — в задаче LVGL, из таймера бездействия
+  s_sleep_req = true;
+  lv_timer_ready(s_timer);
+  lvgl_port_unlock();
+  lvgl_port_task_wake(LVGL_PORT_EVENT_USER, NULL);
+}
+
+static void idle_timer_cb(lv_timer_t *t) {
+  (void)t;
+  if (s_sleep_req) {
+    enter_sleep();
+    return;
+  }
+
+  uint32_t idle = lv_display_get_inactive_time(s_cfg.disp);
+  bool want_off = s_cfg.sleep_ms && idle >= s_cfg.sleep_ms;
+  bool want_dim = s_cfg.dim_ms && idle >= s_cfg.dim_ms;
+
+  switch (s_state) {
+  case UI_SLEEP_ACTIVE:
+    if (want_off) {
+      enter_sleep();
+    } else if (want_dim) {
+      set_state(UI_SLEEP_DIM);
+      backlight_set(s_cfg.dim_pct, BACKLIGHT_RAMP_MS * 4);
+    }
+    break;
+  case UI_SLEEP_DIM:
+    if (want_off) {
+      enter_sleep();
+    } else if (!want_dim) {
+      set_state(UI_SLEEP_ACTIVE);
+      backlight_set(s_cfg.active_pct, BACKLIGHT_RAMP_MS);
+    }
+    break;
+  default:
+    break; // гашение идёт или LVGL уже стоит
+  }
+}
+
+// ------------------------- ввод -------------------------
+
+static void encoder_read_wrap(lv_indev_t *indev, lv_indev_data_t *data) {
+  s_enc_read_cb(indev, data);
+  // порт копит щелчки и во сне — первые после пробуждения не листают меню
+  if (esp_timer_get_time() < s_swallow_until_us)
+    data->enc_diff = 0;
+  // нажатие, разбудившее экран, LVGL видит только после отпускания
+  if (s_hold_release) {
+    if (data->state == LV_INDEV_STATE_PRESSED)
+      data->state = LV_INDEV_STATE_RELEASED;
+    else
+      s_hold_release = false;
+  }
+}
+
+static void packet_evt_cb(ui_evt_type_t type, const void *data, void *ctx) {
+  (void)type;
+  (void)data;
+  (void)ctx;
+  ui_sleep_wake(UI_WAKE_RF);
+}
+
+esp_err_t ui_sleep_init(const ui_sleep_cfg_t *cfg) {
+  if (!cfg || !cfg->disp || !cfg->panel)
+    return ESP_ERR_INVALID_ARG;
+  if (s_timer)
+    return ESP_ERR_INVALID_STATE;
+  s_cfg = *cfg;
+  if (s_cfg.dim_ms && s_cfg.sleep_ms && s_cfg.dim_ms >= s_cfg.sleep_ms)
+    s_cfg.dim_ms = 0; // приглушать незачем, сразу спать
+
+  const esp_timer_create_args_t targs = {
+      .callback = slpout_timer_cb,
+      .name = "panel_on",
+  };
+  esp_err_t err = esp_timer_create(&targs, &s_slpout_timer);
+  if (err != ESP_OK)
+    return err;
+
+  err = knob_irq_init();
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "knob wake unavailable: %s", esp_err_to_name(err));
+    s_cfg.knob_a = s_cfg.knob_b = GPIO_NUM_NC;
+  }
+
+  if (s_cfg.encoder) {
+    s_enc_read_cb = lv_indev_get_read_cb(s_cfg.encoder);
+    if (s_enc_read_cb)
+      lv_indev_set_read_cb(s_cfg.encoder, encoder_read_wrap);
+  }
+  if (s_cfg.wake_on_rf)
+    ui_bus_subscribe(UI_EVT_PACKET, packet_evt_cb, NULL);
+
+  set_state(UI_SLEEP_ACTIVE);
+  lv_display_trigger_activity(s_cfg.disp);
+  s_timer = lv_timer_create(idle_timer_cb, SLEEP_POLL_MS, NULL);
+  backlight_set(s_cfg.active_pct, BACKLIGHT_RAMP_MS);
+  ESP_LOGI(TAG, "dim after %lu s (%u%%), sleep after %lu s",
+           (unsigned long)(s_cfg.dim_ms / 1000), s_cfg.dim_pct,
+           (unsigned long)(s_cfg.sleep_ms / 1000));
+  return ESP_OK;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "esp_lcd_panel_ops.h"
+#include "lvgl.h"
+
+// Сон дисплея по бездействию.
+//
+//   ACTIVE --dim_ms--> DIM --sleep_ms--> SLEEP
+//
+// Время бездействия — lv_display_get_inactive_time (энкодер сбрасывает его
+// сам, ESC и RF — через ui_sleep_wake). В DIM подсветка приглушена, UI
+// работает. В SLEEP подсветка погашена, панель в SLPIN, задача LVGL
+// остановлена (lvgl_port_stop) — ни таймеров, ни отрисовки. Переходы не
+// блокируют LVGL: подсветка гаснет аппаратным fade, панель засыпает по
+// одноразовому lv_timer; при пробуждении паузу после SLPOUT отсчитывает
+// esp_timer, порт возобновляется после неё.
+//
+// Будят: кнопки (ui_sleep_wake из их колбэков), вращение ручки (прерывание
+// по фронту A/B: во сне и при гашении, с UI_LATENCY_TRACE — всегда) и новые
+// пакеты в истории (UI_EVT_PACKET). Нажатие, разбудившее экран, в UI не
+// попадает.
+//
+// Ток по фьюел-гейджу усредняется отдельно для каждого состояния, сводка
+// «сколько экономит DIM/SLEEP» — в лог после каждого пробуждения.
+
+typedef enum {
+  UI_SLEEP_ACTIVE = 0,
+  UI_SLEEP_DIM,
+  UI_SLEEP_OFF,
+  UI_SLEEP_STATE_COUNT,
+} ui_sleep_state_t;
+
+typedef enum {
+  UI_WAKE_INPUT = 0, // кнопка
+  UI_WAKE_KNOB,      // вращение ручки во сне
+  UI_WAKE_RF,        // новый пакет
+} ui_wake_src_t;
+
+typedef struct {
+  lv_display_t *disp;
+  lv_indev_t *encoder; // нажатие/поворот, разбудившие экран, гасятся
+  esp_lcd_panel_handle_t panel;
+  gpio_num_t knob_a, knob_b; // GPIO_NUM_NC — ручка не будит
+  uint32_t dim_ms;           // бездействие до DIM, 0 — не приглушать
+  uint32_t sleep_ms;         // бездействие до SLEEP, 0 — не засыпать
+  uint8_t active_pct;
+  uint8_t dim_pct;
+  bool wake_on_rf;
+} ui_sleep_cfg_t;
+
+#define UI_SLEEP_DIM_MS 30000
+#define UI_SLEEP_OFF_MS 90000
+
+// Контекст LVGL, после backlight_init и создания экранов
+esp_err_t ui_sleep_init(const ui_sleep_cfg_t *cfg);
+
+// Из любой задачи (не из ISR): активность вне indev LVGL.
+// true — экран спал, событие ушло на пробуждение и дальше его не обрабатывать.
+bool ui_sleep_wake(ui_wake_src_t src);
+
+// Контекст LVGL: уснуть сейчас (долгое нажатие ESC)
+void ui_sleep_now(void);
+
+ui_sleep_state_t ui_sleep_state(void);
+
+// Контекст LVGL: новые уровни подсветки (power_governor), текущий
+// применяется сразу
+void ui_sleep_set_levels(uint8_t active_pct, uint8_t dim_pct);
+
+// Из задачи фьюел-гейджа: ток батареи, мА (разряд < 0)
+void ui_sleep_power_sample(int16_t current_ma);
+
+// Сводка токов по состояниям в лог
+void ui_sleep_report(void);
@@ -0,0 +1,213 @@
+#include "ui_status_bar.h"
+
+#include <time.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "timebase.h"
+#include "ui_assets.h"
+#include "ui_bus.h"
+
+static const char *TAG = "status";
+
+#define RF_ACTIVITY_MS 500 // сколько горит индикатор после пакета
+
+static lv_subject_t s_subj_batt_level; // 0..4, шаг значка батареи
+static lv_subject_t s_subj_charging;   // 0/1
+static lv_subject_t s_subj_clock;      // минуты от полуночи
+static lv_subject_t s_subj_rf_active;  // 0/1
+
+static lv_obj_t *s_bar = NULL;
+static lv_timer_t *s_rf_off_timer = NULL;
+static esp_timer_handle_t s_clock_timer = NULL;
+
+static char s_clock_text[6]; // "HH:MM"
+
+// статистика отрисовки, сбрасывается раз в минуту
+static uint32_t s_inv_areas = 0;
+static uint64_t s_flushed_px = 0;
+
+static const char *const s_batt_symbols[5] = {
+    LV_SYMBOL_BATTERY_EMPTY, LV_SYMBOL_BATTERY_1, LV_SYMBOL_BATTERY_2,
+    LV_SYMBOL_BATTERY_3,     LV_SYMBOL_BATTERY_FULL,
+};
+
+static int batt_level_from_percent(int pct) {
+  if (pct <= 5)
+    return 0;
+  if (pct <= 25)
+    return 1;
+  if (pct <= 50)
+    return 2;
+  if (pct <= 75)
+    return 3;
+  return 4;
+}
+
+// lv_subject_set_int оповещает всегда — отсекаем повторы сами
+static void subject_update(lv_subject_t *s, int32_t v) {
+  if (lv_subject_get_int(s) != v)
+    lv_subject_set_int(s, v);
+}
+
+static int32_t clock_now_minutes(void) {
+  time_t now = timebase_now_s();
+  struct tm tm;
+  localtime_r(&now, &tm);
+  return tm.tm_hour * 60 + tm.tm_min;
+}
+
+// ------------------------- наблюдатели -------------------------
+
+static void batt_level_observer(lv_observer_t *o, lv_subject_t *s) {
+  lv_obj_t *lbl = lv_observer_get_target_obj(o);
+  int32_t lvl = lv_subject_get_int(s);
+  if (lvl < 0 || lvl > 4)
+    lvl = 0;
+  lv_label_set_text_static(lbl, s_batt_symbols[lvl]);
+}
+
+static void charging_observer(lv_observer_t *o, lv_subject_t *s) {
+  lv_obj_t *lbl = lv_observer_get_target_obj(o);
+  lv_obj_set_style_text_color(lbl,
+                              lv_subject_get_int(s) ? lv_color_hex(0xA5FF00)
+                                                    : lv_color_white(),
+                              0);
+}
+
+static void clock_observer(lv_observer_t *o, lv_subject_t *s) {
+  lv_obj_t *lbl = lv_observer_get_target_obj(o);
+  int32_t m = lv_subject_get_int(s);
+  s_clock_text[0] = (char)('0' + m / 600);
+  s_clock_text[1] = (char)('0' + (m / 60) % 10);
+  s_clock_text[2] = ':';
+  s_clock_text[3] = (char)('0' + (m % 60) / 10);
+  s_clock_text[4] = (char)('0' + m % 10);
+  s_clock_text[5] = '\0';
+  lv_label_set_text_static(lbl, s_clock_text);
+}
+
+static void rf_observer(lv_observer_t *o, lv_subject_t *s) {
+  lv_obj_t *lbl = lv_observer_get_target_obj(o);
+  lv_obj_set_style_text_opa(lbl, lv_subject_get_int(s) ? LV_OPA_COVER
+                                                       : LV_OPA_TRANSP,
+                            0);
+}
+
+// ------------------------- события -------------------------
+
+static void battery_evt_cb(ui_evt_type_t type, const void *data, void *ctx) {
+  (void)type;
+  (void)ctx;
+  const ui_evt_battery_t *b = data;
+  if (!b)
+    return;
+  subject_update(&s_subj_batt_level, batt_level_from_percent(b->pct));
+  subject_update(&s_subj_charging, b->charging ? 1 : 0);
+}
+
+static void rf_off_timer_cb(lv_timer_t *t) {
+  lv_timer_pause(t);
+  subject_update(&s_subj_rf_active, 0);
+}
+
+static void packet_evt_cb(ui_evt_type_t type, const void *data, void *ctx) {
+  (void)type;
+  (void)data;
+  (void)ctx;
+  subject_update(&s_subj_rf_active, 1);
+  lv_timer_reset(s_rf_off_timer);
+  lv_timer_resume(s_rf_off_timer);
+}
+
+static void clock_evt_cb(ui_evt_type_t type, const void *data, void *ctx) {
+  (void)type;
+  (void)data;
+  (void)ctx;
+  subject_update(&s_subj_clock, clock_now_minutes());
+
+  ESP_LOGI(TAG, "last minute: %lu invalidated areas, %lu px flushed",
+           (unsigned long)s_inv_areas, (unsigned long)s_flushed_px);
+  s_inv_areas = 0;
+  s_flushed_px = 0;
+}
+
+// esp_timer: ровно на следующей границе минуты, дальше перевзводится
+static void clock_arm(void) {
+  uint64_t us_in_min = (uint64_t)(timebase_now_us() % (60 * 1000000LL));
+  // +5 мс, чтобы при срабатывании минута уже точно сменилась
+  esp_timer_start_once(s_clock_timer, 60 * 1000000ULL - us_in_min + 5000);
+}
+
+static void clock_timer_cb(void *arg) {
+  (void)arg;
+  ui_bus_post(UI_EVT_CLOCK, NULL, 0);
+  clock_arm();
+}
+
+static void disp_stats_cb(lv_event_t *e) {
+  if (lv_event_get_code(e) == LV_EVENT_INVALIDATE_AREA) {
+    s_inv_areas++;
+  } else {
+    const lv_area_t *a = lv_event_get_param(e);
+    if (a)
+      s_flushed_px += (uint64_t)lv_area_get_size(a);
+  }
+}
+
+// ------------------------- создание -------------------------
+
+void ui_status_bar_create(lv_display_t *disp, int batt_pct) {
+  if (s_bar)
+    return;
+
+  lv_subject_init_int(&s_subj_batt_level, batt_level_from_percent(batt_pct));
+  lv_subject_init_int(&s_subj_charging, 0);
+  lv_subject_init_int(&s_subj_clock, clock_now_minutes());
+  lv_subject_init_int(&s_subj_rf_active, 0);
+
+  s_bar = lv_obj_create(lv_display_get_layer_top(disp));
+  lv_obj_remove_style_all(s_bar);
+  lv_obj_set_size(s_bar, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
+  lv_obj_align(s_bar, LV_ALIGN_TOP_RIGHT, -2, 2);
+  lv_obj_set_flex_flow(s_bar, LV_FLEX_FLOW_ROW);
+  lv_obj_set_flex_align(s_bar, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER,
+                        LV_FLEX_ALIGN_CENTER);
+  lv_obj_set_style_pad_column(s_bar, 6, 0);
+  lv_obj_set_style_text_color(s_bar, lv_color_white(), 0);
+  lv_obj_remove_flag(s_bar, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+
+  lv_obj_t *rf = lv_label_create(s_bar);
+  lv_label_set_text_static(rf, LV_SYMBOL_GPS);
+  lv_obj_set_style_text_color(rf, lv_palette_main(LV_PALETTE_RED), 0);
+  lv_subject_add_observer_obj(&s_subj_rf_active, rf_observer, rf, NULL);
+
+  lv_obj_t *clock = lv_label_create(s_bar);
+  lv_subject_add_observer_obj(&s_subj_clock, clock_observer, clock, NULL);
+
+  lv_obj_t *batt = lv_label_create(s_bar);
+  lv_obj_set_style_text_font(batt, &ui_font_18, 0);
+  lv_subject_add_observer_obj(&s_subj_batt_level, batt_level_observer, batt,
+                              NULL);
+  lv_subject_add_observer_obj(&s_subj_charging, charging_observer, batt, NULL);
+
+  s_rf_off_timer = lv_timer_create(rf_off_timer_cb, RF_ACTIVITY_MS, NULL);
+  lv_timer_pause(s_rf_off_timer);
+
+  ui_bus_subscribe(UI_EVT_BATTERY, battery_evt_cb, NULL);
+  ui_bus_subscribe(UI_EVT_PACKET, packet_evt_cb, NULL);
+  ui_bus_subscribe(UI_EVT_CLOCK, clock_evt_cb, NULL);
+
+  lv_display_add_event_cb(disp, disp_stats_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+  lv_display_add_event_cb(disp, disp_stats_cb, LV_EVENT_FLUSH_START, NULL);
+
+  const esp_timer_create_args_t targs = {
+      .callback = clock_timer_cb,
+      .name = "ui_clock",
+  };
+  if (esp_timer_create(&targs, &s_clock_timer) == ESP_OK)
+    clock_arm();
+  else
+    ESP_LOGE(TAG, "clock timer create failed");
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <stdbool.h>
+
+#include "lvgl.h"
+
+// Статус-бар поверх всех экранов (lv_layer_top): активность RF, часы,
+// батарея. Каждое значение — lv_subject; субъект меняется, только если
+// значение действительно другое, и лишь тогда наблюдатель трогает виджет.
+//
+// Данные приходят событиями ui_bus: UI_EVT_BATTERY, UI_EVT_PACKET и
+// UI_EVT_CLOCK (его шлёт esp_timer ровно на границе минуты).
+
+// Контекст LVGL, после ui_bus_init
+void ui_status_bar_create(lv_display_t *disp, int batt_pct);
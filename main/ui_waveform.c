@@ -0,0 +1,506 @@
+#include "ui_waveform.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "capture_store.h"
+#include "decoder_capture.h"
+#include "ui_bus.h"
+
+static const char *TAG = "ui_wave";
+
+#define WAVE_Y_HI 8
+#define WAVE_Y_LO (UI_WAVE_H - 9)
+#define WAVE_TRACE 255
+#define WAVE_GRID 48  // риска каждые WAVE_GRID_PX столбцов
+#define WAVE_GRID_PX 64
+#define PAN_PX 32     // столбцов на щелчок (до ускорения)
+#define CKPT_SHIFT 8  // опорная точка времени каждые 256 фронтов
+#define CKPT_MAX (DECODER_CAPTURE_EDGES >> CKPT_SHIFT)
+#define TAKE_WAIT_MS 5
+#define RETRY_MS 50   // сохранённый: хранилище было занято записью
+#define WAVE_CHUNK (1u << CKPT_SHIFT) // фронтов сохранённого захвата за чтение
+
+typedef enum {
+  WAVE_MODE_VIEW = 0, // новый захват сразу на экран, вписан целиком
+  WAVE_MODE_PAN,
+  WAVE_MODE_ZOOM,
+} wave_mode_t;
+
+static const char *const s_mode_names[] = {"", "PAN", "ZOOM"};
+
+static uint8_t *s_buf = NULL; // A8, stride = UI_WAVE_W
+static lv_obj_t *s_canvas = NULL;
+static lv_obj_t *s_info = NULL;
+static bool s_visible = false;
+static wave_mode_t s_mode = WAVE_MODE_VIEW;
+
+// окно: тики (10 мкс) на столбец и время левого края
+static uint32_t s_tpp = 1;
+static uint64_t s_t0 = 0;
+
+// что сейчас нарисовано
+static uint32_t s_seq = 0;
+static uint64_t s_total = 0;
+static uint32_t s_count = 0;
+
+// время начала фронта k << CKPT_SHIFT — вход в середину захвата без
+// прохода с начала
+static uint32_t s_ckpt[CKPT_MAX + 1];
+static uint32_t s_ckpt_n = 0;
+
+static uint32_t s_last_key_ms = 0;
+static uint32_t s_key_step = 1;
+
+// Откуда рисуем: живой захват (буфер decoder_capture, пока взят) или
+// сохранённый в capture_store — он читается кусками по WAVE_CHUNK фронтов
+// по мере прохода, целиком в RAM не бывает.
+typedef struct {
+  const uint16_t *dur; // живой; NULL — сохранённый
+  uint32_t count;
+  uint8_t first_level;
+} wave_src_t;
+
+static bool s_stored = false;
+static capture_index_t s_stored_e;
+static uint16_t s_chunk[WAVE_CHUNK];
+static uint32_t s_chunk_at = 0;
+static uint32_t s_chunk_n = 0;
+static bool s_chunk_fail = false; // за проход что-то не прочиталось
+static bool s_scan_ok = false;    // контрольные точки по целой записи
+static lv_timer_t *s_retry = NULL;
+
+static void chunk_load(uint32_t i) {
+  size_t got = 0;
+  s_chunk_at = i & ~(WAVE_CHUNK - 1);
+  // хранилище не ждёт за записью на флеш — ждём сами, как живой захват,
+  // не дольше TAKE_WAIT_MS; дальше — перерисовка по s_retry
+  int64_t until = esp_timer_get_time() + TAKE_WAIT_MS * 1000;
+  esp_err_t err;
+  while ((err = capture_store_read(&s_stored_e, s_chunk_at * sizeof(uint16_t),
+                                   s_chunk, sizeof(s_chunk), &got)) ==
+             ESP_ERR_TIMEOUT &&
+         esp_timer_get_time() < until)
+    vTaskDelay(1);
+  if (err != ESP_OK) {
+    s_chunk_fail = true;
+    if (err != ESP_ERR_TIMEOUT)
+      ESP_LOGW(TAG, "stored capture read failed at edge %lu: %s",
+               (unsigned long)s_chunk_at, esp_err_to_name(err));
+  }
+  // не дочитали — нулевые длительности: проход идёт дальше, столбцы пустые
+  memset((uint8_t *)s_chunk + got, 0, sizeof(s_chunk) - got);
+  s_chunk_n = WAVE_CHUNK;
+}
+
+static inline uint16_t dur_at(const wave_src_t *src, uint32_t i) {
+  if (src->dur)
+    return src->dur[i];
+  if (i - s_chunk_at >= s_chunk_n)
+    chunk_load(i);
+  return s_chunk[i - s_chunk_at];
+}
+
+// ------------------------- столбцы -------------------------
+
+// риски сетки привязаны ко времени, чтобы при сдвиге ехать вместе с сигналом
+static void col_clear(int x) {
+  uint8_t *p = s_buf + x;
+  uint64_t abs_x = s_t0 / s_tpp + (uint64_t)x;
+  uint8_t bg = (abs_x % WAVE_GRID_PX) ? 0 : WAVE_GRID;
+  for (int y = 0; y < UI_WAVE_H; y++, p += UI_WAVE_W)
+    *p = bg;
+}
+
+// mask: бит 0 — был низкий уровень, бит 1 — высокий; оба — вертикаль
+static void col_draw(int x, unsigned mask) {
+  col_clear(x);
+  if (!mask)
+    return;
+  int y0 = (mask & 2) ? WAVE_Y_HI : WAVE_Y_LO - 1;
+  int y1 = (mask & 1) ? WAVE_Y_LO : WAVE_Y_HI + 1;
+  uint8_t *p = s_buf + y0 * UI_WAVE_W + x;
+  for (int y = y0; y <= y1; y++, p += UI_WAVE_W)
+    *p = WAVE_TRACE;
+}
+
+// Возвращает длительность захвата в тиках
+static uint64_t build_checkpoints(const wave_src_t *src) {
+  uint64_t t = 0;
+  s_ckpt_n = 0;
+  for (uint32_t i = 0; i < src->count; i++) {
+    if (!(i & ((1u << CKPT_SHIFT) - 1)) && s_ckpt_n <= CKPT_MAX)
+      s_ckpt[s_ckpt_n++] = (uint32_t)t;
+    t += dur_at(src, i);
+  }
+  return t;
+}
+
+// Столбцы [x0, x1): min/max уровня за интервал каждого
+static void render_cols(const wave_src_t *cap, int x0, int x1) {
+  uint64_t cs = s_t0 + (uint64_t)x0 * s_tpp;
+
+  // ближайшая опорная точка не позже cs
+  uint32_t k = 0;
+  while (k + 1 < s_ckpt_n && s_ckpt[k + 1] <= cs)
+    k++;
+  uint32_t i = k << CKPT_SHIFT;
+  uint64_t e_start = s_ckpt_n ? s_ckpt[k] : 0;
+
+  for (int x = x0; x < x1; x++, cs += s_tpp) {
+    uint64_t ce = cs + s_tpp;
+    while (i < cap->count && e_start + dur_at(cap, i) <= cs) {
+      e_start += dur_at(cap, i);
+      i++;
+    }
+    unsigned mask = 0;
+    while (i < cap->count) {
+      mask |= 1u << (cap->first_level ^ (i & 1));
+      if (e_start + dur_at(cap, i) >= ce)
+        break; // фронт продолжается в следующем столбце
+      e_start += dur_at(cap, i);
+      i++;
+    }
+    col_draw(x, mask);
+  }
+}
+
+// ------------------------- окно -------------------------
+
+static uint32_t fit_tpp(void) {
+  uint64_t t = (s_total + UI_WAVE_W - 1) / UI_WAVE_W;
+  return t ? (uint32_t)t : 1;
+}
+
+static uint64_t clamp_t0(int64_t t0) {
+  int64_t max = (int64_t)s_total - (int64_t)s_tpp * UI_WAVE_W;
+  if (t0 > max)
+    t0 = max;
+  return t0 > 0 ? (uint64_t)t0 : 0;
+}
+
+// «12.34 ms» / «850 us» из тиков по 10 мкс
+static void fmt_time(char *buf, size_t n, uint64_t ticks) {
+  uint64_t us = ticks * DECODER_CAPTURE_TICK_US;
+  if (us < 1000)
+    snprintf(buf, n, "%lu us", (unsigned long)us);
+  else
+    snprintf(buf, n, "%lu.%02lu ms", (unsigned long)(us / 1000),
+             (unsigned long)(us % 1000 / 10));
+}
+
+// what — «3x» (всплесков) у живого, время записи у сохранённого
+static void update_info(uint8_t radio_id, const char *what, bool truncated) {
+  if (!s_count) {
+    lv_label_set_text_static(s_info, "Waiting for capture...");
+    return;
+  }
+  char span[16], px[16], at[16];
+  fmt_time(span, sizeof(span), s_total);
+  fmt_time(px, sizeof(px), s_tpp);
+  fmt_time(at, sizeof(at), s_t0);
+  lv_label_set_text_fmt(s_info, "r%u %s %lu edges%s %s\n%s/px @%s %s",
+                        radio_id, what, (unsigned long)s_count,
+                        truncated ? "+" : "", span, px, at,
+                        s_mode_names[s_mode]);
+}
+
+// Один проход по сохранённой записи: опорные точки и длительность
+static void stored_scan(void) {
+  wave_src_t src = {.dur = NULL, .count = s_count};
+  s_chunk_fail = false;
+  s_total = build_checkpoints(&src);
+  s_scan_ok = !s_chunk_fail;
+  s_tpp = fit_tpp();
+  s_t0 = 0;
+}
+
+static void redraw_stored(int x0, int x1) {
+  wave_src_t src = {
+      .dur = NULL,
+      .count = s_count,
+      .first_level = (s_stored_e.flags & CAPTURE_FLAG_LEVEL_HIGH) ? 1 : 0,
+  };
+  s_chunk_fail = false;
+  render_cols(&src, x0, x1);
+  if (s_chunk_fail || !s_scan_ok) {
+    lv_timer_reset(s_retry);
+    lv_timer_resume(s_retry);
+  }
+
+  time_t t = (time_t)(s_stored_e.time_us / 1000000);
+  struct tm tm;
+  localtime_r(&t, &tm);
+  char what[16];
+  strftime(what, sizeof(what), "%H:%M:%S", &tm);
+  update_info(s_stored_e.radio_id, what,
+              s_stored_e.flags & CAPTURE_FLAG_TRUNCATED);
+  lv_obj_invalidate(s_canvas);
+}
+
+// Пересчитать [x0, x1) из текущего захвата; false — захват занят
+static bool redraw(int x0, int x1) {
+  if (s_stored) {
+    redraw_stored(x0, x1);
+    return true;
+  }
+  decoder_capture_t cap;
+  if (!decoder_capture_take(&cap, pdMS_TO_TICKS(TAKE_WAIT_MS)))
+    return false;
+
+  int64_t t_start = esp_timer_get_time();
+  wave_src_t src = {
+      .dur = cap.dur,
+      .count = cap.count,
+      .first_level = cap.first_level,
+  };
+  if (cap.seq != s_seq) {
+    s_seq = cap.seq;
+    s_total = cap.total_ticks;
+    s_count = cap.count;
+    build_checkpoints(&src);
+    if (s_mode == WAVE_MODE_VIEW) {
+      s_tpp = fit_tpp();
+      s_t0 = 0;
+    }
+    x0 = 0;
+    x1 = UI_WAVE_W; // другой захват — всё заново
+  }
+  render_cols(&src, x0, x1);
+  char what[8];
+  snprintf(what, sizeof(what), "%ux", cap.bursts);
+  update_info(cap.radio_id, what, cap.truncated);
+  decoder_capture_give();
+
+  lv_obj_invalidate(s_canvas);
+  ESP_LOGD(TAG, "%d cols of %lu edges in %lld us", x1 - x0,
+           (unsigned long)s_count,
+           (long long)(esp_timer_get_time() - t_start));
+  return true;
+}
+
+static void pan_by(int32_t cols) {
+  if (!s_count)
+    return;
+  uint64_t t0 = clamp_t0((int64_t)s_t0 + (int64_t)cols * s_tpp);
+  int32_t shift = (int32_t)(((int64_t)t0 - (int64_t)s_t0) / (int64_t)s_tpp);
+  if (!shift)
+    return;
+  s_t0 += (int64_t)shift * s_tpp; // ровно на целые столбцы
+
+  if (shift >= UI_WAVE_W || shift <= -UI_WAVE_W) {
+    redraw(0, UI_WAVE_W);
+    return;
+  }
+  // остальное уже нарисовано — сдвигаем, считаем только открывшееся
+  int n = UI_WAVE_W - (shift > 0 ? shift : -shift);
+  for (int y = 0; y < UI_WAVE_H; y++) {
+    uint8_t *row = s_buf + y * UI_WAVE_W;
+    if (shift > 0)
+      memmove(row, row + shift, n);
+    else
+      memmove(row - shift, row, n);
+  }
+  if (shift > 0)
+    redraw(n, UI_WAVE_W);
+  else
+    redraw(0, -shift);
+}
+
+static void zoom_by(int steps) {
+  if (!s_count)
+    return;
+  uint64_t center = s_t0 + (uint64_t)s_tpp * UI_WAVE_W / 2;
+  uint32_t tpp = s_tpp;
+  uint32_t max = fit_tpp();
+  for (; steps > 0 && tpp > 1; steps--)
+    tpp /= 2;
+  for (; steps < 0 && tpp < max; steps++)
+    tpp = (tpp * 2 > max) ? max : tpp * 2;
+  if (tpp == s_tpp)
+    return;
+  s_tpp = tpp;
+  s_t0 = clamp_t0((int64_t)center - (int64_t)tpp * UI_WAVE_W / 2);
+  redraw(0, UI_WAVE_W);
+}
+
+// ------------------------- события -------------------------
+
+static void set_mode(wave_mode_t mode) {
+  s_mode = mode;
+  lv_group_t *g = lv_obj_get_group(s_canvas);
+  if (g)
+    lv_group_set_editing(g, mode != WAVE_MODE_VIEW);
+  // пока смотрим — новые всплески не затирают захват
+  if (!s_stored)
+    decoder_capture_hold(mode != WAVE_MODE_VIEW);
+  if (mode == WAVE_MODE_VIEW && s_count) {
+    s_tpp = fit_tpp();
+    s_t0 = 0;
+    s_seq = 0; // вдруг за это время пришёл новый — перечитать
+  }
+  redraw(0, UI_WAVE_W);
+}
+
+static void canvas_event_cb(lv_event_t *e) {
+  lv_event_code_t code = lv_event_get_code(e);
+
+  if (code == LV_EVENT_CLICKED) {
+    set_mode(s_mode == WAVE_MODE_ZOOM ? WAVE_MODE_VIEW
+                                      : (wave_mode_t)(s_mode + 1));
+    return;
+  }
+  if (code == LV_EVENT_DEFOCUSED) {
+    if (s_mode != WAVE_MODE_VIEW)
+      set_mode(WAVE_MODE_VIEW);
+    return;
+  }
+  if (code != LV_EVENT_KEY)
+    return;
+
+  uint32_t key = lv_event_get_key(e);
+  if (key != LV_KEY_LEFT && key != LV_KEY_RIGHT)
+    return;
+  int dir = (key == LV_KEY_RIGHT) ? 1 : -1;
+
+  if (s_mode == WAVE_MODE_ZOOM) {
+    zoom_by(dir);
+    return;
+  }
+  // быстрое вращение ускоряет сдвиг, как в списке пакетов
+  uint32_t now = lv_tick_get();
+  if (now - s_last_key_ms < 60) {
+    if (s_key_step < 8)
+      s_key_step *= 2;
+  } else {
+    s_key_step = 1;
+  }
+  s_last_key_ms = now;
+  pan_by(dir * (int32_t)(PAN_PX * s_key_step));
+}
+
+static void capture_evt_cb(ui_evt_type_t type, const void *data, void *ctx) {
+  (void)type;
+  (void)data;
+  (void)ctx;
+  if (!s_visible || !s_canvas || s_stored || s_mode != WAVE_MODE_VIEW)
+    return;
+  if (decoder_capture_seq() != s_seq)
+    redraw(0, UI_WAVE_W);
+}
+
+// Недочитанное (нули вместо длительностей) — заново
+static void retry_cb(lv_timer_t *t) {
+  lv_timer_pause(t);
+  if (!s_stored || !s_visible)
+    return;
+  s_chunk_n = 0;
+  if (!s_scan_ok)
+    stored_scan();
+  redraw(0, UI_WAVE_W);
+}
+
+esp_err_t ui_waveform_init(void) {
+  return ui_bus_subscribe(UI_EVT_CAPTURE, capture_evt_cb, NULL);
+}
+
+lv_obj_t *ui_waveform_create(lv_obj_t *parent, lv_group_t *group) {
+  lv_obj_t *cont = lv_obj_create(parent);
+  lv_obj_remove_style_all(cont);
+  lv_obj_set_size(cont, UI_WAVE_W, UI_WAVE_H + 24);
+  lv_obj_remove_flag(cont, LV_OBJ_FLAG_SCROLLABLE);
+
+  s_buf = heap_caps_malloc(UI_WAVE_W * UI_WAVE_H,
+                           MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+  if (!s_buf) {
+    ESP_LOGE(TAG, "no memory for %dx%d canvas", UI_WAVE_W, UI_WAVE_H);
+    return cont;
+  }
+  for (int x = 0; x < UI_WAVE_W; x++)
+    col_clear(x);
+
+  s_canvas = lv_canvas_create(cont);
+  lv_canvas_set_buffer(s_canvas, s_buf, UI_WAVE_W, UI_WAVE_H,
+                       LV_COLOR_FORMAT_A8);
+  lv_obj_set_style_image_recolor(s_canvas, lv_palette_main(LV_PALETTE_GREEN),
+                                 0);
+  lv_obj_set_style_image_recolor_opa(s_canvas, LV_OPA_COVER, 0);
+  lv_obj_set_style_outline_width(s_canvas, 1, LV_STATE_FOCUS_KEY);
+  lv_obj_set_style_outline_color(
+      s_canvas, lv_palette_main(LV_PALETTE_BLUE), LV_STATE_FOCUS_KEY);
+  lv_obj_add_flag(s_canvas, LV_OBJ_FLAG_CLICKABLE);
+  lv_obj_add_event_cb(s_canvas, canvas_event_cb, LV_EVENT_CLICKED, NULL);
+  lv_obj_add_event_cb(s_canvas, canvas_event_cb, LV_EVENT_KEY, NULL);
+  lv_obj_add_event_cb(s_canvas, canvas_event_cb, LV_EVENT_DEFOCUSED, NULL);
+  if (group)
+    lv_group_add_obj(group, s_canvas);
+
+  s_info = lv_label_create(cont);
+  lv_obj_set_style_text_font(s_info, &lv_font_unscii_8, 0);
+  lv_obj_set_style_text_color(s_info, lv_color_white(), 0);
+  lv_obj_set_pos(s_info, 4, UI_WAVE_H + 4);
+  lv_label_set_text_static(s_info, "Waiting for capture...");
+
+  s_retry = lv_timer_create(retry_cb, RETRY_MS, NULL);
+  lv_timer_pause(s_retry);
+  return cont;
+}
+
+void ui_waveform_set_visible(bool visible) {
+  s_visible = visible;
+  if (!s_canvas)
+    return;
+  if (!visible) {
+    if (s_mode != WAVE_MODE_VIEW)
+      set_mode(WAVE_MODE_VIEW);
+    return;
+  }
+  if (!s_stored && decoder_capture_seq() != s_seq)
+    redraw(0, UI_WAVE_W);
+}
+
+esp_err_t ui_waveform_open_stored(const capture_index_t *e) {
+  if (!e || e->kind != CAPTURE_KIND_RAW)
+    return ESP_ERR_INVALID_ARG;
+  if (!s_canvas)
+    return ESP_ERR_INVALID_STATE;
+  if (s_mode != WAVE_MODE_VIEW)
+    set_mode(WAVE_MODE_VIEW);
+
+  int64_t t_start = esp_timer_get_time();
+  s_stored = true;
+  s_stored_e = *e;
+  s_chunk_n = 0; // прочитать заново
+  s_count = e->len / sizeof(uint16_t);
+  stored_scan();
+  s_seq = 0;
+  redraw(0, UI_WAVE_W);
+  ESP_LOGI(TAG, "stored capture: %lu edges in %lld us", (unsigned long)s_count,
+           (long long)(esp_timer_get_time() - t_start));
+  return ESP_OK;
+}
+
+void ui_waveform_close_stored(void) {
+  if (!s_stored)
+    return;
+  if (s_mode != WAVE_MODE_VIEW)
+    set_mode(WAVE_MODE_VIEW);
+  s_stored = false;
+  lv_timer_pause(s_retry);
+  s_seq = 0;
+  s_count = 0;
+  s_total = 0;
+  for (int x = 0; x < UI_WAVE_W; x++)
+    col_clear(x);
+  lv_label_set_text_static(s_info, "Waiting for capture...");
+  lv_obj_invalidate(s_canvas);
+}
+
+bool ui_waveform_is_stored(void) { return s_stored; }
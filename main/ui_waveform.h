@@ -0,0 +1,41 @@
+#pragma once
+#include <stdbool.h>
+
+#include "capture_store.h"
+#include "esp_err.h"
+#include "lvgl.h"
+
+// Осциллограмма последнего захвата (decoder_capture): уровни и длительности
+// сырого сигнала GDO0, чтобы было видно, почему посылка не декодировалась.
+//
+// Канвас A8 UI_WAVE_W x UI_WAVE_H (1 байт на пиксель, цвет — image_recolor)
+// выделяется один раз и переиспользуется. Каждый столбец — min/max уровней
+// за его интервал времени: внутри одного столбца может быть сколько угодно
+// фронтов, проход по захвату — O(фронтов в окне + столбцов). При сдвиге
+// картинка в буфере сдвигается memmove, пересчитываются только открывшиеся
+// столбцы.
+//
+// Энкодер: нажатие — режим сдвиг -> масштаб -> просмотр. В режимах сдвига и
+// масштаба захват заморожен, в просмотре — показывается новый целиком.
+//
+// Вместо живого захвата можно показать сохранённый (capture_store): он
+// читается с флеша кусками по ходу отрисовки, в RAM — только кусок и
+// опорные точки.
+
+#define UI_WAVE_W 320
+#define UI_WAVE_H 64
+
+// Один раз при старте: подписка на UI_EVT_CAPTURE
+esp_err_t ui_waveform_init(void);
+
+// Канвас + строка состояния на parent, канвас добавляется в group
+lv_obj_t *ui_waveform_create(lv_obj_t *parent, lv_group_t *group);
+
+// Контекст LVGL: экран показан / скрыт (скрытый не пересчитывается)
+void ui_waveform_set_visible(bool visible);
+
+// Контекст LVGL: показать сохранённый сырой захват (kind RAW) вместо
+// живого / вернуться к живому
+esp_err_t ui_waveform_open_stored(const capture_index_t *e);
+void ui_waveform_close_stored(void);
+bool ui_waveform_is_stored(void);